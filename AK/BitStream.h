@@ -215,6 +215,19 @@ public:
     /// Whether we are (accidentally or intentionally) at a byte boundary right now.
     ALWAYS_INLINE bool is_aligned_to_byte_boundary() const { return m_bit_offset == 0; }
 
+    /// The part of the current byte that hasn't been read yet. Code that rewinds the underlying
+    /// stream can restore this along with it to go back to an earlier position.
+    struct BitPosition {
+        Optional<u8> current_byte;
+        size_t bit_offset { 0 };
+    };
+    BitPosition bit_position() const { return { m_current_byte, m_bit_offset }; }
+    void set_bit_position(BitPosition const& position)
+    {
+        m_current_byte = position.current_byte;
+        m_bit_offset = position.bit_offset;
+    }
+
 private:
     Optional<u8> m_current_byte;
     size_t m_bit_offset { 0 };
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+// An I/O ring is shared between a process and the kernel by mmap()ing the descriptor returned by
+// io_ring_create(). The process queues submissions and advances submission_tail, then calls
+// io_ring_enter() to have the kernel consume them. The kernel posts one completion per consumed
+// submission and advances completion_tail; the process advances completion_head once it has
+// looked at them. Each side only ever writes its own index.
+
+enum class IORingOpcode : u8 {
+    Nop = 0,
+    Read = 1,
+    Write = 2,
+    Fsync = 3,
+};
+
+struct IORingSubmission {
+    IORingOpcode opcode { IORingOpcode::Nop };
+    u8 reserved[3] {};
+    i32 fd { -1 };
+    // A negative offset reads or writes at (and advances) the current file offset.
+    i64 offset { -1 };
+    u64 buffer { 0 };
+    u64 length { 0 };
+    // Passed through to the completion untouched.
+    u64 user_data { 0 };
+};
+
+struct IORingCompletion {
+    u64 user_data { 0 };
+    // The number of bytes transferred, or a negated errno value.
+    i64 result { 0 };
+};
+
+struct IORingHeader {
+    u32 submission_head;
+    u32 submission_tail;
+    u32 completion_head;
+    u32 completion_tail;
+    u32 submission_entry_count;
+    u32 completion_entry_count;
+};
+
+static constexpr u32 IO_RING_MAX_ENTRIES = 4096;
+
+// Completions are posted while submissions are still queued, so the completion ring is larger.
+constexpr u32 io_ring_completion_entry_count(u32 submission_entry_count)
+{
+    return submission_entry_count * 2;
+}
+
+constexpr size_t io_ring_submissions_offset()
+{
+    return 64;
+}
+
+constexpr size_t io_ring_completions_offset(u32 submission_entry_count)
+{
+    return io_ring_submissions_offset() + submission_entry_count * sizeof(IORingSubmission);
+}
+
+constexpr size_t io_ring_size(u32 submission_entry_count)
+{
+    return io_ring_completions_offset(submission_entry_count) + io_ring_completion_entry_count(submission_entry_count) * sizeof(IORingCompletion);
+}
+
+static_assert(sizeof(IORingHeader) <= io_ring_submissions_offset());
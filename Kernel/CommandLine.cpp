@@ -192,6 +192,16 @@ bool CommandLine::is_pc_speaker_enabled() const
     PANIC("Unknown pcspeaker setting: {}", value);
 }
 
+UNMAP_AFTER_INIT bool CommandLine::are_transparent_huge_pages_enabled() const
+{
+    auto value = lookup("thp"sv).value_or("on"sv);
+    if (value == "on"sv)
+        return true;
+    if (value == "off"sv)
+        return false;
+    PANIC("Unknown thp setting: {}", value);
+}
+
 UNMAP_AFTER_INIT bool CommandLine::is_force_pio() const
 {
     return contains("force_pio"sv);
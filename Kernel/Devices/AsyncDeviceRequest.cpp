@@ -41,6 +41,9 @@ AsyncDeviceRequest::~AsyncDeviceRequest()
 
 void AsyncDeviceRequest::request_finished()
 {
+    // The device may drop its last reference to us once it learns that we're done.
+    NonnullLockRefPtr<AsyncDeviceRequest> protector(*this);
+
     if (m_parent_request)
         m_parent_request->sub_request_finished(*this);
 
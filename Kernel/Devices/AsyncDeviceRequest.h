@@ -73,6 +73,7 @@ public:
     }
 
     void complete(RequestResult result);
+    RequestResult get_request_result() const;
 
     void set_private(void* priv)
     {
@@ -120,8 +121,6 @@ public:
 protected:
     AsyncDeviceRequest(Device&);
 
-    RequestResult get_request_result() const;
-
 private:
     void sub_request_finished(AsyncDeviceRequest&);
     void request_finished();
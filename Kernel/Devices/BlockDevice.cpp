@@ -22,7 +22,7 @@ AsyncBlockDeviceRequest::AsyncBlockDeviceRequest(Device& block_device, RequestTy
 
 void AsyncBlockDeviceRequest::start()
 {
-    m_block_device.start_request(*this);
+    m_block_device.submit_request({}, *this);
 }
 
 BlockDevice::~BlockDevice() = default;
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/IntegralMath.h>
+#include <AK/IntrusiveList.h>
 #include <Kernel/Devices/Device.h>
 #include <Kernel/Library/LockWeakable.h>
 
@@ -27,6 +28,15 @@ public:
 
     virtual void start_request(AsyncBlockDeviceRequest&) = 0;
 
+    // Called by AsyncBlockDeviceRequest::start(). Devices with a request queue hold on to the
+    // request here and hand it to start_request() once it's its turn.
+    virtual void submit_request(Badge<AsyncBlockDeviceRequest>, AsyncBlockDeviceRequest& request) { start_request(request); }
+
+    // While plugged, a device holds back submitted requests, so that a whole batch of them can be
+    // merged and sorted before the first one is sent off.
+    virtual void plug_request_queue() { }
+    virtual void unplug_request_queue() { }
+
 protected:
     BlockDevice(MajorNumber major, MinorNumber minor, size_t block_size = PAGE_SIZE)
         : Device(major, minor)
@@ -84,12 +94,23 @@ public:
     }
 
 private:
+    friend class StorageDevice;
+
     BlockDevice& m_block_device;
     const RequestType m_request_type;
     const u64 m_block_index;
     const u32 m_block_count;
     UserOrKernelBuffer m_buffer;
     const size_t m_buffer_size;
+
+    IntrusiveListNode<AsyncBlockDeviceRequest, LockRefPtr<AsyncBlockDeviceRequest>> m_queue_list_node;
+
+public:
+    using QueueList = IntrusiveList<&AsyncBlockDeviceRequest::m_queue_list_node>;
+
+private:
+    // Only used by requests a request queue made up to carry several merged ones.
+    QueueList m_merged_requests;
 };
 
 }
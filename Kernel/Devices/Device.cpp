@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Find.h>
 #include <AK/Singleton.h>
 #include <Kernel/Devices/Device.h>
 #include <Kernel/Devices/DeviceManagement.h>
@@ -72,6 +73,18 @@ ErrorOr<NonnullLockRefPtr<OpenFileDescription>> Device::open(int options)
 void Device::process_next_queued_request(Badge<AsyncDeviceRequest>, AsyncDeviceRequest const& completed_request)
 {
     SpinlockLocker lock(m_requests_lock);
+    if (starts_requests_immediately()) {
+        // Requests the device made up itself never went through our queue.
+        auto it = AK::find_if(m_requests.begin(), m_requests.end(), [&](auto& request) { return request.ptr() == &completed_request; });
+        if (it != m_requests.end())
+            m_requests.remove(it);
+        lock.unlock();
+
+        request_did_complete(completed_request);
+        evaluate_block_conditions();
+        return;
+    }
+
     VERIFY(!m_requests.is_empty());
     VERIFY(m_requests.first().ptr() == &completed_request);
     m_requests.remove(m_requests.begin());
@@ -61,7 +61,7 @@ public:
         SpinlockLocker lock(m_requests_lock);
         bool was_empty = m_requests.is_empty();
         TRY(m_requests.try_append(request));
-        if (was_empty)
+        if (was_empty || starts_requests_immediately())
             request->do_start(move(lock));
         return request;
     }
@@ -74,6 +74,11 @@ protected:
     void after_inserting_add_to_device_management();
     void before_will_be_destroyed_remove_from_device_management();
 
+    // Devices that order their requests themselves (or pass them on to one that does) get each
+    // request started as soon as it is made, rather than one after the other.
+    virtual bool starts_requests_immediately() const { return false; }
+    virtual void request_did_complete(AsyncDeviceRequest const&) { }
+
     virtual void after_inserting_add_symlink_to_device_identifier_directory() = 0;
     virtual void before_will_be_destroyed_remove_symlink_from_device_identifier_directory() = 0;
 
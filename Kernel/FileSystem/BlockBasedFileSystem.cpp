@@ -6,7 +6,9 @@
 
 #include <AK/IntrusiveList.h>
 #include <Kernel/Debug.h>
+#include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
+#include <Kernel/Memory/MemoryManager.h>
 #include <Kernel/Process.h>
 
 namespace Kernel {
@@ -16,20 +18,47 @@ struct CacheEntry {
     BlockBasedFileSystem::BlockIndex block_index { 0 };
     u8* data { nullptr };
     bool has_data { false };
+    bool is_read_ahead { false };
+};
+
+// The cache is made up of equally sized segments, so that it can grow while the system
+// has plenty of memory to spare, and give whole segments back when memory gets tight.
+struct CacheSegment {
+    NonnullOwnPtr<KBuffer> block_data;
+    NonnullOwnPtr<KBuffer> entries_data;
+
+    CacheEntry* entries() { return (CacheEntry*)entries_data->data(); }
 };
 
 class DiskCache {
 public:
-    static constexpr size_t EntryCount = 10000;
-    explicit DiskCache(BlockBasedFileSystem& fs, NonnullOwnPtr<KBuffer> cached_block_data, NonnullOwnPtr<KBuffer> entries_buffer)
-        : m_fs(fs)
-        , m_cached_block_data(move(cached_block_data))
-        , m_entries(move(entries_buffer))
+    static constexpr size_t EntriesPerSegment = 1024;
+    static constexpr size_t MinimumEntryCount = EntriesPerSegment;
+    static constexpr size_t MaximumEntryCount = 64 * EntriesPerSegment;
+
+    // The cache aims to use at most 1/TargetMemoryFraction of the uncommitted physical memory,
+    // and will give memory back once less than 1/LowMemoryFraction of it is left.
+    static constexpr size_t TargetMemoryFraction = 16;
+    static constexpr size_t LowMemoryFraction = 32;
+
+    static constexpr size_t MinimumReadAheadBlockCount = 4;
+    static constexpr size_t MaximumReadAheadBlockCount = 64;
+
+    static ErrorOr<NonnullOwnPtr<DiskCache>> try_create(BlockBasedFileSystem& fs)
     {
-        for (size_t i = 0; i < EntryCount; ++i) {
-            entries()[i].data = m_cached_block_data->data() + i * m_fs->block_size();
-            m_clean_list.append(entries()[i]);
+        auto read_ahead_buffer = TRY(KBuffer::try_create_with_size("BlockBasedFS: Read-ahead buffer"sv, MaximumReadAheadBlockCount * fs.block_size()));
+        auto cache = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCache(fs, move(read_ahead_buffer))));
+
+        auto segment_count = max<size_t>(1, cache->target_entry_count() / EntriesPerSegment);
+        for (size_t i = 0; i < segment_count; ++i) {
+            auto result = cache->try_add_segment();
+            // We need at least one segment to be able to cache anything at all.
+            if (result.is_error() && i == 0)
+                return result.release_error();
+            if (result.is_error())
+                break;
         }
+        return cache;
     }
 
     ~DiskCache() = default;
@@ -80,17 +109,63 @@ public:
         auto& new_entry = *m_clean_list.last();
         m_clean_list.prepend(new_entry);
 
-        m_hash.remove(new_entry.block_index);
+        if (new_entry.has_data)
+            ++m_statistics.evictions;
+        remove_from_hash(new_entry);
         TRY(m_hash.try_set(block_index, &new_entry));
 
         new_entry.block_index = block_index;
         new_entry.has_data = false;
+        new_entry.is_read_ahead = false;
 
         return &new_entry;
     }
 
-    CacheEntry const* entries() const { return (CacheEntry const*)m_entries->data(); }
-    CacheEntry* entries() { return (CacheEntry*)m_entries->data(); }
+    void did_hit(CacheEntry& entry)
+    {
+        ++m_statistics.hits;
+        if (entry.is_read_ahead) {
+            ++m_statistics.read_ahead_hits;
+            entry.is_read_ahead = false;
+        }
+    }
+
+    void did_miss()
+    {
+        ++m_statistics.misses;
+        if (++m_misses_since_resize >= EntriesPerSegment) {
+            m_misses_since_resize = 0;
+            resize_if_needed();
+        }
+    }
+
+    void did_read_ahead(CacheEntry& entry)
+    {
+        ++m_statistics.read_ahead_blocks;
+        entry.is_read_ahead = true;
+    }
+
+    // Records a read of the given block and returns how many blocks should be read ahead
+    // of it, should it have to be fetched from disk.
+    size_t record_read(BlockBasedFileSystem::BlockIndex block_index)
+    {
+        bool is_sequential = m_last_read_block_index.has_value() && block_index.value() == m_last_read_block_index->value() + 1;
+        m_last_read_block_index = block_index;
+
+        if (!is_sequential) {
+            m_read_ahead_block_count = 0;
+            return 0;
+        }
+
+        // Start out small, and double the window for as long as the reads keep being sequential.
+        if (m_read_ahead_block_count == 0)
+            m_read_ahead_block_count = MinimumReadAheadBlockCount;
+        else
+            m_read_ahead_block_count = min(m_read_ahead_block_count * 2, MaximumReadAheadBlockCount);
+        return m_read_ahead_block_count;
+    }
+
+    u8* read_ahead_buffer() { return m_read_ahead_buffer->data(); }
 
     template<typename Callback>
     void for_each_dirty_entry(Callback callback)
@@ -99,13 +174,108 @@ public:
             callback(entry);
     }
 
+    BlockBasedFileSystem::DiskCacheStatistics statistics() const
+    {
+        auto statistics = m_statistics;
+        statistics.entry_count = m_segments.size() * EntriesPerSegment;
+        return statistics;
+    }
+
 private:
+    DiskCache(BlockBasedFileSystem& fs, NonnullOwnPtr<KBuffer> read_ahead_buffer)
+        : m_fs(fs)
+        , m_read_ahead_buffer(move(read_ahead_buffer))
+    {
+    }
+
+    size_t target_entry_count() const
+    {
+        auto uncommitted_bytes = MM.get_system_memory_info().physical_pages_uncommitted * PAGE_SIZE;
+        auto entry_count = uncommitted_bytes / TargetMemoryFraction / m_fs->block_size();
+        return clamp(entry_count, MinimumEntryCount, MaximumEntryCount);
+    }
+
+    static bool is_low_on_memory()
+    {
+        auto memory_info = MM.get_system_memory_info();
+        return memory_info.physical_pages_uncommitted < memory_info.physical_pages / LowMemoryFraction;
+    }
+
+    ErrorOr<void> try_add_segment() const
+    {
+        auto block_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache blocks"sv, EntriesPerSegment * m_fs->block_size()));
+        auto entries_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache entries"sv, EntriesPerSegment * sizeof(CacheEntry)));
+        TRY(m_hash.try_ensure_capacity((m_segments.size() + 1) * EntriesPerSegment));
+        TRY(m_segments.try_append(CacheSegment { move(block_data), move(entries_data) }));
+
+        auto& segment = m_segments.last();
+        for (size_t i = 0; i < EntriesPerSegment; ++i) {
+            auto* entry = new (&segment.entries()[i]) CacheEntry;
+            entry->data = segment.block_data->data() + i * m_fs->block_size();
+            // New entries are the first ones to be handed out by ensure().
+            m_clean_list.append(*entry);
+        }
+        return {};
+    }
+
+    void remove_last_segment() const
+    {
+        VERIFY(m_segments.size() > 1);
+        auto& segment = m_segments.last();
+
+        bool has_dirty_entries = false;
+        for (size_t i = 0; i < EntriesPerSegment && !has_dirty_entries; ++i)
+            has_dirty_entries = entry_is_dirty(segment.entries()[i]);
+        if (has_dirty_entries)
+            m_fs->flush_writes_impl();
+
+        for (size_t i = 0; i < EntriesPerSegment; ++i) {
+            auto& entry = segment.entries()[i];
+            VERIFY(!entry_is_dirty(entry));
+            remove_from_hash(entry);
+            m_clean_list.remove(entry);
+            entry.~CacheEntry();
+        }
+        m_segments.take_last();
+    }
+
+    void resize_if_needed() const
+    {
+        if (is_low_on_memory()) {
+            if (m_segments.size() > 1) {
+                dbgln_if(BBFS_DEBUG, "{}: Shrinking disk cache to {} entries", m_fs->class_name(), (m_segments.size() - 1) * EntriesPerSegment);
+                remove_last_segment();
+            }
+            return;
+        }
+
+        // We keep missing, so grow the cache if there's enough memory to spare for it.
+        if ((m_segments.size() + 1) * EntriesPerSegment > target_entry_count())
+            return;
+        if (!try_add_segment().is_error())
+            dbgln_if(BBFS_DEBUG, "{}: Growing disk cache to {} entries", m_fs->class_name(), m_segments.size() * EntriesPerSegment);
+    }
+
+    void remove_from_hash(CacheEntry& entry) const
+    {
+        // Entries that were never handed out have a stale block index, so make
+        // sure we don't accidentally evict another entry for that block.
+        auto it = m_hash.find(entry.block_index);
+        if (it != m_hash.end() && it->value == &entry)
+            m_hash.remove(it);
+    }
+
     mutable NonnullRefPtr<BlockBasedFileSystem> m_fs;
     mutable IntrusiveList<&CacheEntry::list_node> m_dirty_list;
     mutable IntrusiveList<&CacheEntry::list_node> m_clean_list;
     mutable HashMap<BlockBasedFileSystem::BlockIndex, CacheEntry*> m_hash;
-    NonnullOwnPtr<KBuffer> m_cached_block_data;
-    NonnullOwnPtr<KBuffer> m_entries;
+    mutable Vector<CacheSegment> m_segments;
+    NonnullOwnPtr<KBuffer> m_read_ahead_buffer;
+
+    Optional<BlockBasedFileSystem::BlockIndex> m_last_read_block_index;
+    size_t m_read_ahead_block_count { 0 };
+    size_t m_misses_since_resize { 0 };
+    mutable BlockBasedFileSystem::DiskCacheStatistics m_statistics;
 };
 
 BlockBasedFileSystem::BlockBasedFileSystem(OpenFileDescription& file_description)
@@ -129,9 +299,7 @@ ErrorOr<void> BlockBasedFileSystem::initialize_while_locked()
     VERIFY(m_lock.is_locked());
     VERIFY(!is_initialized_while_locked());
     VERIFY(block_size() != 0);
-    auto cached_block_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache blocks"sv, DiskCache::EntryCount * block_size()));
-    auto entries_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache entries"sv, DiskCache::EntryCount * sizeof(CacheEntry)));
-    auto disk_cache = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCache(*this, move(cached_block_data), move(entries_data))));
+    auto disk_cache = TRY(DiskCache::try_create(*this));
 
     m_cache.with_exclusive([&](auto& cache) {
         cache = move(disk_cache);
@@ -161,11 +329,11 @@ ErrorOr<void> BlockBasedFileSystem::write_block(BlockIndex index, UserOrKernelBu
             return {};
         }
 
-        auto entry = TRY(cache->ensure(index));
         if (count < block_size()) {
             // Fill the cache first.
             TRY(read_block(index, nullptr, block_size()));
         }
+        auto entry = TRY(cache->ensure(index));
         memcpy(entry->data + offset, buffered_data.data(), count);
 
         cache->mark_dirty(*entry);
@@ -235,13 +403,20 @@ ErrorOr<void> BlockBasedFileSystem::read_block(BlockIndex index, UserOrKernelBuf
             return {};
         }
 
-        auto* entry = TRY(cache->ensure(index));
-        if (!entry->has_data) {
-            auto base_offset = index.value() * block_size();
-            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry->data);
-            auto nread = TRY(file_description().read(entry_data_buffer, base_offset, block_size()));
-            VERIFY(nread == block_size());
-            entry->has_data = true;
+        // A null buffer means we are only filling the cache on behalf of a partial write,
+        // which shouldn't count towards detecting sequential reads.
+        auto read_ahead_count = buffer ? cache->record_read(index) : 0;
+
+        auto* entry = cache->get(index);
+        if (entry && entry->has_data) {
+            cache->did_hit(*entry);
+        } else {
+            cache->did_miss();
+            entry = TRY(cache->ensure(index));
+            if (read_ahead_count > 0)
+                TRY(read_block_with_read_ahead(*cache, *entry, read_ahead_count));
+            else
+                TRY(read_block_into_cache_entry(*entry));
         }
         if (buffer)
             TRY(buffer->write(entry->data + offset, count));
@@ -249,6 +424,54 @@ ErrorOr<void> BlockBasedFileSystem::read_block(BlockIndex index, UserOrKernelBuf
     });
 }
 
+ErrorOr<void> BlockBasedFileSystem::read_block_into_cache_entry(CacheEntry& entry) const
+{
+    auto base_offset = entry.block_index.value() * block_size();
+    auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
+    auto nread = TRY(file_description().read(entry_data_buffer, base_offset, block_size()));
+    VERIFY(nread == block_size());
+    entry.has_data = true;
+    return {};
+}
+
+ErrorOr<void> BlockBasedFileSystem::read_block_with_read_ahead(DiskCache& cache, CacheEntry& entry, size_t read_ahead_count) const
+{
+    auto index = entry.block_index;
+
+    // Only read ahead up to the first block we already have, so we never clobber
+    // data that's still waiting to be written out.
+    size_t block_count = 1;
+    while (block_count <= read_ahead_count) {
+        auto* next_entry = cache.get(BlockIndex { index.value() + block_count });
+        if (next_entry && next_entry->has_data)
+            break;
+        ++block_count;
+    }
+    if (block_count == 1)
+        return read_block_into_cache_entry(entry);
+
+    dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::read_block {}, reading {} blocks ahead", index, block_count - 1);
+
+    auto base_offset = index.value() * block_size();
+    auto read_ahead_buffer = UserOrKernelBuffer::for_kernel_buffer(cache.read_ahead_buffer());
+    auto nread = TRY(file_description().read(read_ahead_buffer, base_offset, block_count * block_size()));
+    // We may run into the end of the device while reading ahead, but the block we were asked for must be there.
+    VERIFY(nread >= block_size());
+
+    memcpy(entry.data, cache.read_ahead_buffer(), block_size());
+    entry.has_data = true;
+
+    for (size_t i = 1; i < nread / block_size(); ++i) {
+        auto* read_ahead_entry = TRY(cache.ensure(BlockIndex { index.value() + i }));
+        if (read_ahead_entry->has_data)
+            continue;
+        memcpy(read_ahead_entry->data, cache.read_ahead_buffer() + i * block_size(), block_size());
+        read_ahead_entry->has_data = true;
+        cache.did_read_ahead(*read_ahead_entry);
+    }
+    return {};
+}
+
 ErrorOr<void> BlockBasedFileSystem::read_blocks(BlockIndex index, unsigned count, UserOrKernelBuffer& buffer, bool allow_cache) const
 {
     VERIFY(m_logical_block_size);
@@ -281,18 +504,56 @@ void BlockBasedFileSystem::flush_specific_block_if_needed(BlockIndex index)
     });
 }
 
+// Hands all dirty blocks to the device at once, so that its request queue can merge neighbouring
+// ones into larger transfers, rather than writing them out one after the other.
+static ErrorOr<size_t> write_dirty_entries_to_device(BlockDevice& device, DiskCache& cache, u64 block_size)
+{
+    Vector<NonnullLockRefPtr<AsyncBlockDeviceRequest>> requests;
+    auto device_blocks_per_block = block_size / device.block_size();
+
+    ErrorOr<void> result;
+    device.plug_request_queue();
+    cache.for_each_dirty_entry([&](CacheEntry& entry) {
+        if (result.is_error())
+            return;
+        auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
+        auto request_or_error = device.try_make_request<AsyncBlockDeviceRequest>(AsyncBlockDeviceRequest::Write, entry.block_index.value() * device_blocks_per_block, device_blocks_per_block, entry_data_buffer, block_size);
+        if (request_or_error.is_error())
+            result = request_or_error.release_error();
+        else
+            result = requests.try_append(request_or_error.release_value());
+    });
+    device.unplug_request_queue();
+
+    for (auto& request : requests)
+        (void)request->wait();
+    TRY(result);
+    return requests.size();
+}
+
 void BlockBasedFileSystem::flush_writes_impl()
 {
     size_t count = 0;
     m_cache.with_exclusive([&](auto& cache) {
         if (!cache->is_dirty())
             return;
-        cache->for_each_dirty_entry([&](CacheEntry& entry) {
-            auto base_offset = entry.block_index.value() * block_size();
-            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
-            [[maybe_unused]] auto rc = file_description().write(base_offset, entry_data_buffer, block_size());
-            ++count;
-        });
+
+        auto& file = file_description().file();
+        if (file.is_block_device() && block_size() % static_cast<BlockDevice&>(file).block_size() == 0) {
+            auto count_or_error = write_dirty_entries_to_device(static_cast<BlockDevice&>(file), *cache, block_size());
+            if (!count_or_error.is_error())
+                count = count_or_error.value();
+        }
+
+        // Either we couldn't queue up all of them, or there's no block device to queue them on.
+        if (count == 0) {
+            cache->for_each_dirty_entry([&](CacheEntry& entry) {
+                auto base_offset = entry.block_index.value() * block_size();
+                auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
+                [[maybe_unused]] auto rc = file_description().write(base_offset, entry_data_buffer, block_size());
+                ++count;
+            });
+        }
         cache->mark_all_clean();
         dbgln("{}: Flushed {} blocks to disk", class_name(), count);
     });
@@ -303,4 +564,13 @@ void BlockBasedFileSystem::flush_writes()
     flush_writes_impl();
 }
 
+BlockBasedFileSystem::DiskCacheStatistics BlockBasedFileSystem::disk_cache_statistics() const
+{
+    return m_cache.with_exclusive([&](auto& cache) -> DiskCacheStatistics {
+        if (!cache)
+            return {};
+        return cache->statistics();
+    });
+}
+
 }
@@ -11,6 +11,8 @@
 
 namespace Kernel {
 
+struct CacheEntry;
+
 class BlockBasedFileSystem : public FileBackedFileSystem {
 public:
     AK_TYPEDEF_DISTINCT_ORDERED_ID(u64, BlockIndex);
@@ -22,6 +24,16 @@ public:
     virtual void flush_writes() override;
     void flush_writes_impl();
 
+    struct DiskCacheStatistics {
+        u64 entry_count { 0 };
+        u64 hits { 0 };
+        u64 misses { 0 };
+        u64 evictions { 0 };
+        u64 read_ahead_blocks { 0 };
+        u64 read_ahead_hits { 0 };
+    };
+    DiskCacheStatistics disk_cache_statistics() const;
+
 protected:
     explicit BlockBasedFileSystem(OpenFileDescription&);
 
@@ -44,6 +56,11 @@ protected:
     void remove_disk_cache_before_last_unmount();
 
 private:
+    virtual bool is_block_based() const override { return true; }
+
+    ErrorOr<void> read_block_into_cache_entry(CacheEntry&) const;
+    ErrorOr<void> read_block_with_read_ahead(DiskCache&, CacheEntry&, size_t read_ahead_count) const;
+
     void flush_specific_block_if_needed(BlockIndex index);
 
     mutable MutexProtected<OwnPtr<DiskCache>> m_cache;
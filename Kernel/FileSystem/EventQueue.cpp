@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/EventQueue.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+static BlockFlags block_flags_for_events(u32 events)
+{
+    BlockFlags block_flags = BlockFlags::WriteError | BlockFlags::WriteHangUp; // Like poll(), always report EPOLLERR and EPOLLHUP.
+    if (events & EPOLLIN)
+        block_flags |= BlockFlags::Read;
+    if (events & EPOLLOUT)
+        block_flags |= BlockFlags::Write;
+    if (events & EPOLLPRI)
+        block_flags |= BlockFlags::ReadPriority;
+    if (events & EPOLLWRBAND)
+        block_flags |= BlockFlags::WritePriority;
+    if (events & EPOLLRDHUP)
+        block_flags |= BlockFlags::ReadHangUp;
+    return block_flags;
+}
+
+static u32 events_for_unblocked_flags(BlockFlags unblocked_flags)
+{
+    u32 events = 0;
+    if (has_flag(unblocked_flags, BlockFlags::WriteHangUp))
+        events |= EPOLLHUP;
+    if (has_flag(unblocked_flags, BlockFlags::WriteError))
+        return events | EPOLLERR;
+    if (has_flag(unblocked_flags, BlockFlags::Read))
+        events |= EPOLLIN;
+    if (has_flag(unblocked_flags, BlockFlags::ReadPriority))
+        events |= EPOLLPRI;
+    if (!has_flag(unblocked_flags, BlockFlags::WriteHangUp) && has_flag(unblocked_flags, BlockFlags::Write))
+        events |= EPOLLOUT;
+    if (has_flag(unblocked_flags, BlockFlags::WritePriority))
+        events |= EPOLLWRBAND;
+    if (has_flag(unblocked_flags, BlockFlags::ReadHangUp))
+        events |= EPOLLRDHUP;
+    return events;
+}
+
+ErrorOr<NonnullLockRefPtr<EventQueue>> EventQueue::try_create()
+{
+    return adopt_nonnull_lock_ref_or_enomem(new (nothrow) EventQueue);
+}
+
+EventQueue::~EventQueue()
+{
+    (void)close();
+}
+
+bool EventQueue::can_read(OpenFileDescription const&, u64) const
+{
+    SpinlockLocker lock(m_ready_lock);
+    return !m_ready_watches.is_empty();
+}
+
+ErrorOr<void> EventQueue::close()
+{
+    MutexLocker locker(m_watches_lock);
+    for (auto& it : m_watches)
+        detach_watch(*it.value);
+    m_watches.clear();
+    return {};
+}
+
+ErrorOr<NonnullOwnPtr<KString>> EventQueue::pseudo_path(OpenFileDescription const&) const
+{
+    return KString::formatted("EventQueue:({})", m_watches.size());
+}
+
+void EventQueue::Watch::update(epoll_event const& event)
+{
+    m_events = event.events;
+    m_data = event.data.u64;
+    m_block_flags = block_flags_for_events(event.events);
+    m_disarmed = false;
+}
+
+void EventQueue::Watch::readiness_may_have_changed()
+{
+    // NOTE: The observed description can't go away while we're being called.
+    auto* description = observed_description();
+    VERIFY(description);
+    if (description->should_unblock(m_block_flags) == BlockFlags::None)
+        return;
+    m_queue.watch_became_ready(*this);
+}
+
+void EventQueue::Watch::description_was_closed()
+{
+    SpinlockLocker lock(m_queue.m_ready_lock);
+    m_queue.m_ready_watches.remove(*this);
+}
+
+void EventQueue::watch_became_ready(Watch& watch)
+{
+    {
+        SpinlockLocker lock(m_ready_lock);
+        if (watch.m_disarmed || watch.m_ready_list_node.is_in_list())
+            return;
+        m_ready_watches.append(watch);
+    }
+    m_wait_queue.wake_all();
+    evaluate_block_conditions();
+}
+
+void EventQueue::detach_watch(Watch& watch)
+{
+    VERIFY(m_watches_lock.is_locked());
+    SpinlockLocker global_lock(FileReadinessObserver::lock());
+    if (auto* description = watch.observed_description())
+        description->blocker_set().remove_observer(watch);
+    SpinlockLocker lock(m_ready_lock);
+    m_ready_watches.remove(watch);
+}
+
+ErrorOr<void> EventQueue::add_watch(int fd, OpenFileDescription& description, epoll_event const& event)
+{
+    // Watching another event queue would mean taking two queues' locks in arbitrary order.
+    if (description.is_event_queue())
+        return EINVAL;
+
+    MutexLocker locker(m_watches_lock);
+    if (auto it = m_watches.find(fd); it != m_watches.end()) {
+        // A watch whose description has been closed can be replaced by one for whatever got that fd next.
+        if (it->value->observed_description())
+            return EEXIST;
+        detach_watch(*it->value);
+        m_watches.remove(it);
+    }
+
+    auto watch = TRY(adopt_nonnull_own_or_enomem(new (nothrow) Watch(*this, fd, description, event)));
+    auto& watch_ref = *watch;
+    TRY(m_watches.try_set(fd, move(watch)));
+
+    SpinlockLocker global_lock(FileReadinessObserver::lock());
+    description.blocker_set().add_observer(watch_ref);
+    return {};
+}
+
+ErrorOr<void> EventQueue::modify_watch(int fd, epoll_event const& event)
+{
+    MutexLocker locker(m_watches_lock);
+    auto it = m_watches.find(fd);
+    if (it == m_watches.end() || !it->value->observed_description())
+        return ENOENT;
+
+    auto& watch = *it->value;
+    SpinlockLocker global_lock(FileReadinessObserver::lock());
+    auto* description = watch.observed_description();
+    VERIFY(description);
+    {
+        SpinlockLocker lock(m_ready_lock);
+        watch.update(event);
+        m_ready_watches.remove(watch);
+    }
+    // Re-arm the watch by re-evaluating it against the new interest flags.
+    if (description->should_unblock(watch.m_block_flags) != BlockFlags::None)
+        watch_became_ready(watch);
+    return {};
+}
+
+ErrorOr<void> EventQueue::remove_watch(int fd)
+{
+    MutexLocker locker(m_watches_lock);
+    auto it = m_watches.find(fd);
+    if (it == m_watches.end())
+        return ENOENT;
+    detach_watch(*it->value);
+    m_watches.remove(it);
+    return {};
+}
+
+ErrorOr<size_t> EventQueue::collect_events(Span<epoll_event> events)
+{
+    if (events.is_empty())
+        return 0;
+
+    Vector<Watch*, 64> candidates;
+    TRY(candidates.try_ensure_capacity(events.size()));
+
+    MutexLocker locker(m_watches_lock);
+    // Holding this keeps every observed description alive until we're done asking it about its state.
+    SpinlockLocker global_lock(FileReadinessObserver::lock());
+
+    {
+        SpinlockLocker lock(m_ready_lock);
+        while (!m_ready_watches.is_empty() && candidates.size() < events.size())
+            candidates.unchecked_append(m_ready_watches.take_first());
+    }
+
+    size_t count = 0;
+    // NOTE: Don't ask the descriptions about their state with m_ready_lock held, as files may call
+    //       back into us (through their blocker set) while holding their own locks.
+    for (auto* watch : candidates) {
+        auto* description = watch->observed_description();
+        if (!description)
+            continue;
+        auto unblocked_flags = description->should_unblock(watch->m_block_flags);
+        if (unblocked_flags == BlockFlags::None)
+            continue;
+
+        events[count++] = { events_for_unblocked_flags(unblocked_flags), { .u64 = watch->m_data } };
+
+        SpinlockLocker lock(m_ready_lock);
+        if (watch->is_one_shot()) {
+            watch->m_disarmed = true;
+            continue;
+        }
+        // Level-triggered watches stay queued for as long as they're ready. Edge-triggered ones
+        // are only queued again once their file re-evaluates its block conditions.
+        if (!watch->is_edge_triggered() && !watch->m_ready_list_node.is_in_list())
+            m_ready_watches.append(*watch);
+    }
+    return count;
+}
+
+Thread::BlockResult EventQueue::wait_for_events(Thread::BlockTimeout const& timeout)
+{
+    return Thread::current()->wait_on(m_wait_queue, timeout);
+}
+
+}
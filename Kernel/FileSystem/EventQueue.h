@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <Kernel/API/POSIX/sys/epoll.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Forward.h>
+#include <Kernel/Locking/Mutex.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+// An EventQueue keeps a persistent interest set of file descriptions, and a queue of the ones
+// that have become ready. Unlike poll(), waiting on it doesn't have to walk (or even look at)
+// the descriptions that are idle.
+class EventQueue final : public File {
+public:
+    static ErrorOr<NonnullLockRefPtr<EventQueue>> try_create();
+    virtual ~EventQueue() override;
+
+    virtual bool can_read(OpenFileDescription const&, u64) const override;
+    virtual ErrorOr<size_t> read(OpenFileDescription&, u64, UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual bool can_write(OpenFileDescription const&, u64) const override { return false; }
+    virtual ErrorOr<size_t> write(OpenFileDescription&, u64, UserOrKernelBuffer const&, size_t) override { return EINVAL; }
+    virtual ErrorOr<void> close() override;
+
+    virtual ErrorOr<NonnullOwnPtr<KString>> pseudo_path(OpenFileDescription const&) const override;
+    virtual StringView class_name() const override { return "EventQueue"sv; }
+    virtual bool is_event_queue() const override { return true; }
+
+    ErrorOr<void> add_watch(int fd, OpenFileDescription&, epoll_event const&);
+    ErrorOr<void> modify_watch(int fd, epoll_event const&);
+    ErrorOr<void> remove_watch(int fd);
+
+    // Fills in events for up to events.size() ready descriptions without blocking.
+    ErrorOr<size_t> collect_events(Span<epoll_event> events);
+    Thread::BlockResult wait_for_events(Thread::BlockTimeout const&);
+
+private:
+    class Watch final : public FileReadinessObserver {
+    public:
+        Watch(EventQueue& queue, int fd, OpenFileDescription& description, epoll_event const& event)
+            : FileReadinessObserver(description)
+            , m_queue(queue)
+            , m_fd(fd)
+        {
+            update(event);
+        }
+
+        virtual void readiness_may_have_changed() override;
+        virtual void description_was_closed() override;
+
+        void update(epoll_event const&);
+
+        EventQueue& m_queue;
+        int m_fd { -1 };
+        u32 m_events { 0 };
+        u64 m_data { 0 };
+        Thread::FileBlocker::BlockFlags m_block_flags { Thread::FileBlocker::BlockFlags::None };
+        // Set once a one-shot watch has fired, until it is re-armed with EPOLL_CTL_MOD.
+        bool m_disarmed { false };
+
+        IntrusiveListNode<Watch> m_ready_list_node;
+        using ReadyList = IntrusiveList<&Watch::m_ready_list_node>;
+
+        bool is_edge_triggered() const { return m_events & EPOLLET; }
+        bool is_one_shot() const { return m_events & EPOLLONESHOT; }
+    };
+
+    EventQueue() = default;
+
+    void watch_became_ready(Watch&);
+    void detach_watch(Watch&);
+
+    // Protects m_watches, and is held while events are collected so that watches stay alive.
+    Mutex m_watches_lock { "EventQueue"sv };
+    HashMap<int, NonnullOwnPtr<Watch>> m_watches;
+
+    // Protects the ready list and the per-watch state that is touched from readiness callbacks.
+    mutable Spinlock<LockRank::None> m_ready_lock {};
+    Watch::ReadyList m_ready_watches;
+
+    WaitQueue m_wait_queue;
+};
+
+}
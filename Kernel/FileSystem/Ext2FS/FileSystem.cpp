@@ -223,9 +223,9 @@ ErrorOr<void> Ext2FS::write_ext2_inode(InodeIndex inode, ext2_inode const& e2ino
     return write_block(block_index, buffer, inode_size(), offset);
 }
 
-auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count) -> ErrorOr<Vector<BlockIndex>>
+auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count, BlockIndex goal) -> ErrorOr<Vector<BlockIndex>>
 {
-    dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_blocks(preferred group: {}, count {})", preferred_group_index, count);
+    dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_blocks(preferred group: {}, count {}, goal {})", preferred_group_index, count, goal);
     if (count == 0)
         return Vector<BlockIndex> {};
 
@@ -233,6 +233,26 @@ auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count) ->
     TRY(blocks.try_ensure_capacity(count));
 
     MutexLocker locker(m_lock);
+
+    // Carry on right at the goal block if it's free, so that a growing file stays in one piece.
+    if (goal.value() != 0 && goal.value() < super_block().s_blocks_count) {
+        auto goal_group_index = group_index_from_block_index(goal);
+        auto const& bgd = group_descriptor(goal_group_index);
+        if (bgd.bg_free_blocks_count) {
+            auto* cached_bitmap = TRY(get_bitmap_block(bgd.bg_block_bitmap));
+            u64 blocks_in_group = min(blocks_per_group(), super_block().s_blocks_count);
+            auto block_bitmap = cached_bitmap->bitmap(blocks_in_group);
+            BlockIndex first_block_in_group = (goal_group_index.value() - 1) * blocks_per_group() + first_block_index().value();
+            for (auto bit_index = goal.value() - first_block_in_group.value(); bit_index < blocks_in_group && blocks.size() < count && !block_bitmap.get(bit_index); ++bit_index) {
+                BlockIndex block_index = bit_index + first_block_in_group.value();
+                TRY(set_block_allocation_state(block_index, true));
+                blocks.unchecked_append(block_index);
+                dbgln_if(EXT2_DEBUG, "  allocated at goal > {}", block_index);
+            }
+            preferred_group_index = goal_group_index;
+        }
+    }
+
     auto group_index = preferred_group_index;
 
     if (!group_descriptor(preferred_group_index).bg_free_blocks_count) {
@@ -16,6 +16,10 @@ namespace Kernel {
 
 static constexpr size_t max_inline_symlink_length = 60;
 
+// Used when the superblock doesn't suggest how many blocks to preallocate.
+static constexpr size_t default_preallocation_window = 8;
+static constexpr size_t max_preallocation_window = 64;
+
 static u8 to_ext2_file_type(mode_t mode)
 {
     if (is_regular_file(mode))
@@ -616,7 +620,7 @@ ErrorOr<void> Ext2FSInode::resize(u64 new_size)
         m_block_list = TRY(compute_block_list());
 
     if (blocks_needed_after > blocks_needed_before) {
-        auto blocks = TRY(fs().allocate_blocks(fs().group_index_from_inode(index()), blocks_needed_after - blocks_needed_before));
+        auto blocks = TRY(allocate_data_blocks(blocks_needed_after - blocks_needed_before));
         TRY(m_block_list.try_extend(move(blocks)));
     } else if (blocks_needed_after < blocks_needed_before) {
         if constexpr (EXT2_VERY_DEBUG) {
@@ -661,6 +665,74 @@ ErrorOr<void> Ext2FSInode::resize(u64 new_size)
     return {};
 }
 
+ErrorOr<Vector<BlockBasedFileSystem::BlockIndex>> Ext2FSInode::allocate_data_blocks(size_t count)
+{
+    VERIFY(m_inode_lock.is_locked());
+
+    Vector<BlockBasedFileSystem::BlockIndex> blocks;
+    TRY(blocks.try_ensure_capacity(count));
+    while (blocks.size() < count && !m_preallocated_blocks.is_empty())
+        blocks.unchecked_append(m_preallocated_blocks.take_first());
+    if (blocks.size() == count)
+        return blocks;
+
+    // Only preallocate for regular files that someone has open, as we rely on them being closed to give
+    // the blocks back. The window grows each time it gets used up, as the file evidently keeps growing.
+    auto remaining_count = count - blocks.size();
+    size_t preallocation_count = 0;
+    if (Kernel::is_regular_file(m_raw_inode.i_mode) && m_open_description_count > 0) {
+        size_t initial_window = fs().super_block().s_prealloc_blocks ? fs().super_block().s_prealloc_blocks : default_preallocation_window;
+        m_preallocation_window = m_preallocation_window ? min(m_preallocation_window * 2, max_preallocation_window) : initial_window;
+
+        // Don't use up blocks that may be needed for the block list itself.
+        if (fs().super_block().s_free_blocks_count > remaining_count + 2 * m_preallocation_window)
+            preallocation_count = m_preallocation_window;
+    }
+    TRY(m_preallocated_blocks.try_ensure_capacity(preallocation_count));
+
+    BlockBasedFileSystem::BlockIndex goal = 0;
+    if (!blocks.is_empty())
+        goal = blocks.last().value() + 1;
+    else if (!m_block_list.is_empty() && m_block_list.last().value() != 0)
+        goal = m_block_list.last().value() + 1;
+
+    auto new_blocks = TRY(fs().allocate_blocks(fs().group_index_from_inode(index()), remaining_count + preallocation_count, goal));
+    for (size_t i = 0; i < new_blocks.size(); ++i) {
+        if (i < remaining_count)
+            blocks.unchecked_append(new_blocks[i]);
+        else
+            m_preallocated_blocks.unchecked_append(new_blocks[i]);
+    }
+    return blocks;
+}
+
+ErrorOr<void> Ext2FSInode::discard_preallocated_blocks()
+{
+    VERIFY(m_inode_lock.is_locked());
+
+    m_preallocation_window = 0;
+    while (!m_preallocated_blocks.is_empty())
+        TRY(fs().set_block_allocation_state(m_preallocated_blocks.take_last(), false));
+    return {};
+}
+
+ErrorOr<void> Ext2FSInode::attach(OpenFileDescription&)
+{
+    MutexLocker locker(m_inode_lock);
+    ++m_open_description_count;
+    return {};
+}
+
+void Ext2FSInode::detach(OpenFileDescription&)
+{
+    MutexLocker locker(m_inode_lock);
+    VERIFY(m_open_description_count > 0);
+    if (--m_open_description_count > 0)
+        return;
+    if (auto result = discard_preallocated_blocks(); result.is_error())
+        dbgln("Ext2FSInode[{}]::detach(): Failed to discard preallocated blocks: {}", identifier(), result.error());
+}
+
 ErrorOr<size_t> Ext2FSInode::write_bytes_locked(off_t offset, size_t count, UserOrKernelBuffer const& data, OpenFileDescription* description)
 {
     VERIFY(m_inode_lock.is_locked());
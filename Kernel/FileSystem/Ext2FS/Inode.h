@@ -44,10 +44,14 @@ private:
     virtual ErrorOr<void> chown(UserID, GroupID) override;
     virtual ErrorOr<void> truncate(u64) override;
     virtual ErrorOr<int> get_block_address(int) override;
+    virtual ErrorOr<void> attach(OpenFileDescription&) override;
+    virtual void detach(OpenFileDescription&) override;
 
     ErrorOr<void> write_directory(Vector<Ext2FSDirectoryEntry>&);
     ErrorOr<void> populate_lookup_cache();
     ErrorOr<void> resize(u64);
+    ErrorOr<Vector<BlockBasedFileSystem::BlockIndex>> allocate_data_blocks(size_t count);
+    ErrorOr<void> discard_preallocated_blocks();
     ErrorOr<void> write_indirect_block(BlockBasedFileSystem::BlockIndex, Span<BlockBasedFileSystem::BlockIndex>);
     ErrorOr<void> grow_doubly_indirect_block(BlockBasedFileSystem::BlockIndex, size_t, Span<BlockBasedFileSystem::BlockIndex>, Vector<BlockBasedFileSystem::BlockIndex>&, unsigned&);
     ErrorOr<void> shrink_doubly_indirect_block(BlockBasedFileSystem::BlockIndex, size_t, size_t, unsigned&);
@@ -70,6 +74,13 @@ private:
     ext2_inode m_raw_inode {};
 
     Mutex m_block_list_lock { "BlockList"sv };
+
+    // Blocks that were allocated ahead of time, so that a file which keeps growing by small appends
+    // doesn't end up interleaved with other files on disk. We give them back once the last open file
+    // description of this inode goes away.
+    Vector<BlockBasedFileSystem::BlockIndex> m_preallocated_blocks;
+    size_t m_preallocation_window { 0 };
+    size_t m_open_description_count { 0 };
 };
 
 inline Ext2FS& Ext2FSInode::fs()
@@ -12,6 +12,12 @@
 
 namespace Kernel {
 
+Spinlock<LockRank::None>& FileReadinessObserver::lock()
+{
+    static Spinlock<LockRank::None> s_lock {};
+    return s_lock;
+}
+
 File::File() = default;
 File::~File() = default;
 
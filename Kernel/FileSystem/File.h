@@ -7,7 +7,9 @@
 #pragma once
 
 #include <AK/AtomicRefCounted.h>
+#include <AK/Atomic.h>
 #include <AK/Error.h>
+#include <AK/IntrusiveList.h>
 #include <AK/StringView.h>
 #include <AK/Types.h>
 #include <Kernel/Forward.h>
@@ -21,10 +23,48 @@ namespace Kernel {
 
 class File;
 
+// A FileReadinessObserver hears about every re-evaluation of a File's block conditions,
+// without having to block a thread on it. This is what lets an EventQueue keep a persistent
+// interest set instead of re-registering blockers on every wait.
+class FileReadinessObserver {
+public:
+    virtual ~FileReadinessObserver() = default;
+
+    // Both of these are called with the FileBlockerSet lock held.
+    virtual void readiness_may_have_changed() = 0;
+    virtual void description_was_closed() = 0;
+
+    OpenFileDescription* observed_description() const { return m_observed_description; }
+
+    // Taken around adding and removing observers, so that the observed description and its
+    // File are kept alive by whoever holds it.
+    static Spinlock<LockRank::None>& lock();
+
+protected:
+    explicit FileReadinessObserver(OpenFileDescription& description)
+        : m_observed_description(&description)
+    {
+    }
+
+private:
+    friend class FileBlockerSet;
+
+    OpenFileDescription* m_observed_description { nullptr };
+    IntrusiveListNode<FileReadinessObserver> m_list_node;
+
+public:
+    using List = IntrusiveList<&FileReadinessObserver::m_list_node>;
+};
+
 class FileBlockerSet final : public Thread::BlockerSet {
 public:
     FileBlockerSet() { }
 
+    virtual ~FileBlockerSet() override
+    {
+        VERIFY(m_observers.is_empty());
+    }
+
     virtual bool should_add_blocker(Thread::Blocker& b, void* data) override
     {
         VERIFY(b.blocker_type() == Thread::Blocker::Type::File);
@@ -40,7 +80,54 @@ public:
             auto& blocker = static_cast<Thread::FileBlocker&>(b);
             return blocker.unblock_if_conditions_are_met(false, data);
         });
+        for (auto& observer : m_observers)
+            observer.readiness_may_have_changed();
+    }
+
+    void add_observer(FileReadinessObserver& observer)
+    {
+        VERIFY(FileReadinessObserver::lock().is_locked());
+        SpinlockLocker lock(m_lock);
+        m_observers.append(observer);
+        m_observer_count.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+        // Let the observer pick up whatever is already pending.
+        observer.readiness_may_have_changed();
+    }
+
+    void remove_observer(FileReadinessObserver& observer)
+    {
+        VERIFY(FileReadinessObserver::lock().is_locked());
+        SpinlockLocker lock(m_lock);
+        if (!observer.m_list_node.is_in_list())
+            return;
+        m_observers.remove(observer);
+        observer.m_observed_description = nullptr;
+        m_observer_count.fetch_sub(1, AK::MemoryOrder::memory_order_relaxed);
+    }
+
+    void remove_observers_for_description(OpenFileDescription const& description)
+    {
+        // Nobody can start observing a description that is being destroyed, so there's
+        // nothing to do (and no global lock to take) for the common case of no observers.
+        if (m_observer_count.load(AK::MemoryOrder::memory_order_relaxed) == 0)
+            return;
+        SpinlockLocker global_lock(FileReadinessObserver::lock());
+        SpinlockLocker lock(m_lock);
+        for (auto it = m_observers.begin(); it != m_observers.end();) {
+            auto& observer = *it;
+            ++it;
+            if (observer.m_observed_description != &description)
+                continue;
+            m_observers.remove(observer);
+            observer.m_observed_description = nullptr;
+            m_observer_count.fetch_sub(1, AK::MemoryOrder::memory_order_relaxed);
+            observer.description_was_closed();
+        }
     }
+
+private:
+    FileReadinessObserver::List m_observers;
+    Atomic<size_t> m_observer_count { 0 };
 };
 
 // File is the base class for anything that can be referenced by a OpenFileDescription.
@@ -114,6 +201,8 @@ public:
     virtual bool is_character_device() const { return false; }
     virtual bool is_socket() const { return false; }
     virtual bool is_inode_watcher() const { return false; }
+    virtual bool is_event_queue() const { return false; }
+    virtual bool is_io_ring() const { return false; }
 
     virtual bool is_regular_file() const { return false; }
 
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <Kernel/FileSystem/IORing.h>
+#include <Kernel/Memory/MemoryManager.h>
+
+namespace Kernel {
+
+ErrorOr<NonnullLockRefPtr<IORing>> IORing::try_create(u32 submission_entry_count)
+{
+    if (submission_entry_count == 0 || submission_entry_count > IO_RING_MAX_ENTRIES || !is_power_of_two(submission_entry_count))
+        return EINVAL;
+
+    // One vmobject backs both our kernel region and the process' mapping, like KCOV does it.
+    auto size = TRY(Memory::page_round_up(io_ring_size(submission_entry_count)));
+    auto vmobject = TRY(Memory::AnonymousVMObject::try_create_with_size(size, AllocationStrategy::AllocateNow));
+    auto region = TRY(MM.allocate_kernel_region_with_vmobject(*vmobject, size, "IORing"sv, Memory::Region::Access::ReadWrite));
+    return adopt_nonnull_lock_ref_or_enomem(new (nothrow) IORing(submission_entry_count, move(vmobject), move(region)));
+}
+
+IORing::IORing(u32 submission_entry_count, NonnullLockRefPtr<Memory::AnonymousVMObject> vmobject, NonnullOwnPtr<Memory::Region> region)
+    : m_submission_entry_count(submission_entry_count)
+    , m_completion_entry_count(io_ring_completion_entry_count(submission_entry_count))
+    , m_vmobject(move(vmobject))
+    , m_region(move(region))
+{
+    memset(m_region->vaddr().as_ptr(), 0, m_region->size());
+    header().submission_entry_count = m_submission_entry_count;
+    header().completion_entry_count = m_completion_entry_count;
+}
+
+IORing::~IORing() = default;
+
+bool IORing::can_read(OpenFileDescription const&, u64) const
+{
+    return AK::atomic_load(&header().completion_head, AK::memory_order_acquire) != m_completion_tail;
+}
+
+ErrorOr<NonnullLockRefPtr<Memory::VMObject>> IORing::vmobject_for_mmap(Process&, Memory::VirtualRange const&, u64& offset, bool shared)
+{
+    // A private copy of the ring would never see any completions.
+    if (!shared || offset != 0)
+        return EINVAL;
+    return m_vmobject;
+}
+
+ErrorOr<NonnullOwnPtr<KString>> IORing::pseudo_path(OpenFileDescription const&) const
+{
+    return KString::formatted("IORing:({})", m_submission_entry_count);
+}
+
+ErrorOr<size_t> IORing::process_submissions(u32 max_count, Function<i64(IORingSubmission const&)> execute)
+{
+    MutexLocker locker(m_submission_lock);
+
+    auto submission_tail = AK::atomic_load(&header().submission_tail, AK::memory_order_acquire);
+    auto queued_count = submission_tail - m_submission_head;
+    if (queued_count > m_submission_entry_count)
+        return EINVAL;
+
+    size_t processed_count = 0;
+    while (processed_count < min(max_count, queued_count)) {
+        auto completion_head = AK::atomic_load(&header().completion_head, AK::memory_order_acquire);
+        if (m_completion_tail - completion_head >= m_completion_entry_count) {
+            if (processed_count == 0)
+                return EBUSY;
+            break;
+        }
+
+        IORingSubmission submission;
+        memcpy(&submission, &submissions()[m_submission_head & (m_submission_entry_count - 1)], sizeof(submission));
+        m_submission_head++;
+        AK::atomic_store(&header().submission_head, m_submission_head, AK::memory_order_release);
+
+        auto result = execute(submission);
+
+        auto& completion = completions()[m_completion_tail & (m_completion_entry_count - 1)];
+        completion.user_data = submission.user_data;
+        completion.result = result;
+        m_completion_tail++;
+        AK::atomic_store(&header().completion_tail, m_completion_tail, AK::memory_order_release);
+        processed_count++;
+
+        if (Thread::current()->has_unmasked_pending_signals())
+            break;
+    }
+
+    if (processed_count > 0)
+        evaluate_block_conditions();
+    return processed_count;
+}
+
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/NonnullOwnPtr.h>
+#include <Kernel/API/IORing.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Locking/Mutex.h>
+#include <Kernel/Memory/AnonymousVMObject.h>
+#include <Kernel/Memory/Region.h>
+
+namespace Kernel {
+
+// An IORing holds the memory shared with the process that created it, which the process maps
+// with mmap(). The layout is described in Kernel/API/IORing.h.
+// The ring indices and entries live in memory the process can change at any time, so we keep our
+// own copy of everything we rely on and only read each submission once.
+class IORing final : public File {
+public:
+    static ErrorOr<NonnullLockRefPtr<IORing>> try_create(u32 submission_entry_count);
+    virtual ~IORing() override;
+
+    virtual bool can_read(OpenFileDescription const&, u64) const override;
+    virtual ErrorOr<size_t> read(OpenFileDescription&, u64, UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    // Nothing is ever written through the description, so fail right away instead of blocking forever.
+    virtual bool can_write(OpenFileDescription const&, u64) const override { return true; }
+    virtual ErrorOr<size_t> write(OpenFileDescription&, u64, UserOrKernelBuffer const&, size_t) override { return EINVAL; }
+    virtual ErrorOr<NonnullLockRefPtr<Memory::VMObject>> vmobject_for_mmap(Process&, Memory::VirtualRange const&, u64& offset, bool shared) override;
+
+    virtual ErrorOr<NonnullOwnPtr<KString>> pseudo_path(OpenFileDescription const&) const override;
+    virtual StringView class_name() const override { return "IORing"sv; }
+    virtual bool is_io_ring() const override { return true; }
+
+    // Consumes up to max_count queued submissions, hands each of them to the callback and posts
+    // a completion with its result. Stops early if the completion ring is full.
+    ErrorOr<size_t> process_submissions(u32 max_count, Function<i64(IORingSubmission const&)> execute);
+
+private:
+    IORing(u32 submission_entry_count, NonnullLockRefPtr<Memory::AnonymousVMObject>, NonnullOwnPtr<Memory::Region>);
+
+    IORingHeader& header() const { return *reinterpret_cast<IORingHeader*>(m_region->vaddr().as_ptr()); }
+    IORingSubmission* submissions() const { return reinterpret_cast<IORingSubmission*>(m_region->vaddr().offset(io_ring_submissions_offset()).as_ptr()); }
+    IORingCompletion* completions() const { return reinterpret_cast<IORingCompletion*>(m_region->vaddr().offset(io_ring_completions_offset(m_submission_entry_count)).as_ptr()); }
+
+    u32 const m_submission_entry_count { 0 };
+    u32 const m_completion_entry_count { 0 };
+    u32 m_submission_head { 0 };
+    u32 m_completion_tail { 0 };
+
+    NonnullLockRefPtr<Memory::AnonymousVMObject> m_vmobject;
+    NonnullOwnPtr<Memory::Region> m_region;
+
+    // Serializes io_ring_enter() calls from different threads.
+    Mutex m_submission_lock { "IORing"sv };
+};
+
+}
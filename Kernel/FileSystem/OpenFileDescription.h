@@ -78,6 +78,12 @@ public:
     const TTY* tty() const;
     TTY* tty();
 
+    bool is_event_queue() const;
+    EventQueue* event_queue();
+
+    bool is_io_ring() const;
+    IORing* io_ring();
+
     bool is_inode_watcher() const;
     InodeWatcher const* inode_watcher() const;
     InodeWatcher* inode_watcher();
@@ -20,6 +20,14 @@ StringView StorageDeviceAttributeSysFSComponent::name() const
         return "sector_size"sv;
     case Type::CommandSet:
         return "command_set"sv;
+    case Type::Rotational:
+        return "rotational"sv;
+    case Type::SubmittedRequests:
+        return "submitted_requests"sv;
+    case Type::MergedRequests:
+        return "merged_requests"sv;
+    case Type::DispatchedRequests:
+        return "dispatched_requests"sv;
     default:
         VERIFY_NOT_REACHED();
     }
@@ -62,6 +70,18 @@ ErrorOr<NonnullOwnPtr<KBuffer>> StorageDeviceAttributeSysFSComponent::try_to_gen
     case Type::CommandSet:
         value = TRY(KString::formatted("{}", m_device->command_set_to_string_view()));
         break;
+    case Type::Rotational:
+        value = TRY(KString::formatted("{}", m_device->is_rotational() ? 1 : 0));
+        break;
+    case Type::SubmittedRequests:
+        value = TRY(KString::formatted("{}", m_device->request_queue_statistics().submitted_requests));
+        break;
+    case Type::MergedRequests:
+        value = TRY(KString::formatted("{}", m_device->request_queue_statistics().merged_requests));
+        break;
+    case Type::DispatchedRequests:
+        value = TRY(KString::formatted("{}", m_device->request_queue_statistics().dispatched_requests));
+        break;
     default:
         VERIFY_NOT_REACHED();
     }
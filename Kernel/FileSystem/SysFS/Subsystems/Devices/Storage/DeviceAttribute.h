@@ -18,6 +18,10 @@ public:
         EndLBA,
         SectorSize,
         CommandSet,
+        Rotational,
+        SubmittedRequests,
+        MergedRequests,
+        DispatchedRequests,
     };
 
 public:
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/JsonObjectSerializer.h>
+#include <Kernel/FileSystem/BlockBasedFileSystem.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/DiskCacheStatistics.h>
+#include <Kernel/FileSystem/VirtualFileSystem.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT NonnullLockRefPtr<SysFSDiskCacheStatistics> SysFSDiskCacheStatistics::must_create(SysFSDirectory const& parent_directory)
+{
+    return adopt_lock_ref_if_nonnull(new (nothrow) SysFSDiskCacheStatistics(parent_directory)).release_nonnull();
+}
+
+UNMAP_AFTER_INIT SysFSDiskCacheStatistics::SysFSDiskCacheStatistics(SysFSDirectory const& parent_directory)
+    : SysFSGlobalInformation(parent_directory)
+{
+}
+
+ErrorOr<void> SysFSDiskCacheStatistics::try_generate(KBufferBuilder& builder)
+{
+    auto array = TRY(JsonArraySerializer<>::try_create(builder));
+    TRY(VirtualFileSystem::the().for_each_mount([&array](auto& mount) -> ErrorOr<void> {
+        auto& fs = mount.guest_fs();
+        if (!fs.is_block_based())
+            return {};
+        auto statistics = static_cast<BlockBasedFileSystem const&>(fs).disk_cache_statistics();
+
+        auto fs_object = TRY(array.add_object());
+        TRY(fs_object.add("class_name"sv, fs.class_name()));
+        auto mount_point = TRY(mount.absolute_path());
+        TRY(fs_object.add("mount_point"sv, mount_point->view()));
+        TRY(fs_object.add("block_size"sv, static_cast<u64>(fs.block_size())));
+        TRY(fs_object.add("entry_count"sv, statistics.entry_count));
+        TRY(fs_object.add("hits"sv, statistics.hits));
+        TRY(fs_object.add("misses"sv, statistics.misses));
+        TRY(fs_object.add("evictions"sv, statistics.evictions));
+        TRY(fs_object.add("read_ahead_blocks"sv, statistics.read_ahead_blocks));
+        TRY(fs_object.add("read_ahead_hits"sv, statistics.read_ahead_hits));
+        TRY(fs_object.finish());
+        return {};
+    }));
+    TRY(array.finish());
+    return {};
+}
+
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/JsonObjectSerializer.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/KmallocSlabheapStatistics.h>
+#include <Kernel/Heap/kmalloc.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT NonnullLockRefPtr<SysFSKmallocSlabheapStatistics> SysFSKmallocSlabheapStatistics::must_create(SysFSDirectory const& parent_directory)
+{
+    return adopt_lock_ref_if_nonnull(new (nothrow) SysFSKmallocSlabheapStatistics(parent_directory)).release_nonnull();
+}
+
+UNMAP_AFTER_INIT SysFSKmallocSlabheapStatistics::SysFSKmallocSlabheapStatistics(SysFSDirectory const& parent_directory)
+    : SysFSGlobalInformation(parent_directory)
+{
+}
+
+ErrorOr<void> SysFSKmallocSlabheapStatistics::try_generate(KBufferBuilder& builder)
+{
+    kmalloc_slabheap_stats stats[KMALLOC_SLABHEAP_COUNT];
+    get_kmalloc_slabheap_stats(stats);
+
+    auto array = TRY(JsonArraySerializer<>::try_create(builder));
+    for (auto const& slabheap_stats : stats) {
+        auto slabheap_object = TRY(array.add_object());
+        TRY(slabheap_object.add("slab_size"sv, slabheap_stats.slab_size));
+        TRY(slabheap_object.add("bytes_allocated"sv, slabheap_stats.bytes_allocated));
+        TRY(slabheap_object.add("bytes_free"sv, slabheap_stats.bytes_free));
+        TRY(slabheap_object.add("bytes_cached"sv, slabheap_stats.bytes_cached));
+        TRY(slabheap_object.add("allocation_count"sv, slabheap_stats.allocation_count));
+        TRY(slabheap_object.add("free_count"sv, slabheap_stats.free_count));
+        TRY(slabheap_object.add("magazine_hits"sv, slabheap_stats.magazine_hits));
+        TRY(slabheap_object.add("magazine_refills"sv, slabheap_stats.magazine_refills));
+        TRY(slabheap_object.add("magazine_flushes"sv, slabheap_stats.magazine_flushes));
+        TRY(slabheap_object.finish());
+    }
+    TRY(array.finish());
+    return {};
+}
+
+}
@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/GlobalInformation.h>
+#include <Kernel/KBufferBuilder.h>
+#include <Kernel/Library/LockRefPtr.h>
+#include <Kernel/UserOrKernelBuffer.h>
+
+namespace Kernel {
+
+class SysFSKmallocSlabheapStatistics final : public SysFSGlobalInformation {
+public:
+    virtual StringView name() const override { return "kmallocslabs"sv; }
+
+    static NonnullLockRefPtr<SysFSKmallocSlabheapStatistics> must_create(SysFSDirectory const& parent_directory);
+
+private:
+    SysFSKmallocSlabheapStatistics(SysFSDirectory const& parent_directory);
+    virtual ErrorOr<void> try_generate(KBufferBuilder& builder) override;
+};
+
+}
@@ -40,6 +40,9 @@ ErrorOr<void> SysFSNetworkAdaptersStats::try_generate(KBufferBuilder& builder)
         TRY(obj.add("bytes_in"sv, adapter.bytes_in()));
         TRY(obj.add("packets_out"sv, adapter.packets_out()));
         TRY(obj.add("bytes_out"sv, adapter.bytes_out()));
+        TRY(obj.add("packets_dropped"sv, adapter.packets_dropped()));
+        TRY(obj.add("packets_in_per_second"sv, adapter.packets_in_per_second()));
+        TRY(obj.add("packets_out_per_second"sv, adapter.packets_out_per_second()));
         TRY(obj.add("link_up"sv, adapter.link_up()));
         TRY(obj.add("link_speed"sv, adapter.link_speed()));
         TRY(obj.add("link_full_duplex"sv, adapter.link_full_duplex()));
@@ -41,6 +41,11 @@ ErrorOr<void> SysFSNetworkTCPStats::try_generate(KBufferBuilder& builder)
         TRY(obj.add("bytes_in"sv, socket.bytes_in()));
         TRY(obj.add("packets_out"sv, socket.packets_out()));
         TRY(obj.add("bytes_out"sv, socket.bytes_out()));
+        TRY(obj.add("send_window_size"sv, socket.send_window_size()));
+        TRY(obj.add("congestion_window"sv, socket.congestion_window()));
+        TRY(obj.add("slow_start_threshold"sv, socket.slow_start_threshold()));
+        TRY(obj.add("round_trip_time_us"sv, socket.smoothed_round_trip_time().to_microseconds()));
+        TRY(obj.add("retransmission_timeout_us"sv, socket.retransmission_timeout().to_microseconds()));
         auto current_process_credentials = Process::current().credentials();
         if (current_process_credentials->is_superuser() || current_process_credentials->uid() == socket.origin_uid()) {
             TRY(obj.add("origin_pid"sv, socket.origin_pid().value()));
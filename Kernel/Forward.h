@@ -25,8 +25,10 @@ class File;
 class FATInode;
 class OpenFileDescription;
 class DisplayConnector;
+class EventQueue;
 class FileSystem;
 class FutexQueue;
+class IORing;
 class IPv4Socket;
 class Inode;
 class InodeIdentifier;
@@ -10,6 +10,7 @@
 #include <Kernel/Debug.h>
 #include <Kernel/Heap/Heap.h>
 #include <Kernel/Heap/kmalloc.h>
+#include <Kernel/InterruptDisabler.h>
 #include <Kernel/KSyms.h>
 #include <Kernel/Locking/Spinlock.h>
 #include <Kernel/Memory/MemoryManager.h>
@@ -205,6 +206,8 @@ private:
     KmallocSlabBlock::List m_full_blocks;
 };
 
+static void flush_current_processor_magazines();
+
 struct KmallocGlobalData {
     static constexpr size_t minimum_subheap_size = 1 * MiB;
 
@@ -237,6 +240,10 @@ struct KmallocGlobalData {
 
         // NOTE: This size calculation is a mirror of kmalloc_aligned(KmallocSlabBlock)
         if (size <= KmallocSlabBlock::block_size * 2 + sizeof(ptrdiff_t) + sizeof(size_t)) {
+            // Slabs cached in our magazines keep their blocks alive, so give them back before trying to purge.
+            // FIXME: We can't reach into the magazines of other processors from here.
+            flush_current_processor_magazines();
+
             // FIXME: We should propagate a freed pointer, to find the specific subheap it belonged to
             //        This would save us iterating over them in the next step and remove a recursion
             bool did_purge = false;
@@ -394,7 +401,7 @@ struct KmallocGlobalData {
 
     KmallocSubheap::List subheaps;
 
-    KmallocSlabheap slabheaps[6] = { 16, 32, 64, 128, 256, 512 };
+    KmallocSlabheap slabheaps[KMALLOC_SLABHEAP_COUNT] = { 16, 32, 64, 128, 256, 512 };
 
     bool expansion_in_progress { false };
 };
@@ -402,11 +409,128 @@ struct KmallocGlobalData {
 READONLY_AFTER_INIT static KmallocGlobalData* g_kmalloc_global;
 alignas(KmallocGlobalData) static u8 g_kmalloc_global_heap[sizeof(KmallocGlobalData)];
 
-static size_t g_kmalloc_call_count;
-static size_t g_kfree_call_count;
-static size_t g_nested_kfree_calls;
 bool g_dump_kmalloc_stacks;
 
+// A magazine is a small per-processor stack of free slabs of one size, which lets most small
+// allocations and frees complete with interrupts disabled instead of taking s_lock.
+// Slabs move between a magazine and its slabheap in batches, under s_lock.
+struct KmallocMagazine {
+    static constexpr size_t capacity = 32;
+    static constexpr size_t batch_size = capacity / 2;
+
+    size_t count { 0 };
+    void* slabs[capacity];
+};
+
+struct KmallocSlabheapCounters {
+    size_t allocations { 0 };
+    size_t frees { 0 };
+    size_t magazine_hits { 0 };
+    size_t magazine_refills { 0 };
+    size_t magazine_flushes { 0 };
+};
+
+struct KmallocProcessorData {
+    KmallocMagazine magazines[KMALLOC_SLABHEAP_COUNT];
+    KmallocSlabheapCounters counters[KMALLOC_SLABHEAP_COUNT];
+
+    size_t kmalloc_call_count { 0 };
+    size_t kfree_call_count { 0 };
+    size_t nested_kfree_calls { 0 };
+};
+
+static KmallocProcessorData s_processor_data[MAX_CPU_COUNT];
+
+// NOTE: Interrupts must be disabled while using the returned data, so that we can't be moved to another processor.
+static KmallocProcessorData& current_processor_data()
+{
+    VERIFY(!Processor::are_interrupts_enabled());
+    // Before the Processor is set up, we are running on the bootstrap processor, which will get ID 0.
+    if (!Processor::is_initialized())
+        return s_processor_data[0];
+    return s_processor_data[Processor::current_id()];
+}
+
+static Optional<size_t> slabheap_index_for_allocation(size_t size, size_t alignment)
+{
+    for (size_t i = 0; i < KMALLOC_SLABHEAP_COUNT; ++i) {
+        auto slab_size = g_kmalloc_global->slabheaps[i].slab_size();
+        if (size <= slab_size && alignment <= slab_size)
+            return i;
+    }
+    return {};
+}
+
+static Optional<size_t> slabheap_index_for_deallocation(size_t size)
+{
+    for (size_t i = 0; i < KMALLOC_SLABHEAP_COUNT; ++i) {
+        if (size <= g_kmalloc_global->slabheaps[i].slab_size())
+            return i;
+    }
+    return {};
+}
+
+// NOTE: s_lock must be held.
+static void flush_magazine(KmallocProcessorData& data, size_t index, size_t slabs_to_keep)
+{
+    VERIFY(s_lock.is_locked());
+    auto& magazine = data.magazines[index];
+    if (magazine.count <= slabs_to_keep)
+        return;
+    auto& slabheap = g_kmalloc_global->slabheaps[index];
+    while (magazine.count > slabs_to_keep)
+        slabheap.deallocate(magazine.slabs[--magazine.count]);
+    ++data.counters[index].magazine_flushes;
+}
+
+static void flush_current_processor_magazines()
+{
+    auto& data = current_processor_data();
+    for (size_t i = 0; i < KMALLOC_SLABHEAP_COUNT; ++i)
+        flush_magazine(data, i, 0);
+}
+
+static void* allocate_from_magazine(KmallocProcessorData& data, size_t index, CallerWillInitializeMemory caller_will_initialize_memory)
+{
+    auto& magazine = data.magazines[index];
+    auto& counters = data.counters[index];
+    if (magazine.count == 0) {
+        SpinlockLocker lock(s_lock);
+        // Going through KmallocGlobalData::allocate() lets the refill purge and expand the heap when needed.
+        // The slabs are scrubbed when we hand them out, so there's no need to do that twice.
+        auto slab_size = g_kmalloc_global->slabheaps[index].slab_size();
+        while (magazine.count < KmallocMagazine::batch_size) {
+            auto* slab = g_kmalloc_global->allocate(slab_size, 1, CallerWillInitializeMemory::Yes);
+            if (!slab)
+                break;
+            magazine.slabs[magazine.count++] = slab;
+        }
+        ++counters.magazine_refills;
+        if (magazine.count == 0)
+            return nullptr;
+    } else {
+        ++counters.magazine_hits;
+    }
+
+    ++counters.allocations;
+    auto* ptr = magazine.slabs[--magazine.count];
+    if (caller_will_initialize_memory == CallerWillInitializeMemory::No)
+        memset(ptr, KMALLOC_SCRUB_BYTE, g_kmalloc_global->slabheaps[index].slab_size());
+    return ptr;
+}
+
+static void deallocate_to_magazine(KmallocProcessorData& data, size_t index, void* ptr)
+{
+    auto& magazine = data.magazines[index];
+    memset(ptr, KFREE_SCRUB_BYTE, g_kmalloc_global->slabheaps[index].slab_size());
+    if (magazine.count == KmallocMagazine::capacity) {
+        SpinlockLocker lock(s_lock);
+        flush_magazine(data, index, KmallocMagazine::capacity - KmallocMagazine::batch_size);
+    }
+    magazine.slabs[magazine.count++] = ptr;
+    ++data.counters[index].frees;
+}
+
 void kmalloc_enable_expand()
 {
     g_kmalloc_global->enable_expansion();
@@ -431,15 +555,22 @@ static void* kmalloc_impl(size_t size, size_t alignment, CallerWillInitializeMem
     // Alignment must be a power of two.
     VERIFY(is_power_of_two(alignment));
 
-    SpinlockLocker lock(s_lock);
-    ++g_kmalloc_call_count;
+    Kernel::InterruptDisabler disabler;
+    auto& data = current_processor_data();
+    ++data.kmalloc_call_count;
 
     if (g_dump_kmalloc_stacks && Kernel::g_kernel_symbols_available) {
         dbgln("kmalloc({})", size);
         Kernel::dump_backtrace();
     }
 
-    void* ptr = g_kmalloc_global->allocate(size, alignment, caller_will_initialize_memory);
+    void* ptr = nullptr;
+    if (auto index = slabheap_index_for_allocation(size, alignment); index.has_value()) {
+        ptr = allocate_from_magazine(data, *index, caller_will_initialize_memory);
+    } else {
+        SpinlockLocker lock(s_lock);
+        ptr = g_kmalloc_global->allocate(size, alignment, caller_will_initialize_memory);
+    }
 
     Thread* current_thread = Thread::current();
     if (!current_thread)
@@ -482,11 +613,12 @@ void kfree_sized(void* ptr, size_t size)
         Processor::verify_no_spinlocks_held();
     }
 
-    SpinlockLocker lock(s_lock);
-    ++g_kfree_call_count;
-    ++g_nested_kfree_calls;
+    Kernel::InterruptDisabler disabler;
+    auto& data = current_processor_data();
+    ++data.kfree_call_count;
+    ++data.nested_kfree_calls;
 
-    if (g_nested_kfree_calls == 1) {
+    if (data.nested_kfree_calls == 1) {
         Thread* current_thread = Thread::current();
         if (!current_thread)
             current_thread = Processor::idle_thread();
@@ -496,8 +628,14 @@ void kfree_sized(void* ptr, size_t size)
         }
     }
 
-    g_kmalloc_global->deallocate(ptr, size);
-    --g_nested_kfree_calls;
+    if (auto index = slabheap_index_for_deallocation(size); index.has_value()) {
+        VERIFY(g_kmalloc_global->is_valid_kmalloc_address(VirtualAddress { ptr }));
+        deallocate_to_magazine(data, *index, ptr);
+    } else {
+        SpinlockLocker lock(s_lock);
+        g_kmalloc_global->deallocate(ptr, size);
+    }
+    --data.nested_kfree_calls;
 }
 
 size_t kmalloc_good_size(size_t size)
@@ -584,6 +722,41 @@ void get_kmalloc_stats(kmalloc_stats& stats)
     SpinlockLocker lock(s_lock);
     stats.bytes_allocated = g_kmalloc_global->allocated_bytes();
     stats.bytes_free = g_kmalloc_global->free_bytes();
-    stats.kmalloc_call_count = g_kmalloc_call_count;
-    stats.kfree_call_count = g_kfree_call_count;
+    stats.kmalloc_call_count = 0;
+    stats.kfree_call_count = 0;
+    // NOTE: The per-processor data of other processors may change under us, so this is only a snapshot.
+    for (auto const& data : s_processor_data) {
+        stats.kmalloc_call_count += data.kmalloc_call_count;
+        stats.kfree_call_count += data.kfree_call_count;
+        for (size_t i = 0; i < KMALLOC_SLABHEAP_COUNT; ++i) {
+            // Slabs sitting in a magazine are free, even though their slabheap considers them allocated.
+            auto cached_bytes = data.magazines[i].count * g_kmalloc_global->slabheaps[i].slab_size();
+            stats.bytes_allocated -= cached_bytes;
+            stats.bytes_free += cached_bytes;
+        }
+    }
+}
+
+void get_kmalloc_slabheap_stats(kmalloc_slabheap_stats (&stats)[KMALLOC_SLABHEAP_COUNT])
+{
+    SpinlockLocker lock(s_lock);
+    for (size_t i = 0; i < KMALLOC_SLABHEAP_COUNT; ++i) {
+        auto const& slabheap = g_kmalloc_global->slabheaps[i];
+        auto& slabheap_stats = stats[i];
+        slabheap_stats = {};
+        slabheap_stats.slab_size = slabheap.slab_size();
+        slabheap_stats.bytes_allocated = slabheap.allocated_bytes();
+        slabheap_stats.bytes_free = slabheap.free_bytes();
+        // NOTE: The per-processor data of other processors may change under us, so this is only a snapshot.
+        for (auto const& data : s_processor_data) {
+            auto cached_bytes = data.magazines[i].count * slabheap.slab_size();
+            slabheap_stats.bytes_allocated -= cached_bytes;
+            slabheap_stats.bytes_cached += cached_bytes;
+            slabheap_stats.allocation_count += data.counters[i].allocations;
+            slabheap_stats.free_count += data.counters[i].frees;
+            slabheap_stats.magazine_hits += data.counters[i].magazine_hits;
+            slabheap_stats.magazine_refills += data.counters[i].magazine_refills;
+            slabheap_stats.magazine_flushes += data.counters[i].magazine_flushes;
+        }
+    }
 }
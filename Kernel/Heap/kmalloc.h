@@ -55,6 +55,21 @@ struct kmalloc_stats {
 };
 void get_kmalloc_stats(kmalloc_stats&);
 
+#define KMALLOC_SLABHEAP_COUNT 6
+
+struct kmalloc_slabheap_stats {
+    size_t slab_size;
+    size_t bytes_allocated;
+    size_t bytes_free;
+    size_t bytes_cached;
+    size_t allocation_count;
+    size_t free_count;
+    size_t magazine_hits;
+    size_t magazine_refills;
+    size_t magazine_flushes;
+};
+void get_kmalloc_slabheap_stats(kmalloc_slabheap_stats (&)[KMALLOC_SLABHEAP_COUNT]);
+
 extern bool g_dump_kmalloc_stacks;
 
 inline void* operator new(size_t, void* p) { return p; }
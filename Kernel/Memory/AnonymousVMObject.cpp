@@ -276,6 +276,45 @@ NonnullRefPtr<PhysicalPage> AnonymousVMObject::allocate_committed_page(Badge<Reg
     return m_unused_committed_pages->take_one();
 }
 
+bool AnonymousVMObject::try_allocate_huge_page(Badge<Region>, size_t first_page_index)
+{
+    VERIFY(first_page_index + MemoryManager::pages_per_huge_page <= page_count());
+
+    SpinlockLocker lock(m_lock);
+
+    // Purgeable memory may lose its pages at any time, so there's not much point in backing it with huge pages.
+    if (is_purgeable())
+        return false;
+
+    // We can only replace pages nobody has touched yet, and all of them have to come from the same place.
+    size_t lazy_committed_pages = 0;
+    for (size_t i = first_page_index; i < first_page_index + MemoryManager::pages_per_huge_page; ++i) {
+        auto const& page = m_physical_pages[i];
+        if (!page || !(page->is_shared_zero_page() || page->is_lazy_committed_page()))
+            return false;
+        if (!m_cow_map.is_null() && m_cow_map.get(i))
+            return false;
+        if (page->is_lazy_committed_page())
+            ++lazy_committed_pages;
+    }
+
+    ErrorOr<NonnullRefPtrVector<PhysicalPage>> physical_pages_or_error = ENOMEM;
+    if (lazy_committed_pages == MemoryManager::pages_per_huge_page) {
+        if (!m_unused_committed_pages.has_value() || m_unused_committed_pages->page_count() < MemoryManager::pages_per_huge_page)
+            return false;
+        physical_pages_or_error = m_unused_committed_pages->try_take_huge_page();
+    }
+    else if (lazy_committed_pages == 0)
+        physical_pages_or_error = MM.allocate_huge_physical_pages();
+    if (physical_pages_or_error.is_error())
+        return false;
+
+    auto physical_pages = physical_pages_or_error.release_value();
+    for (size_t i = 0; i < MemoryManager::pages_per_huge_page; ++i)
+        m_physical_pages[first_page_index + i] = physical_pages[i];
+    return true;
+}
+
 ErrorOr<void> AnonymousVMObject::ensure_cow_map()
 {
     if (m_cow_map.is_null())
@@ -12,6 +12,7 @@
 #include <Kernel/Arch/PageFault.h>
 #include <Kernel/Arch/RegisterState.h>
 #include <Kernel/BootInfo.h>
+#include <Kernel/CommandLine.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/InterruptDisabler.h>
@@ -88,6 +89,10 @@ UNMAP_AFTER_INIT MemoryManager::MemoryManager()
 {
     s_the = this;
 
+#if ARCH(X86_64)
+    m_huge_pages_enabled = kernel_command_line().are_transparent_huge_pages_enabled();
+#endif
+
     parse_memory_map();
     activate_kernel_page_directory(kernel_page_directory());
     protect_kernel_image();
@@ -571,6 +576,14 @@ PageTableEntry* MemoryManager::pte(PageDirectory& page_directory, VirtualAddress
     if (!pde.is_present())
         return nullptr;
 
+    // The caller wants to look at (or modify) a single 4 KiB page, so a huge page has to be broken up first.
+    if (pde.is_huge()) {
+        auto* pde_to_split = &pd[page_directory_index];
+        if (!split_huge_pde(page_directory, pde_to_split, page_directory_table_index, vaddr))
+            return nullptr;
+        return &quickmap_pt(PhysicalAddress((FlatPtr)pde_to_split->page_table_base()))[page_table_index];
+    }
+
     return &quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()))[page_table_index];
 }
 
@@ -583,9 +596,13 @@ PageTableEntry* MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
     u32 page_table_index = (vaddr.get() >> 12) & 0x1ff;
 
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
-    auto& pde = pd[page_directory_index];
-    if (pde.is_present())
-        return &quickmap_pt(PhysicalAddress(pde.page_table_base()))[page_table_index];
+    auto* pde = &pd[page_directory_index];
+    if (pde->is_present() && pde->is_huge()) {
+        if (!split_huge_pde(page_directory, pde, page_directory_table_index, vaddr))
+            return nullptr;
+    }
+    if (pde->is_present())
+        return &quickmap_pt(PhysicalAddress(pde->page_table_base()))[page_table_index];
 
     bool did_purge = false;
     auto page_table_or_error = allocate_physical_page(ShouldZeroFill::Yes, &did_purge);
@@ -599,20 +616,20 @@ PageTableEntry* MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
         // of the purging process. So we need to re-map the pd in this case to ensure
         // we're writing to the correct underlying physical page
         pd = quickmap_pd(page_directory, page_directory_table_index);
-        VERIFY(&pde == &pd[page_directory_index]); // Sanity check
+        VERIFY(pde == &pd[page_directory_index]); // Sanity check
 
-        VERIFY(!pde.is_present()); // Should have not changed
+        VERIFY(!pde->is_present()); // Should have not changed
     }
-    pde.set_page_table_base(page_table->paddr().get());
-    pde.set_user_allowed(true);
-    pde.set_present(true);
-    pde.set_writable(true);
-    pde.set_global(&page_directory == m_kernel_page_directory.ptr());
+    pde->set_page_table_base(page_table->paddr().get());
+    pde->set_user_allowed(true);
+    pde->set_present(true);
+    pde->set_writable(true);
+    pde->set_global(&page_directory == m_kernel_page_directory.ptr());
 
     // NOTE: This leaked ref is matched by the unref in MemoryManager::release_pte()
     (void)page_table.leak_ref();
 
-    return &quickmap_pt(PhysicalAddress(pde.page_table_base()))[page_table_index];
+    return &quickmap_pt(PhysicalAddress(pde->page_table_base()))[page_table_index];
 }
 
 void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress vaddr, IsLastPTERelease is_last_pte_release)
@@ -625,6 +642,13 @@ void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress va
 
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
     PageDirectoryEntry& pde = pd[page_directory_index];
+    if (pde.is_present() && pde.is_huge()) {
+        // Huge pages are only ever used when a single region covers all of it, and regions are always
+        // released as a whole, so the rest of this huge page is about to go away as well.
+        pde.clear();
+        --m_huge_pages_mapped;
+        return;
+    }
     if (pde.is_present()) {
         auto* page_table = quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()));
         auto& pte = page_table[page_table_index];
@@ -648,6 +672,80 @@ void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress va
     }
 }
 
+PageDirectoryEntry* MemoryManager::ensure_huge_pde(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(page_directory.get_lock().is_locked_by_current_processor());
+    VERIFY(vaddr.get() % huge_page_size == 0);
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x1ff;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    auto& pde = pd[page_directory_index];
+    if (pde.is_present() && pde.is_huge())
+        return &pde;
+
+    if (pde.is_present()) {
+        // The caller is about to map all 512 pages covered by this page table at once, so we can let go of it.
+        get_physical_page_entry(PhysicalAddress { pde.page_table_base() }).allocated.physical_page.unref();
+        pde.clear();
+    }
+    ++m_huge_pages_mapped;
+    return &pde;
+}
+
+bool MemoryManager::split_huge_pde(PageDirectory& page_directory, PageDirectoryEntry*& pde, size_t pdpt_index, VirtualAddress vaddr)
+{
+    VERIFY(pde->is_present() && pde->is_huge());
+
+    bool did_purge = false;
+    auto page_table_or_error = allocate_physical_page(ShouldZeroFill::No, &did_purge);
+    if (page_table_or_error.is_error()) {
+        dbgln("MM: Unable to allocate page table to split huge page at {}", vaddr);
+        return false;
+    }
+    auto page_table = page_table_or_error.release_value();
+    if (did_purge) {
+        // See ensure_pte() for why we need to re-map the pd here.
+        auto* pd = quickmap_pd(page_directory, pdpt_index);
+        VERIFY(pde == &pd[(vaddr.get() >> 21) & 0x1ff]);
+        VERIFY(pde->is_present() && pde->is_huge());
+    }
+
+    // Recreate the huge page with 4 KiB pages of the same attributes, then swap it out for the page table.
+    auto huge_page_base = pde->page_table_base();
+    auto* ptes = quickmap_pt(page_table->paddr());
+    for (size_t i = 0; i < pages_per_huge_page; ++i) {
+        auto& pte = ptes[i];
+        pte.clear();
+        pte.set_physical_page_base(huge_page_base + i * PAGE_SIZE);
+        pte.set_present(true);
+        pte.set_writable(pde->is_writable());
+        pte.set_user_allowed(pde->is_user_allowed());
+        pte.set_write_through(pde->is_write_through());
+        pte.set_cache_disabled(pde->is_cache_disabled());
+        pte.set_global(pde->is_global());
+        pte.set_execute_disabled(pde->is_execute_disabled());
+    }
+
+    pde->clear();
+    pde->set_page_table_base(page_table->paddr().get());
+    pde->set_user_allowed(true);
+    pde->set_present(true);
+    pde->set_writable(true);
+    pde->set_global(&page_directory == m_kernel_page_directory.ptr());
+
+    // NOTE: This leaked ref is matched by the unref in MemoryManager::release_pte()
+    (void)page_table.leak_ref();
+
+    --m_huge_pages_mapped;
+    ++m_huge_page_splits;
+
+    // The translation for this range didn't change, but the CPU may still have the huge page cached.
+    flush_tlb(&page_directory, VirtualAddress { vaddr.get() & ~(huge_page_size - 1) }, pages_per_huge_page);
+    return true;
+}
+
 UNMAP_AFTER_INIT void MemoryManager::initialize(u32 cpu)
 {
     dmesgln("Initialize MMU");
@@ -1039,6 +1137,54 @@ ErrorOr<NonnullRefPtrVector<PhysicalPage>> MemoryManager::allocate_contiguous_ph
     return physical_pages;
 }
 
+ErrorOr<NonnullRefPtrVector<PhysicalPage>> MemoryManager::allocate_huge_physical_pages_impl(bool committed)
+{
+    auto physical_pages = TRY(m_global_data.with([&](auto& global_data) -> ErrorOr<NonnullRefPtrVector<PhysicalPage>> {
+        if (committed) {
+            VERIFY(global_data.system_memory_info.physical_pages_committed >= pages_per_huge_page);
+        } else if (global_data.system_memory_info.physical_pages_uncommitted < pages_per_huge_page) {
+            return ENOMEM;
+        }
+
+        for (auto& physical_region : global_data.physical_regions) {
+            auto physical_pages = physical_region.take_contiguous_free_pages(pages_per_huge_page);
+            if (physical_pages.is_empty())
+                continue;
+            // NOTE: PhysicalRegion lines up its large zones with huge page boundaries, so this is naturally aligned.
+            VERIFY(physical_pages[0].paddr().get() % huge_page_size == 0);
+            if (committed)
+                global_data.system_memory_info.physical_pages_committed -= pages_per_huge_page;
+            else
+                global_data.system_memory_info.physical_pages_uncommitted -= pages_per_huge_page;
+            global_data.system_memory_info.physical_pages_used += pages_per_huge_page;
+            return physical_pages;
+        }
+        // NOTE: Huge pages are opportunistic, so we don't complain about running out of them.
+        return ENOMEM;
+    }));
+
+    {
+        InterruptDisabler disabler;
+        for (auto& physical_page : physical_pages) {
+            auto* ptr = quickmap_page(physical_page);
+            memset(ptr, 0, PAGE_SIZE);
+            unquickmap_page();
+        }
+    }
+    ++m_huge_page_allocations;
+    return physical_pages;
+}
+
+ErrorOr<NonnullRefPtrVector<PhysicalPage>> MemoryManager::allocate_huge_physical_pages()
+{
+    return allocate_huge_physical_pages_impl(false);
+}
+
+ErrorOr<NonnullRefPtrVector<PhysicalPage>> MemoryManager::allocate_committed_huge_physical_pages(Badge<CommittedPhysicalPageSet>)
+{
+    return allocate_huge_physical_pages_impl(true);
+}
+
 void MemoryManager::enter_process_address_space(Process& process)
 {
     process.address_space().with([](auto& space) {
@@ -1195,6 +1341,14 @@ NonnullRefPtr<PhysicalPage> CommittedPhysicalPageSet::take_one()
     return MM.allocate_committed_physical_page({}, MemoryManager::ShouldZeroFill::Yes);
 }
 
+ErrorOr<NonnullRefPtrVector<PhysicalPage>> CommittedPhysicalPageSet::try_take_huge_page()
+{
+    VERIFY(m_page_count >= MemoryManager::pages_per_huge_page);
+    auto physical_pages = TRY(MM.allocate_committed_huge_physical_pages({}));
+    m_page_count -= MemoryManager::pages_per_huge_page;
+    return physical_pages;
+}
+
 void CommittedPhysicalPageSet::uncommit_one()
 {
     VERIFY(m_page_count > 0);
@@ -1234,4 +1388,14 @@ MemoryManager::SystemMemoryInfo MemoryManager::get_system_memory_info()
         return global_data.system_memory_info;
     });
 }
+
+MemoryManager::HugePageStatistics MemoryManager::get_huge_page_statistics() const
+{
+    return {
+        .mapped = m_huge_pages_mapped.load(AK::MemoryOrder::memory_order_relaxed),
+        .allocations = m_huge_page_allocations.load(AK::MemoryOrder::memory_order_relaxed),
+        .splits = m_huge_page_splits.load(AK::MemoryOrder::memory_order_relaxed),
+    };
+}
+
 }
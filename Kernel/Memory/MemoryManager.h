@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/Badge.h>
 #include <AK/Concepts.h>
 #include <AK/HashTable.h>
@@ -115,6 +116,7 @@ public:
     size_t page_count() const { return m_page_count; }
 
     [[nodiscard]] NonnullRefPtr<PhysicalPage> take_one();
+    ErrorOr<NonnullRefPtrVector<PhysicalPage>> try_take_huge_page();
     void uncommit_one();
 
     void operator=(CommittedPhysicalPageSet&&) = delete;
@@ -161,12 +163,20 @@ public:
         Yes
     };
 
+    // Anonymous memory is opportunistically mapped with 2 MiB pages, see Region::try_map_huge_page().
+    static constexpr size_t huge_page_size = 2 * MiB;
+    static constexpr size_t pages_per_huge_page = huge_page_size / PAGE_SIZE;
+
+    bool are_huge_pages_enabled() const { return m_huge_pages_enabled; }
+
     ErrorOr<CommittedPhysicalPageSet> commit_physical_pages(size_t page_count);
     void uncommit_physical_pages(Badge<CommittedPhysicalPageSet>, size_t page_count);
 
     NonnullRefPtr<PhysicalPage> allocate_committed_physical_page(Badge<CommittedPhysicalPageSet>, ShouldZeroFill = ShouldZeroFill::Yes);
     ErrorOr<NonnullRefPtr<PhysicalPage>> allocate_physical_page(ShouldZeroFill = ShouldZeroFill::Yes, bool* did_purge = nullptr);
     ErrorOr<NonnullRefPtrVector<PhysicalPage>> allocate_contiguous_physical_pages(size_t size);
+    ErrorOr<NonnullRefPtrVector<PhysicalPage>> allocate_huge_physical_pages();
+    ErrorOr<NonnullRefPtrVector<PhysicalPage>> allocate_committed_huge_physical_pages(Badge<CommittedPhysicalPageSet>);
     void deallocate_physical_page(PhysicalAddress);
 
     ErrorOr<NonnullOwnPtr<Region>> allocate_contiguous_kernel_region(size_t, StringView name, Region::Access access, Region::Cacheable = Region::Cacheable::Yes);
@@ -189,6 +199,14 @@ public:
 
     SystemMemoryInfo get_system_memory_info();
 
+    struct HugePageStatistics {
+        u64 mapped { 0 };
+        u64 allocations { 0 };
+        u64 splits { 0 };
+    };
+
+    HugePageStatistics get_huge_page_statistics() const;
+
     template<IteratorFunction<VMObject&> Callback>
     static void for_each_vmobject(Callback callback)
     {
@@ -256,6 +274,7 @@ private:
     static Region* find_region_from_vaddr(VirtualAddress);
 
     RefPtr<PhysicalPage> find_free_physical_page(bool);
+    ErrorOr<NonnullRefPtrVector<PhysicalPage>> allocate_huge_physical_pages_impl(bool committed);
 
     ALWAYS_INLINE u8* quickmap_page(PhysicalPage& page)
     {
@@ -275,6 +294,9 @@ private:
     };
     void release_pte(PageDirectory&, VirtualAddress, IsLastPTERelease);
 
+    PageDirectoryEntry* ensure_huge_pde(PageDirectory&, VirtualAddress);
+    bool split_huge_pde(PageDirectory&, PageDirectoryEntry*&, size_t pdpt_index, VirtualAddress);
+
     // NOTE: These are outside of GlobalData as they are only assigned on startup,
     //       and then never change. Atomic ref-counting covers that case without
     //       the need for additional synchronization.
@@ -287,6 +309,12 @@ private:
     PhysicalPageEntry* m_physical_page_entries { nullptr };
     size_t m_physical_page_entries_count { 0 };
 
+    bool m_huge_pages_enabled { false };
+
+    Atomic<u64> m_huge_pages_mapped { 0 };
+    Atomic<u64> m_huge_page_allocations { 0 };
+    Atomic<u64> m_huge_page_splits { 0 };
+
     struct GlobalData {
         GlobalData();
 
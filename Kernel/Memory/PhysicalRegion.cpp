@@ -56,6 +56,17 @@ void PhysicalRegion::initialize_zones()
         return zone_count;
     };
 
+    // Line the large zones up with huge page boundaries, so that any 2 MiB block they hand out can back a huge page.
+    // We get there by carving off a few zones whose size matches the alignment of the current base address.
+    while (remaining_pages > 0 && base_address.get() % MemoryManager::huge_page_size != 0) {
+        size_t alignment_in_pages = 1ul << count_trailing_zeroes(base_address.get() / PAGE_SIZE);
+        size_t pages_in_zone = min(alignment_in_pages, 1ul << (sizeof(size_t) * 8 - 1 - count_leading_zeroes(remaining_pages)));
+        m_zones.append(adopt_nonnull_own_or_enomem(new (nothrow) PhysicalZone(base_address, pages_in_zone)).release_value_but_fixme_should_propagate_errors());
+        m_usable_zones.append(m_zones.last());
+        base_address = base_address.offset(pages_in_zone * PAGE_SIZE);
+        remaining_pages -= pages_in_zone;
+    }
+
     // First make 16 MiB zones (with 4096 pages each)
     m_large_zones = make_zones(large_zone_size);
 
@@ -247,6 +247,91 @@ bool Region::map_individual_page_impl(size_t page_index)
     return map_individual_page_impl(page_index, page);
 }
 
+bool Region::is_huge_page_candidate() const
+{
+    // NOTE: Shared regions are left alone, as other regions mapping the same VMObject wouldn't know about the huge page.
+    return MM.are_huge_pages_enabled()
+        && is_user()
+        && !is_shared()
+        && vmobject().is_anonymous()
+        && m_cacheable
+        && !m_write_combine
+        && (is_readable() || is_writable());
+}
+
+bool Region::can_map_huge_page(size_t page_index) const
+{
+    auto page_vaddr = vaddr_from_page_index(page_index);
+    if (page_vaddr.get() % MemoryManager::huge_page_size != 0 || page_index + MemoryManager::pages_per_huge_page > page_count())
+        return false;
+    if (!is_huge_page_candidate())
+        return false;
+
+    // A huge page can only stand in for 512 physically contiguous, naturally aligned and privately owned pages.
+    SpinlockLocker vmobject_locker(vmobject().m_lock);
+    auto first_page_index_in_vmobject = translate_to_vmobject_page(page_index);
+    auto const& first_page = vmobject().physical_pages()[first_page_index_in_vmobject];
+    if (!first_page || first_page->paddr().get() % MemoryManager::huge_page_size != 0)
+        return false;
+    for (size_t i = 0; i < MemoryManager::pages_per_huge_page; ++i) {
+        auto const& page = vmobject().physical_pages()[first_page_index_in_vmobject + i];
+        if (!page || page->paddr() != first_page->paddr().offset(i * PAGE_SIZE))
+            return false;
+        if (page->is_shared_zero_page() || page->is_lazy_committed_page() || should_cow(page_index + i))
+            return false;
+    }
+    return true;
+}
+
+void Region::map_huge_page_impl(size_t page_index)
+{
+    VERIFY(m_page_directory->get_lock().is_locked_by_current_processor());
+
+    auto page_vaddr = vaddr_from_page_index(page_index);
+    auto page = physical_page(page_index);
+    VERIFY(page);
+
+    auto* pde = MM.ensure_huge_pde(*m_page_directory, page_vaddr);
+    pde->clear();
+    pde->set_page_table_base(page->paddr().get());
+    pde->set_huge(true);
+    pde->set_present(true);
+    pde->set_writable(is_writable());
+    if (Processor::current().has_nx())
+        pde->set_execute_disabled(!is_executable());
+    pde->set_user_allowed(true);
+}
+
+bool Region::try_map_huge_page(size_t page_index)
+{
+    if (!is_huge_page_candidate())
+        return false;
+
+    auto huge_page_vaddr = VirtualAddress { vaddr_from_page_index(page_index).get() & ~(MemoryManager::huge_page_size - 1) };
+    if (huge_page_vaddr < vaddr() || huge_page_vaddr.offset(MemoryManager::huge_page_size) > range().end())
+        return false;
+
+    auto first_page_index = page_index_from_address(huge_page_vaddr);
+    if (!static_cast<AnonymousVMObject&>(vmobject()).try_allocate_huge_page({}, translate_to_vmobject_page(first_page_index)))
+        return false;
+
+    if (auto* current_thread = Thread::current())
+        current_thread->did_zero_fault();
+
+    SpinlockLocker page_lock(m_page_directory->get_lock());
+    if (can_map_huge_page(first_page_index)) {
+        map_huge_page_impl(first_page_index);
+    } else {
+        // The pages are ours now either way, so fall back to mapping them one by one.
+        for (size_t i = 0; i < MemoryManager::pages_per_huge_page; ++i) {
+            if (!map_individual_page_impl(first_page_index + i))
+                break;
+        }
+    }
+    MemoryManager::flush_tlb(m_page_directory, huge_page_vaddr, MemoryManager::pages_per_huge_page);
+    return true;
+}
+
 bool Region::remap_vmobject_page(size_t page_index, NonnullRefPtr<PhysicalPage> physical_page)
 {
     SpinlockLocker page_lock(m_page_directory->get_lock());
@@ -300,6 +385,11 @@ ErrorOr<void> Region::map(PageDirectory& page_directory, ShouldFlushTLB should_f
     set_page_directory(page_directory);
     size_t page_index = 0;
     while (page_index < page_count()) {
+        if (can_map_huge_page(page_index)) {
+            map_huge_page_impl(page_index);
+            page_index += MemoryManager::pages_per_huge_page;
+            continue;
+        }
         if (!map_individual_page_impl(page_index))
             break;
         ++page_index;
@@ -363,6 +453,9 @@ PageFaultResponse Region::handle_fault(PageFault const& fault)
             return handle_inode_fault(page_index_in_region);
         }
 
+        if (fault.is_write() && try_map_huge_page(page_index_in_region))
+            return PageFaultResponse::Continue;
+
         SpinlockLocker vmobject_locker(vmobject().m_lock);
         auto& page_slot = physical_page_slot(page_index_in_region);
         if (page_slot->is_lazy_committed_page()) {
@@ -388,6 +481,8 @@ PageFaultResponse Region::handle_fault(PageFault const& fault)
         auto phys_page = physical_page(page_index_in_region);
         if (phys_page->is_shared_zero_page() || phys_page->is_lazy_committed_page()) {
             dbgln_if(PAGE_FAULT_DEBUG, "NP(zero) fault in Region({})[{}] at {}", this, page_index_in_region, fault.vaddr());
+            if (try_map_huge_page(page_index_in_region))
+                return PageFaultResponse::Continue;
             return handle_zero_fault(page_index_in_region, *phys_page);
         }
         return handle_cow_fault(page_index_in_region);
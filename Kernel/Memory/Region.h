@@ -229,6 +229,11 @@ private:
     [[nodiscard]] bool map_individual_page_impl(size_t page_index);
     [[nodiscard]] bool map_individual_page_impl(size_t page_index, RefPtr<PhysicalPage>);
 
+    [[nodiscard]] bool is_huge_page_candidate() const;
+    [[nodiscard]] bool can_map_huge_page(size_t page_index) const;
+    void map_huge_page_impl(size_t page_index);
+    [[nodiscard]] bool try_map_huge_page(size_t page_index);
+
     LockRefPtr<PageDirectory> m_page_directory;
     VirtualRange m_range;
     size_t m_offset_in_vmobject { 0 };
@@ -83,8 +83,10 @@ protected:
     u16 in16(u16 address);
     u32 in32(u16 address);
 
-    void receive();
+    virtual size_t receive_packets(size_t budget) override;
+    virtual void enable_receive_interrupts() override;
 
+    static constexpr u32 maximum_interrupts_per_second = 8000;
     static constexpr size_t number_of_rx_descriptors = 256;
     static constexpr size_t number_of_tx_descriptors = 256;
 
@@ -76,39 +76,71 @@ void NetworkAdapter::did_receive(ReadonlyBytes payload)
     m_bytes_in += payload.size();
 
     if (m_packet_queue_size == max_packet_buffers) {
-        // FIXME: Keep track of the number of dropped packets
+        m_packets_dropped++;
         return;
     }
 
     auto packet = acquire_packet_buffer(payload.size());
     if (!packet) {
         dbgln("Discarding packet because we're out of memory");
+        m_packets_dropped++;
         return;
     }
 
     memcpy(packet->buffer->data(), payload.data(), payload.size());
 
+    bool queue_was_empty = m_packet_queue.is_empty();
     m_packet_queue.append(*packet);
     m_packet_queue_size++;
 
-    if (on_receive)
+    // The network task drains the whole queue once woken up, so only wake it for the first packet.
+    if (queue_was_empty && on_receive)
         on_receive();
 }
 
-size_t NetworkAdapter::dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp)
+size_t NetworkAdapter::dequeue_packets(PacketList& packets, size_t max_packet_count)
 {
     InterruptDisabler disabler;
-    if (m_packet_queue.is_empty())
+    size_t packet_count = 0;
+    while (packet_count < max_packet_count && !m_packet_queue.is_empty()) {
+        packets.append(*m_packet_queue.take_first());
+        m_packet_queue_size--;
+        packet_count++;
+    }
+    return packet_count;
+}
+
+void NetworkAdapter::schedule_receive_poll()
+{
+    if (m_receive_poll_scheduled.exchange(true, AK::MemoryOrder::memory_order_acq_rel))
+        return;
+    if (on_receive)
+        on_receive();
+}
+
+size_t NetworkAdapter::poll_receive(size_t budget)
+{
+    if (!m_receive_poll_scheduled.load(AK::MemoryOrder::memory_order_acquire))
         return 0;
-    auto packet_with_timestamp = m_packet_queue.take_first();
-    m_packet_queue_size--;
-    packet_timestamp = packet_with_timestamp->timestamp;
-    auto& packet_buffer = packet_with_timestamp->buffer;
-    size_t packet_size = packet_buffer->size();
-    VERIFY(packet_size <= buffer_size);
-    memcpy(buffer, packet_buffer->data(), packet_size);
-    release_packet_buffer(*packet_with_timestamp);
-    return packet_size;
+    auto packet_count = receive_packets(budget);
+    if (packet_count < budget) {
+        // The ring ran dry, so let the next packet raise an interrupt again.
+        m_receive_poll_scheduled.store(false, AK::MemoryOrder::memory_order_release);
+        enable_receive_interrupts();
+    }
+    return packet_count;
+}
+
+void NetworkAdapter::update_packet_rates(Time const& now)
+{
+    auto elapsed_milliseconds = (now - m_packet_rate_sample_time).to_milliseconds();
+    if (elapsed_milliseconds < 1000)
+        return;
+    m_packets_in_per_second = static_cast<u64>(m_packets_in - m_packets_in_at_last_sample) * 1000 / elapsed_milliseconds;
+    m_packets_out_per_second = static_cast<u64>(m_packets_out - m_packets_out_at_last_sample) * 1000 / elapsed_milliseconds;
+    m_packets_in_at_last_sample = m_packets_in;
+    m_packets_out_at_last_sample = m_packets_out;
+    m_packet_rate_sample_time = now;
 }
 
 LockRefPtr<PacketWithTimestamp> NetworkAdapter::acquire_packet_buffer(size_t size)
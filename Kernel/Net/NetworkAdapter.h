@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/AtomicRefCounted.h>
 #include <AK/ByteBuffer.h>
 #include <AK/Function.h>
@@ -52,6 +53,8 @@ public:
         Ethernet
     };
 
+    using PacketList = IntrusiveList<&PacketWithTimestamp::packet_node>;
+
     static constexpr i32 LINKSPEED_INVALID = -1;
 
     virtual ~NetworkAdapter();
@@ -79,9 +82,16 @@ public:
     void send(MACAddress const&, ARPPacket const&);
     void fill_in_ipv4_header(PacketWithTimestamp&, IPv4Address const&, MACAddress const&, IPv4Address const&, IPv4Protocol, size_t, u8 type_of_service, u8 ttl);
 
-    size_t dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp);
+    // Moves up to max_packet_count received packets into the given list. Each of them has to be
+    // handed back with release_packet_buffer() once it has been processed.
+    size_t dequeue_packets(PacketList&, size_t max_packet_count);
 
     bool has_queued_packets() const { return !m_packet_queue.is_empty(); }
+    bool has_pending_receive_work() const { return has_queued_packets() || m_receive_poll_scheduled.load(AK::MemoryOrder::memory_order_relaxed); }
+
+    // Drains up to budget packets from the receive ring if the driver asked to be polled.
+    // Once the ring is empty, the driver goes back to being interrupt-driven.
+    size_t poll_receive(size_t budget);
 
     u32 mtu() const { return m_mtu; }
     void set_mtu(u32 mtu) { m_mtu = mtu; }
@@ -90,6 +100,11 @@ public:
     u32 bytes_in() const { return m_bytes_in; }
     u32 packets_out() const { return m_packets_out; }
     u32 bytes_out() const { return m_bytes_out; }
+    u32 packets_dropped() const { return m_packets_dropped; }
+    u32 packets_in_per_second() const { return m_packets_in_per_second; }
+    u32 packets_out_per_second() const { return m_packets_out_per_second; }
+
+    void update_packet_rates(Time const& now);
 
     LockRefPtr<PacketWithTimestamp> acquire_packet_buffer(size_t);
     void release_packet_buffer(PacketWithTimestamp&);
@@ -107,6 +122,13 @@ protected:
     void did_receive(ReadonlyBytes);
     virtual void send_raw(ReadonlyBytes) = 0;
 
+    // NAPI-style receive: a driver's interrupt handler masks its receive interrupts and calls
+    // schedule_receive_poll() instead of draining the ring itself. The network task then calls
+    // receive_packets() until the ring runs dry, and finally enable_receive_interrupts().
+    void schedule_receive_poll();
+    virtual size_t receive_packets([[maybe_unused]] size_t budget) { return 0; }
+    virtual void enable_receive_interrupts() { }
+
 private:
     MACAddress m_mac_address;
     IPv4Address m_ipv4_address;
@@ -115,8 +137,6 @@ private:
     // FIXME: Make this configurable
     static constexpr size_t max_packet_buffers = 1024;
 
-    using PacketList = IntrusiveList<&PacketWithTimestamp::packet_node>;
-
     PacketList m_packet_queue;
     size_t m_packet_queue_size { 0 };
     SpinlockProtected<PacketList, LockRank::None> m_unused_packets {};
@@ -125,6 +145,13 @@ private:
     u32 m_bytes_in { 0 };
     u32 m_packets_out { 0 };
     u32 m_bytes_out { 0 };
+    u32 m_packets_dropped { 0 };
+    Atomic<bool> m_receive_poll_scheduled { false };
+    Time m_packet_rate_sample_time;
+    u32 m_packets_in_at_last_sample { 0 };
+    u32 m_packets_out_at_last_sample { 0 };
+    u32 m_packets_in_per_second { 0 };
+    u32 m_packets_out_per_second { 0 };
     u32 m_mtu { 1500 };
 };
 
@@ -152,7 +152,8 @@ private:
     void initialize_rx_descriptors();
     void initialize_tx_descriptors();
 
-    void receive();
+    virtual size_t receive_packets(size_t budget) override;
+    virtual void enable_receive_interrupts() override;
 
     void out8(u16 address, u8 data);
     void out16(u16 address, u16 data);
@@ -207,6 +208,7 @@ private:
     OwnPtr<Memory::Region> m_rx_descriptors_region;
     NonnullOwnPtrVector<Memory::Region> m_rx_buffers_regions;
     u16 m_rx_free_index { 0 };
+    u16 m_enabled_interrupts { 0 };
     OwnPtr<Memory::Region> m_tx_descriptors_region;
     NonnullOwnPtrVector<Memory::Region> m_tx_buffers_regions;
     u16 m_tx_free_index { 0 };
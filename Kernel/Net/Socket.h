@@ -81,6 +81,9 @@ public:
     virtual bool is_ipv4() const { return false; }
     virtual ErrorOr<size_t> sendto(OpenFileDescription&, UserOrKernelBuffer const&, size_t, int flags, Userspace<sockaddr const*>, socklen_t) = 0;
     virtual ErrorOr<size_t> recvfrom(OpenFileDescription&, UserOrKernelBuffer&, size_t, int flags, Userspace<sockaddr*>, Userspace<socklen_t*>, Time&, bool blocking) = 0;
+    // Sends up to `length` bytes of `source`, starting at `offset`, without bouncing them through an intermediate buffer.
+    // Sockets that can't do this return ENOTSUP, and sendfile() falls back to a regular write().
+    virtual ErrorOr<size_t> send_file_contents(OpenFileDescription&, OpenFileDescription& /* source */, u64 /* offset */, size_t /* length */) { return ENOTSUP; }
 
     virtual ErrorOr<void> setsockopt(int level, int option, Userspace<void const*>, socklen_t);
     virtual ErrorOr<void> getsockopt(OpenFileDescription&, int level, int option, Userspace<void*>, Userspace<socklen_t*>);
@@ -21,6 +21,19 @@ struct TCPFlags {
     };
 };
 
+// Sequence numbers wrap around, so they have to be compared modulo 2^32 (RFC 793, section 3.3).
+constexpr bool tcp_sequence_before(u32 a, u32 b) { return static_cast<i32>(a - b) < 0; }
+constexpr bool tcp_sequence_before_or_equal(u32 a, u32 b) { return static_cast<i32>(a - b) <= 0; }
+
+enum class TCPOptionKind : u8 {
+    End = 0,
+    NoOperation = 1,
+    MSS = 2,
+    WindowScale = 3,
+    SACKPermitted = 4,
+    SACK = 5,
+};
+
 class [[gnu::packed]] TCPOptionMSS {
 public:
     TCPOptionMSS(u16 value)
@@ -38,6 +51,62 @@ private:
 
 static_assert(AssertSize<TCPOptionMSS, 4>());
 
+// RFC 7323, section 2.2. Preceded by a NOP to keep the following options aligned.
+class [[gnu::packed]] TCPOptionWindowScale {
+public:
+    TCPOptionWindowScale(u8 shift_count)
+        : m_shift_count(shift_count)
+    {
+    }
+
+    u8 shift_count() const { return m_shift_count; }
+
+private:
+    u8 m_padding { to_underlying(TCPOptionKind::NoOperation) };
+    u8 m_option_kind { to_underlying(TCPOptionKind::WindowScale) };
+    u8 m_option_length { 3 };
+    u8 m_shift_count { 0 };
+};
+
+static_assert(AssertSize<TCPOptionWindowScale, 4>());
+
+// RFC 2018, section 2. Preceded by two NOPs to keep the following options aligned.
+class [[gnu::packed]] TCPOptionSACKPermitted {
+private:
+    u8 m_padding[2] { to_underlying(TCPOptionKind::NoOperation), to_underlying(TCPOptionKind::NoOperation) };
+    u8 m_option_kind { to_underlying(TCPOptionKind::SACKPermitted) };
+    u8 m_option_length { 2 };
+};
+
+static_assert(AssertSize<TCPOptionSACKPermitted, 4>());
+
+struct [[gnu::packed]] TCPSACKBlock {
+    NetworkOrdered<u32> left_edge;
+    NetworkOrdered<u32> right_edge;
+};
+
+static_assert(AssertSize<TCPSACKBlock, 8>());
+
+// RFC 2018, section 3. Followed by up to maximum_block_count TCPSACKBlocks.
+class [[gnu::packed]] TCPOptionSACK {
+public:
+    // Leaves room for a timestamp option, should we ever send one.
+    static constexpr size_t maximum_block_count = 3;
+
+    TCPOptionSACK(size_t block_count)
+        : m_option_length(2 + block_count * sizeof(TCPSACKBlock))
+    {
+        VERIFY(block_count <= maximum_block_count);
+    }
+
+private:
+    u8 m_padding[2] { to_underlying(TCPOptionKind::NoOperation), to_underlying(TCPOptionKind::NoOperation) };
+    u8 m_option_kind { to_underlying(TCPOptionKind::SACK) };
+    u8 m_option_length { 0 };
+};
+
+static_assert(AssertSize<TCPOptionSACK, 4>());
+
 class [[gnu::packed]] TCPPacket {
 public:
     TCPPacket() = default;
@@ -77,6 +146,8 @@ public:
     u16 urgent() const { return m_urgent; }
     void set_urgent(u16 urgent) { m_urgent = urgent; }
 
+    ReadonlyBytes options() const { return { ((u8 const*)this) + sizeof(TCPPacket), header_size() - sizeof(TCPPacket) }; }
+
     void const* payload() const { return ((u8 const*)this) + header_size(); }
     void* payload() { return ((u8*)this) + header_size(); }
 
@@ -22,6 +22,34 @@
 
 namespace Kernel {
 
+template<typename Callback>
+static void for_each_tcp_option(ReadonlyBytes options, Callback callback)
+{
+    while (!options.is_empty()) {
+        auto kind = static_cast<TCPOptionKind>(options[0]);
+        if (kind == TCPOptionKind::End)
+            return;
+        if (kind == TCPOptionKind::NoOperation) {
+            options = options.slice(1);
+            continue;
+        }
+        // Give up on malformed options, like everyone else does.
+        if (options.size() < 2 || options[1] < 2 || options[1] > options.size())
+            return;
+        callback(kind, options.slice(2, options[1] - 2));
+        options = options.slice(options[1]);
+    }
+}
+
+// The smallest shift that lets us advertise the whole receive buffer.
+static constexpr u8 window_scale_for(size_t window_size)
+{
+    u8 scale = 0;
+    while ((static_cast<size_t>(NumericLimits<u16>::max()) << scale) < window_size)
+        ++scale;
+    return scale;
+}
+
 void TCPSocket::for_each(Function<void(TCPSocket const&)> callback)
 {
     sockets_by_tuple().for_each_shared([&](auto const& it) {
@@ -164,7 +192,9 @@ void TCPSocket::release_for_accept(NonnullLockRefPtr<TCPSocket> socket)
 
 TCPSocket::TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, NonnullOwnPtr<KBuffer> scratch_buffer)
     : IPv4Socket(SOCK_STREAM, protocol, move(receive_buffer), move(scratch_buffer))
+    , m_receive_window_scale(window_scale_for(receive_buffer_size))
 {
+    static_assert(window_scale_for(receive_buffer_size) <= maximum_window_scale);
     m_last_retransmit_time = kgettimeofday();
 }
 
@@ -205,12 +235,31 @@ ErrorOr<size_t> TCPSocket::protocol_send(UserOrKernelBuffer const& data, size_t
     RoutingDecision routing_decision = route_to(peer_address(), local_address(), bound_interface());
     if (routing_decision.is_zero())
         return set_so_error(EHOSTUNREACH);
-    size_t mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
+    size_t mss = min<size_t>(routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket), m_peer_mss);
     data_length = min(data_length, mss);
     TRY(send_tcp_packet(TCPFlags::PSH | TCPFlags::ACK, &data, data_length, &routing_decision));
     return data_length;
 }
 
+ErrorOr<size_t> TCPSocket::protocol_send_file_contents(OpenFileDescription& source, u64 offset, size_t length)
+{
+    RoutingDecision routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    if (routing_decision.is_zero())
+        return set_so_error(EHOSTUNREACH);
+    size_t mss = min<size_t>(routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket), m_peer_mss);
+    length = min(length, mss);
+    // Read the file contents straight into the outgoing packet.
+    TRY(send_tcp_packet(TCPFlags::PSH | TCPFlags::ACK, length, &routing_decision, [&](Bytes payload) -> ErrorOr<void> {
+        auto buffer = UserOrKernelBuffer::for_kernel_buffer(payload.data());
+        auto nread = TRY(source.read(buffer, offset, payload.size()));
+        // The caller only asks for what's in the file, so coming up short means it was truncated under us.
+        if (nread != payload.size())
+            return EIO;
+        return {};
+    }));
+    return length;
+}
+
 ErrorOr<void> TCPSocket::send_ack(bool allow_duplicate)
 {
     if (!allow_duplicate && m_last_ack_number_sent == m_ack_number)
@@ -219,6 +268,15 @@ ErrorOr<void> TCPSocket::send_ack(bool allow_duplicate)
 }
 
 ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* payload, size_t payload_size, RoutingDecision* user_routing_decision)
+{
+    if (!payload)
+        return send_tcp_packet(flags, 0, user_routing_decision, {});
+    return send_tcp_packet(flags, payload_size, user_routing_decision, [&](Bytes bytes) {
+        return payload->read(bytes.data(), bytes.size());
+    });
+}
+
+ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, size_t payload_size, RoutingDecision* user_routing_decision, Function<ErrorOr<void>(Bytes)> const& write_payload)
 {
     RoutingDecision routing_decision = user_routing_decision ? *user_routing_decision : route_to(peer_address(), local_address(), bound_interface());
     if (routing_decision.is_zero())
@@ -226,8 +284,26 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
 
     auto ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
 
-    bool const has_mss_option = flags == TCPFlags::SYN;
-    const size_t options_size = has_mss_option ? sizeof(TCPOptionMSS) : 0;
+    // Our SYN offers everything we support, while a SYN-ACK may only agree to what the peer offered on its SYN.
+    bool const is_syn = flags & TCPFlags::SYN;
+    bool const is_syn_ack = is_syn && (flags & TCPFlags::ACK);
+    bool const has_window_scale_option = is_syn && (!is_syn_ack || m_window_scaling_enabled);
+    bool const has_sack_permitted_option = is_syn && (!is_syn_ack || m_sack_permitted);
+
+    Array<TCPSACKBlock, TCPOptionSACK::maximum_block_count> sack_blocks;
+    size_t sack_block_count = 0;
+    if (!is_syn && (flags & TCPFlags::ACK) && m_sack_permitted)
+        sack_block_count = build_sack_blocks(sack_blocks);
+
+    size_t options_size = 0;
+    if (is_syn)
+        options_size += sizeof(TCPOptionMSS);
+    if (has_window_scale_option)
+        options_size += sizeof(TCPOptionWindowScale);
+    if (has_sack_permitted_option)
+        options_size += sizeof(TCPOptionSACKPermitted);
+    if (sack_block_count > 0)
+        options_size += sizeof(TCPOptionSACK) + sack_block_count * sizeof(TCPSACKBlock);
     const size_t tcp_header_size = sizeof(TCPPacket) + options_size;
     const size_t buffer_size = ipv4_payload_offset + tcp_header_size + payload_size;
     auto packet = routing_decision.adapter->acquire_packet_buffer(buffer_size);
@@ -241,13 +317,13 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
     VERIFY(local_port());
     tcp_packet.set_source_port(local_port());
     tcp_packet.set_destination_port(peer_port());
-    tcp_packet.set_window_size(NumericLimits<u16>::max());
+    tcp_packet.set_window_size(receive_window_size_to_advertise(is_syn));
     tcp_packet.set_sequence_number(m_sequence_number);
     tcp_packet.set_data_offset(tcp_header_size / sizeof(u32));
     tcp_packet.set_flags(flags);
 
-    if (payload) {
-        if (auto result = payload->read(tcp_packet.payload(), payload_size); result.is_error()) {
+    if (write_payload) {
+        if (auto result = write_payload({ tcp_packet.payload(), payload_size }); result.is_error()) {
             routing_decision.adapter->release_packet_buffer(*packet);
             return set_so_error(result.release_error());
         }
@@ -265,11 +341,29 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
         m_sequence_number += payload_size;
     }
 
-    if (has_mss_option) {
-        u16 mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
+    VERIFY(packet->buffer->size() >= ipv4_payload_offset + tcp_header_size);
+    auto* options = packet->buffer->data() + ipv4_payload_offset + sizeof(TCPPacket);
+    auto append_option = [&](void const* option, size_t size) {
+        memcpy(options, option, size);
+        options += size;
+    };
+    if (is_syn) {
+        u16 mss = min<size_t>(routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket), NumericLimits<u16>::max());
         TCPOptionMSS mss_option { mss };
-        VERIFY(packet->buffer->size() >= ipv4_payload_offset + sizeof(TCPPacket) + sizeof(mss_option));
-        memcpy(packet->buffer->data() + ipv4_payload_offset + sizeof(TCPPacket), &mss_option, sizeof(mss_option));
+        append_option(&mss_option, sizeof(mss_option));
+    }
+    if (has_window_scale_option) {
+        TCPOptionWindowScale window_scale_option { m_receive_window_scale };
+        append_option(&window_scale_option, sizeof(window_scale_option));
+    }
+    if (has_sack_permitted_option) {
+        TCPOptionSACKPermitted sack_permitted_option;
+        append_option(&sack_permitted_option, sizeof(sack_permitted_option));
+    }
+    if (sack_block_count > 0) {
+        TCPOptionSACK sack_option { sack_block_count };
+        append_option(&sack_option, sizeof(sack_option));
+        append_option(sack_blocks.data(), sack_block_count * sizeof(TCPSACKBlock));
     }
 
     tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
@@ -278,7 +372,11 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
     if (expect_ack) {
         bool append_failed { false };
         m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
-            auto result = unacked_packets.packets.try_append({ m_sequence_number, packet, ipv4_payload_offset, *routing_decision.adapter });
+            auto now = kgettimeofday();
+            // The retransmission timer starts with the first packet that goes out (RFC 6298, section 5.1).
+            if (unacked_packets.packets.is_empty())
+                m_last_retransmit_time = now;
+            auto result = unacked_packets.packets.try_append({ m_sequence_number, packet, ipv4_payload_offset, *routing_decision.adapter, 0, payload_size, now });
             if (result.is_error()) {
                 dbgln("TCPSocket: Dropped outbound packet because try_append() failed");
                 append_failed = true;
@@ -300,35 +398,117 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
     return {};
 }
 
+void TCPSocket::receive_syn_options(TCPPacket const& packet)
+{
+    VERIFY(packet.has_syn());
+
+    bool has_window_scale_option = false;
+    for_each_tcp_option(packet.options(), [&](TCPOptionKind kind, ReadonlyBytes data) {
+        switch (kind) {
+        case TCPOptionKind::MSS:
+            if (data.size() == sizeof(u16)) {
+                if (u16 mss = (data[0] << 8) | data[1]; mss > 0)
+                    m_peer_mss = mss;
+            }
+            break;
+        case TCPOptionKind::WindowScale:
+            if (data.size() == sizeof(u8)) {
+                has_window_scale_option = true;
+                m_send_window_scale = min(data[0], maximum_window_scale);
+            }
+            break;
+        case TCPOptionKind::SACKPermitted:
+            m_sack_permitted = true;
+            break;
+        default:
+            break;
+        }
+    });
+
+    m_window_scaling_enabled = has_window_scale_option;
+    if (!m_window_scaling_enabled)
+        m_send_window_scale = 0;
+
+    // The window on a SYN is never scaled.
+    m_send_window_size = packet.window_size();
+    m_last_ack_number_received = packet.has_ack() ? packet.ack_number() : m_sequence_number;
+
+    // RFC 6928, section 2.
+    m_congestion_window = min(10u * m_peer_mss, max(2u * m_peer_mss, 14600u));
+    m_recovery_point = m_sequence_number;
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) negotiated mss={}, window_scaling={} (send {}, receive {}), sack={}",
+        this, m_peer_mss, m_window_scaling_enabled, m_send_window_scale, m_receive_window_scale, m_sack_permitted);
+}
+
 void TCPSocket::receive_tcp_packet(TCPPacket const& packet, u16 size)
 {
+    if (packet.has_syn() && m_state == State::SynSent)
+        receive_syn_options(packet);
+
     if (packet.has_ack()) {
         u32 ack_number = packet.ack_number();
+        size_t payload_size = size - packet.header_size();
+        u32 send_window_size = packet.has_syn() ? packet.window_size() : packet.window_size() << m_send_window_scale;
 
         dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet: {}", ack_number);
 
         int removed = 0;
+        bool can_send_more = false;
         m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+            // RFC 5681, section 2.
+            bool is_duplicate_ack = !unacked_packets.packets.is_empty()
+                && ack_number == m_last_ack_number_received
+                && payload_size == 0
+                && !packet.has_syn() && !packet.has_fin()
+                && send_window_size == m_send_window_size;
+
+            auto now = kgettimeofday();
+            Optional<Time> round_trip_time_sample;
+            size_t acknowledged_bytes = 0;
             while (!unacked_packets.packets.is_empty()) {
-                auto& packet = unacked_packets.packets.first();
-
-                dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
-
-                if (packet.ack_number <= ack_number) {
-                    auto old_adapter = packet.adapter.strong_ref();
-                    if (old_adapter)
-                        old_adapter->release_packet_buffer(*packet.buffer);
-                    TCPPacket& tcp_packet = *(TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
-                    auto payload_size = packet.buffer->buffer->data() + packet.buffer->buffer->size() - (u8*)tcp_packet.payload();
-                    unacked_packets.size -= payload_size;
-                    evaluate_block_conditions();
-                    unacked_packets.packets.take_first();
-                    removed++;
-                } else {
+                auto& unacked_packet = unacked_packets.packets.first();
+
+                dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", unacked_packet.ack_number);
+
+                if (!tcp_sequence_before_or_equal(unacked_packet.ack_number, ack_number))
                     break;
-                }
+
+                auto old_adapter = unacked_packet.adapter.strong_ref();
+                if (old_adapter)
+                    old_adapter->release_packet_buffer(*unacked_packet.buffer);
+                unacked_packets.size -= unacked_packet.payload_size;
+                if (unacked_packet.is_sacked)
+                    unacked_packets.sacked_size -= unacked_packet.payload_size;
+                if (unacked_packet.is_lost)
+                    unacked_packets.lost_size -= unacked_packet.payload_size;
+                acknowledged_bytes += unacked_packet.payload_size;
+                // Karn's algorithm: Only packets that were sent once can tell us how long a round trip takes.
+                if (unacked_packet.tx_counter == 0)
+                    round_trip_time_sample = now - unacked_packet.last_sent_time;
+                unacked_packets.packets.take_first();
+                removed++;
             }
 
+            if (round_trip_time_sample.has_value())
+                update_round_trip_time(round_trip_time_sample.value());
+
+            auto sacked_size_before = unacked_packets.sacked_size;
+            if (m_sack_permitted)
+                process_sack_blocks(unacked_packets, packet.options());
+
+            if (removed > 0) {
+                // Restart the retransmission timer, and forget about any previous backoff (RFC 6298, section 5.3).
+                m_retransmit_attempts = 0;
+                m_last_retransmit_time = now;
+            }
+
+            auto congestion_window_before = m_congestion_window;
+            if (m_congestion_window > 0)
+                update_congestion_window(unacked_packets, ack_number, acknowledged_bytes, is_duplicate_ack);
+
+            can_send_more = removed > 0 || unacked_packets.sacked_size > sacked_size_before || m_congestion_window > congestion_window_before;
+
             if (unacked_packets.packets.is_empty()) {
                 m_retransmit_attempts = 0;
                 dequeue_for_retransmit();
@@ -336,12 +516,242 @@ void TCPSocket::receive_tcp_packet(TCPPacket const& packet, u16 size)
 
             dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet acknowledged {} packets", removed);
         });
+
+        if (tcp_sequence_before_or_equal(m_last_ack_number_received, ack_number)) {
+            m_last_ack_number_received = ack_number;
+            // FIXME: Keep probing the peer while it advertises a zero window (RFC 1122, section 4.2.2.17).
+            if (send_window_size > m_send_window_size)
+                can_send_more = true;
+            m_send_window_size = send_window_size;
+        }
+
+        // Writers may be blocked on either window, not just on packets still waiting to be acknowledged.
+        if (can_send_more)
+            evaluate_block_conditions();
     }
 
     m_packets_in++;
     m_bytes_in += packet.header_size() + size;
 }
 
+void TCPSocket::process_sack_blocks(UnackedPackets& unacked_packets, ReadonlyBytes options)
+{
+    for_each_tcp_option(options, [&](TCPOptionKind kind, ReadonlyBytes data) {
+        if (kind != TCPOptionKind::SACK)
+            return;
+        for (size_t offset = 0; offset + sizeof(TCPSACKBlock) <= data.size(); offset += sizeof(TCPSACKBlock)) {
+            auto const& block = *reinterpret_cast<TCPSACKBlock const*>(data.offset(offset));
+            u32 left_edge = block.left_edge;
+            u32 right_edge = block.right_edge;
+            for (auto& unacked_packet : unacked_packets.packets) {
+                if (unacked_packet.is_sacked || unacked_packet.payload_size == 0)
+                    continue;
+                if (!tcp_sequence_before_or_equal(left_edge, unacked_packet.sequence_number()) || !tcp_sequence_before_or_equal(unacked_packet.ack_number, right_edge))
+                    continue;
+                unacked_packet.is_sacked = true;
+                unacked_packets.sacked_size += unacked_packet.payload_size;
+                if (unacked_packet.is_lost) {
+                    unacked_packet.is_lost = false;
+                    unacked_packets.lost_size -= unacked_packet.payload_size;
+                }
+            }
+        }
+    });
+}
+
+void TCPSocket::mark_packet_lost(UnackedPackets& unacked_packets, OutgoingPacket& packet)
+{
+    if (packet.is_lost || packet.is_sacked)
+        return;
+    packet.is_lost = true;
+    unacked_packets.lost_size += packet.payload_size;
+}
+
+void TCPSocket::mark_lost_packets(UnackedPackets& unacked_packets)
+{
+    // With SACK, a hole with enough SACKed packets after it is lost as well (RFC 6675, section 4).
+    size_t sacked_packets_after = 0;
+    for (auto& unacked_packet : unacked_packets.packets) {
+        if (unacked_packet.is_sacked)
+            ++sacked_packets_after;
+    }
+    for (auto& unacked_packet : unacked_packets.packets) {
+        if (sacked_packets_after < duplicate_ack_threshold)
+            break;
+        if (unacked_packet.is_sacked) {
+            --sacked_packets_after;
+            continue;
+        }
+        // Anything we've resent during this recovery is left to the retransmission timer.
+        if (unacked_packet.tx_counter == 0)
+            mark_packet_lost(unacked_packets, unacked_packet);
+    }
+}
+
+void TCPSocket::update_congestion_window(UnackedPackets& unacked_packets, u32 ack_number, size_t acknowledged_bytes, bool is_duplicate_ack)
+{
+    u32 mss = m_peer_mss;
+    auto mark_first_hole_lost = [&] {
+        for (auto& unacked_packet : unacked_packets.packets) {
+            if (!unacked_packet.is_sacked) {
+                mark_packet_lost(unacked_packets, unacked_packet);
+                return;
+            }
+        }
+    };
+
+    if (is_duplicate_ack) {
+        ++m_duplicate_acks_received;
+        if (m_in_fast_recovery) {
+            // Every duplicate ACK means another packet has left the network (RFC 5681, section 3.2, step 4).
+            m_congestion_window = min(m_congestion_window + mss, maximum_congestion_window);
+            if (m_sack_permitted)
+                mark_lost_packets(unacked_packets);
+        } else if (m_duplicate_acks_received == duplicate_ack_threshold && tcp_sequence_before_or_equal(m_recovery_point, ack_number)) {
+            // Fast retransmit (RFC 5681, section 3.2 and RFC 6582, section 3.2).
+            dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) entering fast recovery at {}", this, ack_number);
+            m_slow_start_threshold = max<u32>(unacked_packets.in_flight_size() / 2, 2 * mss);
+            m_recovery_point = m_sequence_number;
+            m_in_fast_recovery = true;
+            mark_first_hole_lost();
+            if (m_sack_permitted)
+                mark_lost_packets(unacked_packets);
+            m_congestion_window = m_slow_start_threshold + duplicate_ack_threshold * mss;
+        }
+    } else if (acknowledged_bytes > 0) {
+        m_duplicate_acks_received = 0;
+        if (m_in_fast_recovery) {
+            if (tcp_sequence_before(ack_number, m_recovery_point)) {
+                // A partial ACK means the next hole was lost as well (RFC 6582, section 3.2, step 5).
+                mark_first_hole_lost();
+                if (m_sack_permitted)
+                    mark_lost_packets(unacked_packets);
+                m_congestion_window -= min<u32>(m_congestion_window, acknowledged_bytes);
+                m_congestion_window += mss;
+            } else {
+                m_congestion_window = min<u32>(m_slow_start_threshold, max<u32>(unacked_packets.in_flight_size(), mss) + mss);
+                m_in_fast_recovery = false;
+            }
+        } else if (m_congestion_window < m_slow_start_threshold) {
+            // Slow start (RFC 5681, section 3.1).
+            m_congestion_window += min<u32>(acknowledged_bytes, mss);
+        } else {
+            // Congestion avoidance, which grows the window by about one MSS per round trip.
+            m_congestion_window += max(1u, mss * mss / m_congestion_window);
+        }
+        m_congestion_window = min(m_congestion_window, maximum_congestion_window);
+    }
+
+    retransmit_lost_packets(unacked_packets);
+}
+
+void TCPSocket::update_round_trip_time(Time sample)
+{
+    // RFC 6298, section 2.
+    static constexpr i64 clock_granularity_in_microseconds = 1000;
+    i64 sample_in_microseconds = max<i64>(sample.to_microseconds(), 0);
+    i64 smoothed_round_trip_time = m_smoothed_round_trip_time.to_microseconds();
+    i64 round_trip_time_variance = m_round_trip_time_variance.to_microseconds();
+    if (!m_has_round_trip_time_sample) {
+        smoothed_round_trip_time = sample_in_microseconds;
+        round_trip_time_variance = sample_in_microseconds / 2;
+        m_has_round_trip_time_sample = true;
+    } else {
+        auto deviation = smoothed_round_trip_time - sample_in_microseconds;
+        round_trip_time_variance = (3 * round_trip_time_variance + (deviation < 0 ? -deviation : deviation)) / 4;
+        smoothed_round_trip_time = (7 * smoothed_round_trip_time + sample_in_microseconds) / 8;
+    }
+    m_smoothed_round_trip_time = Time::from_microseconds(smoothed_round_trip_time);
+    m_round_trip_time_variance = Time::from_microseconds(round_trip_time_variance);
+
+    auto retransmission_timeout = Time::from_microseconds(smoothed_round_trip_time + max(clock_granularity_in_microseconds, 4 * round_trip_time_variance));
+    m_retransmission_timeout = clamp(retransmission_timeout, minimum_retransmission_timeout, maximum_retransmission_timeout);
+}
+
+u16 TCPSocket::receive_window_size_to_advertise(bool is_syn) const
+{
+    // FIXME: Advertise the space that's actually left in the receive buffer, and send window updates as it drains.
+    size_t window_size = receive_buffer_size;
+    // The window on a SYN is never scaled.
+    if (!is_syn && m_window_scaling_enabled)
+        window_size >>= m_receive_window_scale;
+    return min<size_t>(window_size, NumericLimits<u16>::max());
+}
+
+bool TCPSocket::queue_out_of_order_segment(IPv4Packet const& ipv4_packet, TCPPacket const& tcp_packet, Time const& packet_timestamp)
+{
+    u32 sequence_number = tcp_packet.sequence_number();
+    u32 payload_size = ipv4_packet.payload_size() - tcp_packet.header_size();
+    if (payload_size == 0 || tcp_packet.has_fin() || !tcp_sequence_before(m_ack_number, sequence_number))
+        return false;
+
+    size_t index = 0;
+    for (; index < m_out_of_order_segments.size(); ++index) {
+        auto& segment = m_out_of_order_segments[index];
+        if (segment.sequence_number == sequence_number) {
+            m_last_out_of_order_sequence_number = sequence_number;
+            return true;
+        }
+        if (tcp_sequence_before(sequence_number, segment.sequence_number))
+            break;
+    }
+
+    if (m_out_of_order_segments.size() >= maximum_out_of_order_segments || m_out_of_order_bytes + payload_size > receive_buffer_size)
+        return false;
+
+    auto packet_or_error = KBuffer::try_create_with_bytes("TCPSocket: Out-of-order segment"sv, { &ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size() });
+    if (packet_or_error.is_error())
+        return false;
+    if (m_out_of_order_segments.try_insert(index, { sequence_number, payload_size, packet_timestamp, packet_or_error.release_value() }).is_error())
+        return false;
+
+    m_out_of_order_bytes += payload_size;
+    m_last_out_of_order_sequence_number = sequence_number;
+    return true;
+}
+
+void TCPSocket::deliver_out_of_order_segments()
+{
+    while (!m_out_of_order_segments.is_empty()) {
+        if (tcp_sequence_before(m_ack_number, m_out_of_order_segments.first().sequence_number))
+            return;
+
+        auto segment = m_out_of_order_segments.take_first();
+        m_out_of_order_bytes -= segment.payload_size;
+
+        // A segment that overlaps what we already have would end up in the receive buffer twice, so let the peer resend it.
+        if (segment.sequence_number != m_ack_number)
+            continue;
+        if (!did_receive(peer_address(), peer_port(), segment.ipv4_packet->bytes(), segment.timestamp))
+            return;
+        m_ack_number += segment.payload_size;
+    }
+}
+
+size_t TCPSocket::build_sack_blocks(Span<TCPSACKBlock> blocks) const
+{
+    // RFC 2018, section 4: The first block has to be the one holding the segment we've received most recently.
+    size_t block_count = 0;
+    for (auto wants_most_recent_block : Array { true, false }) {
+        for (size_t i = 0; i < m_out_of_order_segments.size() && block_count < blocks.size();) {
+            u32 left_edge = m_out_of_order_segments[i].sequence_number;
+            u32 right_edge = left_edge + m_out_of_order_segments[i].payload_size;
+            bool is_most_recent_block = left_edge == m_last_out_of_order_sequence_number;
+            for (++i; i < m_out_of_order_segments.size(); ++i) {
+                auto const& segment = m_out_of_order_segments[i];
+                if (tcp_sequence_before(right_edge, segment.sequence_number))
+                    break;
+                if (tcp_sequence_before(right_edge, segment.sequence_number + segment.payload_size))
+                    right_edge = segment.sequence_number + segment.payload_size;
+                is_most_recent_block |= segment.sequence_number == m_last_out_of_order_sequence_number;
+            }
+            if (is_most_recent_block == wants_most_recent_block)
+                blocks[block_count++] = { left_edge, right_edge };
+        }
+    }
+    return block_count;
+}
+
 bool TCPSocket::should_delay_next_ack() const
 {
     // FIXME: We don't know the MSS here so make a reasonable guess.
@@ -577,13 +987,12 @@ void TCPSocket::retransmit_packets()
 {
     auto now = kgettimeofday();
 
-    // RFC6298 says we should have at least one second between retransmits. According to
-    // RFC1122 we must do exponential backoff - even for SYN packets.
-    i64 retransmit_interval = 1;
+    // RFC 6298, section 5.5: Back off exponentially with every retransmission.
+    auto retransmission_timeout = m_retransmission_timeout;
     for (decltype(m_retransmit_attempts) i = 0; i < m_retransmit_attempts; i++)
-        retransmit_interval *= 2;
+        retransmission_timeout = min(retransmission_timeout + retransmission_timeout, maximum_retransmission_timeout);
 
-    if (m_last_retransmit_time > now - Time::from_seconds(retransmit_interval))
+    if (m_last_retransmit_time > now - retransmission_timeout)
         return;
 
     dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) handling retransmit", this);
@@ -591,53 +1000,91 @@ void TCPSocket::retransmit_packets()
     m_last_retransmit_time = now;
     ++m_retransmit_attempts;
 
-    if (m_retransmit_attempts > maximum_retransmits) {
+    bool is_connecting = m_state == State::SynSent || m_state == State::SynReceived;
+    if (m_retransmit_attempts > (is_connecting ? maximum_syn_retransmits : maximum_retransmits)) {
         set_state(TCPSocket::State::Closed);
         set_error(TCPSocket::Error::RetransmitTimeout);
         set_setup_state(Socket::SetupState::Completed);
         return;
     }
 
-    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
-    if (routing_decision.is_zero())
-        return;
-
     m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+        // RFC 5681, section 3.1: Start over from a single packet after a timeout.
+        u32 mss = m_peer_mss;
+        m_slow_start_threshold = max<u32>(unacked_packets.in_flight_size() / 2, 2 * mss);
+        m_congestion_window = mss;
+        m_in_fast_recovery = false;
+        m_recovery_point = m_sequence_number;
+        m_duplicate_acks_received = 0;
+
+        // RFC 2018, section 8: The peer is allowed to drop what it has SACKed, so we have to consider everything lost.
         for (auto& packet : unacked_packets.packets) {
-            packet.tx_counter++;
-
-            if constexpr (TCP_SOCKET_DEBUG) {
-                auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
-                dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
-                    local_address(), local_port(),
-                    peer_address(), peer_port(),
-                    (tcp_packet.has_syn() ? "SYN " : ""),
-                    (tcp_packet.has_ack() ? "ACK " : ""),
-                    (tcp_packet.has_fin() ? "FIN " : ""),
-                    (tcp_packet.has_rst() ? "RST " : ""),
-                    tcp_packet.sequence_number(),
-                    tcp_packet.ack_number(),
-                    packet.tx_counter);
-            }
+            packet.is_sacked = false;
+            packet.is_lost = false;
+        }
+        unacked_packets.sacked_size = 0;
+        unacked_packets.lost_size = 0;
+        for (auto& packet : unacked_packets.packets)
+            mark_packet_lost(unacked_packets, packet);
 
-            size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
-            if (ipv4_payload_offset != packet.ipv4_payload_offset) {
-                // FIXME: Add support for this. This can happen if after a route change
-                // we ended up on another adapter which doesn't have the same layer 2 type
-                // like the previous adapter.
-                VERIFY_NOT_REACHED();
-            }
+        // This sends the first one right away, the rest follow as the ACKs come in.
+        retransmit_lost_packets(unacked_packets);
+    });
+}
 
-            auto packet_buffer = packet.buffer->bytes();
+void TCPSocket::retransmit_lost_packets(UnackedPackets& unacked_packets)
+{
+    Optional<RoutingDecision> routing_decision;
+    for (auto& packet : unacked_packets.packets) {
+        if (m_congestion_window > 0 && unacked_packets.in_flight_size() >= m_congestion_window)
+            break;
+        if (!packet.is_lost)
+            continue;
+        if (!routing_decision.has_value())
+            routing_decision = route_to(peer_address(), local_address(), bound_interface());
+        if (routing_decision->is_zero())
+            return;
+        packet.is_lost = false;
+        unacked_packets.lost_size -= packet.payload_size;
+        retransmit_packet(packet, *routing_decision);
+    }
+}
 
-            routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
-                local_address(), routing_decision.next_hop, peer_address(),
-                IPv4Protocol::TCP, packet_buffer.size() - ipv4_payload_offset, type_of_service(), ttl());
-            routing_decision.adapter->send_packet(packet_buffer);
-            m_packets_out++;
-            m_bytes_out += packet_buffer.size();
-        }
-    });
+void TCPSocket::retransmit_packet(OutgoingPacket& packet, RoutingDecision& routing_decision)
+{
+    packet.tx_counter++;
+    packet.last_sent_time = kgettimeofday();
+
+    if constexpr (TCP_SOCKET_DEBUG) {
+        auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
+        dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
+            local_address(), local_port(),
+            peer_address(), peer_port(),
+            (tcp_packet.has_syn() ? "SYN " : ""),
+            (tcp_packet.has_ack() ? "ACK " : ""),
+            (tcp_packet.has_fin() ? "FIN " : ""),
+            (tcp_packet.has_rst() ? "RST " : ""),
+            tcp_packet.sequence_number(),
+            tcp_packet.ack_number(),
+            packet.tx_counter);
+    }
+
+    size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
+    if (ipv4_payload_offset != packet.ipv4_payload_offset) {
+        // FIXME: Add support for this. This can happen if after a route change
+        // we ended up on another adapter which doesn't have the same layer 2 type
+        // like the previous adapter.
+        VERIFY_NOT_REACHED();
+    }
+
+    auto packet_buffer = packet.buffer->bytes();
+
+    routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
+        local_address(), routing_decision.next_hop, peer_address(),
+        IPv4Protocol::TCP, packet_buffer.size() - ipv4_payload_offset, type_of_service(), ttl());
+    routing_decision.adapter->send_packet(packet_buffer);
+    m_packets_out++;
+    m_bytes_out += packet_buffer.size();
 }
 
 bool TCPSocket::can_write(OpenFileDescription const& file_description, u64 size) const
@@ -652,7 +1099,10 @@ bool TCPSocket::can_write(OpenFileDescription const& file_description, u64 size)
         return true;
 
     return m_unacked_packets.with_shared([&](auto& unacked_packets) {
-        return unacked_packets.size + size <= m_send_window_size;
+        // The peer has to buffer everything it hasn't acknowledged, but the network only holds what hasn't been SACKed.
+        if (unacked_packets.size + size >= m_send_window_size)
+            return false;
+        return m_congestion_window == 0 || unacked_packets.outstanding_size() < m_congestion_window;
     });
 }
 }
@@ -10,9 +10,11 @@
 #include <AK/Function.h>
 #include <AK/HashMap.h>
 #include <AK/SinglyLinkedList.h>
+#include <Kernel/KBuffer.h>
 #include <Kernel/Library/LockWeakPtr.h>
 #include <Kernel/Locking/MutexProtected.h>
 #include <Kernel/Net/IPv4Socket.h>
+#include <Kernel/Net/TCP.h>
 
 namespace Kernel {
 
@@ -133,6 +135,11 @@ public:
     u32 bytes_in() const { return m_bytes_in; }
     u32 packets_out() const { return m_packets_out; }
     u32 bytes_out() const { return m_bytes_out; }
+    u32 send_window_size() const { return m_send_window_size; }
+    u32 congestion_window() const { return m_congestion_window; }
+    u32 slow_start_threshold() const { return m_slow_start_threshold; }
+    Time smoothed_round_trip_time() const { return m_smoothed_round_trip_time; }
+    Time retransmission_timeout() const { return m_retransmission_timeout; }
 
     // FIXME: Make this configurable?
     static constexpr u32 maximum_duplicate_acks = 5;
@@ -141,7 +148,14 @@ public:
 
     ErrorOr<void> send_ack(bool allow_duplicate = false);
     ErrorOr<void> send_tcp_packet(u16 flags, UserOrKernelBuffer const* = nullptr, size_t = 0, RoutingDecision* = nullptr);
+    ErrorOr<void> send_tcp_packet(u16 flags, size_t payload_size, RoutingDecision*, Function<ErrorOr<void>(Bytes)> const& write_payload);
     void receive_tcp_packet(TCPPacket const&, u16 size);
+    void receive_syn_options(TCPPacket const&);
+
+    // Out-of-order segments are held on to until the gap in front of them is filled, and reported to the peer with SACK.
+    bool queue_out_of_order_segment(IPv4Packet const&, TCPPacket const&, Time const& packet_timestamp);
+    bool has_out_of_order_segments() const { return !m_out_of_order_segments.is_empty(); }
+    void deliver_out_of_order_segments();
 
     bool should_delay_next_ack() const;
 
@@ -175,6 +189,7 @@ private:
 
     virtual ErrorOr<size_t> protocol_receive(ReadonlyBytes raw_ipv4_packet, UserOrKernelBuffer& buffer, size_t buffer_size, int flags) override;
     virtual ErrorOr<size_t> protocol_send(UserOrKernelBuffer const&, size_t) override;
+    virtual ErrorOr<size_t> protocol_send_file_contents(OpenFileDescription& source, u64 offset, size_t length) override;
     virtual ErrorOr<void> protocol_connect(OpenFileDescription&) override;
     virtual ErrorOr<u16> protocol_allocate_local_port() override;
     virtual ErrorOr<size_t> protocol_size(ReadonlyBytes raw_ipv4_packet) override;
@@ -185,6 +200,18 @@ private:
     void enqueue_for_retransmit();
     void dequeue_for_retransmit();
 
+    struct UnackedPackets;
+    struct OutgoingPacket;
+    void process_sack_blocks(UnackedPackets&, ReadonlyBytes options);
+    void mark_lost_packets(UnackedPackets&);
+    void retransmit_lost_packets(UnackedPackets&);
+    void retransmit_packet(OutgoingPacket&, RoutingDecision&);
+    void update_round_trip_time(Time sample);
+    void update_congestion_window(UnackedPackets&, u32 ack_number, size_t acknowledged_bytes, bool is_duplicate_ack);
+    void mark_packet_lost(UnackedPackets&, OutgoingPacket&);
+    u16 receive_window_size_to_advertise(bool is_syn) const;
+    size_t build_sack_blocks(Span<TCPSACKBlock>) const;
+
     LockWeakPtr<TCPSocket> m_originator;
     HashMap<IPv4SocketTuple, NonnullLockRefPtr<TCPSocket>> m_pending_release_for_accept;
     Direction m_direction { Direction::Unspecified };
@@ -204,11 +231,26 @@ private:
         size_t ipv4_payload_offset;
         LockWeakPtr<NetworkAdapter> adapter;
         int tx_counter { 0 };
+        size_t payload_size { 0 };
+        Time last_sent_time;
+        // The peer has told us it has this one (with SACK), but it hasn't been acknowledged cumulatively yet.
+        bool is_sacked { false };
+        // We think this one was dropped, and it is waiting to be retransmitted.
+        bool is_lost { false };
+
+        u32 sequence_number() const { return ack_number - payload_size; }
     };
 
     struct UnackedPackets {
         SinglyLinkedList<OutgoingPacket> packets;
         size_t size { 0 };
+        size_t sacked_size { 0 };
+        size_t lost_size { 0 };
+
+        // What the peer hasn't got yet, including what's waiting to be retransmitted.
+        size_t outstanding_size() const { return size - sacked_size; }
+        // What we think is still on its way to the peer ("pipe" in RFC 6675).
+        size_t in_flight_size() const { return size - sacked_size - lost_size; }
     };
 
     MutexProtected<UnackedPackets> m_unacked_packets;
@@ -218,14 +260,56 @@ private:
     u32 m_last_ack_number_sent { 0 };
     Time m_last_ack_sent_time;
 
-    // FIXME: Make this configurable (sysctl)
-    static constexpr u32 maximum_retransmits = 5;
+    // FIXME: Make these configurable (sysctl)
+    static constexpr u32 maximum_syn_retransmits = 5;
+    static constexpr u32 maximum_retransmits = 10;
+    // The retransmission timer runs from here, i.e. from the last time we (re)sent something or got a new ACK.
     Time m_last_retransmit_time;
     u32 m_retransmit_attempts { 0 };
 
-    // FIXME: Parse window size TCP option from the peer
+    // RFC 6298. Like Linux, we use a lower minimum RTO than the recommended one second.
+    static constexpr Time minimum_retransmission_timeout = Time::from_milliseconds(200);
+    static constexpr Time maximum_retransmission_timeout = Time::from_seconds(60);
+    bool m_has_round_trip_time_sample { false };
+    Time m_smoothed_round_trip_time;
+    Time m_round_trip_time_variance;
+    Time m_retransmission_timeout { Time::from_seconds(1) };
+
+    // RFC 879 says to assume this if the peer doesn't tell us otherwise.
+    static constexpr u16 default_mss = 536;
+    u16 m_peer_mss { default_mss };
+
+    // RFC 7323. Both sides have to send the option on their SYN for scaling to be used.
+    static constexpr u8 maximum_window_scale = 14;
+    bool m_window_scaling_enabled { false };
+    u8 m_send_window_scale { 0 };
+    u8 m_receive_window_scale { 0 };
     u32 m_send_window_size { 64 * KiB };
 
+    // RFC 2018.
+    bool m_sack_permitted { false };
+
+    // NewReno congestion control (RFC 5681 and RFC 6582), using SACK information to find lost packets when available.
+    static constexpr u32 duplicate_ack_threshold = 3;
+    static constexpr u32 maximum_congestion_window = 16 * MiB;
+    u32 m_congestion_window { 0 };
+    u32 m_slow_start_threshold { NumericLimits<u32>::max() };
+    u32 m_duplicate_acks_received { 0 };
+    bool m_in_fast_recovery { false };
+    u32 m_recovery_point { 0 };
+    u32 m_last_ack_number_received { 0 };
+
+    struct OutOfOrderSegment {
+        u32 sequence_number { 0 };
+        u32 payload_size { 0 };
+        Time timestamp;
+        NonnullOwnPtr<KBuffer> ipv4_packet;
+    };
+    static constexpr size_t maximum_out_of_order_segments = 64;
+    Vector<OutOfOrderSegment> m_out_of_order_segments;
+    size_t m_out_of_order_bytes { 0 };
+    u32 m_last_out_of_order_sequence_number { 0 };
+
     IntrusiveListNode<TCPSocket> m_retransmit_list_node;
 
 public:
@@ -5,6 +5,8 @@
  */
 
 #include <AK/BuiltinWrappers.h>
+#include <AK/NumericLimits.h>
+#include <AK/Optional.h>
 #include <AK/ScopeGuard.h>
 #include <AK/Singleton.h>
 #include <AK/Time.h>
@@ -46,7 +48,16 @@ struct ThreadReadyQueues {
     Array<ThreadReadyQueue, count> queues;
 };
 
-static Singleton<SpinlockProtected<ThreadReadyQueues, LockRank::None>> g_ready_queues;
+struct ProcessorReadyQueues {
+    SpinlockProtected<ThreadReadyQueues, LockRank::None> ready_queues {};
+    // The number of threads queued on this processor. This is kept outside of
+    // the lock so that placement and work stealing decisions can be made
+    // without touching another processor's ready queues.
+    Atomic<u32> thread_count { 0 };
+    Atomic<u64> steal_count { 0 };
+};
+
+static Singleton<Array<ProcessorReadyQueues, MAX_CPU_COUNT>> g_ready_queues;
 
 static SpinlockProtected<TotalTimeScheduled, LockRank::None> g_total_time_scheduled {};
 
@@ -64,11 +75,17 @@ static inline u32 thread_priority_to_priority_index(u32 thread_priority)
     return priority_bucket;
 }
 
-Thread& Scheduler::pull_next_runnable_thread()
+static inline ProcessorReadyQueues& ready_queues_for(u32 cpu)
 {
-    auto affinity_mask = 1u << Processor::current_id();
+    VERIFY(cpu < Processor::count());
+    return (*g_ready_queues)[cpu];
+}
 
-    return g_ready_queues->with([&](auto& ready_queues) -> Thread& {
+// Finds the highest priority thread in the given processor's ready queues that is allowed to run
+// on the processor identified by affinity_mask, and optionally removes it from the queue.
+Thread* Scheduler::find_runnable_thread(ProcessorReadyQueues& processor_queues, u32 affinity_mask, bool remove)
+{
+    return processor_queues.ready_queues.with([&](auto& ready_queues) -> Thread* {
         auto priority_mask = ready_queues.mask;
         while (priority_mask != 0) {
             auto priority = bit_scan_forward(priority_mask);
@@ -80,55 +97,140 @@ Thread& Scheduler::pull_next_runnable_thread()
                     continue;
                 if (!(thread.affinity() & affinity_mask))
                     continue;
+                if (!remove)
+                    return &thread;
                 thread.m_runnable_priority = -1;
                 ready_queue.thread_list.remove(thread);
                 if (ready_queue.thread_list.is_empty())
                     ready_queues.mask &= ~(1u << priority);
-                // Mark it as active because we are using this thread. This is similar
-                // to comparing it with Processor::current_thread, but when there are
-                // multiple processors there's no easy way to check whether the thread
-                // is actually still needed. This prevents accidental finalization when
-                // a thread is no longer in Running state, but running on another core.
-
-                // We need to mark it active here so that this thread won't be
-                // scheduled on another core if it were to be queued before actually
-                // switching to it.
-                // FIXME: Figure out a better way maybe?
-                thread.set_active(true);
-                return thread;
+                processor_queues.thread_count.fetch_sub(1, AK::MemoryOrder::memory_order_relaxed);
+                return &thread;
             }
             priority_mask &= ~(1u << priority);
         }
-        return *Processor::idle_thread();
+        return nullptr;
     });
 }
 
-Thread* Scheduler::peek_next_runnable_thread()
+// Looks for a thread queued on another processor that we are allowed to run, starting with
+// the processor that has the most threads queued up.
+Thread* Scheduler::find_thread_to_steal(u32 current_id, bool remove)
 {
-    auto affinity_mask = 1u << Processor::current_id();
+    auto affinity_mask = 1u << current_id;
+    auto processor_count = Processor::count();
+
+    u32 busiest_id = current_id;
+    u32 busiest_count = 0;
+    for (u32 id = 0; id < processor_count; ++id) {
+        if (id == current_id)
+            continue;
+        auto count = ready_queues_for(id).thread_count.load(AK::MemoryOrder::memory_order_relaxed);
+        if (count > busiest_count) {
+            busiest_id = id;
+            busiest_count = count;
+        }
+    }
+    if (busiest_count == 0)
+        return nullptr;
 
-    return g_ready_queues->with([&](auto& ready_queues) -> Thread* {
-        auto priority_mask = ready_queues.mask;
-        while (priority_mask != 0) {
-            auto priority = bit_scan_forward(priority_mask);
-            VERIFY(priority > 0);
-            auto& ready_queue = ready_queues.queues[--priority];
-            for (auto& thread : ready_queue.thread_list) {
-                VERIFY(thread.m_runnable_priority == (int)priority);
-                if (thread.is_active())
-                    continue;
-                if (!(thread.affinity() & affinity_mask))
-                    continue;
-                return &thread;
-            }
-            priority_mask &= ~(1u << priority);
+    auto try_steal_from = [&](u32 id) -> Thread* {
+        auto* thread = find_runnable_thread(ready_queues_for(id), affinity_mask, remove);
+        if (thread && remove)
+            ready_queues_for(current_id).steal_count.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+        return thread;
+    };
+
+    if (auto* thread = try_steal_from(busiest_id))
+        return thread;
+
+    // The busiest processor had nothing we are allowed to run, so scan the others in order.
+    for (u32 offset = 1; offset < processor_count; ++offset) {
+        auto id = (current_id + offset) % processor_count;
+        if (id == busiest_id || ready_queues_for(id).thread_count.load(AK::MemoryOrder::memory_order_relaxed) == 0)
+            continue;
+        if (auto* thread = try_steal_from(id))
+            return thread;
+    }
+    return nullptr;
+}
+
+// Picks the processor whose ready queues a newly runnable thread should be placed on.
+// We prefer the processor the thread last ran on to keep its caches warm, unless the
+// thread isn't allowed to run there anymore or that processor is noticeably busier
+// than another one it may run on.
+static u32 select_processor_for(Thread const& thread)
+{
+    auto processor_count = Processor::count();
+    auto affinity = thread.affinity();
+
+    auto is_allowed = [&](u32 id) { return id < processor_count && (affinity & (1u << id)); };
+
+    Optional<u32> preferred_id;
+    if (is_allowed(thread.cpu()))
+        preferred_id = thread.cpu();
+    else if (is_allowed(Processor::current_id()))
+        preferred_id = Processor::current_id();
+
+    u32 least_loaded_id = 0;
+    u32 least_loaded_count = NumericLimits<u32>::max();
+    for (u32 id = 0; id < processor_count; ++id) {
+        if (!is_allowed(id))
+            continue;
+        auto count = ready_queues_for(id).thread_count.load(AK::MemoryOrder::memory_order_relaxed);
+        if (count < least_loaded_count) {
+            least_loaded_id = id;
+            least_loaded_count = count;
         }
+    }
+    // A thread must always be allowed to run on at least one processor.
+    VERIFY(least_loaded_count != NumericLimits<u32>::max());
+
+    if (!preferred_id.has_value())
+        return least_loaded_id;
+
+    // Only migrate away from the preferred processor if the imbalance is large enough to
+    // outweigh losing a warm cache.
+    static constexpr u32 migration_threshold = 2;
+    auto preferred_count = ready_queues_for(*preferred_id).thread_count.load(AK::MemoryOrder::memory_order_relaxed);
+    if (preferred_count >= least_loaded_count + migration_threshold)
+        return least_loaded_id;
+    return *preferred_id;
+}
 
-        // Unlike in pull_next_runnable_thread() we don't want to fall back to
-        // the idle thread. We just want to see if we have any other thread ready
-        // to be scheduled.
-        return nullptr;
-    });
+Thread& Scheduler::pull_next_runnable_thread()
+{
+    auto current_id = Processor::current_id();
+
+    auto* thread = find_runnable_thread(ready_queues_for(current_id), 1u << current_id, true);
+    if (!thread)
+        thread = find_thread_to_steal(current_id, true);
+    if (!thread)
+        return *Processor::idle_thread();
+
+    // Mark it as active because we are using this thread. This is similar
+    // to comparing it with Processor::current_thread, but when there are
+    // multiple processors there's no easy way to check whether the thread
+    // is actually still needed. This prevents accidental finalization when
+    // a thread is no longer in Running state, but running on another core.
+
+    // We need to mark it active here so that this thread won't be
+    // scheduled on another core if it were to be queued before actually
+    // switching to it.
+    // FIXME: Figure out a better way maybe?
+    thread->set_active(true);
+    return *thread;
+}
+
+Thread* Scheduler::peek_next_runnable_thread()
+{
+    auto current_id = Processor::current_id();
+
+    // Unlike in pull_next_runnable_thread() we don't want to fall back to
+    // the idle thread. We just want to see if we have any other thread ready
+    // to be scheduled, either on our own queues or one we could steal.
+    if (auto* thread = find_runnable_thread(ready_queues_for(current_id), 1u << current_id, false))
+        return thread;
+    return find_thread_to_steal(current_id, false);
 }
 
 bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
@@ -136,22 +238,27 @@ bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
     if (thread.is_idle_thread())
         return true;
 
-    return g_ready_queues->with([&](auto& ready_queues) {
-        auto priority = thread.m_runnable_priority;
-        if (priority < 0) {
-            VERIFY(!thread.m_ready_queue_node.is_in_list());
-            return false;
-        }
+    auto priority = thread.m_runnable_priority;
+    if (priority < 0) {
+        VERIFY(!thread.m_ready_queue_node.is_in_list());
+        return false;
+    }
 
-        if (check_affinity && !(thread.affinity() & (1 << Processor::current_id())))
-            return false;
+    if (check_affinity && !(thread.affinity() & (1 << Processor::current_id())))
+        return false;
 
+    auto& processor_queues = ready_queues_for(thread.m_runnable_processor);
+    return processor_queues.ready_queues.with([&](auto& ready_queues) {
+        // Threads only move between ready queues while holding g_scheduler_lock, so the
+        // thread can't have been pulled off the queue between the check above and here.
+        VERIFY(thread.m_runnable_priority == priority);
         VERIFY(ready_queues.mask & (1u << priority));
         auto& ready_queue = ready_queues.queues[priority];
         thread.m_runnable_priority = -1;
         ready_queue.thread_list.remove(thread);
         if (ready_queue.thread_list.is_empty())
             ready_queues.mask &= ~(1u << priority);
+        processor_queues.thread_count.fetch_sub(1, AK::MemoryOrder::memory_order_relaxed);
         return true;
     });
 }
@@ -162,16 +269,20 @@ void Scheduler::enqueue_runnable_thread(Thread& thread)
     if (thread.is_idle_thread())
         return;
     auto priority = thread_priority_to_priority_index(thread.priority());
+    auto processor_id = select_processor_for(thread);
 
-    g_ready_queues->with([&](auto& ready_queues) {
+    auto& processor_queues = ready_queues_for(processor_id);
+    processor_queues.ready_queues.with([&](auto& ready_queues) {
         VERIFY(thread.m_runnable_priority < 0);
         thread.m_runnable_priority = (int)priority;
+        thread.m_runnable_processor = processor_id;
         VERIFY(!thread.m_ready_queue_node.is_in_list());
         auto& ready_queue = ready_queues.queues[priority];
         bool was_empty = ready_queue.thread_list.is_empty();
         ready_queue.thread_list.append(thread);
         if (was_empty)
             ready_queues.mask |= (1u << priority);
+        processor_queues.thread_count.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
     });
 }
 
@@ -504,6 +615,14 @@ TotalTimeScheduled Scheduler::get_total_time_scheduled()
 
 void dump_thread_list(bool with_stack_traces)
 {
+    for (u32 id = 0; id < Processor::count(); ++id) {
+        auto& processor_queues = ready_queues_for(id);
+        dbgln("Scheduler ready queues for processor {}: {} queued, {} stolen",
+            id,
+            processor_queues.thread_count.load(AK::MemoryOrder::memory_order_relaxed),
+            processor_queues.steal_count.load(AK::MemoryOrder::memory_order_relaxed));
+    }
+
     dbgln("Scheduler thread list for processor {}:", Processor::current_id());
 
     auto get_eip = [](Thread& thread) -> u32 {
@@ -17,6 +17,7 @@
 
 namespace Kernel {
 
+struct ProcessorReadyQueues;
 struct RegisterState;
 
 extern Thread* g_finalizer;
@@ -55,6 +56,10 @@ public:
     static bool is_initialized();
     static TotalTimeScheduled get_total_time_scheduled();
     static void add_time_scheduled(u64, bool);
+
+private:
+    static Thread* find_runnable_thread(ProcessorReadyQueues&, u32 affinity_mask, bool remove);
+    static Thread* find_thread_to_steal(u32 current_id, bool remove);
 };
 
 }
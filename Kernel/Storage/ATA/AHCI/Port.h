@@ -38,6 +38,10 @@ class AHCIPort
     friend class AHCIController;
 
 public:
+    // Enough for 64 KiB per request, i.e. 128 sectors of 512 bytes, which still fits the u8
+    // block count that access_device() takes.
+    static constexpr size_t dma_buffer_page_count = 16;
+
     static ErrorOr<NonnullLockRefPtr<AHCIPort>> create(AHCIController const&, AHCI::HBADefinedCapabilities, volatile AHCI::PortRegisters&, u32 port_index);
 
     u32 port_index() const { return m_port_index; }
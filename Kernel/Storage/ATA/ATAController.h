@@ -23,6 +23,9 @@ class ATAController
 public:
     virtual void start_request(ATADevice const&, AsyncBlockDeviceRequest&) = 0;
 
+    // The largest transfer a single request to one of our devices can carry.
+    virtual size_t max_transfer_size() const { return PAGE_SIZE; }
+
 protected:
     ATAController();
 };
@@ -33,4 +33,11 @@ void ATADevice::start_request(AsyncBlockDeviceRequest& request)
     controller->start_request(*this, request);
 }
 
+size_t ATADevice::max_request_size() const
+{
+    auto controller = m_controller.strong_ref();
+    VERIFY(controller);
+    return controller->max_transfer_size();
+}
+
 }
@@ -38,6 +38,9 @@ public:
 protected:
     ATADevice(ATAController const&, Address, u16, u16, u64);
 
+    // ^StorageDevice
+    virtual size_t max_request_size() const override;
+
     LockWeakPtr<ATAController> m_controller;
     const Address m_ata_address;
     const u16 m_capabilities;
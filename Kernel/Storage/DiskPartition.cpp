@@ -45,6 +45,18 @@ void DiskPartition::start_request(AsyncBlockDeviceRequest& request)
     request.add_sub_request(sub_request_or_error.release_value());
 }
 
+void DiskPartition::plug_request_queue()
+{
+    if (auto device = m_device.strong_ref())
+        device->plug_request_queue();
+}
+
+void DiskPartition::unplug_request_queue()
+{
+    if (auto device = m_device.strong_ref())
+        device->unplug_request_queue();
+}
+
 ErrorOr<size_t> DiskPartition::read(OpenFileDescription& fd, u64 offset, UserOrKernelBuffer& outbuf, size_t len)
 {
     u64 adjust = m_metadata.start_block() * block_size();
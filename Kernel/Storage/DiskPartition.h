@@ -21,6 +21,8 @@ public:
     virtual ~DiskPartition();
 
     virtual void start_request(AsyncBlockDeviceRequest&) override;
+    virtual void plug_request_queue() override;
+    virtual void unplug_request_queue() override;
 
     // ^BlockDevice
     virtual ErrorOr<size_t> read(OpenFileDescription&, u64, UserOrKernelBuffer&, size_t) override;
@@ -34,6 +36,9 @@ private:
     DiskPartition(BlockDevice&, MinorNumber, Partition::DiskPartitionMetadata);
     virtual StringView class_name() const override;
 
+    // Our requests are passed on to the underlying device, which queues them up.
+    virtual bool starts_requests_immediately() const override { return true; }
+
     LockWeakPtr<BlockDevice> m_device;
     Partition::DiskPartitionMetadata m_metadata;
 };
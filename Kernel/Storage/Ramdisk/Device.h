@@ -32,6 +32,7 @@ private:
 
     // ^StorageDevice
     virtual CommandSet command_set() const override { return CommandSet::PlainMemory; }
+    virtual bool is_rotational() const override { return false; }
 
     Mutex m_lock { "RamdiskDevice"sv };
 
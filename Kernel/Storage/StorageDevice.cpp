@@ -15,6 +15,7 @@
 #include <Kernel/FileSystem/SysFS/Subsystems/Devices/Storage/Directory.h>
 #include <Kernel/Storage/StorageDevice.h>
 #include <Kernel/Storage/StorageManagement.h>
+#include <Kernel/WorkQueue.h>
 
 namespace Kernel {
 
@@ -23,7 +24,6 @@ StorageDevice::StorageDevice(LUNAddress logical_unit_number_address, u32 hardwar
     , m_logical_unit_number_address(logical_unit_number_address)
     , m_hardware_relative_controller_id(hardware_relative_controller_id)
     , m_max_addressable_block(max_addressable_block)
-    , m_blocks_per_page(PAGE_SIZE / block_size())
 {
 }
 
@@ -32,12 +32,12 @@ StorageDevice::StorageDevice(Badge<RamdiskDevice>, LUNAddress logical_unit_numbe
     , m_logical_unit_number_address(logical_unit_number_address)
     , m_hardware_relative_controller_id(hardware_relative_controller_id)
     , m_max_addressable_block(max_addressable_block)
-    , m_blocks_per_page(PAGE_SIZE / block_size())
 {
 }
 
 ErrorOr<void> StorageDevice::after_inserting()
 {
+    m_merge_buffer = TRY(KBuffer::try_create_with_size("StorageDevice: Merge buffer"sv, max_request_size()));
     after_inserting_add_to_device_management();
     auto sysfs_storage_device_directory = StorageDeviceSysFSDirectory::create(SysFSStorageDirectory::the(), *this);
     m_sysfs_device_directory = sysfs_storage_device_directory;
@@ -83,6 +83,234 @@ StringView StorageDevice::command_set_to_string_view() const
     VERIFY_NOT_REACHED();
 }
 
+StorageDevice::RequestQueueStatistics StorageDevice::request_queue_statistics() const
+{
+    SpinlockLocker locker(m_request_queue_lock);
+    return m_request_queue_statistics;
+}
+
+void StorageDevice::submit_request(Badge<AsyncBlockDeviceRequest>, AsyncBlockDeviceRequest& request)
+{
+    // Merged requests are only started once it's their turn.
+    if (!request.m_merged_requests.is_empty()) {
+        start_request(request);
+        return;
+    }
+
+    {
+        SpinlockLocker locker(m_request_queue_lock);
+        m_queued_requests.append(request);
+        ++m_request_queue_statistics.submitted_requests;
+    }
+    dispatch_queued_requests();
+}
+
+void StorageDevice::plug_request_queue()
+{
+    SpinlockLocker locker(m_request_queue_lock);
+    ++m_plug_count;
+}
+
+void StorageDevice::unplug_request_queue()
+{
+    {
+        SpinlockLocker locker(m_request_queue_lock);
+        VERIFY(m_plug_count > 0);
+        if (--m_plug_count > 0)
+            return;
+    }
+    dispatch_queued_requests();
+}
+
+AsyncBlockDeviceRequest& StorageDevice::pick_next_queued_request()
+{
+    VERIFY(m_request_queue_lock.is_locked());
+    VERIFY(!m_queued_requests.is_empty());
+
+    if (!is_rotational())
+        return *m_queued_requests.first();
+
+    // Sweep across the disk in one direction, and start over at the lowest block index once
+    // there's nothing left ahead of us.
+    AsyncBlockDeviceRequest* next_request_ahead = nullptr;
+    AsyncBlockDeviceRequest* lowest_request = nullptr;
+    for (auto& request : m_queued_requests) {
+        if (!lowest_request || request.block_index() < lowest_request->block_index())
+            lowest_request = &request;
+        if (request.block_index() >= m_next_block_index && (!next_request_ahead || request.block_index() < next_request_ahead->block_index()))
+            next_request_ahead = &request;
+    }
+    return next_request_ahead ? *next_request_ahead : *lowest_request;
+}
+
+void StorageDevice::take_mergeable_queued_requests(AsyncBlockDeviceRequest::QueueList& requests)
+{
+    VERIFY(m_request_queue_lock.is_locked());
+
+    auto request_type = requests.first()->request_type();
+    u64 first_block_index = requests.first()->block_index();
+    u64 end_block_index = first_block_index + requests.first()->block_count();
+    auto can_merge = [&](AsyncBlockDeviceRequest const& request) {
+        return request.request_type() == request_type && (end_block_index - first_block_index) + request.block_count() <= max_blocks_per_request();
+    };
+
+    // A single pass in each direction is enough to catch requests that were submitted in order,
+    // which is how batches of them usually come in.
+    for (auto it = m_queued_requests.begin(); it != m_queued_requests.end();) {
+        auto& request = *it;
+        ++it;
+        if (request.block_index() == end_block_index && can_merge(request)) {
+            end_block_index += request.block_count();
+            requests.append(request);
+        }
+    }
+    for (auto it = m_queued_requests.begin(); it != m_queued_requests.end();) {
+        auto& request = *it;
+        ++it;
+        if (request.block_index() + request.block_count() == first_block_index && can_merge(request)) {
+            first_block_index = request.block_index();
+            requests.prepend(request);
+        }
+    }
+}
+
+void StorageDevice::dispatch_queued_requests()
+{
+    SpinlockLocker locker(m_request_queue_lock);
+
+    // Requests that complete right away call back into here, so we keep going in a loop instead.
+    if (m_is_dispatching)
+        return;
+    m_is_dispatching = true;
+
+    while (!m_request_in_flight && m_plug_count == 0 && !m_queued_requests.is_empty()) {
+        AsyncBlockDeviceRequest::QueueList requests;
+        requests.append(pick_next_queued_request());
+        take_mergeable_queued_requests(requests);
+
+        // This keeps everyone else away from the driver (and the merge buffer) until we're done here.
+        m_request_in_flight = requests.first();
+        auto& last_request = *requests.last();
+        m_next_block_index = last_request.block_index() + last_request.block_count();
+
+        if (requests.first().ptr() == requests.last().ptr()) {
+            NonnullLockRefPtr<AsyncBlockDeviceRequest> request = *requests.take_first();
+            ++m_request_queue_statistics.dispatched_requests;
+            locker.unlock();
+            start_request(*request);
+        } else {
+            locker.unlock();
+            dispatch_merged_requests(requests);
+        }
+
+        locker.lock();
+    }
+
+    m_is_dispatching = false;
+}
+
+void StorageDevice::dispatch_merged_requests(AsyncBlockDeviceRequest::QueueList& requests)
+{
+    auto request_type = requests.first()->request_type();
+    u64 block_index = requests.first()->block_index();
+    u64 block_count = requests.last()->block_index() + requests.last()->block_count() - block_index;
+
+    auto requeue_requests = [&] {
+        SpinlockLocker locker(m_request_queue_lock);
+        while (auto request = requests.take_first())
+            m_queued_requests.append(*request);
+        m_request_in_flight = nullptr;
+    };
+
+    if (request_type == AsyncBlockDeviceRequest::Write) {
+        for (auto& request : requests) {
+            auto offset = (request.block_index() - block_index) * block_size();
+            if (!request.read_from_buffer(request.buffer(), m_merge_buffer->data() + offset, request.block_count() * block_size()).is_error())
+                continue;
+
+            // This one is not going anywhere, but the others may still be merged without it.
+            NonnullLockRefPtr<AsyncBlockDeviceRequest> faulted_request = request;
+            requests.remove(request);
+            requeue_requests();
+            faulted_request->complete(AsyncDeviceRequest::MemoryFault);
+            return;
+        }
+    }
+
+    auto merged_request_or_error = adopt_nonnull_lock_ref_or_enomem(new (nothrow) AsyncBlockDeviceRequest(*this, request_type, block_index, block_count, UserOrKernelBuffer::for_kernel_buffer(m_merge_buffer->data()), block_count * block_size()));
+    if (merged_request_or_error.is_error()) {
+        // Just send off the first request on its own.
+        NonnullLockRefPtr<AsyncBlockDeviceRequest> request = *requests.take_first();
+        requeue_requests();
+        {
+            SpinlockLocker locker(m_request_queue_lock);
+            m_request_in_flight = request;
+            ++m_request_queue_statistics.dispatched_requests;
+        }
+        start_request(*request);
+        return;
+    }
+
+    auto merged_request = merged_request_or_error.release_value();
+    SpinlockLocker locker(m_request_queue_lock);
+    size_t request_count = 0;
+    while (auto request = requests.take_first()) {
+        merged_request->m_merged_requests.append(*request);
+        ++request_count;
+    }
+    m_request_queue_statistics.merged_requests += request_count - 1;
+    ++m_request_queue_statistics.dispatched_requests;
+    m_request_in_flight = merged_request;
+    merged_request->do_start(move(locker));
+}
+
+void StorageDevice::request_did_complete(AsyncDeviceRequest const& completed_request)
+{
+    LockRefPtr<AsyncBlockDeviceRequest> merged_request;
+    {
+        SpinlockLocker locker(m_request_queue_lock);
+        // The requests that a merged request stands for complete through here as well.
+        if (m_request_in_flight.ptr() != &completed_request)
+            return;
+        if (m_request_in_flight->m_merged_requests.is_empty())
+            m_request_in_flight = nullptr;
+        else
+            merged_request = m_request_in_flight;
+    }
+
+    if (!merged_request) {
+        dispatch_queued_requests();
+        return;
+    }
+
+    // Copying the data out to the original buffers may have to page them in, which we can't do here.
+    auto result = g_io_work->try_queue([this, merged_request]() mutable {
+        finish_merged_request(*merged_request);
+    });
+    if (result.is_error())
+        finish_merged_request(*merged_request);
+}
+
+void StorageDevice::finish_merged_request(AsyncBlockDeviceRequest& merged_request)
+{
+    auto merged_result = merged_request.get_request_result();
+    while (auto request = merged_request.m_merged_requests.take_first()) {
+        auto result = merged_result == AsyncDeviceRequest::Success ? AsyncDeviceRequest::Success : AsyncDeviceRequest::Failure;
+        if (result == AsyncDeviceRequest::Success && request->request_type() == AsyncBlockDeviceRequest::Read) {
+            auto offset = (request->block_index() - merged_request.block_index()) * block_size();
+            if (request->write_to_buffer(request->buffer(), m_merge_buffer->data() + offset, request->block_count() * block_size()).is_error())
+                result = AsyncDeviceRequest::MemoryFault;
+        }
+        request->complete(result);
+    }
+
+    {
+        SpinlockLocker locker(m_request_queue_lock);
+        m_request_in_flight = nullptr;
+    }
+    dispatch_queued_requests();
+}
+
 ErrorOr<size_t> StorageDevice::read(OpenFileDescription&, u64 offset, UserOrKernelBuffer& outbuf, size_t len)
 {
     u64 index = offset >> block_size_log();
@@ -90,10 +318,10 @@ ErrorOr<size_t> StorageDevice::read(OpenFileDescription&, u64 offset, UserOrKern
     size_t whole_blocks = len >> block_size_log();
     size_t remaining = len - (whole_blocks << block_size_log());
 
-    // PATAChannel will chuck a wobbly if we try to read more than PAGE_SIZE
-    // at a time, because it uses a single page for its DMA buffer.
-    if (whole_blocks >= m_blocks_per_page) {
-        whole_blocks = m_blocks_per_page;
+    // The driver can only read max_request_size() bytes at a time, because that's
+    // as much as its DMA buffers hold.
+    if (whole_blocks >= max_blocks_per_request()) {
+        whole_blocks = max_blocks_per_request();
         remaining = 0;
     }
 
@@ -156,10 +384,10 @@ ErrorOr<size_t> StorageDevice::write(OpenFileDescription&, u64 offset, UserOrKer
     size_t whole_blocks = len >> block_size_log();
     size_t remaining = len - (whole_blocks << block_size_log());
 
-    // PATAChannel will chuck a wobbly if we try to write more than PAGE_SIZE
-    // at a time, because it uses a single page for its DMA buffer.
-    if (whole_blocks >= m_blocks_per_page) {
-        whole_blocks = m_blocks_per_page;
+    // The driver can only write max_request_size() bytes at a time, because that's
+    // as much as its DMA buffers hold.
+    if (whole_blocks >= max_blocks_per_request()) {
+        whole_blocks = max_blocks_per_request();
         remaining = 0;
     }
 
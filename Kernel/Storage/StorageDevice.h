@@ -9,6 +9,7 @@
 #include <AK/IntrusiveList.h>
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/Interrupts/IRQHandler.h>
+#include <Kernel/KBuffer.h>
 #include <Kernel/Locking/Mutex.h>
 #include <Kernel/Storage/DiskPartition.h>
 #include <Kernel/Storage/StorageController.h>
@@ -75,6 +76,22 @@ public:
 
     StringView command_set_to_string_view() const;
 
+    struct RequestQueueStatistics {
+        u64 submitted_requests { 0 };
+        u64 merged_requests { 0 };
+        u64 dispatched_requests { 0 };
+    };
+    RequestQueueStatistics request_queue_statistics() const;
+
+    // Seeking costs a lot of time on spinning disks (and on most emulated ones), so their
+    // queued requests are sent off in the order of their block index, not in the order they came in.
+    virtual bool is_rotational() const { return true; }
+
+    // ^BlockDevice
+    virtual void submit_request(Badge<AsyncBlockDeviceRequest>, AsyncBlockDeviceRequest&) override;
+    virtual void plug_request_queue() override;
+    virtual void unplug_request_queue() override;
+
     // ^File
     virtual ErrorOr<void> ioctl(OpenFileDescription&, unsigned request, Userspace<void*> arg) final;
 
@@ -88,10 +105,25 @@ protected:
     // ^DiskDevice
     virtual StringView class_name() const override;
 
+    // The largest transfer the driver can handle in a single request.
+    virtual size_t max_request_size() const { return PAGE_SIZE; }
+
 private:
     virtual ErrorOr<void> after_inserting() override;
     virtual void will_be_destroyed() override;
 
+    // ^Device
+    virtual bool starts_requests_immediately() const override { return true; }
+    virtual void request_did_complete(AsyncDeviceRequest const&) override;
+
+    size_t max_blocks_per_request() const { return max_request_size() >> block_size_log(); }
+
+    void dispatch_queued_requests();
+    AsyncBlockDeviceRequest& pick_next_queued_request();
+    void take_mergeable_queued_requests(AsyncBlockDeviceRequest::QueueList&);
+    void dispatch_merged_requests(AsyncBlockDeviceRequest::QueueList&);
+    void finish_merged_request(AsyncBlockDeviceRequest&);
+
     mutable IntrusiveListNode<StorageDevice, LockRefPtr<StorageDevice>> m_list_node;
     NonnullLockRefPtrVector<DiskPartition> m_partitions;
 
@@ -105,7 +137,19 @@ private:
     u32 const m_hardware_relative_controller_id { 0 };
 
     u64 m_max_addressable_block { 0 };
-    size_t m_blocks_per_page { 0 };
+
+    // Requests are held in m_queued_requests until the driver is done with the one before them.
+    // Neighbouring requests of the same type are merged on the way out: the merged request
+    // transfers its data through m_merge_buffer, and completes the requests it stands for once
+    // it is done.
+    mutable Spinlock<LockRank::None> m_request_queue_lock {};
+    AsyncBlockDeviceRequest::QueueList m_queued_requests;
+    LockRefPtr<AsyncBlockDeviceRequest> m_request_in_flight;
+    OwnPtr<KBuffer> m_merge_buffer;
+    u64 m_next_block_index { 0 };
+    size_t m_plug_count { 0 };
+    bool m_is_dispatching { false };
+    RequestQueueStatistics m_request_queue_statistics;
 };
 
 }
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ScopeGuard.h>
+#include <Kernel/FileSystem/EventQueue.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+// Arbitrary cap on how many events we hand out per call, so that the kernel-side buffer stays small.
+static constexpr size_t max_events_per_wait = 256;
+
+ErrorOr<FlatPtr> Process::sys$epoll_create1(int flags)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+
+    if (flags & ~EPOLL_CLOEXEC)
+        return EINVAL;
+
+    auto event_queue = TRY(EventQueue::try_create());
+    auto description = TRY(OpenFileDescription::try_create(move(event_queue)));
+    description->set_readable(true);
+
+    return m_fds.with_exclusive([&](auto& fds) -> ErrorOr<FlatPtr> {
+        auto fd_allocation = TRY(fds.allocate());
+        fds[fd_allocation.fd].set(move(description));
+
+        if (flags & EPOLL_CLOEXEC)
+            fds[fd_allocation.fd].set_flags(fds[fd_allocation.fd].flags() | FD_CLOEXEC);
+
+        return fd_allocation.fd;
+    });
+}
+
+ErrorOr<FlatPtr> Process::sys$epoll_ctl(int epfd, int op, int fd, Userspace<epoll_event const*> user_event)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+
+    if (epfd == fd)
+        return EINVAL;
+
+    auto queue_description = TRY(open_file_description(epfd));
+    auto* event_queue = queue_description->event_queue();
+    if (!event_queue)
+        return EINVAL;
+    auto description = TRY(open_file_description(fd));
+
+    switch (op) {
+    case EPOLL_CTL_ADD: {
+        auto event = TRY(copy_typed_from_user(user_event));
+        TRY(event_queue->add_watch(fd, *description, event));
+        return 0;
+    }
+    case EPOLL_CTL_MOD: {
+        auto event = TRY(copy_typed_from_user(user_event));
+        TRY(event_queue->modify_watch(fd, event));
+        return 0;
+    }
+    case EPOLL_CTL_DEL:
+        TRY(event_queue->remove_watch(fd));
+        return 0;
+    default:
+        return EINVAL;
+    }
+}
+
+ErrorOr<FlatPtr> Process::sys$epoll_pwait(Userspace<Syscall::SC_epoll_pwait_params const*> user_params)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+
+    auto params = TRY(copy_typed_from_user(user_params));
+    if (params.max_events <= 0)
+        return EINVAL;
+
+    auto queue_description = TRY(open_file_description(params.epfd));
+    auto* event_queue = queue_description->event_queue();
+    if (!event_queue)
+        return EINVAL;
+
+    Thread::BlockTimeout timeout;
+    bool is_polling = false;
+    if (params.timeout) {
+        auto timeout_time = TRY(copy_time_from_user(params.timeout));
+        is_polling = timeout_time == Time::zero();
+        timeout = Thread::BlockTimeout(false, &timeout_time);
+    }
+
+    sigset_t sigmask = {};
+    if (params.sigmask)
+        TRY(copy_from_user(&sigmask, params.sigmask));
+
+    Vector<epoll_event> events;
+    TRY(events.try_resize(min(static_cast<size_t>(params.max_events), max_events_per_wait)));
+
+    auto* current_thread = Thread::current();
+
+    u32 previous_signal_mask = 0;
+    if (params.sigmask)
+        previous_signal_mask = current_thread->update_signal_mask(sigmask);
+    ScopeGuard rollback_signal_mask([&]() {
+        if (params.sigmask)
+            current_thread->update_signal_mask(previous_signal_mask);
+    });
+
+    // NOTE: The timeout is absolute once constructed, so spurious wakeups don't extend it.
+    size_t count = 0;
+    for (;;) {
+        count = TRY(event_queue->collect_events(events.span()));
+        if (count > 0 || is_polling)
+            break;
+        auto result = event_queue->wait_for_events(timeout);
+        if (result.was_interrupted())
+            return EINTR;
+        if (result == Thread::BlockResult::InterruptedByTimeout) {
+            count = TRY(event_queue->collect_events(events.span()));
+            break;
+        }
+    }
+
+    if (count > 0)
+        TRY(copy_n_to_user(params.events, events.data(), count));
+    return count;
+}
+
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/NumericLimits.h>
+#include <Kernel/FileSystem/IORing.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+ErrorOr<FlatPtr> Process::sys$io_ring_create(u32 entry_count, int options)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+
+    if (options & ~O_CLOEXEC)
+        return EINVAL;
+
+    auto ring = TRY(IORing::try_create(entry_count));
+    auto description = TRY(OpenFileDescription::try_create(move(ring)));
+    // The process maps the ring shared and writable, which mmap() only allows for writable descriptions.
+    description->set_readable(true);
+    description->set_writable(true);
+
+    return m_fds.with_exclusive([&](auto& fds) -> ErrorOr<FlatPtr> {
+        auto fd_allocation = TRY(fds.allocate());
+        fds[fd_allocation.fd].set(move(description));
+
+        if (options & O_CLOEXEC)
+            fds[fd_allocation.fd].set_flags(fds[fd_allocation.fd].flags() | FD_CLOEXEC);
+
+        return fd_allocation.fd;
+    });
+}
+
+ErrorOr<FlatPtr> Process::sys$io_ring_enter(int fd, u32 to_submit)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    TRY(require_promise(Pledge::stdio));
+
+    auto ring_description = TRY(open_file_description(fd));
+    auto* ring = ring_description->io_ring();
+    if (!ring)
+        return EINVAL;
+
+    auto execute = [this](IORingSubmission const& submission) -> ErrorOr<size_t> {
+        if (submission.opcode == IORingOpcode::Nop)
+            return 0;
+
+        auto description = TRY(open_file_description(submission.fd));
+        // Reading from a ring waits for completions, which we can't post while we're busy with this one.
+        // Rings don't take writes either, so there's no point in targeting one at all.
+        if (description->is_io_ring())
+            return EINVAL;
+        if (submission.opcode == IORingOpcode::Fsync) {
+            TRY(description->sync());
+            return 0;
+        }
+
+        if (submission.length > NumericLimits<ssize_t>::max())
+            return EINVAL;
+        if (submission.length == 0)
+            return 0;
+        Optional<off_t> offset;
+        if (submission.offset >= 0) {
+            if (!description->file().is_seekable())
+                return ESPIPE;
+            offset = submission.offset;
+        }
+        auto buffer = TRY(UserOrKernelBuffer::for_user_buffer(reinterpret_cast<u8*>(static_cast<FlatPtr>(submission.buffer)), submission.length));
+
+        switch (submission.opcode) {
+        case IORingOpcode::Read:
+            if (!description->is_readable())
+                return EBADF;
+            if (description->is_directory())
+                return EISDIR;
+            if (!offset.has_value() && description->is_blocking() && !description->can_read()) {
+                auto unblock_flags = Thread::FileBlocker::BlockFlags::None;
+                if (Thread::current()->block<Thread::ReadBlocker>({}, *description, unblock_flags).was_interrupted())
+                    return EINTR;
+            }
+            if (offset.has_value())
+                return description->read(buffer, offset.value(), submission.length);
+            return description->read(buffer, submission.length);
+        case IORingOpcode::Write:
+            if (!description->is_writable())
+                return EBADF;
+            return TRY(do_write(*description, buffer, submission.length, offset));
+        default:
+            return EINVAL;
+        }
+    };
+
+    // NOTE: Submissions are carried out in order, right here. Those on blocking descriptions can hold up the ones
+    //       queued behind them, so sockets and pipes should be made non-blocking; they then complete with -EAGAIN.
+    return TRY(ring->process_submissions(to_submit, [&](IORingSubmission const& submission) -> i64 {
+        auto result = execute(submission);
+        if (result.is_error())
+            return -static_cast<i64>(result.error().code());
+        return static_cast<i64>(result.value());
+    }));
+}
+
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/NumericLimits.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Net/Socket.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+static constexpr size_t sendfile_bounce_buffer_size = 64 * KiB;
+
+// Hands the file contents straight to the socket, which can read them into its outgoing packets.
+// Returns ENOTSUP if the socket doesn't support this, before anything has been sent.
+static ErrorOr<size_t> send_file_to_socket(OpenFileDescription& out, OpenFileDescription& in, u64 offset, size_t count)
+{
+    auto& socket = *out.socket();
+    auto file_size = static_cast<u64>(in.metadata().size);
+    if (offset >= file_size)
+        return 0;
+    count = min<u64>(count, file_size - offset);
+
+    size_t total_nsent = 0;
+    while (total_nsent < count) {
+        while (!out.can_write()) {
+            if (!out.is_blocking()) {
+                if (total_nsent > 0)
+                    return total_nsent;
+                return EAGAIN;
+            }
+            auto unblock_flags = Thread::FileBlocker::BlockFlags::None;
+            if (Thread::current()->block<Thread::WriteBlocker>({}, out, unblock_flags).was_interrupted()) {
+                if (total_nsent == 0)
+                    return EINTR;
+                return total_nsent;
+            }
+        }
+        auto nsent_or_error = socket.send_file_contents(out, in, offset + total_nsent, count - total_nsent);
+        if (nsent_or_error.is_error()) {
+            if (total_nsent > 0)
+                return total_nsent;
+            if (nsent_or_error.error().code() == EPIPE)
+                Thread::current()->send_signal(SIGPIPE, &Process::current());
+            return nsent_or_error.release_error();
+        }
+        VERIFY(nsent_or_error.value() > 0);
+        total_nsent += nsent_or_error.value();
+        if (Thread::current()->has_unmasked_pending_signals())
+            break;
+    }
+    return total_nsent;
+}
+
+ErrorOr<FlatPtr> Process::sys$sendfile(int out_fd, int in_fd, Userspace<off_t*> userspace_offset, size_t count)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    TRY(require_promise(Pledge::stdio));
+    if (count > NumericLimits<ssize_t>::max())
+        return EINVAL;
+
+    auto out = TRY(open_file_description(out_fd));
+    if (!out->is_writable())
+        return EBADF;
+    auto in = TRY(open_file_description(in_fd));
+    if (!in->is_readable())
+        return EBADF;
+    if (in->is_directory())
+        return EISDIR;
+
+    // NOTE: If an offset is given, we read from there and leave the file offset of in_fd alone.
+    Optional<off_t> offset;
+    if (userspace_offset) {
+        offset = TRY(copy_typed_from_user(userspace_offset));
+        if (offset.value() < 0)
+            return EINVAL;
+        if (!in->file().is_seekable())
+            return ESPIPE;
+    }
+    if (count == 0)
+        return 0;
+
+    bool in_is_seekable = in->file().is_seekable();
+    u64 position = offset.value_or(in_is_seekable ? in->offset() : 0);
+
+    auto update_offset = [&](size_t nsent) -> ErrorOr<void> {
+        if (offset.has_value()) {
+            off_t new_offset = offset.value() + nsent;
+            return copy_to_user(userspace_offset, &new_offset);
+        }
+        if (in_is_seekable)
+            TRY(in->seek(position + nsent, SEEK_SET));
+        return {};
+    };
+
+    if (out->is_socket() && in->metadata().is_regular_file()) {
+        auto nsent_or_error = send_file_to_socket(*out, *in, position, count);
+        if (nsent_or_error.is_error() && nsent_or_error.error().code() != ENOTSUP)
+            return nsent_or_error.release_error();
+        if (!nsent_or_error.is_error()) {
+            TRY(update_offset(nsent_or_error.value()));
+            return nsent_or_error.value();
+        }
+    }
+
+    // Anything else (pipes, or sockets that can't send from a file) goes through a kernel bounce buffer,
+    // which still saves the round trip through userspace.
+    auto bounce_buffer = TRY(KBuffer::try_create_with_size("sendfile: Bounce buffer"sv, min(count, sendfile_bounce_buffer_size)));
+    size_t total_nsent = 0;
+    while (total_nsent < count) {
+        if (!in_is_seekable && in->is_blocking() && !in->can_read()) {
+            // Don't hold on to what we've already sent while waiting for more to arrive.
+            if (total_nsent > 0)
+                break;
+            auto unblock_flags = Thread::FileBlocker::BlockFlags::None;
+            if (Thread::current()->block<Thread::ReadBlocker>({}, *in, unblock_flags).was_interrupted())
+                return EINTR;
+        }
+        auto buffer = UserOrKernelBuffer::for_kernel_buffer(bounce_buffer->data());
+        auto chunk_size = min(count - total_nsent, bounce_buffer->size());
+        auto nread_or_error = in_is_seekable
+            ? in->read(buffer, position + total_nsent, chunk_size)
+            : in->read(buffer, chunk_size);
+        if (nread_or_error.is_error()) {
+            if (total_nsent > 0)
+                break;
+            return nread_or_error.release_error();
+        }
+        auto nread = nread_or_error.value();
+        if (nread == 0)
+            break;
+
+        auto nwritten_or_error = do_write(*out, buffer, nread);
+        if (nwritten_or_error.is_error()) {
+            if (total_nsent > 0)
+                break;
+            return nwritten_or_error.release_error();
+        }
+        total_nsent += nwritten_or_error.value();
+        // NOTE: A short write only happens on non-blocking or interrupted outputs. Like with read()+write(),
+        //       the unwritten bytes can't be pushed back into a non-seekable input.
+        if (nwritten_or_error.value() < nread)
+            break;
+        if (Thread::current()->has_unmasked_pending_signals())
+            break;
+    }
+
+    TRY(update_offset(total_nsent));
+    return total_nsent;
+}
+
+}
@@ -78,6 +78,8 @@ set(HIGHLIGHT_FOCUSED_FRAME_DEBUG ON)
 set(HPET_COMPARATOR_DEBUG ON)
 set(HPET_DEBUG ON)
 set(HTML_SCRIPT_DEBUG ON)
+set(HTTP2_DEBUG ON)
+set(HTTP_CACHE_DEBUG ON)
 set(HTTPJOB_DEBUG ON)
 set(HTTPSJOB_DEBUG ON)
 set(HUNKS_DEBUG ON)
@@ -85,6 +87,7 @@ set(ICMP_DEBUG ON)
 set(ICO_DEBUG ON)
 set(IMAGE_DECODER_DEBUG ON)
 set(IMAGE_LOADER_DEBUG ON)
+set(INCREMENTAL_MARKING_DEBUG ON)
 set(INTEL_GRAPHICS_DEBUG ON)
 set(INTERRUPT_DEBUG ON)
 set(IOAPIC_DEBUG ON)
@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/System.h>
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+struct Pipe {
+    int read_fd { -1 };
+    int write_fd { -1 };
+};
+
+static Pipe make_pipe()
+{
+    auto fds = MUST(Core::System::pipe2(0));
+    return { fds[0], fds[1] };
+}
+
+static int add(int epoll_fd, int fd, u32 events, u64 data)
+{
+    epoll_event event {};
+    event.events = events;
+    event.data.u64 = data;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+}
+
+static int modify(int epoll_fd, int fd, u32 events, u64 data)
+{
+    epoll_event event {};
+    event.events = events;
+    event.data.u64 = data;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event);
+}
+
+static void write_byte(int fd)
+{
+    EXPECT_EQ(write(fd, "x", 1), 1);
+}
+
+static void read_byte(int fd)
+{
+    char byte;
+    EXPECT_EQ(read(fd, &byte, 1), 1);
+}
+
+static i64 milliseconds_since(timespec const& start)
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1'000'000;
+}
+
+TEST_CASE(create)
+{
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    EXPECT(epoll_fd >= 0);
+    EXPECT(fcntl(epoll_fd, F_GETFD) & FD_CLOEXEC);
+    close(epoll_fd);
+
+    EXPECT_EQ(epoll_create1(0x1234), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    // Linux requires a positive size, which is otherwise ignored.
+    epoll_fd = epoll_create(1);
+    EXPECT(epoll_fd >= 0);
+    close(epoll_fd);
+}
+
+TEST_CASE(add_and_wait)
+{
+    int epoll_fd = epoll_create1(0);
+    auto pipe = make_pipe();
+    EXPECT_EQ(add(epoll_fd, pipe.read_fd, EPOLLIN, 0x1122334455667788), 0);
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 0);
+
+    write_byte(pipe.write_fd);
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 1);
+    EXPECT_EQ(events[0].events, static_cast<u32>(EPOLLIN));
+    EXPECT_EQ(events[0].data.u64, 0x1122334455667788u);
+
+    // Watches are level-triggered, so it stays ready until it's been drained.
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 1);
+    read_byte(pipe.read_fd);
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 0);
+
+    close(pipe.read_fd);
+    close(pipe.write_fd);
+    close(epoll_fd);
+}
+
+TEST_CASE(multiple_watches)
+{
+    int epoll_fd = epoll_create1(0);
+    auto first = make_pipe();
+    auto second = make_pipe();
+    EXPECT_EQ(add(epoll_fd, first.read_fd, EPOLLIN, 1), 0);
+    EXPECT_EQ(add(epoll_fd, second.read_fd, EPOLLIN, 2), 0);
+    EXPECT_EQ(add(epoll_fd, second.write_fd, EPOLLOUT, 3), 0);
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 1);
+    EXPECT_EQ(events[0].data.u64, 3u);
+
+    write_byte(first.write_fd);
+    write_byte(second.write_fd);
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 3);
+    u64 seen = 0;
+    for (size_t i = 0; i < 3; ++i)
+        seen |= 1 << events[i].data.u64;
+    EXPECT_EQ(seen, 0b1110u);
+
+    // Only as many as were asked for are reported, the rest are left for the next call.
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 1, 0), 1);
+
+    close(first.read_fd);
+    close(first.write_fd);
+    close(second.read_fd);
+    close(second.write_fd);
+    close(epoll_fd);
+}
+
+TEST_CASE(modify)
+{
+    int epoll_fd = epoll_create1(0);
+    auto pipe = make_pipe();
+    EXPECT_EQ(add(epoll_fd, pipe.write_fd, EPOLLIN, 1), 0);
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 0);
+
+    EXPECT_EQ(modify(epoll_fd, pipe.write_fd, EPOLLOUT, 2), 0);
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 1);
+    EXPECT_EQ(events[0].events, static_cast<u32>(EPOLLOUT));
+    EXPECT_EQ(events[0].data.u64, 2u);
+
+    EXPECT_EQ(modify(epoll_fd, pipe.write_fd, EPOLLIN, 3), 0);
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 0);
+
+    // Only fds that are being watched can be modified.
+    EXPECT_EQ(modify(epoll_fd, pipe.read_fd, EPOLLIN, 4), -1);
+    EXPECT_EQ(errno, ENOENT);
+
+    close(pipe.read_fd);
+    close(pipe.write_fd);
+    close(epoll_fd);
+}
+
+TEST_CASE(delete_)
+{
+    int epoll_fd = epoll_create1(0);
+    auto pipe = make_pipe();
+    EXPECT_EQ(add(epoll_fd, pipe.read_fd, EPOLLIN, 1), 0);
+    write_byte(pipe.write_fd);
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 1);
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_DEL, pipe.read_fd, nullptr), 0);
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 0);
+
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_DEL, pipe.read_fd, nullptr), -1);
+    EXPECT_EQ(errno, ENOENT);
+
+    // It can be added again afterwards.
+    EXPECT_EQ(add(epoll_fd, pipe.read_fd, EPOLLIN, 2), 0);
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 1);
+    EXPECT_EQ(events[0].data.u64, 2u);
+
+    close(pipe.read_fd);
+    close(pipe.write_fd);
+    close(epoll_fd);
+}
+
+TEST_CASE(closing_a_watched_fd)
+{
+    int epoll_fd = epoll_create1(0);
+    auto pipe = make_pipe();
+    EXPECT_EQ(add(epoll_fd, pipe.read_fd, EPOLLIN, 1), 0);
+    write_byte(pipe.write_fd);
+
+    // Closing the only reference to the description removes the watch.
+    close(pipe.read_fd);
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 0);
+
+    close(pipe.write_fd);
+    close(epoll_fd);
+}
+
+TEST_CASE(edge_triggered)
+{
+    int epoll_fd = epoll_create1(0);
+    auto pipe = make_pipe();
+    EXPECT_EQ(add(epoll_fd, pipe.read_fd, EPOLLIN | EPOLLET, 1), 0);
+
+    epoll_event events[4];
+    write_byte(pipe.write_fd);
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 1);
+    EXPECT_EQ(events[0].events, static_cast<u32>(EPOLLIN));
+    // Still readable, but nothing changed since we were told.
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 0);
+
+    write_byte(pipe.write_fd);
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 1);
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 0);
+
+    close(pipe.read_fd);
+    close(pipe.write_fd);
+    close(epoll_fd);
+}
+
+TEST_CASE(oneshot)
+{
+    int epoll_fd = epoll_create1(0);
+    auto pipe = make_pipe();
+    EXPECT_EQ(add(epoll_fd, pipe.read_fd, EPOLLIN | EPOLLONESHOT, 1), 0);
+
+    epoll_event events[4];
+    write_byte(pipe.write_fd);
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 1);
+    write_byte(pipe.write_fd);
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 0);
+
+    // The watch stays disabled until it's modified again.
+    EXPECT_EQ(modify(epoll_fd, pipe.read_fd, EPOLLIN | EPOLLONESHOT, 2), 0);
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 1);
+    EXPECT_EQ(events[0].data.u64, 2u);
+
+    close(pipe.read_fd);
+    close(pipe.write_fd);
+    close(epoll_fd);
+}
+
+TEST_CASE(wait_timeout)
+{
+    int epoll_fd = epoll_create1(0);
+    auto pipe = make_pipe();
+    EXPECT_EQ(add(epoll_fd, pipe.read_fd, EPOLLIN, 1), 0);
+
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 50), 0);
+    EXPECT(milliseconds_since(start) >= 50);
+
+    close(pipe.read_fd);
+    close(pipe.write_fd);
+    close(epoll_fd);
+}
+
+TEST_CASE(wait_is_woken_up)
+{
+    int epoll_fd = epoll_create1(0);
+    auto pipe = make_pipe();
+    EXPECT_EQ(add(epoll_fd, pipe.read_fd, EPOLLIN, 1), 0);
+
+    auto pid = fork();
+    VERIFY(pid >= 0);
+    if (pid == 0) {
+        usleep(20'000);
+        write_byte(pipe.write_fd);
+        _exit(0);
+    }
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, -1), 1);
+    EXPECT_EQ(events[0].data.u64, 1u);
+    MUST(Core::System::waitpid(pid));
+
+    close(pipe.read_fd);
+    close(pipe.write_fd);
+    close(epoll_fd);
+}
+
+TEST_CASE(invalid_arguments)
+{
+    int epoll_fd = epoll_create1(0);
+    auto pipe = make_pipe();
+
+    EXPECT_EQ(add(epoll_fd, pipe.read_fd, EPOLLIN, 1), 0);
+    EXPECT_EQ(add(epoll_fd, pipe.read_fd, EPOLLIN, 1), -1);
+    EXPECT_EQ(errno, EEXIST);
+
+    EXPECT_EQ(add(epoll_fd, epoll_fd, EPOLLIN, 1), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    EXPECT_EQ(add(epoll_fd, 12345, EPOLLIN, 1), -1);
+    EXPECT_EQ(errno, EBADF);
+    EXPECT_EQ(add(12345, pipe.write_fd, EPOLLOUT, 1), -1);
+    EXPECT_EQ(errno, EBADF);
+
+    // The first fd has to be an epoll instance.
+    EXPECT_EQ(add(pipe.read_fd, pipe.write_fd, EPOLLOUT, 1), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    epoll_event event {};
+    EXPECT_EQ(epoll_ctl(epoll_fd, 1234, pipe.write_fd, &event), -1);
+    EXPECT_EQ(errno, EINVAL);
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pipe.write_fd, nullptr), -1);
+    EXPECT_EQ(errno, EFAULT);
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 0, 0), -1);
+    EXPECT_EQ(errno, EINVAL);
+    EXPECT_EQ(epoll_wait(pipe.read_fd, events, 4, 0), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    close(pipe.read_fd);
+    close(pipe.write_fd);
+    close(epoll_fd);
+}
+
+TEST_CASE(event_queues_cannot_be_nested)
+{
+    int outer_fd = epoll_create1(0);
+    int inner_fd = epoll_create1(0);
+
+    EXPECT_EQ(add(outer_fd, inner_fd, EPOLLIN, 1), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    close(inner_fd);
+    close(outer_fd);
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/JsonObject.h>
+#include <AK/JsonValue.h>
+#include <AK/Platform.h>
+#include <LibCore/Stream.h>
+#include <LibCore/System.h>
+#include <LibTest/TestCase.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static constexpr size_t huge_page_size = 2 * MiB;
+static constexpr size_t huge_page_count = 4;
+static constexpr size_t mapping_size = huge_page_count * huge_page_size;
+
+struct HugePageStatistics {
+    i64 mapped { 0 };
+    i64 allocations { 0 };
+};
+
+static HugePageStatistics huge_page_statistics()
+{
+    auto file = MUST(Core::Stream::File::open("/sys/kernel/memstat"sv, Core::Stream::OpenMode::Read));
+    auto json = MUST(JsonValue::from_string(MUST(file->read_until_eof())));
+    auto const& object = json.as_object();
+    return {
+        static_cast<i64>(object.get_u64("huge_pages_mapped"sv).value_or(0)),
+        static_cast<i64>(object.get_u64("huge_page_allocations"sv).value_or(0)),
+    };
+}
+
+static bool are_huge_pages_expected()
+{
+#if ARCH(X86_64)
+    auto file = MUST(Core::Stream::File::open("/sys/kernel/cmdline"sv, Core::Stream::OpenMode::Read));
+    auto command_line = MUST(file->read_until_eof());
+    return !StringView { command_line }.contains("thp=off"sv);
+#else
+    return false;
+#endif
+}
+
+static u8 pattern_byte(size_t offset)
+{
+    return static_cast<u8>((offset / PAGE_SIZE) * 7 + offset);
+}
+
+// NOTE: This forks, which makes the whole mapping copy-on-write and so splits any huge pages in it.
+static bool access_crashes(u8 volatile* address, bool write)
+{
+    auto pid = MUST(Core::System::fork());
+    if (pid == 0) {
+        if (write)
+            *address = 0;
+        else
+            (void)*address;
+        _exit(0);
+    }
+    auto result = MUST(Core::System::waitpid(pid));
+    return WIFSIGNALED(result.status) && WTERMSIG(result.status) == SIGSEGV;
+}
+
+TEST_CASE(partial_mprotect_and_munmap_of_huge_pages)
+{
+    auto* memory = static_cast<u8*>(MUST(Core::System::mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0, huge_page_size, "huge pages test"sv)));
+    EXPECT_EQ(reinterpret_cast<FlatPtr>(memory) % huge_page_size, 0u);
+
+    auto before = huge_page_statistics();
+    for (size_t offset = 0; offset < mapping_size; ++offset)
+        memory[offset] = pattern_byte(offset);
+
+    auto after_write = huge_page_statistics();
+    bool expect_huge_pages = are_huge_pages_expected();
+    if (expect_huge_pages) {
+        EXPECT_EQ(after_write.allocations - before.allocations, static_cast<i64>(huge_page_count));
+        EXPECT_EQ(after_write.mapped - before.mapped, static_cast<i64>(huge_page_count));
+    }
+
+    // Protect a single page in the middle of the second huge page.
+    size_t protected_offset = 1 * huge_page_size + huge_page_size / 2;
+    EXPECT_EQ(mprotect(memory + protected_offset, PAGE_SIZE, PROT_READ), 0);
+
+    // Only the huge page that was carved up should have turned into 4 KiB pages.
+    auto after_mprotect = huge_page_statistics();
+    if (expect_huge_pages)
+        EXPECT_EQ(after_mprotect.mapped - after_write.mapped, -1);
+
+    // Unmap a few pages in the middle of the third huge page.
+    size_t unmapped_offset = 2 * huge_page_size + huge_page_size / 2;
+    size_t unmapped_size = 16 * PAGE_SIZE;
+    MUST(Core::System::munmap(memory + unmapped_offset, unmapped_size));
+
+    auto after_munmap = huge_page_statistics();
+    if (expect_huge_pages)
+        EXPECT_EQ(after_munmap.mapped - after_mprotect.mapped, -1);
+
+    size_t mismatch_count = 0;
+    for (size_t offset = 0; offset < mapping_size; ++offset) {
+        if (offset >= unmapped_offset && offset < unmapped_offset + unmapped_size)
+            continue;
+        if (memory[offset] != pattern_byte(offset))
+            ++mismatch_count;
+    }
+    EXPECT_EQ(mismatch_count, 0u);
+
+    EXPECT(!access_crashes(memory + protected_offset, false));
+    EXPECT(access_crashes(memory + protected_offset, true));
+    EXPECT(!access_crashes(memory + protected_offset + PAGE_SIZE, true));
+    EXPECT(access_crashes(memory + unmapped_offset, false));
+    EXPECT(access_crashes(memory + unmapped_offset + unmapped_size - PAGE_SIZE, false));
+    EXPECT(!access_crashes(memory + unmapped_offset + unmapped_size, true));
+
+    // Unmapping the rest should drop the huge pages that are left, whether or not forking split them up.
+    MUST(Core::System::munmap(memory, unmapped_offset));
+    MUST(Core::System::munmap(memory + unmapped_offset + unmapped_size, mapping_size - unmapped_offset - unmapped_size));
+    auto after_teardown = huge_page_statistics();
+    if (expect_huge_pages)
+        EXPECT(after_teardown.mapped <= after_munmap.mapped - static_cast<i64>(huge_page_count - 2));
+}
@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <Kernel/API/IORing.h>
+#include <LibCore/System.h>
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <serenity.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+class Ring {
+public:
+    explicit Ring(u32 entry_count)
+        : m_fd(MUST(Core::System::io_ring_create(entry_count, O_CLOEXEC)))
+        , m_size(io_ring_size(entry_count))
+    {
+        m_memory = static_cast<u8*>(MUST(Core::System::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0)));
+    }
+
+    ~Ring()
+    {
+        MUST(Core::System::munmap(m_memory, m_size));
+        MUST(Core::System::close(m_fd));
+    }
+
+    int fd() const { return m_fd; }
+    IORingHeader& header() { return *reinterpret_cast<IORingHeader*>(m_memory); }
+
+    void queue(IORingSubmission const& submission)
+    {
+        auto tail = header().submission_tail;
+        auto* submissions = reinterpret_cast<IORingSubmission*>(m_memory + io_ring_submissions_offset());
+        submissions[tail & (header().submission_entry_count - 1)] = submission;
+        AK::atomic_store(&header().submission_tail, tail + 1, AK::memory_order_release);
+    }
+
+    void queue_nop(u64 user_data)
+    {
+        queue({ .opcode = IORingOpcode::Nop, .user_data = user_data });
+    }
+
+    int enter(u32 to_submit)
+    {
+        return io_ring_enter(m_fd, to_submit);
+    }
+
+    u32 pending_completion_count()
+    {
+        return AK::atomic_load(&header().completion_tail, AK::memory_order_acquire) - header().completion_head;
+    }
+
+    IORingCompletion take_completion()
+    {
+        VERIFY(pending_completion_count() > 0);
+        auto head = header().completion_head;
+        auto* completions = reinterpret_cast<IORingCompletion*>(m_memory + io_ring_completions_offset(header().submission_entry_count));
+        auto completion = completions[head & (header().completion_entry_count - 1)];
+        AK::atomic_store(&header().completion_head, head + 1, AK::memory_order_release);
+        return completion;
+    }
+
+    // Submits a single entry and returns its result.
+    i64 run(IORingSubmission const& submission)
+    {
+        queue(submission);
+        EXPECT_EQ(enter(1), 1);
+        auto completion = take_completion();
+        EXPECT_EQ(completion.user_data, submission.user_data);
+        return completion.result;
+    }
+
+private:
+    int m_fd { -1 };
+    size_t m_size { 0 };
+    u8* m_memory { nullptr };
+};
+
+static IORingSubmission read_submission(int fd, Bytes buffer, i64 offset = -1)
+{
+    return { .opcode = IORingOpcode::Read, .fd = fd, .offset = offset, .buffer = reinterpret_cast<FlatPtr>(buffer.data()), .length = buffer.size(), .user_data = 1 };
+}
+
+static IORingSubmission write_submission(int fd, ReadonlyBytes buffer, i64 offset = -1)
+{
+    return { .opcode = IORingOpcode::Write, .fd = fd, .offset = offset, .buffer = reinterpret_cast<FlatPtr>(buffer.data()), .length = buffer.size(), .user_data = 2 };
+}
+
+TEST_CASE(create)
+{
+    for (u32 entry_count : { 0u, 3u, 100u, IO_RING_MAX_ENTRIES * 2 }) {
+        EXPECT_EQ(io_ring_create(entry_count, 0), -1);
+        EXPECT_EQ(errno, EINVAL);
+    }
+    EXPECT_EQ(io_ring_create(8, O_NONBLOCK), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    Ring ring { 8 };
+    EXPECT_EQ(ring.header().submission_entry_count, 8u);
+    EXPECT_EQ(ring.header().completion_entry_count, io_ring_completion_entry_count(8));
+    EXPECT(fcntl(ring.fd(), F_GETFD) & FD_CLOEXEC);
+
+    // The ring is driven through its mapping, not by writing to it.
+    EXPECT_EQ(write(ring.fd(), "x", 1), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    // Only a shared mapping of the whole ring sees the completions.
+    EXPECT_EQ(mmap(nullptr, io_ring_size(8), PROT_READ | PROT_WRITE, MAP_PRIVATE, ring.fd(), 0), MAP_FAILED);
+    EXPECT_EQ(errno, EINVAL);
+}
+
+TEST_CASE(read_and_write)
+{
+    char pattern[] = "/tmp/io_ring.XXXXXX";
+    auto fd = MUST(Core::System::mkstemp(pattern));
+    MUST(Core::System::unlink({ pattern, sizeof(pattern) - 1 }));
+
+    Ring ring { 4 };
+    EXPECT_EQ(ring.run(write_submission(fd, "hello friends"sv.bytes())), 13);
+    EXPECT_EQ(ring.run(write_submission(fd, "F"sv.bytes(), 6)), 1);
+    EXPECT_EQ(ring.run({ .opcode = IORingOpcode::Fsync, .fd = fd, .user_data = 3 }), 0);
+
+    Array<u8, 32> buffer {};
+    EXPECT_EQ(ring.run(read_submission(fd, buffer.span().trim(7), 6)), 7);
+    EXPECT_EQ(StringView(buffer.span().trim(7)), "Friends"sv);
+
+    // Reads without an offset use the current one, which is at the end after the first write.
+    EXPECT_EQ(ring.run(read_submission(fd, buffer)), 0);
+    MUST(Core::System::lseek(fd, 0, SEEK_SET));
+    EXPECT_EQ(ring.run(read_submission(fd, buffer)), 13);
+    EXPECT_EQ(StringView(buffer.span().trim(13)), "hello Friends"sv);
+
+    MUST(Core::System::close(fd));
+}
+
+TEST_CASE(batches)
+{
+    Ring ring { 4 };
+    for (u64 i = 0; i < 4; ++i)
+        ring.queue_nop(100 + i);
+
+    // Only as many as were asked for are taken, the rest stay queued.
+    EXPECT_EQ(ring.enter(3), 3);
+    EXPECT_EQ(ring.header().submission_head, 3u);
+    EXPECT_EQ(ring.enter(100), 1);
+    EXPECT_EQ(ring.enter(100), 0);
+
+    EXPECT_EQ(ring.pending_completion_count(), 4u);
+    for (u64 i = 0; i < 4; ++i) {
+        auto completion = ring.take_completion();
+        EXPECT_EQ(completion.user_data, 100 + i);
+        EXPECT_EQ(completion.result, 0);
+    }
+}
+
+TEST_CASE(readable_while_completions_are_waiting)
+{
+    Ring ring { 4 };
+    pollfd poll_fd { .fd = ring.fd(), .events = POLLIN, .revents = 0 };
+    EXPECT_EQ(poll(&poll_fd, 1, 0), 0);
+
+    ring.queue_nop(1);
+    EXPECT_EQ(ring.enter(1), 1);
+    EXPECT_EQ(poll(&poll_fd, 1, 0), 1);
+    EXPECT(poll_fd.revents & POLLIN);
+
+    (void)ring.take_completion();
+    EXPECT_EQ(poll(&poll_fd, 1, 0), 0);
+}
+
+TEST_CASE(full_completion_queue)
+{
+    Ring ring { 2 };
+    auto completion_entry_count = ring.header().completion_entry_count;
+
+    // Fill up the completion ring without looking at any of it.
+    for (u32 i = 0; i < completion_entry_count; i += 2) {
+        ring.queue_nop(i);
+        ring.queue_nop(i + 1);
+        EXPECT_EQ(ring.enter(2), 2);
+    }
+    EXPECT_EQ(ring.pending_completion_count(), completion_entry_count);
+
+    // Nothing is consumed while there's no room for its completion.
+    ring.queue_nop(1000);
+    ring.queue_nop(1001);
+    EXPECT_EQ(ring.enter(2), -1);
+    EXPECT_EQ(errno, EBUSY);
+    EXPECT_EQ(ring.header().submission_head, completion_entry_count);
+
+    // With room for one more, only one is consumed.
+    EXPECT_EQ(ring.take_completion().user_data, 0u);
+    EXPECT_EQ(ring.enter(2), 1);
+    EXPECT_EQ(ring.pending_completion_count(), completion_entry_count);
+
+    for (u32 i = 1; i < completion_entry_count; ++i)
+        EXPECT_EQ(ring.take_completion().user_data, i);
+    EXPECT_EQ(ring.take_completion().user_data, 1000u);
+
+    EXPECT_EQ(ring.enter(2), 1);
+    EXPECT_EQ(ring.take_completion().user_data, 1001u);
+    EXPECT_EQ(ring.pending_completion_count(), 0u);
+}
+
+TEST_CASE(malformed_submissions)
+{
+    Ring ring { 8 };
+    Array<u8, 16> buffer {};
+
+    auto fd = MUST(Core::System::open("/dev/zero"sv, O_RDONLY));
+    IORingSubmission unknown_opcode { .opcode = static_cast<IORingOpcode>(42), .fd = fd, .buffer = reinterpret_cast<FlatPtr>(buffer.data()), .length = buffer.size() };
+    EXPECT_EQ(ring.run(unknown_opcode), -EINVAL);
+
+    auto too_long = read_submission(fd, buffer);
+    too_long.length = static_cast<u64>(NumericLimits<i64>::max()) + 1;
+    EXPECT_EQ(ring.run(too_long), -EINVAL);
+
+    // Buffers have to be in the process' own memory.
+    auto unmapped_buffer = read_submission(fd, buffer);
+    unmapped_buffer.buffer = 0x1000;
+    EXPECT_EQ(ring.run(unmapped_buffer), -EFAULT);
+    auto kernel_buffer = read_submission(fd, buffer);
+    kernel_buffer.buffer = 0xc000'0000'0000'0000;
+    EXPECT_EQ(ring.run(kernel_buffer), -EFAULT);
+
+    // Empty transfers don't even look at the buffer.
+    auto empty = read_submission(fd, {});
+    EXPECT_EQ(ring.run(empty), 0);
+
+    // A bad submission doesn't stop the ones behind it.
+    ring.queue(unmapped_buffer);
+    ring.queue(read_submission(fd, buffer));
+    EXPECT_EQ(ring.enter(2), 2);
+    EXPECT_EQ(ring.take_completion().result, -EFAULT);
+    EXPECT_EQ(ring.take_completion().result, static_cast<i64>(buffer.size()));
+
+    MUST(Core::System::close(fd));
+}
+
+TEST_CASE(corrupted_ring)
+{
+    Ring ring { 4 };
+
+    // The process claims to have queued more submissions than fit into the ring.
+    AK::atomic_store(&ring.header().submission_tail, 5u);
+    EXPECT_EQ(ring.enter(1), -1);
+    EXPECT_EQ(errno, EINVAL);
+    EXPECT_EQ(ring.header().submission_head, 0u);
+
+    AK::atomic_store(&ring.header().submission_tail, 0xffff'fff0u);
+    EXPECT_EQ(ring.enter(1), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    // The kernel keeps its own submission head, so scribbling over the shared one doesn't change what it consumes next.
+    AK::atomic_store(&ring.header().submission_tail, 0u);
+    ring.queue_nop(1);
+    ring.header().submission_head = 1000;
+    EXPECT_EQ(ring.enter(1), 1);
+    EXPECT_EQ(ring.take_completion().user_data, 1u);
+    EXPECT_EQ(ring.header().submission_head, 1u);
+}
+
+TEST_CASE(bad_descriptors)
+{
+    EXPECT_EQ(io_ring_enter(-1, 1), -1);
+    EXPECT_EQ(errno, EBADF);
+    EXPECT_EQ(io_ring_enter(12345, 1), -1);
+    EXPECT_EQ(errno, EBADF);
+
+    // The descriptor has to be a ring.
+    auto zero_fd = MUST(Core::System::open("/dev/zero"sv, O_RDONLY));
+    EXPECT_EQ(io_ring_enter(zero_fd, 1), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    Ring ring { 8 };
+    Array<u8, 16> buffer {};
+
+    EXPECT_EQ(ring.run(read_submission(-1, buffer)), -EBADF);
+    EXPECT_EQ(ring.run(read_submission(12345, buffer)), -EBADF);
+    EXPECT_EQ(ring.run({ .opcode = IORingOpcode::Fsync, .fd = 12345 }), -EBADF);
+
+    // Reading from a write-only descriptor, and the other way around.
+    auto null_fd = MUST(Core::System::open("/dev/null"sv, O_WRONLY));
+    EXPECT_EQ(ring.run(read_submission(null_fd, buffer)), -EBADF);
+    EXPECT_EQ(ring.run(write_submission(zero_fd, buffer)), -EBADF);
+
+    auto directory_fd = MUST(Core::System::open("/tmp"sv, O_RDONLY | O_DIRECTORY));
+    EXPECT_EQ(ring.run(read_submission(directory_fd, buffer)), -EISDIR);
+
+    // Pipes have no offsets to read or write at.
+    auto pipe_fds = MUST(Core::System::pipe2(O_NONBLOCK));
+    EXPECT_EQ(ring.run(write_submission(pipe_fds[1], buffer, 0)), -ESPIPE);
+    // Non-blocking descriptors complete right away instead of holding up the ring.
+    EXPECT_EQ(ring.run(read_submission(pipe_fds[0], buffer)), -EAGAIN);
+
+    // A descriptor that is closed after its submission was queued is looked up when it's consumed.
+    ring.queue(write_submission(null_fd, buffer));
+    MUST(Core::System::close(null_fd));
+    EXPECT_EQ(ring.enter(1), 1);
+    EXPECT_EQ(ring.take_completion().result, -EBADF);
+
+    // Rings can't be read from or written to through a ring, not even another one.
+    EXPECT_EQ(ring.run(read_submission(ring.fd(), buffer)), -EINVAL);
+    EXPECT_EQ(ring.run(write_submission(ring.fd(), buffer)), -EINVAL);
+    Ring other_ring { 8 };
+    EXPECT_EQ(ring.run(read_submission(other_ring.fd(), buffer)), -EINVAL);
+
+    MUST(Core::System::close(pipe_fds[0]));
+    MUST(Core::System::close(pipe_fds[1]));
+    MUST(Core::System::close(directory_fd));
+    MUST(Core::System::close(zero_fd));
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/JsonArray.h>
+#include <AK/JsonValue.h>
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/Stream.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Every pair of threads bounces a single byte back and forth over two pipes. Each
+// hop blocks the sender and wakes up its partner, so every round trip forces two
+// context switches through the scheduler.
+
+struct PingPongPair {
+    int ping_fds[2] { -1, -1 };
+    int pong_fds[2] { -1, -1 };
+    pthread_t ping_thread {};
+    pthread_t pong_thread {};
+    u64 round_trips { 0 };
+};
+
+static Atomic<bool> s_should_stop { false };
+
+static void* ping_main(void* argument)
+{
+    auto& pair = *static_cast<PingPongPair*>(argument);
+    char byte = 0;
+    while (!s_should_stop.load(AK::MemoryOrder::memory_order_relaxed)) {
+        if (write(pair.ping_fds[1], &byte, 1) != 1)
+            break;
+        if (read(pair.pong_fds[0], &byte, 1) != 1)
+            break;
+        ++pair.round_trips;
+    }
+    // Closing our end of the ping pipe makes the partner thread see EOF and exit.
+    close(pair.ping_fds[1]);
+    return nullptr;
+}
+
+static void* pong_main(void* argument)
+{
+    auto& pair = *static_cast<PingPongPair*>(argument);
+    char byte = 0;
+    while (read(pair.ping_fds[0], &byte, 1) == 1) {
+        if (write(pair.pong_fds[1], &byte, 1) != 1)
+            break;
+    }
+    close(pair.pong_fds[1]);
+    return nullptr;
+}
+
+static int processor_count()
+{
+    auto file_or_error = Core::Stream::File::open("/sys/kernel/cpuinfo"sv, Core::Stream::OpenMode::Read);
+    if (file_or_error.is_error())
+        return 1;
+    auto buffer_or_error = file_or_error.value()->read_until_eof();
+    if (buffer_or_error.is_error())
+        return 1;
+    auto json_or_error = JsonValue::from_string(buffer_or_error.value());
+    if (json_or_error.is_error() || !json_or_error.value().is_array())
+        return 1;
+    return max(1, static_cast<int>(json_or_error.value().as_array().size()));
+}
+
+static bool run_round(int pair_count, int duration_ms)
+{
+    Vector<PingPongPair> pairs;
+    pairs.resize(pair_count);
+
+    for (auto& pair : pairs) {
+        if (pipe(pair.ping_fds) < 0 || pipe(pair.pong_fds) < 0) {
+            perror("pipe");
+            return false;
+        }
+    }
+
+    s_should_stop.store(false);
+    auto timer = Core::ElapsedTimer::start_new();
+
+    for (auto& pair : pairs) {
+        if (pthread_create(&pair.pong_thread, nullptr, pong_main, &pair) != 0 || pthread_create(&pair.ping_thread, nullptr, ping_main, &pair) != 0) {
+            perror("pthread_create");
+            return false;
+        }
+    }
+
+    usleep(duration_ms * 1000);
+    s_should_stop.store(true);
+
+    u64 total_round_trips = 0;
+    for (auto& pair : pairs) {
+        pthread_join(pair.ping_thread, nullptr);
+        pthread_join(pair.pong_thread, nullptr);
+        close(pair.ping_fds[0]);
+        close(pair.pong_fds[0]);
+        total_round_trips += pair.round_trips;
+    }
+    auto elapsed_ms = max<i64>(1, timer.elapsed());
+
+    auto switches_per_second = total_round_trips * 2 * 1000 / elapsed_ms;
+    printf("%4d thread pairs: %10" PRIu64 " context switches/sec (%" PRIu64 " per pair)\n",
+        pair_count, switches_per_second, switches_per_second / pair_count);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int max_pairs = 0;
+    int duration_ms = 2000;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure scheduler throughput with pairs of threads ping-ponging over pipes.");
+    args_parser.add_option(max_pairs, "Highest number of thread pairs to run (default: 2x processor count)", "pairs", 'p', "number");
+    args_parser.add_option(duration_ms, "Duration of each round in milliseconds", "duration", 'd', "ms");
+    args_parser.parse(argc, argv);
+
+    auto processors = processor_count();
+    if (max_pairs <= 0)
+        max_pairs = processors * 2;
+
+    printf("Running on %d processor(s), %d ms per round\n", processors, duration_ms);
+
+    for (int pair_count = 1; pair_count <= max_pairs; pair_count *= 2) {
+        if (!run_round(pair_count, duration_ms))
+            return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -4,11 +4,15 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/HashTable.h>
+#include <AK/Vector.h>
 #include <LibTest/TestCase.h>
 
 #include <errno.h>
 #include <mallocdefs.h>
+#include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
 
 TEST_CASE(malloc_limits)
 {
@@ -38,3 +42,81 @@ TEST_CASE(malloc_limits)
         return Test::Crash::Failure::DidNotCrash;
     });
 }
+
+static constexpr size_t chunk_sizes_to_test[] = { 8, 24, 48, 100, 200, 400, 1000, 2000 };
+
+TEST_CASE(malloc_free_across_threads)
+{
+    // Chunks allocated on one thread and freed on another end up in the freeing thread's cache,
+    // which must still never hand out a chunk that is in use.
+    Vector<void*> chunks;
+    pthread_t thread;
+    auto allocate_chunks = [](void* argument) -> void* {
+        auto& chunks = *static_cast<Vector<void*>*>(argument);
+        for (size_t i = 0; i < 1000; ++i) {
+            auto size = chunk_sizes_to_test[i % array_size(chunk_sizes_to_test)];
+            auto* ptr = malloc(size);
+            memset(ptr, static_cast<int>(i), size);
+            chunks.append(ptr);
+        }
+        return nullptr;
+    };
+    EXPECT_EQ(pthread_create(&thread, nullptr, allocate_chunks, &chunks), 0);
+    EXPECT_EQ(pthread_join(thread, nullptr), 0);
+    EXPECT_EQ(chunks.size(), 1000u);
+
+    for (size_t i = 0; i < chunks.size(); i += 2)
+        free(chunks[i]);
+
+    HashTable<void*> live_chunks;
+    for (size_t i = 1; i < chunks.size(); i += 2) {
+        auto size = chunk_sizes_to_test[i % array_size(chunk_sizes_to_test)];
+        EXPECT_EQ(static_cast<u8 const*>(chunks[i])[size - 1], static_cast<u8>(i));
+        live_chunks.set(chunks[i]);
+    }
+    for (size_t i = 0; i < 1000; ++i) {
+        auto* ptr = malloc(chunk_sizes_to_test[i % array_size(chunk_sizes_to_test)]);
+        EXPECT(!live_chunks.contains(ptr));
+        live_chunks.set(ptr);
+    }
+    for (auto* ptr : live_chunks)
+        free(ptr);
+}
+
+static void* allocate_and_free_small_chunks(void*)
+{
+    Vector<void*, 64> chunks;
+    for (size_t round = 0; round < 20000; ++round) {
+        for (size_t i = 0; i < 8; ++i)
+            chunks.append(malloc(chunk_sizes_to_test[(round + i) % 6]));
+        for (auto* ptr : chunks)
+            free(ptr);
+        chunks.clear_with_capacity();
+    }
+    return nullptr;
+}
+
+static void run_on_threads(size_t thread_count)
+{
+    Vector<pthread_t> threads;
+    threads.resize(thread_count);
+    for (auto& thread : threads)
+        EXPECT_EQ(pthread_create(&thread, nullptr, allocate_and_free_small_chunks, nullptr), 0);
+    for (auto& thread : threads)
+        EXPECT_EQ(pthread_join(thread, nullptr), 0);
+}
+
+BENCHMARK_CASE(malloc_contention_1_thread)
+{
+    run_on_threads(1);
+}
+
+BENCHMARK_CASE(malloc_contention_4_threads)
+{
+    run_on_threads(4);
+}
+
+BENCHMARK_CASE(malloc_contention_16_threads)
+{
+    run_on_threads(16);
+}
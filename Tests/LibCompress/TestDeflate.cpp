@@ -148,6 +148,32 @@ TEST_CASE(deflate_round_trip_compress_large)
     EXPECT(uncompressed.value() == original);
 }
 
+static ByteBuffer compressible_test_data(size_t size)
+{
+    // Random words from a small vocabulary, so that there is plenty for back references to find, also across chunks.
+    constexpr Array words { "deflate"sv, "chunk"sv, "window"sv, "huffman"sv, "literal"sv, "distance"sv, " "sv, "\n"sv };
+    auto buffer = ByteBuffer::create_uninitialized(size).release_value();
+    size_t offset = 0;
+    while (offset < size) {
+        auto word = words[get_random_uniform(words.size())];
+        auto count = min(word.length(), size - offset);
+        buffer.overwrite(offset, word.characters_without_null_termination(), count);
+        offset += count;
+    }
+    return buffer;
+}
+
+TEST_CASE(deflate_round_trip_compress_parallel)
+{
+    auto original = compressible_test_data(Compress::DeflateCompressor::parallel_chunk_size * 3 + 1234);
+    auto compressed = Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::FAST, Compress::DeflateCompressor::Parallelism::Parallel);
+    EXPECT(!compressed.is_error());
+    EXPECT(compressed.value().size() < original.size() / 2);
+    auto uncompressed = Compress::DeflateDecompressor::decompress_all(compressed.value());
+    EXPECT(!uncompressed.is_error());
+    EXPECT(uncompressed.value() == original);
+}
+
 TEST_CASE(deflate_compress_literals)
 {
     // This byte array is known to not produce any back references with our lz77 implementation even at the highest compression settings
@@ -155,3 +181,19 @@ TEST_CASE(deflate_compress_literals)
     auto compressed = Compress::DeflateCompressor::compress_all(test, Compress::DeflateCompressor::CompressionLevel::GOOD);
     EXPECT(!compressed.is_error());
 }
+
+static constexpr size_t benchmark_size = 4 * MiB;
+
+BENCHMARK_CASE(deflate_compress_serial)
+{
+    auto original = compressible_test_data(benchmark_size);
+    auto compressed = Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::GOOD);
+    EXPECT(!compressed.is_error());
+}
+
+BENCHMARK_CASE(deflate_compress_parallel)
+{
+    auto original = compressible_test_data(benchmark_size);
+    auto compressed = Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::GOOD, Compress::DeflateCompressor::Parallelism::Parallel);
+    EXPECT(!compressed.is_error());
+}
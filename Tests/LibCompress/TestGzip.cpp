@@ -95,3 +95,15 @@ TEST_CASE(gzip_round_trip)
     EXPECT(!uncompressed.is_error());
     EXPECT(uncompressed.value() == original);
 }
+
+TEST_CASE(gzip_round_trip_parallel)
+{
+    auto size = Compress::DeflateCompressor::parallel_chunk_size * 4;
+    auto original = ByteBuffer::create_zeroed(size).release_value();
+    fill_with_random(original.data(), size / 2);
+    auto compressed = Compress::GzipCompressor::compress_all(original, Compress::DeflateCompressor::Parallelism::Parallel);
+    EXPECT(!compressed.is_error());
+    auto uncompressed = Compress::GzipDecompressor::decompress_all(compressed.value());
+    EXPECT(!uncompressed.is_error());
+    EXPECT(uncompressed.value() == original);
+}
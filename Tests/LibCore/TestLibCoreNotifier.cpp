@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/EventLoop.h>
+#include <LibCore/Notifier.h>
+#include <LibCore/Timer.h>
+#include <LibTest/TestCase.h>
+#include <unistd.h>
+
+TEST_CASE(notifier_read_and_write)
+{
+    Core::EventLoop event_loop;
+    auto reaper = MUST(Core::Timer::create_single_shot(1000, [] {
+        warnln("The notifiers never fired!");
+        VERIFY_NOT_REACHED();
+    }));
+
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+
+    auto read_notifier = Core::Notifier::construct(pipe_fds[0], Core::Notifier::Read);
+    auto write_notifier = Core::Notifier::construct(pipe_fds[1], Core::Notifier::Write);
+
+    int reads = 0;
+    read_notifier->on_ready_to_read = [&] {
+        char buffer[8];
+        EXPECT_EQ(read(pipe_fds[0], buffer, sizeof(buffer)), 1);
+        if (++reads == 2)
+            event_loop.quit(0);
+    };
+    write_notifier->on_ready_to_write = [&] {
+        EXPECT_EQ(write(pipe_fds[1], "x", 1), 1);
+        // Only write a second time once the mask has been changed back and forth.
+        write_notifier->set_event_mask(Core::Notifier::None);
+        Core::deferred_invoke([&] {
+            if (reads < 2)
+                write_notifier->set_event_mask(Core::Notifier::Write);
+        });
+    };
+
+    event_loop.exec();
+    EXPECT_EQ(reads, 2);
+
+    read_notifier->close();
+    write_notifier->close();
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
+
+TEST_CASE(notifier_survives_fd_reuse)
+{
+    Core::EventLoop event_loop;
+    auto reaper = MUST(Core::Timer::create_single_shot(1000, [] {
+        warnln("The notifier for the reused fd never fired!");
+        VERIFY_NOT_REACHED();
+    }));
+
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+    auto stale_notifier = Core::Notifier::construct(pipe_fds[0], Core::Notifier::Read);
+    // Let the event loop pick up the first pipe before it goes away behind its back.
+    event_loop.pump(Core::EventLoop::WaitMode::PollForEvents);
+    int stale_fd = pipe_fds[0];
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+
+    EXPECT_EQ(pipe(pipe_fds), 0);
+    EXPECT_EQ(pipe_fds[0], stale_fd);
+    auto notifier = Core::Notifier::construct(pipe_fds[0], Core::Notifier::Read);
+    notifier->on_ready_to_read = [&] {
+        event_loop.quit(0);
+    };
+    EXPECT_EQ(write(pipe_fds[1], "x", 1), 1);
+
+    event_loop.exec();
+
+    stale_notifier->close();
+    notifier->close();
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
+#include <AK/Random.h>
 #include <LibCrypto/Checksum/Adler32.h>
 #include <LibCrypto/Checksum/CRC32.h>
 #include <LibTest/TestCase.h>
@@ -33,3 +35,92 @@ TEST_CASE(test_crc32)
     do_test(DeprecatedString("The quick brown fox jumps over the lazy dog").bytes(), 0x414FA339);
     do_test(DeprecatedString("various CRC algorithms input data").bytes(), 0x9BD366AE);
 }
+
+// The straightforward byte-at-a-time implementations, to check the optimized ones against.
+static u32 reference_adler32(ReadonlyBytes data)
+{
+    u32 a = 1;
+    u32 b = 0;
+    for (auto byte : data) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+static u32 reference_crc32(ReadonlyBytes data)
+{
+    u32 state = ~0u;
+    for (auto byte : data) {
+        state ^= byte;
+        for (auto i = 0; i < 8; i++)
+            state = (state & 1) ? (0xEDB88320 ^ (state >> 1)) : (state >> 1);
+    }
+    return ~state;
+}
+
+static ByteBuffer random_data(size_t size)
+{
+    auto buffer = ByteBuffer::create_uninitialized(size).release_value();
+    fill_with_random(buffer.data(), buffer.size());
+    return buffer;
+}
+
+TEST_CASE(test_checksums_against_reference)
+{
+    // Cover every size around the block boundaries of the vectorized paths, and unaligned starts.
+    auto data = random_data(20000);
+    constexpr Array<size_t, 21> sizes { 0, 1, 7, 8, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 129, 1000, 5552, 5553, 11104, 19990 };
+    for (auto size : sizes) {
+        for (size_t offset = 0; offset < 4; ++offset) {
+            auto bytes = data.bytes().slice(offset, size);
+            EXPECT_EQ(Crypto::Checksum::Adler32(bytes).digest(), reference_adler32(bytes));
+            EXPECT_EQ(Crypto::Checksum::CRC32(bytes).digest(), reference_crc32(bytes));
+        }
+    }
+
+    // All 0xff bytes give the largest possible sums, which is the worst case for overflow.
+    data.bytes().fill(0xff);
+    EXPECT_EQ(Crypto::Checksum::Adler32(data).digest(), reference_adler32(data));
+}
+
+TEST_CASE(test_checksums_incremental)
+{
+    auto data = random_data(10000);
+    Crypto::Checksum::Adler32 adler32;
+    Crypto::Checksum::CRC32 crc32;
+    for (size_t offset = 0; offset < data.size();) {
+        auto size = min<size_t>(get_random_uniform(300), data.size() - offset);
+        adler32.update(data.bytes().slice(offset, size));
+        crc32.update(data.bytes().slice(offset, size));
+        offset += size;
+    }
+    EXPECT_EQ(adler32.digest(), reference_adler32(data));
+    EXPECT_EQ(crc32.digest(), reference_crc32(data));
+}
+
+static constexpr size_t benchmark_size = 16 * MiB;
+
+BENCHMARK_CASE(benchmark_adler32)
+{
+    auto data = random_data(benchmark_size);
+    EXPECT_NE(Crypto::Checksum::Adler32(data).digest(), 0u);
+}
+
+BENCHMARK_CASE(benchmark_adler32_reference)
+{
+    auto data = random_data(benchmark_size);
+    EXPECT_NE(reference_adler32(data), 0u);
+}
+
+BENCHMARK_CASE(benchmark_crc32)
+{
+    auto data = random_data(benchmark_size);
+    EXPECT_NE(Crypto::Checksum::CRC32(data).digest(), 0u);
+}
+
+BENCHMARK_CASE(benchmark_crc32_reference)
+{
+    auto data = random_data(benchmark_size);
+    EXPECT_NE(reference_crc32(data), 0u);
+}
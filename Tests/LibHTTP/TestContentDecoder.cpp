@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Array.h>
+#include <AK/StringBuilder.h>
+#include <LibCompress/Deflate.h>
+#include <LibCompress/Gzip.h>
+#include <LibCompress/Zlib.h>
+#include <LibHTTP/ContentDecoder.h>
+
+static ByteBuffer sample_body()
+{
+    StringBuilder builder;
+    for (size_t i = 0; i < 200; ++i)
+        builder.appendff("{} bottles of beer on the wall, {} bottles of beer.\n", i * 7 % 101, i * 13 % 97);
+    return builder.to_byte_buffer();
+}
+
+// Feeds the encoded body to a decoder in pieces of the given sizes, the last of which is repeated until it's all gone.
+static ByteBuffer decode_in_pieces(StringView content_encoding, ReadonlyBytes encoded, Vector<size_t> const& piece_sizes)
+{
+    auto decoder = MUST(HTTP::ContentDecoder::create(content_encoding));
+    VERIFY(decoder);
+
+    ByteBuffer decoded;
+    size_t offset = 0;
+    for (size_t i = 0; offset < encoded.size(); ++i) {
+        auto piece_size = min(piece_sizes[min(i, piece_sizes.size() - 1)], encoded.size() - offset);
+        decoded.append(MUST(decoder->decode(encoded.slice(offset, piece_size))));
+        offset += piece_size;
+    }
+    decoded.append(MUST(decoder->finish()));
+    return decoded;
+}
+
+static void expect_decodes_when_split_anywhere(StringView content_encoding, ReadonlyBytes encoded, ReadonlyBytes expected)
+{
+    for (size_t split = 0; split <= encoded.size(); ++split) {
+        auto decoded = decode_in_pieces(content_encoding, encoded, { split, encoded.size() });
+        EXPECT_EQ(decoded.bytes(), expected);
+        if (decoded.bytes() != expected) {
+            warnln("{}: failed when split at {}", content_encoding, split);
+            return;
+        }
+    }
+}
+
+TEST_CASE(gzip_split_at_every_offset)
+{
+    auto body = sample_body();
+    auto encoded = MUST(Compress::GzipCompressor::compress_all(body));
+    expect_decodes_when_split_anywhere("gzip"sv, encoded, body);
+}
+
+TEST_CASE(deflate_split_at_every_offset)
+{
+    auto body = sample_body();
+
+    auto zlib_encoded = MUST(Compress::ZlibCompressor::compress_all(body));
+    expect_decodes_when_split_anywhere("deflate"sv, zlib_encoded, body);
+
+    auto raw_encoded = MUST(Compress::DeflateCompressor::compress_all(body));
+    expect_decodes_when_split_anywhere("deflate"sv, raw_encoded, body);
+}
+
+// Tests/LibCompress/brotli-test-files/lorem2.txt.br
+static constexpr Array<u8, 190> brotli_encoded_lorem {
+    0xa1, 0xe0, 0x09, 0x00, 0x20, 0xaa, 0x53, 0xfc, 0xf7, 0x5c, 0xbe, 0x5f,
+    0x17, 0xa2, 0xd6, 0x12, 0x50, 0x86, 0x93, 0x9a, 0xed, 0x74, 0x60, 0x38,
+    0xe0, 0xbf, 0xdb, 0xed, 0x6e, 0x3e, 0x98, 0xc0, 0x3a, 0xaf, 0x52, 0x08,
+    0x30, 0xca, 0x0b, 0x2c, 0xb5, 0xdc, 0x89, 0x2e, 0xc7, 0x67, 0x95, 0xf6,
+    0x1b, 0xc6, 0xa5, 0xeb, 0xc1, 0x3e, 0x8c, 0x95, 0x1d, 0x9f, 0x8f, 0x9c,
+    0xfa, 0x57, 0x60, 0xf2, 0x5e, 0x84, 0x95, 0xe0, 0x8c, 0xc4, 0xae, 0x53,
+    0xc6, 0x66, 0xdf, 0xba, 0x13, 0xff, 0x92, 0x71, 0x09, 0xce, 0x94, 0xc8,
+    0x3a, 0xfb, 0x39, 0xc2, 0x85, 0xcb, 0xd0, 0xc2, 0xc3, 0x16, 0xb7, 0x97,
+    0x92, 0x76, 0x60, 0x0f, 0x66, 0x10, 0x5d, 0x2d, 0x6b, 0x3a, 0xf1, 0x10,
+    0x21, 0xa7, 0x32, 0x65, 0x7a, 0x55, 0xdb, 0x7f, 0xef, 0xa8, 0xdc, 0x4c,
+    0xb4, 0x77, 0xf9, 0x4e, 0xd4, 0x06, 0x93, 0x75, 0x64, 0x0c, 0x01, 0xa1,
+    0x72, 0x76, 0x57, 0x60, 0xc9, 0xc2, 0xa7, 0x64, 0xc0, 0xe5, 0xa6, 0xdd,
+    0x4c, 0x89, 0x31, 0xca, 0x08, 0xc8, 0x3e, 0xe2, 0xc4, 0x64, 0xb4, 0x58,
+    0x34, 0x1c, 0x1d, 0xb1, 0x34, 0x51, 0x09, 0xc7, 0xc4, 0xa7, 0x2f, 0xce,
+    0x21, 0x38, 0x3c, 0x33, 0x89, 0xb8, 0x23, 0x85, 0x2f, 0xda, 0x61, 0xf6,
+    0x5d, 0x5b, 0x6e, 0x5a, 0x37, 0x89, 0x47, 0xf9, 0xb6, 0x1f
+};
+static constexpr auto brotli_decoded_lorem = "nibh praesent tristique magna sit amet purus gravida quis blandit turpis cursus in hac habitasse platea dictumst quisque sagittis purus sit amet volutpat consequat mauris nunc congue nisi vitae suscipit tellus mauris a diam maecenas sed enim ut sem viverra aliquet eget sit amet tellus cras adipiscing enim eu turpis\n"sv;
+
+TEST_CASE(brotli_split_at_every_offset)
+{
+    expect_decodes_when_split_anywhere("br"sv, brotli_encoded_lorem, brotli_decoded_lorem.bytes());
+}
+
+TEST_CASE(byte_by_byte)
+{
+    auto body = sample_body();
+    auto gzip_decoded = decode_in_pieces("gzip"sv, MUST(Compress::GzipCompressor::compress_all(body)), { 1 });
+    EXPECT_EQ(gzip_decoded.bytes(), body.bytes());
+    auto deflate_decoded = decode_in_pieces("deflate"sv, MUST(Compress::ZlibCompressor::compress_all(body)), { 1 });
+    EXPECT_EQ(deflate_decoded.bytes(), body.bytes());
+    auto brotli_decoded = decode_in_pieces("br"sv, brotli_encoded_lorem, { 1 });
+    EXPECT_EQ(brotli_decoded.bytes(), brotli_decoded_lorem.bytes());
+}
+
+TEST_CASE(decodes_before_the_body_is_complete)
+{
+    auto body = sample_body();
+    auto encoded = MUST(Compress::GzipCompressor::compress_all(body));
+
+    auto decoder = MUST(HTTP::ContentDecoder::create("gzip"sv));
+    auto decoded = MUST(decoder->decode(encoded.bytes().trim(encoded.size() / 2)));
+    EXPECT(!decoded.is_empty());
+    EXPECT_EQ(decoded.bytes(), body.bytes().trim(decoded.size()));
+}
+
+// A valid gzip stream that starts with a lot of input that doesn't decode to anything.
+TEST_CASE(gzip_many_empty_stored_blocks)
+{
+    ByteBuffer encoded;
+    encoded.append(Array<u8, 10> { 0x1f, 0x8b, 0x08, 0, 0, 0, 0, 0, 0, 0x03 });
+    for (size_t i = 0; i < 20000; ++i)
+        encoded.append(Array<u8, 5> { 0x00, 0x00, 0x00, 0xff, 0xff });
+    encoded.append(Array<u8, 5> { 0x01, 0x05, 0x00, 0xfa, 0xff });
+    encoded.append("hello"sv.bytes());
+    // CRC32 and size of "hello".
+    encoded.append(Array<u8, 8> { 0x86, 0xa6, 0x10, 0x36, 0x05, 0, 0, 0 });
+
+    auto decoded = decode_in_pieces("gzip"sv, encoded, { 1400 });
+    EXPECT_EQ(decoded.bytes(), "hello"sv.bytes());
+}
+
+// Same for brotli, with empty metadata blocks.
+TEST_CASE(brotli_many_empty_metadata_blocks)
+{
+    ByteBuffer encoded;
+    // A 16-bit window, and the first empty metadata block.
+    encoded.append(0x0c);
+    for (size_t i = 0; i < 20000; ++i)
+        encoded.append(0x06);
+    // An uncompressed meta-block of five bytes.
+    encoded.append(Array<u8, 3> { 0x20, 0x00, 0x08 });
+    encoded.append("hello"sv.bytes());
+    // The last meta-block, which is empty.
+    encoded.append(0x03);
+
+    auto decoded = decode_in_pieces("br"sv, encoded, { 1400 });
+    EXPECT_EQ(decoded.bytes(), "hello"sv.bytes());
+    auto decoded_byte_by_byte = decode_in_pieces("br"sv, encoded, { 1 });
+    EXPECT_EQ(decoded_byte_by_byte.bytes(), "hello"sv.bytes());
+}
+
+TEST_CASE(truncated_body)
+{
+    auto body = sample_body();
+    auto encoded = MUST(Compress::GzipCompressor::compress_all(body));
+
+    auto decoder = MUST(HTTP::ContentDecoder::create("gzip"sv));
+    (void)MUST(decoder->decode(encoded.bytes().trim(encoded.size() - 10)));
+    EXPECT(decoder->finish().is_error());
+}
+
+TEST_CASE(empty_body)
+{
+    auto decoder = MUST(HTTP::ContentDecoder::create("gzip"sv));
+    EXPECT(MUST(decoder->finish()).is_empty());
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Array.h>
+#include <LibHTTP/HPACK.h>
+
+using HTTP::HPACK::Header;
+
+static void expect_headers(Vector<Header> const& headers, Vector<Header> const& expected)
+{
+    EXPECT_EQ(headers.size(), expected.size());
+    for (size_t i = 0; i < min(headers.size(), expected.size()); ++i) {
+        EXPECT_EQ(headers[i].name, expected[i].name);
+        EXPECT_EQ(headers[i].value, expected[i].value);
+    }
+}
+
+// RFC 7541, Appendix C.3 and C.4: Three requests over the same connection, without and with Huffman coding.
+static Vector<Header> const first_request {
+    { ":method", "GET" },
+    { ":scheme", "http" },
+    { ":path", "/" },
+    { ":authority", "www.example.com" },
+};
+static Vector<Header> const second_request {
+    { ":method", "GET" },
+    { ":scheme", "http" },
+    { ":path", "/" },
+    { ":authority", "www.example.com" },
+    { "cache-control", "no-cache" },
+};
+static Vector<Header> const third_request {
+    { ":method", "GET" },
+    { ":scheme", "https" },
+    { ":path", "/index.html" },
+    { ":authority", "www.example.com" },
+    { "custom-key", "custom-value" },
+};
+
+TEST_CASE(decode_requests_without_huffman_coding)
+{
+    Array<u8, 20> const first_block { 0x82, 0x86, 0x84, 0x41, 0x0f, 0x77, 0x77, 0x77, 0x2e, 0x65, 0x78, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x2e, 0x63, 0x6f, 0x6d };
+    Array<u8, 14> const second_block { 0x82, 0x86, 0x84, 0xbe, 0x58, 0x08, 0x6e, 0x6f, 0x2d, 0x63, 0x61, 0x63, 0x68, 0x65 };
+    Array<u8, 29> const third_block { 0x82, 0x87, 0x85, 0xbf, 0x40, 0x0a, 0x63, 0x75, 0x73, 0x74, 0x6f, 0x6d, 0x2d, 0x6b, 0x65, 0x79, 0x0c, 0x63, 0x75, 0x73, 0x74, 0x6f, 0x6d, 0x2d, 0x76, 0x61, 0x6c, 0x75, 0x65 };
+
+    HTTP::HPACK::Decoder decoder;
+    expect_headers(MUST(decoder.decode(first_block)), first_request);
+    expect_headers(MUST(decoder.decode(second_block)), second_request);
+    expect_headers(MUST(decoder.decode(third_block)), third_request);
+}
+
+static Array<u8, 17> const first_huffman_block { 0x82, 0x86, 0x84, 0x41, 0x8c, 0xf1, 0xe3, 0xc2, 0xe5, 0xf2, 0x3a, 0x6b, 0xa0, 0xab, 0x90, 0xf4, 0xff };
+static Array<u8, 12> const second_huffman_block { 0x82, 0x86, 0x84, 0xbe, 0x58, 0x86, 0xa8, 0xeb, 0x10, 0x64, 0x9c, 0xbf };
+static Array<u8, 24> const third_huffman_block { 0x82, 0x87, 0x85, 0xbf, 0x40, 0x88, 0x25, 0xa8, 0x49, 0xe9, 0x5b, 0xa9, 0x7d, 0x7f, 0x89, 0x25, 0xa8, 0x49, 0xe9, 0x5b, 0xb8, 0xe8, 0xb4, 0xbf };
+
+TEST_CASE(decode_requests_with_huffman_coding)
+{
+    HTTP::HPACK::Decoder decoder;
+    expect_headers(MUST(decoder.decode(first_huffman_block)), first_request);
+    expect_headers(MUST(decoder.decode(second_huffman_block)), second_request);
+    expect_headers(MUST(decoder.decode(third_huffman_block)), third_request);
+}
+
+TEST_CASE(encode_requests)
+{
+    HTTP::HPACK::Encoder encoder;
+    EXPECT(MUST(encoder.encode(first_request)).bytes() == first_huffman_block.span());
+    EXPECT(MUST(encoder.encode(second_request)).bytes() == second_huffman_block.span());
+    EXPECT(MUST(encoder.encode(third_request)).bytes() == third_huffman_block.span());
+}
+
+TEST_CASE(encoder_and_decoder_stay_in_sync)
+{
+    Vector<Header> const headers {
+        { ":method", "GET" },
+        { ":path", "/style.css" },
+        { "user-agent", "Mozilla/5.0 (SerenityOS; x86_64) LibWeb+LibJS/1.0 Browser/1.0" },
+        { "cookie", "session=0123456789abcdef0123456789abcdef" },
+        { "cookie", "short=1" },
+        { "authorization", "Basic c2VyZW5pdHk6b3M=" },
+        { "x-large", DeprecatedString::repeated('x', 3000) },
+    };
+
+    HTTP::HPACK::Encoder encoder;
+    HTTP::HPACK::Decoder decoder;
+    auto first_block = MUST(encoder.encode(headers));
+    expect_headers(MUST(decoder.decode(first_block)), headers);
+
+    // Everything but the sensitive and the oversized headers comes from the table the second time around.
+    auto second_block = MUST(encoder.encode(headers));
+    expect_headers(MUST(decoder.decode(second_block)), headers);
+    EXPECT(second_block.size() < first_block.size());
+
+    encoder.set_max_table_size(64);
+    auto third_block = MUST(encoder.encode(headers));
+    expect_headers(MUST(decoder.decode(third_block)), headers);
+}
+
+TEST_CASE(huffman_round_trip)
+{
+    auto text = "Mon, 21 Oct 2013 20:13:21 GMT"sv;
+    Array<u8, 22> const encoded { 0xd0, 0x7a, 0xbe, 0x94, 0x10, 0x54, 0xd4, 0x44, 0xa8, 0x20, 0x05, 0x95, 0x04, 0x0b, 0x81, 0x66, 0xe0, 0x82, 0xa6, 0x2d, 0x1b, 0xff };
+
+    ByteBuffer output;
+    MUST(HTTP::HPACK::huffman_encode(text.bytes(), output));
+    EXPECT(output.bytes() == encoded.span());
+    EXPECT_EQ(HTTP::HPACK::huffman_encoded_length(text.bytes()), encoded.size());
+    auto decoded = MUST(HTTP::HPACK::huffman_decode(encoded));
+    EXPECT_EQ(StringView { decoded.bytes() }, text);
+
+    Array<u8, 256> all_bytes;
+    for (size_t i = 0; i < all_bytes.size(); ++i)
+        all_bytes[i] = i;
+    output.clear();
+    MUST(HTTP::HPACK::huffman_encode(all_bytes, output));
+    EXPECT(MUST(HTTP::HPACK::huffman_decode(output)).bytes() == all_bytes.span());
+}
+
+TEST_CASE(reject_invalid_input)
+{
+    HTTP::HPACK::Decoder decoder;
+
+    // Index 0, and an index beyond the (empty) dynamic table.
+    EXPECT(decoder.decode(Array<u8, 1> { 0x80 }).is_error());
+    EXPECT(decoder.decode(Array<u8, 1> { 0xbe }).is_error());
+
+    // A string that is longer than the block.
+    EXPECT(decoder.decode(Array<u8, 3> { 0x40, 0x05, 0x61 }).is_error());
+
+    // A table size update after a header, and one that is bigger than we allow.
+    EXPECT(decoder.decode(Array<u8, 2> { 0x82, 0x20 }).is_error());
+    EXPECT(decoder.decode(Array<u8, 3> { 0x3f, 0xe2, 0x1f }).is_error());
+
+    // Huffman padding that is longer than seven bits, or not all ones.
+    EXPECT(HTTP::HPACK::huffman_decode(Array<u8, 2> { 0x1f, 0xff }).is_error());
+    EXPECT(HTTP::HPACK::huffman_decode(Array<u8, 1> { 0x18 }).is_error());
+}
@@ -0,0 +1,582 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Endian.h>
+#include <AK/MemoryStream.h>
+#include <AK/URL.h>
+#include <LibCore/Stream.h>
+#include <LibHTTP/HPACK.h>
+#include <LibHTTP/Http2Connection.h>
+#include <LibHTTP/HttpRequest.h>
+
+using HTTP::HPACK::Header;
+using NetworkError = Core::NetworkJob::Error;
+
+namespace FrameType {
+static constexpr u8 Data = 0x0;
+static constexpr u8 Headers = 0x1;
+static constexpr u8 RstStream = 0x3;
+static constexpr u8 Settings = 0x4;
+static constexpr u8 Ping = 0x6;
+static constexpr u8 GoAway = 0x7;
+static constexpr u8 WindowUpdate = 0x8;
+static constexpr u8 Continuation = 0x9;
+}
+
+static constexpr u8 flag_end_stream = 0x1;
+static constexpr u8 flag_ack = 0x1;
+static constexpr u8 flag_end_headers = 0x4;
+static constexpr u8 flag_padded = 0x8;
+static constexpr u8 flag_priority = 0x20;
+
+static constexpr auto connection_preface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"sv;
+
+struct Frame {
+    u8 type { 0 };
+    u8 flags { 0 };
+    u32 stream_id { 0 };
+    ByteBuffer payload;
+};
+
+static ByteBuffer make_frame(u8 type, u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    ByteBuffer frame;
+    frame.append(static_cast<u8>(payload.size() >> 16));
+    frame.append(static_cast<u8>(payload.size() >> 8));
+    frame.append(static_cast<u8>(payload.size()));
+    frame.append(type);
+    frame.append(flags);
+    BigEndian<u32> big_endian_stream_id = stream_id;
+    frame.append(&big_endian_stream_id, sizeof(big_endian_stream_id));
+    frame.append(payload);
+    return frame;
+}
+
+static ByteBuffer u32_payload(u32 value)
+{
+    BigEndian<u32> big_endian_value = value;
+    return MUST(ByteBuffer::copy(&big_endian_value, sizeof(big_endian_value)));
+}
+
+static u32 read_u32(ReadonlyBytes bytes)
+{
+    return (static_cast<u32>(bytes[0]) << 24) | (static_cast<u32>(bytes[1]) << 16) | (static_cast<u32>(bytes[2]) << 8) | bytes[3];
+}
+
+// Stands in for the server: whatever it receives is handed to the connection right away,
+// and whatever the connection writes is kept to be looked at frame by frame.
+class MockSocket final : public Core::Stream::Socket {
+public:
+    virtual ErrorOr<Bytes> read(Bytes bytes) override { return m_incoming.read(bytes); }
+    virtual ErrorOr<size_t> write(ReadonlyBytes bytes) override
+    {
+        TRY(m_outgoing.try_append(bytes));
+        return bytes.size();
+    }
+    virtual bool is_eof() const override { return m_is_eof && m_incoming.used_buffer_size() == 0; }
+    virtual bool is_open() const override { return !m_is_closed; }
+    virtual void close() override { m_is_closed = true; }
+    virtual ErrorOr<size_t> pending_bytes() const override { return m_incoming.used_buffer_size(); }
+    virtual ErrorOr<bool> can_read_without_blocking(int) const override { return m_incoming.used_buffer_size() > 0; }
+    virtual ErrorOr<void> set_blocking(bool) override { return {}; }
+    virtual ErrorOr<void> set_close_on_exec(bool) override { return {}; }
+
+    // Delivers the bytes in pieces of the given size, as a server that's slow to send them might.
+    void receive(ReadonlyBytes bytes, size_t piece_size = SIZE_MAX)
+    {
+        for (size_t offset = 0; offset < bytes.size(); offset += piece_size) {
+            MUST(m_incoming.write_entire_buffer(bytes.slice(offset, min(piece_size, bytes.size() - offset))));
+            if (on_ready_to_read)
+                on_ready_to_read();
+        }
+    }
+
+    void receive_frame(u8 type, u8 flags, u32 stream_id, ReadonlyBytes payload = {})
+    {
+        receive(make_frame(type, flags, stream_id, payload));
+    }
+
+    // Everything the connection has sent since the last call, after the connection preface.
+    Vector<Frame> take_sent_frames()
+    {
+        auto bytes = m_outgoing.bytes();
+        if (!m_has_taken_preface) {
+            VERIFY(StringView { bytes.trim(connection_preface.length()) } == connection_preface);
+            bytes = bytes.slice(connection_preface.length());
+            m_has_taken_preface = true;
+        }
+
+        Vector<Frame> frames;
+        while (!bytes.is_empty()) {
+            VERIFY(bytes.size() >= 9);
+            size_t length = (bytes[0] << 16) | (bytes[1] << 8) | bytes[2];
+            VERIFY(bytes.size() >= 9 + length);
+            frames.append({ bytes[3], bytes[4], read_u32(bytes.slice(5)) & 0x7fffffff, MUST(ByteBuffer::copy(bytes.slice(9, length))) });
+            bytes = bytes.slice(9 + length);
+        }
+        m_outgoing.clear();
+        return frames;
+    }
+
+    bool is_closed() const { return m_is_closed; }
+
+private:
+    AllocatingMemoryStream m_incoming;
+    ByteBuffer m_outgoing;
+    bool m_has_taken_preface { false };
+    bool m_is_eof { false };
+    bool m_is_closed { false };
+};
+
+struct StreamEvents {
+    Vector<Vector<Header>> headers;
+    ByteBuffer data;
+    bool has_ended { false };
+    Optional<NetworkError> error;
+};
+
+static HTTP::Http2Connection::StreamCallbacks callbacks_for(StreamEvents& events)
+{
+    return {
+        .on_headers = [&events](auto headers, bool end_of_stream) {
+            events.headers.append(move(headers));
+            if (end_of_stream)
+                events.has_ended = true;
+        },
+        .on_data = [&events](auto data, bool end_of_stream) {
+            events.data.append(data);
+            if (end_of_stream)
+                events.has_ended = true;
+        },
+        .on_error = [&events](auto error) { events.error = error; },
+    };
+}
+
+static HTTP::HttpRequest make_request(HTTP::HttpRequest::Method method = HTTP::HttpRequest::Method::GET, ByteBuffer body = {})
+{
+    HTTP::HttpRequest request;
+    request.set_method(method);
+    request.set_url(URL("https://example.com/index.html"sv));
+    request.set_body(move(body));
+    return request;
+}
+
+static ByteBuffer response_header_block(HTTP::HPACK::Encoder& encoder, StringView status = "200"sv)
+{
+    Vector<Header> headers {
+        { ":status", status },
+        { "content-type", "text/plain" },
+    };
+    return MUST(encoder.encode(headers));
+}
+
+static Frame const* find_frame(Vector<Frame> const& frames, u8 type, u32 stream_id)
+{
+    for (auto const& frame : frames) {
+        if (frame.type == type && frame.stream_id == stream_id)
+            return &frame;
+    }
+    return nullptr;
+}
+
+static size_t data_sent_on(Vector<Frame> const& frames, u32 stream_id, bool* ended = nullptr)
+{
+    size_t size = 0;
+    for (auto const& frame : frames) {
+        if (frame.type != FrameType::Data || frame.stream_id != stream_id)
+            continue;
+        size += frame.payload.size();
+        if (ended && (frame.flags & flag_end_stream))
+            *ended = true;
+    }
+    return size;
+}
+
+// A connection that has exchanged settings with the server, and has nothing left to send.
+static NonnullRefPtr<HTTP::Http2Connection> start_connection(MockSocket& socket)
+{
+    auto connection = HTTP::Http2Connection::construct(socket);
+    MUST(connection->start());
+    socket.receive_frame(FrameType::Settings, 0, 0);
+    (void)socket.take_sent_frames();
+    return connection;
+}
+
+TEST_CASE(connection_preface_and_settings)
+{
+    MockSocket socket;
+    auto connection = HTTP::Http2Connection::construct(socket);
+    MUST(connection->start());
+
+    auto frames = socket.take_sent_frames();
+    EXPECT_EQ(frames.size(), 2u);
+    EXPECT_EQ(frames[0].type, FrameType::Settings);
+    EXPECT_EQ(frames[0].stream_id, 0u);
+    EXPECT_EQ(frames[0].payload.size() % 6, 0u);
+    EXPECT_EQ(frames[1].type, FrameType::WindowUpdate);
+    EXPECT_EQ(frames[1].stream_id, 0u);
+
+    // SETTINGS_MAX_CONCURRENT_STREAMS = 1
+    Array<u8, 6> settings { 0x00, 0x03, 0x00, 0x00, 0x00, 0x01 };
+    socket.receive_frame(FrameType::Settings, 0, 0, settings);
+    frames = socket.take_sent_frames();
+    EXPECT_EQ(frames.size(), 1u);
+    EXPECT_EQ(frames[0].type, FrameType::Settings);
+    EXPECT_EQ(frames[0].flags, flag_ack);
+    EXPECT(frames[0].payload.is_empty());
+
+    StreamEvents events;
+    MUST(connection->open_stream(make_request(), callbacks_for(events)));
+    EXPECT(!connection->can_open_stream());
+
+    // Pings are answered with the same payload.
+    Array<u8, 8> ping_payload { 1, 2, 3, 4, 5, 6, 7, 8 };
+    (void)socket.take_sent_frames();
+    socket.receive_frame(FrameType::Ping, 0, 0, ping_payload);
+    frames = socket.take_sent_frames();
+    EXPECT_EQ(frames.size(), 1u);
+    EXPECT_EQ(frames[0].type, FrameType::Ping);
+    EXPECT_EQ(frames[0].flags, flag_ack);
+    EXPECT_EQ(frames[0].payload.bytes(), ping_payload.span());
+}
+
+TEST_CASE(frames_split_at_every_offset)
+{
+    for (size_t piece_size = 1; piece_size <= 32; ++piece_size) {
+        MockSocket socket;
+        auto connection = start_connection(socket);
+
+        StreamEvents events;
+        auto stream_id = MUST(connection->open_stream(make_request(), callbacks_for(events)));
+        EXPECT_EQ(stream_id, 1u);
+
+        auto frames = socket.take_sent_frames();
+        EXPECT_EQ(frames.size(), 1u);
+        EXPECT_EQ(frames[0].type, FrameType::Headers);
+        EXPECT_EQ(frames[0].flags, flag_end_headers | flag_end_stream);
+        EXPECT_EQ(frames[0].stream_id, 1u);
+
+        HTTP::HPACK::Decoder decoder;
+        auto request_headers = MUST(decoder.decode(frames[0].payload));
+        EXPECT_EQ(request_headers[0].name, ":method");
+        EXPECT_EQ(request_headers[0].value, "GET");
+        EXPECT_EQ(request_headers[3].name, ":path");
+        EXPECT_EQ(request_headers[3].value, "/index.html");
+
+        HTTP::HPACK::Encoder encoder;
+        ByteBuffer response;
+        response.append(make_frame(FrameType::Headers, flag_end_headers, 1, response_header_block(encoder)));
+        response.append(make_frame(FrameType::Data, 0, 1, "Hello, "sv.bytes()));
+        response.append(make_frame(FrameType::Data, flag_end_stream, 1, "world!"sv.bytes()));
+        socket.receive(response, piece_size);
+
+        EXPECT_EQ(events.headers.size(), 1u);
+        if (!events.headers.is_empty()) {
+            EXPECT_EQ(events.headers[0][0].name, ":status");
+            EXPECT_EQ(events.headers[0][0].value, "200");
+        }
+        EXPECT_EQ(StringView { events.data.bytes() }, "Hello, world!"sv);
+        EXPECT(events.has_ended);
+        EXPECT(!events.error.has_value());
+        EXPECT_EQ(connection->active_stream_count(), 0u);
+        EXPECT(connection->is_open());
+    }
+}
+
+TEST_CASE(padding)
+{
+    MockSocket socket;
+    auto connection = start_connection(socket);
+
+    StreamEvents events;
+    MUST(connection->open_stream(make_request(), callbacks_for(events)));
+
+    HTTP::HPACK::Encoder encoder;
+    ByteBuffer headers_payload;
+    headers_payload.append(3); // Pad length
+    headers_payload.append(Array<u8, 5> { 0, 0, 0, 0, 16 }); // Priority
+    headers_payload.append(response_header_block(encoder));
+    headers_payload.append(Array<u8, 3> { 0, 0, 0 });
+    socket.receive_frame(FrameType::Headers, flag_end_headers | flag_padded | flag_priority, 1, headers_payload);
+    EXPECT_EQ(events.headers.size(), 1u);
+
+    ByteBuffer data_payload;
+    data_payload.append(4);
+    data_payload.append("data"sv.bytes());
+    data_payload.append(Array<u8, 4> { 0, 0, 0, 0 });
+    socket.receive_frame(FrameType::Data, flag_padded, 1, data_payload);
+    EXPECT_EQ(StringView { events.data.bytes() }, "data"sv);
+
+    // Nothing but padding.
+    socket.receive_frame(FrameType::Data, flag_padded, 1, Array<u8, 3> { 2, 0, 0 });
+    EXPECT_EQ(StringView { events.data.bytes() }, "data"sv);
+    EXPECT(!events.error.has_value());
+
+    // The padding can't be longer than the frame.
+    socket.receive_frame(FrameType::Data, flag_padded, 1, Array<u8, 3> { 3, 0, 0 });
+    EXPECT_EQ(events.error, NetworkError::ProtocolFailed);
+    EXPECT(!connection->is_open());
+    EXPECT(socket.is_closed());
+
+    auto frames = socket.take_sent_frames();
+    auto const* goaway = find_frame(frames, FrameType::GoAway, 0);
+    EXPECT(goaway);
+    if (goaway)
+        EXPECT_EQ(read_u32(goaway->payload.bytes().slice(4)), 0x1u); // PROTOCOL_ERROR
+}
+
+TEST_CASE(continuation)
+{
+    MockSocket socket;
+    auto connection = start_connection(socket);
+
+    StreamEvents events;
+    MUST(connection->open_stream(make_request(), callbacks_for(events)));
+
+    HTTP::HPACK::Encoder encoder;
+    auto header_block = response_header_block(encoder);
+    VERIFY(header_block.size() >= 3);
+    socket.receive_frame(FrameType::Headers, flag_end_stream, 1, header_block.bytes().trim(1));
+    EXPECT(events.headers.is_empty());
+    socket.receive_frame(FrameType::Continuation, 0, 1, header_block.bytes().slice(1, 1));
+    EXPECT(events.headers.is_empty());
+    socket.receive_frame(FrameType::Continuation, flag_end_headers, 1, header_block.bytes().slice(2));
+
+    EXPECT_EQ(events.headers.size(), 1u);
+    if (!events.headers.is_empty()) {
+        EXPECT_EQ(events.headers[0].size(), 2u);
+        EXPECT_EQ(events.headers[0][1].value, "text/plain");
+    }
+    EXPECT(events.has_ended);
+    EXPECT(connection->is_open());
+
+    // Nothing else may come between the frames of a header block.
+    StreamEvents interrupted_events;
+    MUST(connection->open_stream(make_request(), callbacks_for(interrupted_events)));
+    (void)socket.take_sent_frames();
+    socket.receive_frame(FrameType::Headers, 0, 3, response_header_block(encoder));
+    socket.receive_frame(FrameType::Ping, 0, 0, Array<u8, 8> {});
+    EXPECT_EQ(interrupted_events.error, NetworkError::ProtocolFailed);
+    EXPECT(!connection->is_open());
+    EXPECT(find_frame(socket.take_sent_frames(), FrameType::GoAway, 0));
+}
+
+TEST_CASE(continuation_without_headers)
+{
+    MockSocket socket;
+    auto connection = start_connection(socket);
+
+    StreamEvents events;
+    MUST(connection->open_stream(make_request(), callbacks_for(events)));
+    socket.receive_frame(FrameType::Continuation, flag_end_headers, 1, Array<u8, 1> { 0x88 });
+    EXPECT_EQ(events.error, NetworkError::ProtocolFailed);
+    EXPECT(!connection->is_open());
+}
+
+TEST_CASE(send_flow_control)
+{
+    MockSocket socket;
+    auto connection = start_connection(socket);
+
+    // Both the stream and the connection start out with a window of 65535 bytes.
+    auto body = MUST(ByteBuffer::create_zeroed(100000));
+    StreamEvents events;
+    MUST(connection->open_stream(make_request(HTTP::HttpRequest::Method::POST, move(body)), callbacks_for(events)));
+
+    auto frames = socket.take_sent_frames();
+    bool ended = false;
+    EXPECT_EQ(data_sent_on(frames, 1, &ended), 65535u);
+    EXPECT(!ended);
+    for (auto const& frame : frames)
+        EXPECT(frame.payload.size() <= 16384);
+
+    // Opening up only the stream's window doesn't let anything more through.
+    socket.receive_frame(FrameType::WindowUpdate, 0, 1, u32_payload(50000));
+    EXPECT_EQ(data_sent_on(socket.take_sent_frames(), 1), 0u);
+
+    socket.receive_frame(FrameType::WindowUpdate, 0, 0, u32_payload(10000));
+    EXPECT_EQ(data_sent_on(socket.take_sent_frames(), 1), 10000u);
+
+    socket.receive_frame(FrameType::WindowUpdate, 0, 0, u32_payload(100000));
+    frames = socket.take_sent_frames();
+    EXPECT_EQ(data_sent_on(frames, 1, &ended), 100000u - 65535u - 10000u);
+    EXPECT(ended);
+}
+
+TEST_CASE(initial_window_size_applies_to_open_streams)
+{
+    MockSocket socket;
+    auto connection = start_connection(socket);
+
+    // The connection window stays in the way unless it's opened up first.
+    socket.receive_frame(FrameType::WindowUpdate, 0, 0, u32_payload(1000000));
+
+    // SETTINGS_INITIAL_WINDOW_SIZE = 1000
+    socket.receive_frame(FrameType::Settings, 0, 0, Array<u8, 6> { 0x00, 0x04, 0x00, 0x00, 0x03, 0xe8 });
+    (void)socket.take_sent_frames();
+
+    auto body = MUST(ByteBuffer::create_zeroed(3000));
+    StreamEvents events;
+    MUST(connection->open_stream(make_request(HTTP::HttpRequest::Method::POST, move(body)), callbacks_for(events)));
+    EXPECT_EQ(data_sent_on(socket.take_sent_frames(), 1), 1000u);
+
+    // SETTINGS_INITIAL_WINDOW_SIZE = 3000, which opens up the stream's window by 2000.
+    socket.receive_frame(FrameType::Settings, 0, 0, Array<u8, 6> { 0x00, 0x04, 0x00, 0x00, 0x0b, 0xb8 });
+    bool ended = false;
+    EXPECT_EQ(data_sent_on(socket.take_sent_frames(), 1, &ended), 2000u);
+    EXPECT(ended);
+
+    // A window that grows too big is an error on the stream.
+    socket.receive_frame(FrameType::WindowUpdate, 0, 1, u32_payload(1));
+    EXPECT(!events.error.has_value());
+    socket.receive_frame(FrameType::WindowUpdate, 0, 1, u32_payload(0x7fffffff));
+    EXPECT_EQ(events.error, NetworkError::ProtocolFailed);
+    auto frames = socket.take_sent_frames();
+    auto const* reset = find_frame(frames, FrameType::RstStream, 1);
+    EXPECT(reset);
+    if (reset)
+        EXPECT_EQ(read_u32(reset->payload), 0x3u); // FLOW_CONTROL_ERROR
+    EXPECT(connection->is_open());
+}
+
+TEST_CASE(receive_flow_control)
+{
+    MockSocket socket;
+    auto connection = start_connection(socket);
+
+    StreamEvents events;
+    MUST(connection->open_stream(make_request(), callbacks_for(events)));
+    (void)socket.take_sent_frames();
+
+    HTTP::HPACK::Encoder encoder;
+    socket.receive_frame(FrameType::Headers, flag_end_headers, 1, response_header_block(encoder));
+
+    // The stream's window is 1 MiB, and gets topped up once half of it is used.
+    auto chunk = MUST(ByteBuffer::create_zeroed(16384));
+    size_t received = 0;
+    while (received < 512 * KiB) {
+        EXPECT(!find_frame(socket.take_sent_frames(), FrameType::WindowUpdate, 1));
+        socket.receive_frame(FrameType::Data, 0, 1, chunk);
+        received += chunk.size();
+    }
+    auto frames = socket.take_sent_frames();
+    auto const* window_update = find_frame(frames, FrameType::WindowUpdate, 1);
+    EXPECT(window_update);
+    if (window_update)
+        EXPECT_EQ(read_u32(window_update->payload), received);
+    EXPECT_EQ(events.data.size(), received);
+
+    // Frames can't be bigger than the 16 KiB we allowed.
+    auto too_big = MUST(ByteBuffer::create_zeroed(16385));
+    socket.receive_frame(FrameType::Data, 0, 1, too_big);
+    EXPECT_EQ(events.error, NetworkError::ProtocolFailed);
+    frames = socket.take_sent_frames();
+    auto const* goaway = find_frame(frames, FrameType::GoAway, 0);
+    EXPECT(goaway);
+    if (goaway)
+        EXPECT_EQ(read_u32(goaway->payload.bytes().slice(4)), 0x6u); // FRAME_SIZE_ERROR
+}
+
+TEST_CASE(goaway)
+{
+    MockSocket socket;
+    auto connection = start_connection(socket);
+
+    bool was_closed = false;
+    connection->on_close = [&] { was_closed = true; };
+
+    StreamEvents events[3];
+    for (auto& stream_events : events)
+        MUST(connection->open_stream(make_request(), callbacks_for(stream_events)));
+    EXPECT_EQ(connection->active_stream_count(), 3u);
+
+    // The server got as far as stream 3, so stream 5 never happened.
+    ByteBuffer payload;
+    payload.append(u32_payload(3));
+    payload.append(u32_payload(0)); // NO_ERROR
+    payload.append("shutting down"sv.bytes());
+    socket.receive_frame(FrameType::GoAway, 0, 0, payload);
+
+    EXPECT(was_closed);
+    EXPECT(!connection->is_open());
+    EXPECT(!connection->can_open_stream());
+    EXPECT(connection->open_stream(make_request(), {}).is_error());
+    EXPECT(!events[0].error.has_value());
+    EXPECT(!events[1].error.has_value());
+    EXPECT_EQ(events[2].error, NetworkError::ConnectionFailed);
+    EXPECT_EQ(connection->active_stream_count(), 2u);
+
+    // The streams that did get through still finish.
+    HTTP::HPACK::Encoder encoder;
+    socket.receive_frame(FrameType::Headers, flag_end_headers | flag_end_stream, 3, response_header_block(encoder, "204"sv));
+    EXPECT(events[1].has_ended);
+    EXPECT_EQ(connection->active_stream_count(), 1u);
+    EXPECT(!socket.is_closed());
+
+    // A GOAWAY has to be for the connection.
+    socket.receive_frame(FrameType::GoAway, 0, 1, payload);
+    EXPECT_EQ(events[0].error, NetworkError::ProtocolFailed);
+    EXPECT(socket.is_closed());
+}
+
+TEST_CASE(rst_stream)
+{
+    MockSocket socket;
+    auto connection = start_connection(socket);
+
+    size_t closed_stream_count = 0;
+    connection->on_stream_closed = [&] { ++closed_stream_count; };
+
+    StreamEvents refused_events;
+    StreamEvents cancelled_events;
+    StreamEvents other_events;
+    MUST(connection->open_stream(make_request(), callbacks_for(refused_events)));
+    MUST(connection->open_stream(make_request(), callbacks_for(cancelled_events)));
+    MUST(connection->open_stream(make_request(), callbacks_for(other_events)));
+    (void)socket.take_sent_frames();
+
+    // A refused stream was never processed, so it can safely be retried.
+    socket.receive_frame(FrameType::RstStream, 0, 1, u32_payload(0x7)); // REFUSED_STREAM
+    EXPECT_EQ(refused_events.error, NetworkError::ConnectionFailed);
+    socket.receive_frame(FrameType::RstStream, 0, 3, u32_payload(0x8)); // CANCEL
+    EXPECT_EQ(cancelled_events.error, NetworkError::TransmissionFailed);
+    EXPECT_EQ(closed_stream_count, 2u);
+    EXPECT_EQ(connection->active_stream_count(), 1u);
+
+    // Frames for a stream that was reset are ignored, and don't break the connection.
+    socket.receive_frame(FrameType::Data, flag_end_stream, 1, "late"sv.bytes());
+    EXPECT(refused_events.data.is_empty());
+    EXPECT(connection->is_open());
+    EXPECT(socket.take_sent_frames().is_empty());
+
+    // Cancelling a stream ourselves tells the server.
+    connection->close_stream(5);
+    auto frames = socket.take_sent_frames();
+    EXPECT_EQ(frames.size(), 1u);
+    EXPECT_EQ(frames[0].type, FrameType::RstStream);
+    EXPECT_EQ(frames[0].stream_id, 5u);
+    EXPECT_EQ(read_u32(frames[0].payload), 0x8u);
+    EXPECT(!other_events.error.has_value());
+
+    // RST_STREAM for a stream we never opened is a connection error.
+    socket.receive_frame(FrameType::RstStream, 0, 7, u32_payload(0x8));
+    EXPECT(!connection->is_open());
+    EXPECT(find_frame(socket.take_sent_frames(), FrameType::GoAway, 0));
+}
+
+TEST_CASE(rst_stream_with_wrong_size)
+{
+    MockSocket socket;
+    auto connection = start_connection(socket);
+
+    StreamEvents events;
+    MUST(connection->open_stream(make_request(), callbacks_for(events)));
+    socket.receive_frame(FrameType::RstStream, 0, 1, Array<u8, 3> { 0, 0, 8 });
+    EXPECT_EQ(events.error, NetworkError::ProtocolFailed);
+    EXPECT(socket.is_closed());
+}
@@ -139,3 +139,55 @@ TEST_CASE(catch_exception)
                             "if (hitCatch !== true) throw new Exception('failed');\n"
                             "if (hitFinally !== true) throw new Exception('failed');");
 }
+
+TEST_CASE(register_allocation)
+{
+    SETUP_AND_PARSE("var a = [1, 2, 3];\n"
+                    "var o = { x: a[0] + a[1], y: [a[2], 4] };\n"
+                    "var s = `${o.x}-${o.y[1]}`;\n"
+                    "try {\n"
+                    "    o.z.w;\n"
+                    "} catch (e) {\n"
+                    "    s = s + '!';\n"
+                    "}\n"
+                    "if (s !== '3-4!') throw new Exception('failed');");
+
+    auto executable = MUST(JS::Bytecode::Generator::generate(program));
+    auto number_of_registers = executable->number_of_registers;
+
+    auto& passes = JS::Bytecode::Interpreter::optimization_pipeline(JS::Bytecode::Interpreter::OptimizationLevel::Optimize);
+    passes.perform(*executable);
+    EXPECT(executable->number_of_registers < number_of_registers);
+
+    auto result = bytecode_interpreter.run(*executable);
+    EXPECT(!result.is_error());
+}
+
+TEST_CASE(property_lookup_caches)
+{
+    SETUP_AND_PARSE("function get(o) { return o.x; }\n"
+                    "function set(o, v) { o.x = v; }\n"
+                    "var a = { x: 1 }, b = { y: 0, x: 2 };\n"
+                    "for (var i = 0; i < 10; ++i) {\n"
+                    "    if (get(a) !== 1 || get(b) !== 2) throw new Exception('failed');\n"
+                    "}\n"
+                    "set(a, 3); set(a, 4);\n"
+                    "if (get(a) !== 4) throw new Exception('failed');\n"
+                    "Object.defineProperty(a, 'x', { get() { return 5; } });\n"
+                    "if (get(a) !== 5) throw new Exception('failed');\n"
+                    "Object.freeze(b); set(b, 6);\n"
+                    "if (get(b) !== 2) throw new Exception('failed');\n"
+                    "var c = {};\n"
+                    "for (var i = 0; i < 200; ++i) c['p' + i] = i;\n"
+                    "c.x = 7; get(c); delete c.p0;\n"
+                    "if (get(c) !== 7) throw new Exception('failed');");
+
+    auto executable = MUST(JS::Bytecode::Generator::generate(program));
+    auto statistics_before = JS::Bytecode::g_property_lookup_cache_statistics;
+    auto result = bytecode_interpreter.run(*executable);
+    EXPECT(!result.is_error());
+    if (result.is_error())
+        dbgln("Error: {}", MUST(result.throw_completion().value()->to_deprecated_string(vm)));
+    EXPECT(JS::Bytecode::g_property_lookup_cache_statistics.get_hits > statistics_before.get_hits);
+    EXPECT(JS::Bytecode::g_property_lookup_cache_statistics.put_hits > statistics_before.put_hits);
+}
@@ -7,6 +7,7 @@
 #include <unistd.h>
 
 #include <AK/ScopeGuard.h>
+#include <LibCore/Stream.h>
 #include <LibSQL/BTree.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Heap.h>
@@ -113,6 +114,93 @@ TEST_CASE(create_heap)
     EXPECT_EQ(heap->version(), SQL::Heap::current_version);
 }
 
+TEST_CASE(heap_page_cache)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    EXPECT(!heap->open().is_error());
+
+    auto block = heap->new_record_pointer();
+    auto buffer = MUST(ByteBuffer::copy("First"sv.bytes()));
+    heap->add_to_wal(block, buffer);
+    EXPECT(!heap->flush().is_error());
+    EXPECT(!heap->checkpoint().is_error());
+
+    auto statistics = heap->page_cache_statistics();
+    for (auto i = 0; i < 3; ++i) {
+        auto read_buffer = MUST(heap->read_block(block));
+        EXPECT_EQ(StringView(read_buffer.trim(5)), "First"sv);
+    }
+    EXPECT_EQ(heap->page_cache_statistics().misses, statistics.misses + 1);
+    EXPECT_EQ(heap->page_cache_statistics().hits, statistics.hits + 2);
+
+    // Cached blocks are handed out as they are, not copied.
+    EXPECT_EQ(MUST(heap->read_block(block)).data(), MUST(heap->read_block(block)).data());
+
+    // Writing a cached block must not leave a stale copy in the cache.
+    buffer = MUST(ByteBuffer::copy("Second"sv.bytes()));
+    heap->add_to_wal(block, buffer);
+    EXPECT(!heap->flush().is_error());
+    EXPECT(!heap->checkpoint().is_error());
+    auto read_buffer = MUST(heap->read_block(block));
+    EXPECT_EQ(StringView(read_buffer.trim(6)), "Second"sv);
+}
+
+static ByteBuffer read_file(StringView path)
+{
+    auto file = MUST(Core::Stream::File::open(path, Core::Stream::OpenMode::Read));
+    return MUST(file->read_until_eof());
+}
+
+static void write_file(StringView path, ReadonlyBytes contents)
+{
+    auto file = MUST(Core::Stream::File::open(path, Core::Stream::OpenMode::Write | Core::Stream::OpenMode::Truncate));
+    MUST(file->write_entire_buffer(contents));
+}
+
+TEST_CASE(heap_recover_from_write_ahead_log)
+{
+    ScopeGuard guard([]() {
+        unlink("/tmp/test.db");
+        unlink("/tmp/test.db-wal");
+    });
+
+    u32 block;
+    ByteBuffer heap_contents;
+    ByteBuffer log_contents;
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        EXPECT(!heap->open().is_error());
+
+        block = heap->new_record_pointer();
+        auto buffer = MUST(ByteBuffer::copy("Committed"sv.bytes()));
+        heap->add_to_wal(block, buffer);
+        EXPECT(!heap->flush().is_error());
+
+        // Start a second transaction that never gets its commit record.
+        buffer = MUST(ByteBuffer::copy("Uncommitted"sv.bytes()));
+        heap->add_to_wal(block, buffer);
+
+        // Take a snapshot of the files as they would be if we crashed right now.
+        heap_contents = read_file("/tmp/test.db"sv);
+        log_contents = read_file("/tmp/test.db-wal"sv);
+    }
+
+    EXPECT(heap_contents.is_empty());
+    EXPECT(!log_contents.is_empty());
+
+    // Simulate a torn write of the second transaction at the end of the log.
+    auto torn_log = MUST(ByteBuffer::copy(log_contents));
+    MUST(torn_log.try_append(log_contents.bytes().trim(log_contents.size() / 2)));
+    write_file("/tmp/test.db"sv, heap_contents);
+    write_file("/tmp/test.db-wal"sv, torn_log);
+
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    EXPECT(!heap->open().is_error());
+    auto read_buffer = MUST(heap->read_block(block));
+    EXPECT_EQ(StringView(read_buffer.trim(9)), "Committed"sv);
+}
+
 TEST_CASE(create_from_dev_random)
 {
     auto heap = SQL::Heap::construct("/dev/random");
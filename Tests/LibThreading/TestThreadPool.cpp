@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/Vector.h>
+#include <LibCore/EventLoop.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/ThreadPool.h>
+
+TEST_CASE(parallel_for_visits_every_index_once)
+{
+    auto pool = MUST(Threading::ThreadPool::try_create(4));
+
+    // Chunks never overlap, so the counters don't need to be atomic.
+    Vector<u32> visits;
+    visits.resize(10000);
+    Threading::parallel_for(
+        0, visits.size(), [&](size_t begin, size_t end) {
+            for (auto i = begin; i < end; ++i)
+                ++visits[i];
+        },
+        0, *pool);
+
+    for (auto& visit_count : visits)
+        EXPECT_EQ(visit_count, 1u);
+}
+
+TEST_CASE(nested_parallel_for)
+{
+    // Every outer chunk waits on inner work while holding a worker, which must not deadlock.
+    auto pool = MUST(Threading::ThreadPool::try_create(2));
+
+    Atomic<size_t> sum { 0 };
+    Threading::parallel_for(
+        0, 64, [&](size_t outer_begin, size_t outer_end) {
+            for (auto i = outer_begin; i < outer_end; ++i) {
+                Threading::parallel_for(
+                    0, 100, [&](size_t begin, size_t end) {
+                        sum.fetch_add(end - begin);
+                    },
+                    10, *pool);
+            }
+        },
+        1, *pool);
+
+    EXPECT_EQ(sum.load(), 6400u);
+}
+
+TEST_CASE(task_group_waits_for_all_tasks)
+{
+    auto pool = MUST(Threading::ThreadPool::try_create(3));
+
+    Atomic<int> finished { 0 };
+    {
+        Threading::TaskGroup group { *pool };
+        for (int i = 0; i < 100; ++i)
+            group.spawn([&] { finished.fetch_add(1); });
+        group.wait();
+        EXPECT_EQ(finished.load(), 100);
+    }
+}
+
+TEST_CASE(future_await)
+{
+    auto pool = MUST(Threading::ThreadPool::try_create(2));
+
+    auto future = pool->async<int>([] { return 6 * 7; });
+    EXPECT_EQ(future->await(), 42);
+    EXPECT(future->is_resolved());
+}
+
+TEST_CASE(future_resolves_on_event_loop)
+{
+    Core::EventLoop loop;
+    auto pool = MUST(Threading::ThreadPool::try_create(2));
+
+    auto future = pool->async<int>([] { return 42; });
+    future->on_resolution([&](int& value) {
+        EXPECT_EQ(value, 42);
+        loop.quit(0);
+    });
+    EXPECT_EQ(loop.exec(), 0);
+}
+
+static u64 sum_of_squares(size_t begin, size_t end)
+{
+    u64 sum = 0;
+    for (auto i = begin; i < end; ++i)
+        sum += static_cast<u64>(i) * i;
+    return sum;
+}
+
+static constexpr size_t benchmark_size = 1 << 26;
+
+BENCHMARK_CASE(sum_of_squares_serial)
+{
+    EXPECT_NE(sum_of_squares(0, benchmark_size), 0u);
+}
+
+BENCHMARK_CASE(sum_of_squares_parallel)
+{
+    Atomic<u64> sum { 0 };
+    Threading::parallel_for(0, benchmark_size, [&](size_t begin, size_t end) {
+        sum.fetch_add(sum_of_squares(begin, end));
+    });
+    EXPECT_NE(sum.load(), 0u);
+}
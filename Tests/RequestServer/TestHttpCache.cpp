@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <RequestServer/HttpCache.h>
+#include <time.h>
+
+using RequestServer::HttpCache;
+using RequestServer::ResponseHeaders;
+using RequestHeaders = HashMap<DeprecatedString, DeprecatedString>;
+
+static URL const url { "http://www.example.com/style.css"sv };
+
+static DeprecatedString http_date(time_t timestamp)
+{
+    struct tm tm;
+    gmtime_r(&timestamp, &tm);
+    char buffer[64];
+    strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    return buffer;
+}
+
+static ResponseHeaders response_headers(Vector<Array<StringView, 2>> const& headers)
+{
+    ResponseHeaders result;
+    for (auto const& header : headers)
+        result.set(header[0], header[1]);
+    return result;
+}
+
+static HttpCache& empty_cache()
+{
+    auto& cache = HttpCache::the();
+    cache.clear();
+    return cache;
+}
+
+static void store(HttpCache& cache, ResponseHeaders const& headers, RequestHeaders const& request_headers = {}, StringView body = "body { color: red; }"sv)
+{
+    cache.store(url, request_headers, time(nullptr), 200, headers, MUST(ByteBuffer::copy(body.bytes())));
+}
+
+enum class LookupResult {
+    Miss,
+    Hit,
+    Validation,
+};
+
+static LookupResult lookup(HttpCache& cache, RequestHeaders const& request_headers = {})
+{
+    auto result = cache.lookup(url, request_headers);
+    if (!result.has_value())
+        return LookupResult::Miss;
+    return result->needs_validation ? LookupResult::Validation : LookupResult::Hit;
+}
+
+TEST_CASE(cacheable_requests)
+{
+    EXPECT(HttpCache::is_cacheable_request("GET"sv, {}));
+    EXPECT(HttpCache::is_cacheable_request("get"sv, {}));
+    EXPECT(!HttpCache::is_cacheable_request("POST"sv, {}));
+    EXPECT(!HttpCache::is_cacheable_request("HEAD"sv, {}));
+
+    EXPECT(!HttpCache::is_cacheable_request("GET"sv, { { "Range", "bytes=0-99" } }));
+    EXPECT(!HttpCache::is_cacheable_request("GET"sv, { { "if-none-match", "\"abc\"" } }));
+    EXPECT(!HttpCache::is_cacheable_request("GET"sv, { { "Cache-Control", "max-age=0, no-store" } }));
+    EXPECT(HttpCache::is_cacheable_request("GET"sv, { { "Cache-Control", "no-cache" } }));
+}
+
+TEST_CASE(max_age)
+{
+    auto& cache = empty_cache();
+    EXPECT(lookup(cache) == LookupResult::Miss);
+
+    store(cache, response_headers({ { "Cache-Control"sv, "public, max-age=3600"sv } }));
+    EXPECT(lookup(cache) == LookupResult::Hit);
+
+    auto result = cache.lookup(url, {});
+    EXPECT(result.has_value());
+    auto body = StringView { result->body->bytes() };
+    EXPECT_EQ(body, "body { color: red; }"sv);
+    EXPECT_EQ(result->entry->status_code(), 200u);
+
+    // max-age takes precedence over Expires.
+    store(cache, response_headers({ { "Cache-Control"sv, "max-age=3600"sv }, { "Expires"sv, "0"sv } }));
+    EXPECT(lookup(cache) == LookupResult::Hit);
+}
+
+TEST_CASE(age)
+{
+    auto& cache = empty_cache();
+
+    // The response spent longer in other caches than it was fresh for.
+    store(cache, response_headers({ { "Cache-Control"sv, "max-age=100"sv }, { "Age"sv, "200"sv }, { "ETag"sv, "\"1\""sv } }));
+    EXPECT(lookup(cache) == LookupResult::Validation);
+
+    store(cache, response_headers({ { "Cache-Control"sv, "max-age=300"sv }, { "Age"sv, "200"sv }, { "ETag"sv, "\"1\""sv } }));
+    EXPECT(lookup(cache) == LookupResult::Hit);
+
+    // The Date header says the response was generated a day ago.
+    auto now = time(nullptr);
+    store(cache, response_headers({ { "Cache-Control"sv, "max-age=3600"sv }, { "Date"sv, http_date(now - 24 * 60 * 60) }, { "ETag"sv, "\"1\""sv } }));
+    EXPECT(lookup(cache) == LookupResult::Validation);
+}
+
+TEST_CASE(expires)
+{
+    auto& cache = empty_cache();
+    auto now = time(nullptr);
+
+    store(cache, response_headers({ { "Date"sv, http_date(now) }, { "Expires"sv, http_date(now + 3600) } }));
+    EXPECT(lookup(cache) == LookupResult::Hit);
+
+    store(cache, response_headers({ { "Date"sv, http_date(now) }, { "Expires"sv, http_date(now - 3600) }, { "ETag"sv, "\"1\""sv } }));
+    EXPECT(lookup(cache) == LookupResult::Validation);
+
+    // An invalid date means that the response has already expired.
+    store(cache, response_headers({ { "Expires"sv, "0"sv }, { "ETag"sv, "\"1\""sv } }));
+    EXPECT(lookup(cache) == LookupResult::Validation);
+}
+
+TEST_CASE(heuristic_freshness)
+{
+    auto& cache = empty_cache();
+    auto now = time(nullptr);
+
+    // Unchanged for 100 days, so it's good for a tenth of that, but no longer than a day.
+    store(cache, response_headers({ { "Last-Modified"sv, http_date(now - 100 * 24 * 60 * 60) } }));
+    EXPECT(lookup(cache) == LookupResult::Hit);
+
+    // Changed just now, so it needs to be validated right away.
+    store(cache, response_headers({ { "Last-Modified"sv, http_date(now) } }));
+    EXPECT(lookup(cache) == LookupResult::Validation);
+}
+
+TEST_CASE(not_stored)
+{
+    auto& cache = empty_cache();
+
+    // Stale right away, and there would be no way to validate it.
+    store(cache, response_headers({}));
+    EXPECT(lookup(cache) == LookupResult::Miss);
+    store(cache, response_headers({ { "Cache-Control"sv, "max-age=0"sv } }));
+    EXPECT(lookup(cache) == LookupResult::Miss);
+
+    store(cache, response_headers({ { "Cache-Control"sv, "no-store, max-age=3600"sv } }));
+    EXPECT(lookup(cache) == LookupResult::Miss);
+
+    cache.store(url, {}, time(nullptr), 206, response_headers({ { "Cache-Control"sv, "max-age=3600"sv } }), {});
+    EXPECT(lookup(cache) == LookupResult::Miss);
+
+    store(cache, response_headers({ { "Cache-Control"sv, "max-age=3600"sv }, { "Vary"sv, "*"sv } }));
+    EXPECT(lookup(cache) == LookupResult::Miss);
+}
+
+TEST_CASE(vary)
+{
+    auto& cache = empty_cache();
+
+    auto headers = response_headers({ { "Cache-Control"sv, "max-age=3600"sv }, { "Vary"sv, "Accept-Language, Accept-Encoding"sv } });
+    store(cache, headers, { { "Accept-Language", "en" } }, "english"sv);
+    store(cache, headers, { { "accept-language", "fr" } }, "french"sv);
+
+    auto english = cache.lookup(url, { { "ACCEPT-LANGUAGE", "en" } });
+    EXPECT(english.has_value());
+    EXPECT_EQ(StringView { english->body->bytes() }, "english"sv);
+    auto french = cache.lookup(url, { { "Accept-Language", "fr" } });
+    EXPECT(french.has_value());
+    EXPECT_EQ(StringView { french->body->bytes() }, "french"sv);
+
+    EXPECT(lookup(cache, { { "Accept-Language", "de" } }) == LookupResult::Miss);
+    // A header that was absent from the original request has to be absent from this one too.
+    EXPECT(lookup(cache, {}) == LookupResult::Miss);
+    EXPECT(lookup(cache, { { "Accept-Language", "en" }, { "Accept-Encoding", "gzip" } }) == LookupResult::Miss);
+    // Headers that aren't named by Vary don't matter.
+    EXPECT(lookup(cache, { { "Accept-Language", "en" }, { "User-Agent", "Ladybird" } }) == LookupResult::Hit);
+
+    // A new response replaces the one stored for the same request, but not the other variants.
+    store(cache, headers, { { "Accept-Language", "en" } }, "english, again"sv);
+    english = cache.lookup(url, { { "Accept-Language", "en" } });
+    EXPECT(english.has_value());
+    EXPECT_EQ(StringView { english->body->bytes() }, "english, again"sv);
+    EXPECT(lookup(cache, { { "Accept-Language", "fr" } }) == LookupResult::Hit);
+    EXPECT_EQ(cache.statistics().entry_count, 2u);
+
+    cache.invalidate(url);
+    EXPECT(lookup(cache, { { "Accept-Language", "fr" } }) == LookupResult::Miss);
+    EXPECT_EQ(cache.statistics().entry_count, 0u);
+}
+
+TEST_CASE(validation)
+{
+    auto& cache = empty_cache();
+    auto now = time(nullptr);
+    auto last_modified = http_date(now - 60);
+
+    store(cache, response_headers({ { "Cache-Control"sv, "no-cache"sv }, { "ETag"sv, "\"v1\""sv }, { "Last-Modified"sv, last_modified }, { "Content-Length"sv, "20"sv } }));
+    auto statistics_before = cache.statistics();
+
+    auto result = cache.lookup(url, {});
+    EXPECT(result.has_value());
+    EXPECT(result->needs_validation);
+    EXPECT_EQ(cache.statistics().validations, statistics_before.validations + 1);
+
+    RequestHeaders request_headers;
+    HttpCache::add_validation_headers(result->entry, request_headers);
+    EXPECT_EQ(request_headers.get("If-None-Match").value_or({}), "\"v1\"");
+    EXPECT_EQ(request_headers.get("If-Modified-Since").value_or({}), last_modified);
+
+    // The 304 response freshens the stored one, except for its Content-Length.
+    cache.did_validate(result->entry, now, response_headers({ { "Cache-Control"sv, "max-age=3600"sv }, { "ETag"sv, "\"v2\""sv }, { "Content-Length"sv, "0"sv } }));
+    EXPECT_EQ(cache.statistics().validated_hits, statistics_before.validated_hits + 1);
+    auto const& headers = result->entry->response_headers();
+    EXPECT_EQ(headers.get("ETag").value_or({}), "\"v2\"");
+    EXPECT_EQ(headers.get("Last-Modified").value_or({}), last_modified);
+    EXPECT_EQ(headers.get("Content-Length").value_or({}), "20");
+    EXPECT(lookup(cache) == LookupResult::Hit);
+
+    // The client can insist on validation.
+    EXPECT(lookup(cache, { { "Cache-Control", "no-cache" } }) == LookupResult::Validation);
+    EXPECT(lookup(cache, { { "Cache-Control", "max-age=0" } }) == LookupResult::Validation);
+    EXPECT(lookup(cache, { { "Pragma", "no-cache" } }) == LookupResult::Validation);
+    EXPECT(lookup(cache) == LookupResult::Hit);
+}
+
+TEST_CASE(stale_without_validators)
+{
+    auto& cache = empty_cache();
+
+    // Fresh when it's stored, but once the client wants it validated there's nothing to validate it with.
+    store(cache, response_headers({ { "Cache-Control"sv, "max-age=3600"sv } }));
+    EXPECT(lookup(cache, { { "Cache-Control", "no-cache" } }) == LookupResult::Miss);
+    EXPECT(lookup(cache) == LookupResult::Miss);
+}
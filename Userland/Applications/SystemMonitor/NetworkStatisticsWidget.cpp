@@ -71,6 +71,9 @@ NetworkStatisticsWidget::NetworkStatisticsWidget()
         net_adapters_fields.empend("packets_out", "Pkt Out", Gfx::TextAlignment::CenterRight);
         net_adapters_fields.empend("bytes_in", "Bytes In", Gfx::TextAlignment::CenterRight);
         net_adapters_fields.empend("bytes_out", "Bytes Out", Gfx::TextAlignment::CenterRight);
+        net_adapters_fields.empend("packets_dropped", "Dropped", Gfx::TextAlignment::CenterRight);
+        net_adapters_fields.empend("packets_in_per_second", "Pkt/s In", Gfx::TextAlignment::CenterRight);
+        net_adapters_fields.empend("packets_out_per_second", "Pkt/s Out", Gfx::TextAlignment::CenterRight);
         m_adapter_model = GUI::JsonArrayModel::create("/sys/kernel/net/adapters", move(net_adapters_fields));
         m_adapter_table_view->set_model(MUST(GUI::SortingProxyModel::create(*m_adapter_model)));
         m_adapter_context_menu = MUST(GUI::Menu::try_create());
@@ -77,6 +77,9 @@ u32 Emulator::virt_syscall(u32 function, u32 arg1, u32 arg2, u32 arg3)
         return virt$dup2(arg1, arg2);
     case SC_emuctl:
         return virt$emuctl(arg1, arg2, arg3);
+    case SC_epoll_create1:
+        // FIXME: Emulate event queues. Core::EventLoop falls back to select() without them.
+        return -ENOSYS;
     case SC_execve:
         return virt$execve(arg1);
     case SC_exit:
@@ -142,6 +145,9 @@ u32 Emulator::virt_syscall(u32 function, u32 arg1, u32 arg2, u32 arg3)
         return virt$inode_watcher_add_watch(arg1);
     case SC_inode_watcher_remove_watch:
         return virt$inode_watcher_remove_watch(arg1, arg2);
+    case SC_io_ring_create:
+        // FIXME: Emulate I/O rings. The kernel would access the emulated program's buffers behind our back.
+        return -ENOSYS;
     case SC_ioctl:
         return virt$ioctl(arg1, arg2, arg3);
     case SC_kill:
@@ -206,6 +212,9 @@ u32 Emulator::virt_syscall(u32 function, u32 arg1, u32 arg2, u32 arg3)
         return virt$scheduler_set_parameters(arg1);
     case SC_sendfd:
         return virt$sendfd(arg1, arg2);
+    case SC_sendfile:
+        // FIXME: Emulate sendfile(). Its offset pointer would need to be shadowed.
+        return -ENOSYS;
     case SC_sendmsg:
         return virt$sendmsg(arg1, arg2, arg3);
     case SC_set_coredump_metadata:
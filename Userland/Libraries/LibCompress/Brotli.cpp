@@ -29,7 +29,8 @@ ErrorOr<size_t> BrotliDecompressionStream::CanonicalCode::read_symbol(LittleEndi
 }
 
 BrotliDecompressionStream::BrotliDecompressionStream(Stream& stream)
-    : m_input_stream(MaybeOwned(stream))
+    : m_rewindable_input_stream(MaybeOwned(stream))
+    , m_input_stream(MaybeOwned<Stream>(m_rewindable_input_stream))
 {
 }
 
@@ -573,10 +574,69 @@ size_t BrotliDecompressionStream::literal_code_index_from_context()
     return literal_code_index;
 }
 
+void BrotliDecompressionStream::set_checkpoint()
+{
+    m_rewindable_input_stream.set_checkpoint();
+
+    auto block_position = [](Block const& block) {
+        return Checkpoint::BlockPosition { block.type, block.type_previous, block.length };
+    };
+    m_checkpoint = {
+        .bit_position = m_input_stream.bit_position(),
+        .state = m_current_state,
+        .read_final_block = m_read_final_block,
+        .bytes_left = m_bytes_left,
+        .insert_length = m_insert_length,
+        .copy_length = m_copy_length,
+        .implicit_zero_distance = m_implicit_zero_distance,
+        .distances = { m_distances[0], m_distances[1], m_distances[2], m_distances[3] },
+        .literal_block = block_position(m_literal_block),
+        .insert_and_copy_block = block_position(m_insert_and_copy_block),
+        .distance_block = block_position(m_distance_block),
+    };
+}
+
+void BrotliDecompressionStream::rewind_to_checkpoint()
+{
+    m_rewindable_input_stream.rewind_to_checkpoint();
+
+    auto restore_block_position = [](Block& block, Checkpoint::BlockPosition const& position) {
+        block.type = position.type;
+        block.type_previous = position.type_previous;
+        block.length = position.length;
+    };
+    m_input_stream.set_bit_position(m_checkpoint.bit_position);
+    m_current_state = m_checkpoint.state;
+    m_read_final_block = m_checkpoint.read_final_block;
+    m_bytes_left = m_checkpoint.bytes_left;
+    m_insert_length = m_checkpoint.insert_length;
+    m_copy_length = m_checkpoint.copy_length;
+    m_implicit_zero_distance = m_checkpoint.implicit_zero_distance;
+    for (size_t i = 0; i < 4; ++i)
+        m_distances[i] = m_checkpoint.distances[i];
+    restore_block_position(m_literal_block, m_checkpoint.literal_block);
+    restore_block_position(m_insert_and_copy_block, m_checkpoint.insert_and_copy_block);
+    restore_block_position(m_distance_block, m_checkpoint.distance_block);
+}
+
 ErrorOr<Bytes> BrotliDecompressionStream::read(Bytes output_buffer)
 {
     size_t bytes_read = 0;
+    if (auto result = read_until_out_of_input(output_buffer, bytes_read); result.is_error()) {
+        if (!is_waiting_for_input(result.error()))
+            return result.release_error();
+        rewind_to_checkpoint();
+    }
+    return output_buffer.slice(0, bytes_read);
+}
+
+ErrorOr<void> BrotliDecompressionStream::read_until_out_of_input(Bytes output_buffer, size_t& bytes_read)
+{
     while (bytes_read < output_buffer.size()) {
+        // Copies don't read any input, so they never have to be repeated.
+        if (m_current_state != State::CompressedCopy && m_current_state != State::CompressedDictionary)
+            set_checkpoint();
+
         if (m_current_state == State::WindowSize) {
             size_t window_bits = TRY(read_window_length());
             m_window_size = (1 << window_bits) - 16;
@@ -941,7 +1001,7 @@ ErrorOr<Bytes> BrotliDecompressionStream::read(Bytes output_buffer)
         }
     }
 
-    return output_buffer.slice(0, bytes_read);
+    return {};
 }
 
 bool BrotliDecompressionStream::is_eof() const
@@ -9,6 +9,7 @@
 #include <AK/BitStream.h>
 #include <AK/CircularQueue.h>
 #include <AK/FixedArray.h>
+#include <LibCompress/RewindableStream.h>
 #include <LibCore/Stream.h>
 
 namespace Compress {
@@ -47,11 +48,11 @@ public:
     };
 
     struct Block {
-        size_t type;
-        size_t type_previous;
-        size_t number_of_types;
+        size_t type { 0 };
+        size_t type_previous { 1 };
+        size_t number_of_types { 0 };
 
-        size_t length;
+        size_t length { 0 };
 
         CanonicalCode type_code;
         CanonicalCode length_code;
@@ -114,6 +115,34 @@ public:
     void close() override { m_input_stream.close(); }
 
 private:
+    // Everything a step of decoding may change before it has read all of its input. The rest is either
+    // only changed once it has, or set up again from scratch when a meta-block header is read again.
+    struct Checkpoint {
+        struct BlockPosition {
+            size_t type;
+            size_t type_previous;
+            size_t length;
+        };
+
+        LittleEndianInputBitStream::BitPosition bit_position;
+        State state;
+        bool read_final_block;
+        size_t bytes_left;
+        size_t insert_length;
+        size_t copy_length;
+        bool implicit_zero_distance;
+        size_t distances[4];
+        BlockPosition literal_block;
+        BlockPosition insert_and_copy_block;
+        BlockPosition distance_block;
+    };
+
+    // Decodes until the output buffer is full or the input runs out. In the latter case, we go back to the
+    // last checkpoint, which is set before every step that reads input.
+    ErrorOr<void> read_until_out_of_input(Bytes output_buffer, size_t& bytes_read);
+    void set_checkpoint();
+    void rewind_to_checkpoint();
+
     ErrorOr<size_t> read_window_length();
     ErrorOr<size_t> read_size_number_of_nibbles();
     ErrorOr<size_t> read_variable_length();
@@ -130,7 +159,9 @@ private:
 
     size_t literal_code_index_from_context();
 
+    RewindableStream m_rewindable_input_stream;
     LittleEndianInputBitStream m_input_stream;
+    Checkpoint m_checkpoint;
     State m_current_state { State::WindowSize };
     Optional<LookbackBuffer> m_lookback_buffer;
 
@@ -14,6 +14,8 @@
 #include <string.h>
 
 #include <LibCompress/Deflate.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/ThreadPool.h>
 
 namespace Compress {
 
@@ -182,6 +184,8 @@ ErrorOr<bool> DeflateDecompressor::UncompressedBlock::try_read_more()
     Array<u8, 4096> temporary_buffer;
     auto readable_bytes = temporary_buffer.span().trim(min(m_bytes_remaining, m_decompressor.m_output_buffer.empty_space()));
     auto read_bytes = TRY(m_decompressor.m_input_stream->read(readable_bytes));
+    if (read_bytes.is_empty())
+        return Error::from_string_literal("Unexpected end of input in uncompressed block");
     auto written_bytes = m_decompressor.m_output_buffer.write(read_bytes);
     VERIFY(read_bytes.size() == written_bytes);
 
@@ -196,7 +200,8 @@ ErrorOr<NonnullOwnPtr<DeflateDecompressor>> DeflateDecompressor::construct(Maybe
 }
 
 DeflateDecompressor::DeflateDecompressor(MaybeOwned<AK::Stream> stream, CircularBuffer output_buffer)
-    : m_input_stream(make<LittleEndianInputBitStream>(move(stream)))
+    : m_rewindable_input_stream(move(stream))
+    , m_input_stream(make<LittleEndianInputBitStream>(MaybeOwned<AK::Stream>(m_rewindable_input_stream)))
     , m_output_buffer(move(output_buffer))
 {
 }
@@ -209,65 +214,109 @@ DeflateDecompressor::~DeflateDecompressor()
         m_uncompressed_block.~UncompressedBlock();
 }
 
-ErrorOr<Bytes> DeflateDecompressor::read(Bytes bytes)
+void DeflateDecompressor::set_checkpoint()
 {
-    size_t total_read = 0;
-    while (total_read < bytes.size()) {
-        auto slice = bytes.slice(total_read);
+    m_rewindable_input_stream.set_checkpoint();
+    m_checkpoint_bit_position = m_input_stream->bit_position();
+}
 
-        if (m_state == State::Idle) {
-            if (m_read_final_bock)
-                break;
+void DeflateDecompressor::rewind_to_checkpoint()
+{
+    m_rewindable_input_stream.rewind_to_checkpoint();
+    m_input_stream->set_bit_position(m_checkpoint_bit_position);
+}
 
-            m_read_final_bock = TRY(m_input_stream->read_bit());
-            auto const block_type = TRY(m_input_stream->read_bits(2));
+ErrorOr<void> DeflateDecompressor::read_block_header()
+{
+    // Nothing may change before we've read all of the header, as we may have to start over.
+    auto const is_final_block = TRY(m_input_stream->read_bit());
+    auto const block_type = TRY(m_input_stream->read_bits(2));
 
-            if (block_type == 0b00) {
-                m_input_stream->align_to_byte_boundary();
+    if (block_type == 0b00) {
+        m_input_stream->align_to_byte_boundary();
 
-                LittleEndian<u16> length, negated_length;
-                TRY(m_input_stream->read(length.bytes()));
-                TRY(m_input_stream->read(negated_length.bytes()));
+        LittleEndian<u16> length, negated_length;
+        TRY(m_input_stream->read_entire_buffer(length.bytes()));
+        TRY(m_input_stream->read_entire_buffer(negated_length.bytes()));
 
-                if ((length ^ 0xffff) != negated_length)
-                    return Error::from_string_literal("Calculated negated length does not equal stored negated length");
+        if ((length ^ 0xffff) != negated_length)
+            return Error::from_string_literal("Calculated negated length does not equal stored negated length");
 
-                m_state = State::ReadingUncompressedBlock;
-                new (&m_uncompressed_block) UncompressedBlock(*this, length);
+        m_read_final_bock = is_final_block;
+        m_state = State::ReadingUncompressedBlock;
+        new (&m_uncompressed_block) UncompressedBlock(*this, length);
+        return {};
+    }
 
-                continue;
-            }
+    if (block_type == 0b01) {
+        m_read_final_bock = is_final_block;
+        m_state = State::ReadingCompressedBlock;
+        new (&m_compressed_block) CompressedBlock(*this, CanonicalCode::fixed_literal_codes(), CanonicalCode::fixed_distance_codes());
+        return {};
+    }
 
-            if (block_type == 0b01) {
-                m_state = State::ReadingCompressedBlock;
-                new (&m_compressed_block) CompressedBlock(*this, CanonicalCode::fixed_literal_codes(), CanonicalCode::fixed_distance_codes());
+    if (block_type == 0b10) {
+        CanonicalCode literal_codes;
+        Optional<CanonicalCode> distance_codes;
+        TRY(decode_codes(literal_codes, distance_codes));
 
-                continue;
-            }
+        m_read_final_bock = is_final_block;
+        m_state = State::ReadingCompressedBlock;
+        new (&m_compressed_block) CompressedBlock(*this, literal_codes, distance_codes);
+        return {};
+    }
 
-            if (block_type == 0b10) {
-                CanonicalCode literal_codes;
-                Optional<CanonicalCode> distance_codes;
-                TRY(decode_codes(literal_codes, distance_codes));
+    return Error::from_string_literal("Unhandled block type for Idle state");
+}
 
-                m_state = State::ReadingCompressedBlock;
-                new (&m_compressed_block) CompressedBlock(*this, literal_codes, distance_codes);
+ErrorOr<Bytes> DeflateDecompressor::read(Bytes bytes)
+{
+    size_t total_read = 0;
 
-                continue;
-            }
+    // Returns false if the input ran out before the step was done, in which case we're back to where it started.
+    auto run_step = [this](auto step) -> ErrorOr<bool> {
+        set_checkpoint();
+        auto result = step();
+        if (!result.is_error())
+            return true;
+        if (!is_waiting_for_input(result.error()))
+            return result.release_error();
+        rewind_to_checkpoint();
+        return false;
+    };
+
+    while (total_read < bytes.size()) {
+        auto slice = bytes.slice(total_read);
+
+        if (m_state == State::Idle) {
+            if (m_read_final_bock)
+                break;
 
-            return Error::from_string_literal("Unhandled block type for Idle state");
+            if (!TRY(run_step([&] { return read_block_header(); })))
+                break;
+
+            continue;
         }
 
         if (m_state == State::ReadingCompressedBlock) {
             auto nread = m_output_buffer.read(slice).size();
 
-            while (nread < slice.size() && TRY(m_compressed_block.try_read_more())) {
+            bool ran_out_of_input = false;
+            bool has_more = true;
+            while (nread < slice.size() && has_more) {
+                auto did_finish_step = TRY(run_step([&]() -> ErrorOr<void> {
+                    has_more = TRY(m_compressed_block.try_read_more());
+                    return {};
+                }));
+                if (!did_finish_step) {
+                    ran_out_of_input = true;
+                    break;
+                }
                 nread += m_output_buffer.read(slice.slice(nread)).size();
             }
 
             total_read += nread;
-            if (nread == slice.size())
+            if (nread == slice.size() || ran_out_of_input)
                 break;
 
             m_compressed_block.~CompressedBlock();
@@ -279,12 +328,22 @@ ErrorOr<Bytes> DeflateDecompressor::read(Bytes bytes)
         if (m_state == State::ReadingUncompressedBlock) {
             auto nread = m_output_buffer.read(slice).size();
 
-            while (nread < slice.size() && TRY(m_uncompressed_block.try_read_more())) {
+            bool ran_out_of_input = false;
+            bool has_more = true;
+            while (nread < slice.size() && has_more) {
+                auto did_finish_step = TRY(run_step([&]() -> ErrorOr<void> {
+                    has_more = TRY(m_uncompressed_block.try_read_more());
+                    return {};
+                }));
+                if (!did_finish_step) {
+                    ran_out_of_input = true;
+                    break;
+                }
                 nread += m_output_buffer.read(slice.slice(nread)).size();
             }
 
             total_read += nread;
-            if (nread == slice.size())
+            if (nread == slice.size() || ran_out_of_input)
                 break;
 
             m_uncompressed_block.~UncompressedBlock();
@@ -550,7 +609,7 @@ size_t DeflateCompressor::find_back_match(size_t start, u16 hash, size_t previou
             break; // no remaining candidates
 
         VERIFY(candidate < start);
-        if (start - candidate > window_size)
+        if (start - candidate > max_back_reference_distance)
             break; // outside the window
 
         auto match_length = compare_match_candidate(start, candidate, previous_match_length, maximum_match_length);
@@ -660,6 +719,11 @@ void DeflateCompressor::lz77_compress_block()
         m_hash_head[hash] = window_pos;
     };
 
+    // make the preset dictionary available to back references from this block
+    for (auto position = block_size - m_dictionary_size; position < block_size; position++)
+        insert_hash(position, hash_sequence(&m_rolling_window[position]));
+    m_dictionary_size = 0;
+
     auto emit_literal = [&](auto literal) {
         VERIFY(m_pending_symbol_size <= block_size + 1);
         auto index = m_pending_symbol_size++;
@@ -1015,8 +1079,11 @@ ErrorOr<void> DeflateCompressor::final_flush()
     return {};
 }
 
-ErrorOr<ByteBuffer> DeflateCompressor::compress_all(ReadonlyBytes bytes, CompressionLevel compression_level)
+ErrorOr<ByteBuffer> DeflateCompressor::compress_all(ReadonlyBytes bytes, CompressionLevel compression_level, Parallelism parallelism)
 {
+    if (parallelism == Parallelism::Parallel && bytes.size() > parallel_chunk_size)
+        return compress_all_in_parallel(bytes, compression_level);
+
     auto output_stream = TRY(try_make<AllocatingMemoryStream>());
     auto deflate_stream = TRY(DeflateCompressor::construct(MaybeOwned<AK::Stream>(*output_stream), compression_level));
 
@@ -1029,4 +1096,91 @@ ErrorOr<ByteBuffer> DeflateCompressor::compress_all(ReadonlyBytes bytes, Compres
     return buffer;
 }
 
+void DeflateCompressor::set_dictionary(ReadonlyBytes dictionary)
+{
+    VERIFY(m_pending_block_size == 0);
+    if (dictionary.size() > block_size)
+        dictionary = dictionary.slice(dictionary.size() - block_size);
+    dictionary.copy_to({ m_rolling_window + block_size - dictionary.size(), dictionary.size() });
+    m_dictionary_size = dictionary.size();
+}
+
+ErrorOr<void> DeflateCompressor::finish_on_byte_boundary()
+{
+    VERIFY(!m_finished);
+    if (m_pending_block_size != 0)
+        TRY(flush());
+
+    // An empty non-final uncompressed block pads the output to a byte boundary, so that another stream can follow it (like zlib's Z_SYNC_FLUSH)
+    TRY(m_output_stream->write_bits(0u, 1));
+    TRY(m_output_stream->write_bits(0b00u, 2));
+    TRY(m_output_stream->align_to_byte_boundary());
+    LittleEndian<u16> len = 0;
+    TRY(m_output_stream->write_entire_buffer(len.bytes()));
+    LittleEndian<u16> nlen = 0xffff;
+    TRY(m_output_stream->write_entire_buffer(nlen.bytes()));
+    m_finished = true;
+    return {};
+}
+
+ErrorOr<ByteBuffer> DeflateCompressor::compress_chunk(ReadonlyBytes dictionary, ReadonlyBytes chunk, CompressionLevel compression_level, bool is_last_chunk)
+{
+    auto output_stream = TRY(try_make<AllocatingMemoryStream>());
+    auto deflate_stream = TRY(DeflateCompressor::construct(MaybeOwned<AK::Stream>(*output_stream), compression_level));
+
+    deflate_stream->set_dictionary(dictionary);
+    TRY(deflate_stream->write_entire_buffer(chunk));
+    if (is_last_chunk)
+        TRY(deflate_stream->final_flush());
+    else
+        TRY(deflate_stream->finish_on_byte_boundary());
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(output_stream->used_buffer_size()));
+    TRY(output_stream->read_entire_buffer(buffer));
+    return buffer;
+}
+
+ErrorOr<ByteBuffer> DeflateCompressor::compress_all_in_parallel(ReadonlyBytes bytes, CompressionLevel compression_level)
+{
+    auto chunk_count = ceil_div(bytes.size(), parallel_chunk_size);
+
+    Vector<ByteBuffer> compressed_chunks;
+    TRY(compressed_chunks.try_resize(chunk_count));
+    Threading::Mutex error_mutex;
+    Optional<Error> error;
+
+    Threading::parallel_for(
+        0, chunk_count, [&](size_t begin, size_t end) {
+            for (auto i = begin; i < end; ++i) {
+                auto offset = i * parallel_chunk_size;
+                auto chunk = bytes.slice(offset, min(parallel_chunk_size, bytes.size() - offset));
+                auto dictionary = bytes.slice(0, offset);
+                auto compressed_chunk = compress_chunk(dictionary, chunk, compression_level, i == chunk_count - 1);
+                if (compressed_chunk.is_error()) {
+                    Threading::MutexLocker locker(error_mutex);
+                    if (!error.has_value())
+                        error = compressed_chunk.release_error();
+                    continue;
+                }
+                compressed_chunks[i] = compressed_chunk.release_value();
+            }
+        },
+        1);
+
+    if (error.has_value())
+        return error.release_value();
+
+    size_t total_size = 0;
+    for (auto& chunk : compressed_chunks)
+        total_size += chunk.size();
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(total_size));
+    size_t offset = 0;
+    for (auto& chunk : compressed_chunks) {
+        buffer.overwrite(offset, chunk.data(), chunk.size());
+        offset += chunk.size();
+    }
+    return buffer;
+}
+
 }
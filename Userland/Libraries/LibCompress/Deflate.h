@@ -7,12 +7,14 @@
 
 #pragma once
 
+#include <AK/BitStream.h>
 #include <AK/ByteBuffer.h>
 #include <AK/Endian.h>
 #include <AK/Forward.h>
 #include <AK/MaybeOwned.h>
 #include <AK/Vector.h>
 #include <LibCompress/DeflateTables.h>
+#include <LibCompress/RewindableStream.h>
 #include <LibCore/Stream.h>
 
 namespace Compress {
@@ -92,6 +94,11 @@ private:
     ErrorOr<u32> decode_length(u32);
     ErrorOr<u32> decode_distance(u32);
     ErrorOr<void> decode_codes(CanonicalCode& literal_code, Optional<CanonicalCode>& distance_code);
+    ErrorOr<void> read_block_header();
+
+    // Where the current block header or symbol starts, which we go back to if the input runs out halfway through it.
+    void set_checkpoint();
+    void rewind_to_checkpoint();
 
     bool m_read_final_bock { false };
 
@@ -101,7 +108,9 @@ private:
         UncompressedBlock m_uncompressed_block;
     };
 
+    RewindableStream m_rewindable_input_stream;
     MaybeOwned<LittleEndianInputBitStream> m_input_stream;
+    LittleEndianInputBitStream::BitPosition m_checkpoint_bit_position;
     CircularBuffer m_output_buffer;
 };
 
@@ -109,6 +118,8 @@ class DeflateCompressor final : public AK::Stream {
 public:
     static constexpr size_t block_size = 32 * KiB - 1; // TODO: this can theoretically be increased to 64 KiB - 2
     static constexpr size_t window_size = block_size * 2;
+    static constexpr size_t max_back_reference_distance = 32 * KiB;
+    static constexpr size_t parallel_chunk_size = 128 * KiB;
     static constexpr size_t hash_bits = 15;
     static constexpr size_t max_huffman_literals = 288;
     static constexpr size_t max_huffman_distances = 32;
@@ -140,6 +151,13 @@ public:
         BEST // WARNING: this one can take an unreasonable amount of time!
     };
 
+    enum class Parallelism {
+        Serial,
+        // Splits the input into chunks that are compressed concurrently on the thread pool, each
+        // primed with the end of the previous chunk as a dictionary, and joined into a single stream.
+        Parallel,
+    };
+
     static ErrorOr<NonnullOwnPtr<DeflateCompressor>> construct(MaybeOwned<AK::Stream>, CompressionLevel = CompressionLevel::GOOD);
     ~DeflateCompressor();
 
@@ -150,11 +168,16 @@ public:
     virtual void close() override;
     ErrorOr<void> final_flush();
 
-    static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes bytes, CompressionLevel = CompressionLevel::GOOD);
+    static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes bytes, CompressionLevel = CompressionLevel::GOOD, Parallelism = Parallelism::Serial);
 
 private:
     DeflateCompressor(NonnullOwnPtr<LittleEndianOutputBitStream>, CompressionLevel = CompressionLevel::GOOD);
 
+    static ErrorOr<ByteBuffer> compress_chunk(ReadonlyBytes dictionary, ReadonlyBytes chunk, CompressionLevel, bool is_last_chunk);
+    static ErrorOr<ByteBuffer> compress_all_in_parallel(ReadonlyBytes bytes, CompressionLevel);
+    void set_dictionary(ReadonlyBytes);
+    ErrorOr<void> finish_on_byte_boundary();
+
     Bytes pending_block() { return { m_rolling_window + block_size, block_size }; }
 
     // LZ77 Compression
@@ -189,6 +212,7 @@ private:
 
     u8 m_rolling_window[window_size];
     size_t m_pending_block_size { 0 };
+    size_t m_dictionary_size { 0 }; // bytes right before the pending block that the next block may refer back to
 
     struct [[gnu::packed]] {
         u16 distance; // back reference length
@@ -10,6 +10,7 @@
 #include <AK/DeprecatedString.h>
 #include <AK/MemoryStream.h>
 #include <LibCore/DateTime.h>
+#include <LibThreading/ThreadPool.h>
 
 namespace Compress {
 
@@ -50,7 +51,7 @@ GzipDecompressor::Member::Member(BlockHeader header, NonnullOwnPtr<DeflateDecomp
 {
 }
 
-GzipDecompressor::GzipDecompressor(NonnullOwnPtr<AK::Stream> stream)
+GzipDecompressor::GzipDecompressor(MaybeOwned<AK::Stream> stream)
     : m_input_stream(move(stream))
 {
 }
@@ -60,91 +61,117 @@ GzipDecompressor::~GzipDecompressor()
     m_current_member.clear();
 }
 
-ErrorOr<Bytes> GzipDecompressor::read(Bytes bytes)
+ErrorOr<void> GzipDecompressor::read_member_header()
 {
-    size_t total_read = 0;
-    while (total_read < bytes.size()) {
-        if (is_eof())
-            break;
-
-        auto slice = bytes.slice(total_read);
+    BlockHeader header;
+    Bytes header_bytes { &header, sizeof(header) };
+    size_t header_size_read = 0;
+    while (header_size_read < sizeof(header)) {
+        auto read_bytes = TRY(m_input_stream.read(header_bytes.slice(header_size_read)));
+        if (read_bytes.is_empty())
+            return {}; // partial header at the end of the input
+        header_size_read += read_bytes.size();
+    }
 
-        if (m_current_member) {
-            auto current_slice = TRY(current_member().m_stream->read(slice));
-            current_member().m_checksum.update(current_slice);
-            current_member().m_nread += current_slice.size();
+    if (!header.valid_magic_number())
+        return Error::from_string_literal("Header does not have a valid magic number");
 
-            if (current_slice.size() < slice.size()) {
-                LittleEndian<u32> crc32, input_size;
-                TRY(m_input_stream->read(crc32.bytes()));
-                TRY(m_input_stream->read(input_size.bytes()));
+    if (!header.supported_by_implementation())
+        return Error::from_string_literal("Header is not supported by implementation");
 
-                if (crc32 != current_member().m_checksum.digest())
-                    return Error::from_string_literal("Stored CRC32 does not match the calculated CRC32 of the current member");
+    if (header.flags & Flags::FEXTRA) {
+        LittleEndian<u16> subfield_id, length;
+        TRY(m_input_stream.read_entire_buffer(subfield_id.bytes()));
+        TRY(m_input_stream.read_entire_buffer(length.bytes()));
+        TRY(m_input_stream.discard(length));
+    }
 
-                if (input_size != current_member().m_nread)
-                    return Error::from_string_literal("Input size does not match the number of read bytes");
+    auto discard_string = [&]() -> ErrorOr<void> {
+        char next_char;
+        do {
+            TRY(m_input_stream.read_entire_buffer({ &next_char, sizeof(next_char) }));
+        } while (next_char);
 
-                m_current_member.clear();
+        return {};
+    };
 
-                total_read += current_slice.size();
-                continue;
-            }
+    if (header.flags & Flags::FNAME)
+        TRY(discard_string());
 
-            total_read += current_slice.size();
-            continue;
-        } else {
-            auto current_partial_header_slice = Bytes { m_partial_header, sizeof(BlockHeader) }.slice(m_partial_header_offset);
-            auto current_partial_header_data = TRY(m_input_stream->read(current_partial_header_slice));
-            m_partial_header_offset += current_partial_header_data.size();
+    if (header.flags & Flags::FCOMMENT)
+        TRY(discard_string());
 
-            if (is_eof())
-                break;
+    if (header.flags & Flags::FHCRC) {
+        LittleEndian<u16> crc16;
+        TRY(m_input_stream.read_entire_buffer(crc16.bytes()));
+        // FIXME: we should probably verify this instead of just assuming it matches
+    }
 
-            if (m_partial_header_offset < sizeof(BlockHeader)) {
-                break; // partial header read
-            }
-            m_partial_header_offset = 0;
+    m_current_member = TRY(Member::construct(header, m_input_stream));
+    return {};
+}
 
-            BlockHeader header = *(reinterpret_cast<BlockHeader*>(m_partial_header));
+ErrorOr<void> GzipDecompressor::read_member_trailer()
+{
+    LittleEndian<u32> crc32, input_size;
+    TRY(m_input_stream.read_entire_buffer(crc32.bytes()));
+    TRY(m_input_stream.read_entire_buffer(input_size.bytes()));
 
-            if (!header.valid_magic_number())
-                return Error::from_string_literal("Header does not have a valid magic number");
+    if (crc32 != current_member().m_checksum.digest())
+        return Error::from_string_literal("Stored CRC32 does not match the calculated CRC32 of the current member");
 
-            if (!header.supported_by_implementation())
-                return Error::from_string_literal("Header is not supported by implementation");
+    if (input_size != current_member().m_nread)
+        return Error::from_string_literal("Input size does not match the number of read bytes");
 
-            if (header.flags & Flags::FEXTRA) {
-                LittleEndian<u16> subfield_id, length;
-                TRY(m_input_stream->read(subfield_id.bytes()));
-                TRY(m_input_stream->read(length.bytes()));
-                TRY(m_input_stream->discard(length));
-            }
+    m_current_member.clear();
+    return {};
+}
 
-            auto discard_string = [&]() -> ErrorOr<void> {
-                char next_char;
-                do {
-                    TRY(m_input_stream->read({ &next_char, sizeof(next_char) }));
-                } while (next_char);
+ErrorOr<Bytes> GzipDecompressor::read(Bytes bytes)
+{
+    // Headers and trailers are read again from the start if the input runs out halfway through them.
+    // Returns false in that case, as we have to wait for more input first.
+    auto run_step = [this](auto step) -> ErrorOr<bool> {
+        m_input_stream.set_checkpoint();
+        auto result = step();
+        if (!result.is_error())
+            return true;
+        if (!is_waiting_for_input(result.error()))
+            return result.release_error();
+        m_input_stream.rewind_to_checkpoint();
+        return false;
+    };
 
-                return {};
-            };
+    size_t total_read = 0;
+    while (total_read < bytes.size()) {
+        if (is_eof())
+            break;
 
-            if (header.flags & Flags::FNAME)
-                TRY(discard_string());
+        auto slice = bytes.slice(total_read);
 
-            if (header.flags & Flags::FCOMMENT)
-                TRY(discard_string());
+        if (m_current_member) {
+            // The deflate stream keeps whatever it may have to read again itself.
+            m_input_stream.set_checkpoint();
+            auto current_slice = TRY(current_member().m_stream->read(slice));
+            current_member().m_checksum.update(current_slice);
+            current_member().m_nread += current_slice.size();
+            total_read += current_slice.size();
 
-            if (header.flags & Flags::FHCRC) {
-                LittleEndian<u16> crc16;
-                TRY(m_input_stream->read(crc16.bytes()));
-                // FIXME: we should probably verify this instead of just assuming it matches
+            if (!current_member().m_stream->is_eof()) {
+                if (current_slice.size() < slice.size())
+                    break; // waiting for more input
+                continue;
             }
 
-            m_current_member = TRY(Member::construct(header, *m_input_stream));
+            if (!TRY(run_step([&] { return read_member_trailer(); })))
+                break;
             continue;
         }
+
+        if (!TRY(run_step([&] { return read_member_header(); })))
+            break;
+        if (!m_current_member)
+            break;
     }
     return bytes.slice(0, total_read);
 }
@@ -179,15 +206,16 @@ ErrorOr<ByteBuffer> GzipDecompressor::decompress_all(ReadonlyBytes bytes)
     return output_buffer;
 }
 
-bool GzipDecompressor::is_eof() const { return m_input_stream->is_eof(); }
+bool GzipDecompressor::is_eof() const { return m_input_stream.is_eof() && !m_current_member; }
 
 ErrorOr<size_t> GzipDecompressor::write(ReadonlyBytes)
 {
     return Error::from_errno(EBADF);
 }
 
-GzipCompressor::GzipCompressor(MaybeOwned<AK::Stream> stream)
+GzipCompressor::GzipCompressor(MaybeOwned<AK::Stream> stream, DeflateCompressor::Parallelism parallelism)
     : m_output_stream(move(stream))
+    , m_parallelism(parallelism)
 {
 }
 
@@ -207,12 +235,25 @@ ErrorOr<size_t> GzipCompressor::write(ReadonlyBytes bytes)
     header.extra_flags = 3;      // DEFLATE sets 2 for maximum compression and 4 for minimum compression
     header.operating_system = 3; // unix
     TRY(m_output_stream->write_entire_buffer({ &header, sizeof(header) }));
-    auto compressed_stream = TRY(DeflateCompressor::construct(MaybeOwned(*m_output_stream)));
-    TRY(compressed_stream->write_entire_buffer(bytes));
-    TRY(compressed_stream->final_flush());
-    Crypto::Checksum::CRC32 crc32;
-    crc32.update(bytes);
-    LittleEndian<u32> digest = crc32.digest();
+
+    u32 checksum;
+    if (m_parallelism == DeflateCompressor::Parallelism::Parallel) {
+        // Checksum the input while the other workers compress it.
+        auto crc32 = Threading::ThreadPool::the().async<u32>([bytes] {
+            return Crypto::Checksum::CRC32 { bytes }.digest();
+        });
+        auto compressed = DeflateCompressor::compress_all(bytes, DeflateCompressor::CompressionLevel::GOOD, m_parallelism);
+        // The checksum task still reads from the input, so it has to be done before we can bail out.
+        checksum = crc32->await();
+        TRY(m_output_stream->write_entire_buffer(TRY(compressed)));
+    } else {
+        auto compressed_stream = TRY(DeflateCompressor::construct(MaybeOwned(*m_output_stream)));
+        TRY(compressed_stream->write_entire_buffer(bytes));
+        TRY(compressed_stream->final_flush());
+        checksum = Crypto::Checksum::CRC32 { bytes }.digest();
+    }
+
+    LittleEndian<u32> digest = checksum;
     LittleEndian<u32> size = bytes.size();
     TRY(m_output_stream->write_entire_buffer(digest.bytes()));
     TRY(m_output_stream->write_entire_buffer(size.bytes()));
@@ -233,10 +274,10 @@ void GzipCompressor::close()
 {
 }
 
-ErrorOr<ByteBuffer> GzipCompressor::compress_all(ReadonlyBytes bytes)
+ErrorOr<ByteBuffer> GzipCompressor::compress_all(ReadonlyBytes bytes, DeflateCompressor::Parallelism parallelism)
 {
     auto output_stream = TRY(try_make<AllocatingMemoryStream>());
-    GzipCompressor gzip_stream { MaybeOwned<AK::Stream>(*output_stream) };
+    GzipCompressor gzip_stream { MaybeOwned<AK::Stream>(*output_stream), parallelism };
 
     TRY(gzip_stream.write_entire_buffer(bytes));
 
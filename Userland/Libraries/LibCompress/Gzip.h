@@ -7,7 +7,9 @@
 
 #pragma once
 
+#include <AK/MaybeOwned.h>
 #include <LibCompress/Deflate.h>
+#include <LibCompress/RewindableStream.h>
 #include <LibCore/Stream.h>
 #include <LibCrypto/Checksum/CRC32.h>
 
@@ -40,7 +42,7 @@ struct Flags {
 
 class GzipDecompressor final : public AK::Stream {
 public:
-    GzipDecompressor(NonnullOwnPtr<AK::Stream>);
+    GzipDecompressor(MaybeOwned<AK::Stream>);
     ~GzipDecompressor();
 
     virtual ErrorOr<Bytes> read(Bytes) override;
@@ -70,9 +72,10 @@ private:
     Member const& current_member() const { return *m_current_member; }
     Member& current_member() { return *m_current_member; }
 
-    NonnullOwnPtr<AK::Stream> m_input_stream;
-    u8 m_partial_header[sizeof(BlockHeader)];
-    size_t m_partial_header_offset { 0 };
+    ErrorOr<void> read_member_header();
+    ErrorOr<void> read_member_trailer();
+
+    RewindableStream m_input_stream;
     OwnPtr<Member> m_current_member {};
 
     bool m_eof { false };
@@ -80,7 +83,7 @@ private:
 
 class GzipCompressor final : public AK::Stream {
 public:
-    GzipCompressor(MaybeOwned<AK::Stream>);
+    GzipCompressor(MaybeOwned<AK::Stream>, DeflateCompressor::Parallelism = DeflateCompressor::Parallelism::Serial);
 
     virtual ErrorOr<Bytes> read(Bytes) override;
     virtual ErrorOr<size_t> write(ReadonlyBytes) override;
@@ -88,10 +91,11 @@ public:
     virtual bool is_open() const override;
     virtual void close() override;
 
-    static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes bytes);
+    static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes bytes, DeflateCompressor::Parallelism = DeflateCompressor::Parallelism::Serial);
 
 private:
     MaybeOwned<AK::Stream> m_output_stream;
+    DeflateCompressor::Parallelism m_parallelism;
 };
 
 }
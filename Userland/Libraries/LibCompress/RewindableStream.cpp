@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCompress/RewindableStream.h>
+
+namespace Compress {
+
+RewindableStream::RewindableStream(MaybeOwned<AK::Stream> stream)
+    : m_stream(move(stream))
+{
+}
+
+ErrorOr<Bytes> RewindableStream::read(Bytes bytes)
+{
+    if (m_replay_offset < m_read_since_checkpoint.size()) {
+        auto replayed_size = m_read_since_checkpoint.bytes().slice(m_replay_offset).copy_trimmed_to(bytes);
+        m_replay_offset += replayed_size;
+        return bytes.trim(replayed_size);
+    }
+
+    auto read_bytes = TRY(m_stream->read(bytes));
+    TRY(m_read_since_checkpoint.try_append(read_bytes));
+    m_replay_offset = m_read_since_checkpoint.size();
+    return read_bytes;
+}
+
+ErrorOr<size_t> RewindableStream::write(ReadonlyBytes bytes)
+{
+    return m_stream->write(bytes);
+}
+
+bool RewindableStream::is_eof() const
+{
+    return m_replay_offset == m_read_since_checkpoint.size() && m_stream->is_eof();
+}
+
+bool RewindableStream::is_open() const
+{
+    return m_stream->is_open();
+}
+
+void RewindableStream::close()
+{
+    m_stream->close();
+}
+
+void RewindableStream::set_checkpoint()
+{
+    if (m_replay_offset == m_read_since_checkpoint.size()) {
+        m_read_since_checkpoint.clear();
+    } else {
+        // We were rewound, and haven't gotten as far as before yet.
+        auto remaining = m_read_since_checkpoint.bytes().slice(m_replay_offset);
+        memmove(m_read_since_checkpoint.data(), remaining.data(), remaining.size());
+        m_read_since_checkpoint.resize(remaining.size());
+    }
+    m_replay_offset = 0;
+}
+
+void RewindableStream::rewind_to_checkpoint()
+{
+    m_replay_offset = 0;
+}
+
+}
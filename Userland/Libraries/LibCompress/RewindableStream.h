@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Error.h>
+#include <AK/MaybeOwned.h>
+#include <AK/Noncopyable.h>
+#include <AK/Stream.h>
+
+namespace Compress {
+
+// The decompressors can be fed their input as it arrives: a stream that has nothing to read yet, but will
+// have more later, fails its reads with EAGAIN. The decompressor then goes back to where it was before it
+// started on the current block header or symbol, and returns what it has decoded so far.
+inline bool is_waiting_for_input(Error const& error)
+{
+    return error.is_errno() && error.code() == EAGAIN;
+}
+
+// Keeps everything that was read since the last checkpoint, so that it can be read again after rewinding.
+class RewindableStream final : public AK::Stream {
+    AK_MAKE_NONCOPYABLE(RewindableStream);
+    AK_MAKE_NONMOVABLE(RewindableStream);
+
+public:
+    explicit RewindableStream(MaybeOwned<AK::Stream>);
+
+    virtual ErrorOr<Bytes> read(Bytes) override;
+    virtual ErrorOr<size_t> write(ReadonlyBytes) override;
+    virtual bool is_eof() const override;
+    virtual bool is_open() const override;
+    virtual void close() override;
+
+    // Forgets what was read so far, which we won't have to go back to anymore.
+    void set_checkpoint();
+    void rewind_to_checkpoint();
+
+private:
+    MaybeOwned<AK::Stream> m_stream;
+    ByteBuffer m_read_since_checkpoint;
+    size_t m_replay_offset { 0 };
+};
+
+}
@@ -36,6 +36,11 @@
 #include <time.h>
 #include <unistd.h>
 
+#if defined(AK_OS_SERENITY) || defined(AK_OS_LINUX)
+#    define EVENTLOOP_HAS_EPOLL
+#    include <sys/epoll.h>
+#endif
+
 #ifdef AK_OS_SERENITY
 #    include <LibCore/Account.h>
 
@@ -76,6 +81,117 @@ static thread_local HashTable<Notifier*>* s_notifiers;
 thread_local int EventLoop::s_wake_pipe_fds[2];
 thread_local bool EventLoop::s_wake_pipe_initialized { false };
 
+#ifdef EVENTLOOP_HAS_EPOLL
+// Notifiers are kept registered with a per-thread epoll instance, so that waiting for events doesn't have
+// to hand every file descriptor to the kernel again. If anything about that fails, we fall back to select().
+struct EpollRegistration {
+    Vector<Notifier*, 2> notifiers;
+    u32 registered_events { 0 };
+};
+static thread_local int s_epoll_fd { -1 };
+static thread_local bool s_epoll_unavailable { false };
+static thread_local HashMap<int, EpollRegistration>* s_epoll_registrations;
+
+static void give_up_on_epoll()
+{
+    dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop: Falling back to select(): {}", strerror(errno));
+    if (s_epoll_fd >= 0)
+        close(s_epoll_fd);
+    s_epoll_fd = -1;
+    s_epoll_unavailable = true;
+    s_epoll_registrations->clear();
+}
+
+static u32 epoll_events_for(EpollRegistration const& registration)
+{
+    u32 events = 0;
+    for (auto* notifier : registration.notifiers) {
+        if (notifier->event_mask() & Notifier::Read)
+            events |= EPOLLIN;
+        if (notifier->event_mask() & Notifier::Write)
+            events |= EPOLLOUT;
+        if (notifier->event_mask() & Notifier::Exceptional)
+            VERIFY_NOT_REACHED();
+    }
+    return events;
+}
+
+enum class ForceEpollUpdate {
+    No,
+    Yes,
+};
+
+static void update_epoll_registration(int fd, ForceEpollUpdate force)
+{
+    auto it = s_epoll_registrations->find(fd);
+    if (it == s_epoll_registrations->end())
+        return;
+    auto& registration = it->value;
+
+    if (s_epoll_fd >= 0) {
+        auto events = epoll_events_for(registration);
+        if (events != registration.registered_events || (events != 0 && force == ForceEpollUpdate::Yes)) {
+            epoll_event event {};
+            event.events = events;
+            event.data.fd = fd;
+            int rc = 0;
+            if (events == 0) {
+                // The fd may well have been closed already, which takes it out of the interest set anyway.
+                (void)epoll_ctl(s_epoll_fd, EPOLL_CTL_DEL, fd, &event);
+            } else if (registration.registered_events == 0) {
+                rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, fd, &event);
+                if (rc < 0 && errno == EEXIST)
+                    rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_MOD, fd, &event);
+            } else {
+                // If the fd was closed and reused behind our back, the old registration is gone.
+                rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_MOD, fd, &event);
+                if (rc < 0 && errno == ENOENT)
+                    rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, fd, &event);
+            }
+            if (rc < 0) {
+                give_up_on_epoll();
+                return;
+            }
+            registration.registered_events = events;
+        }
+    }
+
+    if (registration.notifiers.is_empty() && registration.registered_events == 0)
+        s_epoll_registrations->remove(it);
+}
+
+static bool ensure_epoll_instance(int wake_pipe_fd)
+{
+    if (s_epoll_fd >= 0)
+        return true;
+    if (s_epoll_unavailable)
+        return false;
+
+    s_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (s_epoll_fd < 0) {
+        give_up_on_epoll();
+        return false;
+    }
+
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.fd = wake_pipe_fd;
+    if (epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, wake_pipe_fd, &event) < 0) {
+        give_up_on_epoll();
+        return false;
+    }
+
+    Vector<int> fds;
+    for (auto& it : *s_epoll_registrations) {
+        it.value.registered_events = 0;
+        fds.append(it.key);
+    }
+    for (auto fd : fds)
+        update_epoll_registration(fd, ForceEpollUpdate::No);
+    return s_epoll_fd >= 0;
+}
+#endif
+
 void EventLoop::initialize_wake_pipes()
 {
     if (!s_wake_pipe_initialized) {
@@ -330,6 +446,9 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
         s_event_loop_stack = new Vector<EventLoop&>;
         s_timers = new HashMap<int, NonnullOwnPtr<EventLoopTimer>>;
         s_notifiers = new HashTable<Notifier*>;
+#ifdef EVENTLOOP_HAS_EPOLL
+        s_epoll_registrations = new HashMap<int, EpollRegistration>;
+#endif
     }
 
     if (s_event_loop_stack->is_empty()) {
@@ -665,6 +784,14 @@ void EventLoop::notify_forked(ForkEvent event)
         s_event_loop_stack->clear();
         s_timers->clear();
         s_notifiers->clear();
+#ifdef EVENTLOOP_HAS_EPOLL
+        // The epoll instance is shared with our parent, so get our own the next time we wait.
+        if (s_epoll_fd >= 0)
+            close(s_epoll_fd);
+        s_epoll_fd = -1;
+        s_epoll_unavailable = false;
+        s_epoll_registrations->clear();
+#endif
         s_wake_pipe_initialized = false;
         initialize_wake_pipes();
         if (auto* info = signals_info<false>()) {
@@ -682,10 +809,18 @@ void EventLoop::wait_for_event(WaitMode mode)
 {
     fd_set rfds;
     fd_set wfds;
+#ifdef EVENTLOOP_HAS_EPOLL
+    epoll_event epoll_events[64];
+#endif
 retry:
+    bool use_epoll = false;
+#ifdef EVENTLOOP_HAS_EPOLL
+    use_epoll = ensure_epoll_instance(s_wake_pipe_fds[0]);
+#endif
 
     // Set up the file descriptors for select().
     // Basically, we translate high-level event information into low-level selectable file descriptors.
+    // With epoll, the notifiers are already registered with the kernel and there's nothing to do here.
     FD_ZERO(&rfds);
     FD_ZERO(&wfds);
 
@@ -701,13 +836,15 @@ retry:
     add_fd_to_set(s_wake_pipe_fds[0], rfds);
     max_fd = max(max_fd, max_fd_added);
 
-    for (auto& notifier : *s_notifiers) {
-        if (notifier->event_mask() & Notifier::Read)
-            add_fd_to_set(notifier->fd(), rfds);
-        if (notifier->event_mask() & Notifier::Write)
-            add_fd_to_set(notifier->fd(), wfds);
-        if (notifier->event_mask() & Notifier::Exceptional)
-            VERIFY_NOT_REACHED();
+    if (!use_epoll) {
+        for (auto& notifier : *s_notifiers) {
+            if (notifier->event_mask() & Notifier::Read)
+                add_fd_to_set(notifier->fd(), rfds);
+            if (notifier->event_mask() & Notifier::Write)
+                add_fd_to_set(notifier->fd(), wfds);
+            if (notifier->event_mask() & Notifier::Exceptional)
+                VERIFY_NOT_REACHED();
+        }
     }
 
     bool queued_events_is_empty;
@@ -719,13 +856,14 @@ retry:
     // Figure out how long to wait at maximum.
     // This mainly depends on the WaitMode and whether we have pending events, but also the next expiring timer.
     Time now;
+    Time computed_timeout;
     struct timeval timeout = { 0, 0 };
     bool should_wait_forever = false;
     if (mode == WaitMode::WaitForEvents && queued_events_is_empty) {
         auto next_timer_expiration = get_next_timer_expiration();
         if (next_timer_expiration.has_value()) {
             now = Time::now_monotonic_coarse();
-            auto computed_timeout = next_timer_expiration.value() - now;
+            computed_timeout = next_timer_expiration.value() - now;
             if (computed_timeout.is_negative())
                 computed_timeout = Time::zero();
             timeout = computed_timeout.to_timeval();
@@ -736,7 +874,16 @@ retry:
 
 try_select_again:
     // select() and wait for file system events, calls to wake(), POSIX signals, or timer expirations.
-    int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
+    int marked_fd_count;
+#ifdef EVENTLOOP_HAS_EPOLL
+    if (use_epoll) {
+        // to_milliseconds() rounds up, as waking up before the next timer is due would have us spin with a zero timeout until it is.
+        // Also don't let a far-away timer overflow the timeout into a negative value, which would mean forever.
+        int timeout_ms = should_wait_forever ? -1 : static_cast<int>(min(computed_timeout.to_milliseconds(), static_cast<i64>(NumericLimits<int>::max())));
+        marked_fd_count = epoll_wait(s_epoll_fd, epoll_events, array_size(epoll_events), timeout_ms);
+    } else
+#endif
+        marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
     // Because POSIX, we might spuriously return from select() with EINTR; just select again.
     if (marked_fd_count < 0) {
         int saved_errno = errno;
@@ -749,9 +896,20 @@ try_select_again:
         VERIFY_NOT_REACHED();
     }
 
+    bool wake_pipe_is_readable = false;
+#ifdef EVENTLOOP_HAS_EPOLL
+    if (use_epoll) {
+        for (int i = 0; i < marked_fd_count; ++i) {
+            if (epoll_events[i].data.fd == s_wake_pipe_fds[0])
+                wake_pipe_is_readable = true;
+        }
+    } else
+#endif
+        wake_pipe_is_readable = FD_ISSET(s_wake_pipe_fds[0], &rfds);
+
     // We woke up due to a call to wake() or a POSIX signal.
     // Handle signals and see whether we need to handle events as well.
-    if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
+    if (wake_pipe_is_readable) {
         int wake_events[8];
         ssize_t nread;
         // We might receive another signal while read()ing here. The signal will go to the handle_signal properly,
@@ -811,6 +969,26 @@ try_select_again:
         return;
 
     // Handle file system notifiers by making them normal events.
+#ifdef EVENTLOOP_HAS_EPOLL
+    if (use_epoll) {
+        for (int i = 0; i < marked_fd_count; ++i) {
+            auto it = s_epoll_registrations->find(epoll_events[i].data.fd);
+            if (it == s_epoll_registrations->end())
+                continue;
+            // Like select(), consider errors and hangups to make the fd both readable and writable.
+            auto events = epoll_events[i].events;
+            bool is_readable = events & (EPOLLIN | EPOLLERR | EPOLLHUP);
+            bool is_writable = events & (EPOLLOUT | EPOLLERR | EPOLLHUP);
+            for (auto* notifier : it->value.notifiers) {
+                if (is_readable && (notifier->event_mask() & Notifier::Event::Read))
+                    post_event(*notifier, make<NotifierReadEvent>(notifier->fd()));
+                if (is_writable && (notifier->event_mask() & Notifier::Event::Write))
+                    post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
+            }
+        }
+        return;
+    }
+#endif
     for (auto& notifier : *s_notifiers) {
         if (FD_ISSET(notifier->fd(), &rfds)) {
             if (notifier->event_mask() & Notifier::Event::Read)
@@ -885,12 +1063,38 @@ void EventLoop::register_notifier(Badge<Notifier>, Notifier& notifier)
 {
     VERIFY_EVENT_LOOP_INITIALIZED();
     s_notifiers->set(&notifier);
+#ifdef EVENTLOOP_HAS_EPOLL
+    if (s_epoll_unavailable)
+        return;
+    auto& registration = s_epoll_registrations->ensure(notifier.fd());
+    if (!registration.notifiers.contains_slow(&notifier))
+        registration.notifiers.append(&notifier);
+    update_epoll_registration(notifier.fd(), ForceEpollUpdate::Yes);
+#endif
 }
 
 void EventLoop::unregister_notifier(Badge<Notifier>, Notifier& notifier)
 {
     VERIFY_EVENT_LOOP_INITIALIZED();
     s_notifiers->remove(&notifier);
+#ifdef EVENTLOOP_HAS_EPOLL
+    auto it = s_epoll_registrations->find(notifier.fd());
+    if (it == s_epoll_registrations->end())
+        return;
+    it->value.notifiers.remove_first_matching([&](auto* candidate) { return candidate == &notifier; });
+    update_epoll_registration(notifier.fd(), ForceEpollUpdate::No);
+#endif
+}
+
+void EventLoop::notifier_event_mask_changed(Badge<Notifier>, Notifier& notifier)
+{
+    VERIFY_EVENT_LOOP_INITIALIZED();
+#ifdef EVENTLOOP_HAS_EPOLL
+    if (s_notifiers->contains(&notifier))
+        update_epoll_registration(notifier.fd(), ForceEpollUpdate::No);
+#else
+    (void)notifier;
+#endif
 }
 
 void EventLoop::wake_current()
@@ -4,18 +4,107 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Platform.h>
 #include <AK/Span.h>
 #include <AK/Types.h>
 #include <LibCrypto/Checksum/Adler32.h>
 
+#if ARCH(X86_64)
+#    include <cpuid.h>
+#    include <immintrin.h>
+#endif
+
 namespace Crypto::Checksum {
 
+static constexpr u32 modulus = 65521;
+// The largest number of bytes for which the sums can't overflow 32 bits before we have to reduce them.
+static constexpr size_t max_bytes_between_reductions = 5552;
+
+static void update_scalar(u32& a, u32& b, ReadonlyBytes data)
+{
+    while (!data.is_empty()) {
+        auto chunk = data.trim(max_bytes_between_reductions);
+        for (auto byte : chunk) {
+            a += byte;
+            b += a;
+        }
+        a %= modulus;
+        b %= modulus;
+        data = data.slice(chunk.size());
+    }
+}
+
+#if ARCH(X86_64)
+// Processes 32 bytes per iteration: the bytes are summed horizontally for a, and multiplied with their
+// distance from the end of the 32-byte block and summed for b. The b contribution of the running value
+// of a is accounted for separately, as 32 times the sum of a at the start of every block.
+[[gnu::target("ssse3")]] static void update_ssse3(u32& a, u32& b, u8 const* bytes, size_t block_count)
+{
+    static constexpr size_t block_size = 32;
+
+    auto const weights_high = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+    auto const weights_low = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    auto const zero = _mm_setzero_si128();
+    auto const ones = _mm_set1_epi16(1);
+
+    while (block_count > 0) {
+        auto blocks = min(block_count, max_bytes_between_reductions / block_size);
+        block_count -= blocks;
+
+        auto previous_a_sums = _mm_set_epi32(0, 0, 0, static_cast<int>(a * blocks));
+        auto b_sums = _mm_set_epi32(0, 0, 0, static_cast<int>(b));
+        auto a_sums = _mm_setzero_si128();
+
+        for (size_t i = 0; i < blocks; ++i) {
+            auto first_half = _mm_loadu_si128(reinterpret_cast<__m128i const*>(bytes));
+            auto second_half = _mm_loadu_si128(reinterpret_cast<__m128i const*>(bytes + 16));
+
+            previous_a_sums = _mm_add_epi32(previous_a_sums, a_sums);
+
+            a_sums = _mm_add_epi32(a_sums, _mm_sad_epu8(first_half, zero));
+            b_sums = _mm_add_epi32(b_sums, _mm_madd_epi16(_mm_maddubs_epi16(first_half, weights_high), ones));
+            a_sums = _mm_add_epi32(a_sums, _mm_sad_epu8(second_half, zero));
+            b_sums = _mm_add_epi32(b_sums, _mm_madd_epi16(_mm_maddubs_epi16(second_half, weights_low), ones));
+
+            bytes += block_size;
+        }
+
+        b_sums = _mm_add_epi32(b_sums, _mm_slli_epi32(previous_a_sums, 5));
+
+        // Add up the lanes.
+        a_sums = _mm_add_epi32(a_sums, _mm_shuffle_epi32(a_sums, _MM_SHUFFLE(1, 0, 3, 2)));
+        a += static_cast<u32>(_mm_cvtsi128_si32(a_sums));
+        b_sums = _mm_add_epi32(b_sums, _mm_shuffle_epi32(b_sums, _MM_SHUFFLE(2, 3, 0, 1)));
+        b_sums = _mm_add_epi32(b_sums, _mm_shuffle_epi32(b_sums, _MM_SHUFFLE(1, 0, 3, 2)));
+        b = static_cast<u32>(_mm_cvtsi128_si32(b_sums));
+
+        a %= modulus;
+        b %= modulus;
+    }
+}
+
+static bool has_ssse3()
+{
+    static bool const s_has_ssse3 = [] {
+        u32 eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+            return false;
+        return (ecx & bit_SSSE3) != 0;
+    }();
+    return s_has_ssse3;
+}
+#endif
+
 void Adler32::update(ReadonlyBytes data)
 {
-    for (size_t i = 0; i < data.size(); i++) {
-        m_state_a = (m_state_a + data.at(i)) % 65521;
-        m_state_b = (m_state_b + m_state_a) % 65521;
+#if ARCH(X86_64)
+    if (data.size() >= 32 && has_ssse3()) {
+        auto block_count = data.size() / 32;
+        update_ssse3(m_state_a, m_state_b, data.data(), block_count);
+        data = data.slice(block_count * 32);
     }
+#endif
+    update_scalar(m_state_a, m_state_b, data);
 };
 
 u32 Adler32::digest()
@@ -117,7 +117,8 @@ Optional<Packet> Packet::from_raw_packet(u8 const* raw_data, size_t raw_size)
     packet.m_code = header.response_code();
 
     // FIXME: Should we parse further in this case?
-    if (packet.code() != Code::NOERROR)
+    //        A name that doesn't exist is still an answer to the question though, which can be cached.
+    if (packet.code() != Code::NOERROR && packet.code() != Code::NXDOMAIN)
         return packet;
 
     size_t offset = sizeof(PacketHeader);
@@ -175,6 +176,26 @@ Optional<Packet> Packet::from_raw_packet(u8 const* raw_data, size_t raw_size)
         offset += record.data_length();
     }
 
+    for (u16 i = 0; i < header.authority_count(); ++i) {
+        (void)Name::parse(raw_data, offset, raw_size);
+        if (offset + sizeof(DNSRecordWithoutName) > raw_size)
+            break;
+
+        auto& record = *(DNSRecordWithoutName const*)(&raw_data[offset]);
+        offset += sizeof(DNSRecordWithoutName);
+        if (offset + record.data_length() > raw_size)
+            break;
+
+        // The SOA record ends with the MINIMUM field, which says how long negative answers from the zone may be cached.
+        if ((RecordType)record.type() == RecordType::SOA && record.data_length() >= sizeof(u32)) {
+            auto const* minimum_field = (NetworkOrdered<u32> const*)&raw_data[offset + record.data_length() - sizeof(u32)];
+            u32 negative_caching_ttl = min<u32>(record.ttl(), *minimum_field);
+            packet.m_negative_caching_ttl = min(packet.m_negative_caching_ttl.value_or(negative_caching_ttl), negative_caching_ttl);
+            dbgln_if(LOOKUPSERVER_DEBUG, "Authority #{}: SOA, negative caching TTL {}", i, negative_caching_ttl);
+        }
+        offset += record.data_length();
+    }
+
     return packet;
 }
 
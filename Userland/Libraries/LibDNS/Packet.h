@@ -59,6 +59,9 @@ public:
     void add_question(Question const&);
     void add_answer(Answer const&);
 
+    // How long the absence of an answer may be cached, taken from the SOA record in the authority section (RFC 2308).
+    Optional<u32> negative_caching_ttl() const { return m_negative_caching_ttl; }
+
     enum class Code : u8 {
         NOERROR = 0,
         FORMERR = 1,
@@ -84,6 +87,7 @@ private:
     bool m_recursion_available { true };
     Vector<Question> m_questions;
     Vector<Answer> m_answers;
+    Optional<u32> m_negative_caching_ttl;
 };
 
 }
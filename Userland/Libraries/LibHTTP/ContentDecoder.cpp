@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <LibCompress/Brotli.h>
+#include <LibCompress/Deflate.h>
+#include <LibCompress/Gzip.h>
+#include <LibCompress/Zlib.h>
+#include <LibHTTP/ContentDecoder.h>
+
+namespace HTTP {
+
+static constexpr size_t output_chunk_size = 4 * KiB;
+
+ErrorOr<OwnPtr<ContentDecoder>> ContentDecoder::create(StringView content_encoding)
+{
+    auto encoding = content_encoding.trim_whitespace();
+    if (encoding.equals_ignoring_case("gzip"sv) || encoding.equals_ignoring_case("x-gzip"sv))
+        return adopt_nonnull_own_or_enomem(new (nothrow) ContentDecoder(Encoding::Gzip));
+    if (encoding.equals_ignoring_case("deflate"sv))
+        return adopt_nonnull_own_or_enomem(new (nothrow) ContentDecoder(Encoding::Deflate));
+    if (encoding.equals_ignoring_case("br"sv))
+        return adopt_nonnull_own_or_enomem(new (nothrow) ContentDecoder(Encoding::Brotli));
+    return nullptr;
+}
+
+ErrorOr<void> ContentDecoder::create_decompressor()
+{
+    switch (m_encoding) {
+    case Encoding::Gzip:
+        m_decompressor = TRY(try_make<Compress::GzipDecompressor>(MaybeOwned<AK::Stream>(m_input)));
+        break;
+    case Encoding::Deflate: {
+        // Even though the content encoding is "deflate", it's actually deflate with the zlib wrapper.
+        // https://tools.ietf.org/html/rfc7230#section-4.2.2
+        // From the RFC:
+        // "Note: Some non-conformant implementations send the "deflate"
+        //        compressed data without the zlib wrapper."
+        // We tell the two apart by the header, and never look at the trailing checksum.
+        u8 header_buffer[sizeof(Compress::ZlibHeader)];
+        auto header_bytes = TRY(m_input.buffer().read({ header_buffer, sizeof(header_buffer) }));
+        bool has_zlib_header = false;
+        if (header_bytes.size() == sizeof(Compress::ZlibHeader)) {
+            Compress::ZlibHeader header { .as_u16 = header_bytes[0] << 8 | header_bytes[1] };
+            has_zlib_header = header.compression_method == Compress::ZlibCompressionMethod::Deflate && header.compression_info <= 7
+                && !header.present_dictionary && header.as_u16 % 31 == 0;
+        }
+        if (!has_zlib_header) {
+            dbgln_if(JOB_DEBUG, "ContentDecoder: No zlib header, treating the body as raw deflate data");
+            auto raw_input = TRY(ByteBuffer::copy(header_bytes));
+            TRY(raw_input.try_append(TRY(m_input.buffer().read_until_eof())));
+            TRY(m_input.write_entire_buffer(raw_input));
+        }
+        m_decompressor = TRY(Compress::DeflateDecompressor::construct(MaybeOwned<AK::Stream>(m_input)));
+        break;
+    }
+    case Encoding::Brotli:
+        m_decompressor = TRY(try_make<Compress::BrotliDecompressionStream>(m_input));
+        break;
+    }
+    return {};
+}
+
+ErrorOr<Bytes> ContentDecoder::InputStream::read(Bytes bytes)
+{
+    if (m_buffer.is_eof() && !m_is_complete)
+        return Error::from_errno(EAGAIN);
+    return m_buffer.read(bytes);
+}
+
+ErrorOr<ByteBuffer> ContentDecoder::decode(ReadonlyBytes bytes)
+{
+    TRY(m_input.write_entire_buffer(bytes));
+    return decode_buffered_input();
+}
+
+ErrorOr<ByteBuffer> ContentDecoder::finish()
+{
+    m_input.set_complete();
+    // An empty body stays empty, whatever its encoding claims.
+    if (!m_decompressor && m_input.buffered_size() == 0)
+        return ByteBuffer {};
+    return decode_buffered_input();
+}
+
+ErrorOr<ByteBuffer> ContentDecoder::decode_buffered_input()
+{
+    ByteBuffer output;
+    if (!m_decompressor) {
+        // We can't tell what kind of deflate data this is until we have its first bytes.
+        if (m_encoding == Encoding::Deflate && m_input.buffered_size() < sizeof(Compress::ZlibHeader) && !m_input.is_complete())
+            return output;
+        TRY(create_decompressor());
+    }
+
+    // The decompressors only come up short once they've run out of input, or reached the end of their data.
+    while (!m_decompressor->is_eof()) {
+        auto chunk = TRY(output.get_bytes_for_writing(output_chunk_size));
+        auto decoded = TRY(m_decompressor->read(chunk));
+        output.resize(output.size() - (chunk.size() - decoded.size()));
+        if (decoded.size() < chunk.size())
+            break;
+    }
+
+    dbgln_if(JOB_DEBUG, "ContentDecoder: Decoded {} bytes, {} bytes of input left buffered", output.size(), m_input.buffered_size());
+    return output;
+}
+
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/MemoryStream.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/OwnPtr.h>
+
+namespace HTTP {
+
+// Decodes a response body with a Content-Encoding piece by piece as it arrives, so that the decoded
+// body can be passed on right away instead of once the entire encoded body has been received.
+class ContentDecoder {
+public:
+    // Returns null for encodings we don't know, in which case the body should be passed on as it is.
+    static ErrorOr<OwnPtr<ContentDecoder>> create(StringView content_encoding);
+
+    // Takes the next part of the encoded body, and returns as much of the decoded body as it allows us to decode.
+    ErrorOr<ByteBuffer> decode(ReadonlyBytes);
+
+    // Returns whatever is left of the decoded body, once all of the encoded body has been received.
+    ErrorOr<ByteBuffer> finish();
+
+private:
+    enum class Encoding {
+        Gzip,
+        Deflate,
+        Brotli,
+    };
+
+    explicit ContentDecoder(Encoding encoding)
+        : m_encoding(encoding)
+    {
+    }
+
+    // The encoded body we have so far. Reading past its end fails with EAGAIN until we know that there's no more
+    // to come, which the decompressors take as their cue to stop and carry on with the rest once it's here.
+    class InputStream final : public AK::Stream {
+    public:
+        virtual ErrorOr<Bytes> read(Bytes) override;
+        virtual ErrorOr<size_t> write(ReadonlyBytes bytes) override { return m_buffer.write(bytes); }
+        virtual bool is_eof() const override { return m_is_complete && m_buffer.is_eof(); }
+        virtual bool is_open() const override { return true; }
+        virtual void close() override { }
+
+        size_t buffered_size() const { return m_buffer.used_buffer_size(); }
+        AllocatingMemoryStream& buffer() { return m_buffer; }
+
+        bool is_complete() const { return m_is_complete; }
+        void set_complete() { m_is_complete = true; }
+
+    private:
+        AllocatingMemoryStream m_buffer;
+        bool m_is_complete { false };
+    };
+
+    ErrorOr<void> create_decompressor();
+    ErrorOr<ByteBuffer> decode_buffered_input();
+
+    Encoding m_encoding;
+    InputStream m_input;
+    OwnPtr<AK::Stream> m_decompressor;
+};
+
+}
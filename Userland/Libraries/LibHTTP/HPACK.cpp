@@ -0,0 +1,494 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/StringView.h>
+#include <LibHTTP/HPACK.h>
+
+namespace HTTP::HPACK {
+
+struct StaticTableEntry {
+    StringView name;
+    StringView value;
+};
+
+// RFC 7541, Appendix A. Index 1 is the first entry.
+static constexpr Array<StaticTableEntry, 61> s_static_table { {
+    { ":authority"sv, ""sv },
+    { ":method"sv, "GET"sv },
+    { ":method"sv, "POST"sv },
+    { ":path"sv, "/"sv },
+    { ":path"sv, "/index.html"sv },
+    { ":scheme"sv, "http"sv },
+    { ":scheme"sv, "https"sv },
+    { ":status"sv, "200"sv },
+    { ":status"sv, "204"sv },
+    { ":status"sv, "206"sv },
+    { ":status"sv, "304"sv },
+    { ":status"sv, "400"sv },
+    { ":status"sv, "404"sv },
+    { ":status"sv, "500"sv },
+    { "accept-charset"sv, ""sv },
+    { "accept-encoding"sv, "gzip, deflate"sv },
+    { "accept-language"sv, ""sv },
+    { "accept-ranges"sv, ""sv },
+    { "accept"sv, ""sv },
+    { "access-control-allow-origin"sv, ""sv },
+    { "age"sv, ""sv },
+    { "allow"sv, ""sv },
+    { "authorization"sv, ""sv },
+    { "cache-control"sv, ""sv },
+    { "content-disposition"sv, ""sv },
+    { "content-encoding"sv, ""sv },
+    { "content-language"sv, ""sv },
+    { "content-length"sv, ""sv },
+    { "content-location"sv, ""sv },
+    { "content-range"sv, ""sv },
+    { "content-type"sv, ""sv },
+    { "cookie"sv, ""sv },
+    { "date"sv, ""sv },
+    { "etag"sv, ""sv },
+    { "expect"sv, ""sv },
+    { "expires"sv, ""sv },
+    { "from"sv, ""sv },
+    { "host"sv, ""sv },
+    { "if-match"sv, ""sv },
+    { "if-modified-since"sv, ""sv },
+    { "if-none-match"sv, ""sv },
+    { "if-range"sv, ""sv },
+    { "if-unmodified-since"sv, ""sv },
+    { "last-modified"sv, ""sv },
+    { "link"sv, ""sv },
+    { "location"sv, ""sv },
+    { "max-forwards"sv, ""sv },
+    { "proxy-authenticate"sv, ""sv },
+    { "proxy-authorization"sv, ""sv },
+    { "range"sv, ""sv },
+    { "referer"sv, ""sv },
+    { "refresh"sv, ""sv },
+    { "retry-after"sv, ""sv },
+    { "server"sv, ""sv },
+    { "set-cookie"sv, ""sv },
+    { "strict-transport-security"sv, ""sv },
+    { "transfer-encoding"sv, ""sv },
+    { "user-agent"sv, ""sv },
+    { "vary"sv, ""sv },
+    { "via"sv, ""sv },
+    { "www-authenticate"sv, ""sv },
+} };
+
+struct HuffmanCode {
+    u32 code;
+    u8 length;
+};
+
+// RFC 7541, Appendix B. The last one is EOS, which must never appear in a string.
+static constexpr Array<HuffmanCode, 257> s_huffman_codes { {
+    { 0x1ff8, 13 }, { 0x7fffd8, 23 }, { 0xfffffe2, 28 }, { 0xfffffe3, 28 },
+    { 0xfffffe4, 28 }, { 0xfffffe5, 28 }, { 0xfffffe6, 28 }, { 0xfffffe7, 28 },
+    { 0xfffffe8, 28 }, { 0xffffea, 24 }, { 0x3ffffffc, 30 }, { 0xfffffe9, 28 },
+    { 0xfffffea, 28 }, { 0x3ffffffd, 30 }, { 0xfffffeb, 28 }, { 0xfffffec, 28 },
+    { 0xfffffed, 28 }, { 0xfffffee, 28 }, { 0xfffffef, 28 }, { 0xffffff0, 28 },
+    { 0xffffff1, 28 }, { 0xffffff2, 28 }, { 0x3ffffffe, 30 }, { 0xffffff3, 28 },
+    { 0xffffff4, 28 }, { 0xffffff5, 28 }, { 0xffffff6, 28 }, { 0xffffff7, 28 },
+    { 0xffffff8, 28 }, { 0xffffff9, 28 }, { 0xffffffa, 28 }, { 0xffffffb, 28 },
+    { 0x14, 6 }, { 0x3f8, 10 }, { 0x3f9, 10 }, { 0xffa, 12 },
+    { 0x1ff9, 13 }, { 0x15, 6 }, { 0xf8, 8 }, { 0x7fa, 11 },
+    { 0x3fa, 10 }, { 0x3fb, 10 }, { 0xf9, 8 }, { 0x7fb, 11 },
+    { 0xfa, 8 }, { 0x16, 6 }, { 0x17, 6 }, { 0x18, 6 },
+    { 0x0, 5 }, { 0x1, 5 }, { 0x2, 5 }, { 0x19, 6 },
+    { 0x1a, 6 }, { 0x1b, 6 }, { 0x1c, 6 }, { 0x1d, 6 },
+    { 0x1e, 6 }, { 0x1f, 6 }, { 0x5c, 7 }, { 0xfb, 8 },
+    { 0x7ffc, 15 }, { 0x20, 6 }, { 0xffb, 12 }, { 0x3fc, 10 },
+    { 0x1ffa, 13 }, { 0x21, 6 }, { 0x5d, 7 }, { 0x5e, 7 },
+    { 0x5f, 7 }, { 0x60, 7 }, { 0x61, 7 }, { 0x62, 7 },
+    { 0x63, 7 }, { 0x64, 7 }, { 0x65, 7 }, { 0x66, 7 },
+    { 0x67, 7 }, { 0x68, 7 }, { 0x69, 7 }, { 0x6a, 7 },
+    { 0x6b, 7 }, { 0x6c, 7 }, { 0x6d, 7 }, { 0x6e, 7 },
+    { 0x6f, 7 }, { 0x70, 7 }, { 0x71, 7 }, { 0x72, 7 },
+    { 0xfc, 8 }, { 0x73, 7 }, { 0xfd, 8 }, { 0x1ffb, 13 },
+    { 0x7fff0, 19 }, { 0x1ffc, 13 }, { 0x3ffc, 14 }, { 0x22, 6 },
+    { 0x7ffd, 15 }, { 0x3, 5 }, { 0x23, 6 }, { 0x4, 5 },
+    { 0x24, 6 }, { 0x5, 5 }, { 0x25, 6 }, { 0x26, 6 },
+    { 0x27, 6 }, { 0x6, 5 }, { 0x74, 7 }, { 0x75, 7 },
+    { 0x28, 6 }, { 0x29, 6 }, { 0x2a, 6 }, { 0x7, 5 },
+    { 0x2b, 6 }, { 0x76, 7 }, { 0x2c, 6 }, { 0x8, 5 },
+    { 0x9, 5 }, { 0x2d, 6 }, { 0x77, 7 }, { 0x78, 7 },
+    { 0x79, 7 }, { 0x7a, 7 }, { 0x7b, 7 }, { 0x7ffe, 15 },
+    { 0x7fc, 11 }, { 0x3ffd, 14 }, { 0x1ffd, 13 }, { 0xffffffc, 28 },
+    { 0xfffe6, 20 }, { 0x3fffd2, 22 }, { 0xfffe7, 20 }, { 0xfffe8, 20 },
+    { 0x3fffd3, 22 }, { 0x3fffd4, 22 }, { 0x3fffd5, 22 }, { 0x7fffd9, 23 },
+    { 0x3fffd6, 22 }, { 0x7fffda, 23 }, { 0x7fffdb, 23 }, { 0x7fffdc, 23 },
+    { 0x7fffdd, 23 }, { 0x7fffde, 23 }, { 0xffffeb, 24 }, { 0x7fffdf, 23 },
+    { 0xffffec, 24 }, { 0xffffed, 24 }, { 0x3fffd7, 22 }, { 0x7fffe0, 23 },
+    { 0xffffee, 24 }, { 0x7fffe1, 23 }, { 0x7fffe2, 23 }, { 0x7fffe3, 23 },
+    { 0x7fffe4, 23 }, { 0x1fffdc, 21 }, { 0x3fffd8, 22 }, { 0x7fffe5, 23 },
+    { 0x3fffd9, 22 }, { 0x7fffe6, 23 }, { 0x7fffe7, 23 }, { 0xffffef, 24 },
+    { 0x3fffda, 22 }, { 0x1fffdd, 21 }, { 0xfffe9, 20 }, { 0x3fffdb, 22 },
+    { 0x3fffdc, 22 }, { 0x7fffe8, 23 }, { 0x7fffe9, 23 }, { 0x1fffde, 21 },
+    { 0x7fffea, 23 }, { 0x3fffdd, 22 }, { 0x3fffde, 22 }, { 0xfffff0, 24 },
+    { 0x1fffdf, 21 }, { 0x3fffdf, 22 }, { 0x7fffeb, 23 }, { 0x7fffec, 23 },
+    { 0x1fffe0, 21 }, { 0x1fffe1, 21 }, { 0x3fffe0, 22 }, { 0x1fffe2, 21 },
+    { 0x7fffed, 23 }, { 0x3fffe1, 22 }, { 0x7fffee, 23 }, { 0x7fffef, 23 },
+    { 0xfffea, 20 }, { 0x3fffe2, 22 }, { 0x3fffe3, 22 }, { 0x3fffe4, 22 },
+    { 0x7ffff0, 23 }, { 0x3fffe5, 22 }, { 0x3fffe6, 22 }, { 0x7ffff1, 23 },
+    { 0x3ffffe0, 26 }, { 0x3ffffe1, 26 }, { 0xfffeb, 20 }, { 0x7fff1, 19 },
+    { 0x3fffe7, 22 }, { 0x7ffff2, 23 }, { 0x3fffe8, 22 }, { 0x1ffffec, 25 },
+    { 0x3ffffe2, 26 }, { 0x3ffffe3, 26 }, { 0x3ffffe4, 26 }, { 0x7ffffde, 27 },
+    { 0x7ffffdf, 27 }, { 0x3ffffe5, 26 }, { 0xfffff1, 24 }, { 0x1ffffed, 25 },
+    { 0x7fff2, 19 }, { 0x1fffe3, 21 }, { 0x3ffffe6, 26 }, { 0x7ffffe0, 27 },
+    { 0x7ffffe1, 27 }, { 0x3ffffe7, 26 }, { 0x7ffffe2, 27 }, { 0xfffff2, 24 },
+    { 0x1fffe4, 21 }, { 0x1fffe5, 21 }, { 0x3ffffe8, 26 }, { 0x3ffffe9, 26 },
+    { 0xffffffd, 28 }, { 0x7ffffe3, 27 }, { 0x7ffffe4, 27 }, { 0x7ffffe5, 27 },
+    { 0xfffec, 20 }, { 0xfffff3, 24 }, { 0xfffed, 20 }, { 0x1fffe6, 21 },
+    { 0x3fffe9, 22 }, { 0x1fffe7, 21 }, { 0x1fffe8, 21 }, { 0x7ffff3, 23 },
+    { 0x3fffea, 22 }, { 0x3fffeb, 22 }, { 0x1ffffee, 25 }, { 0x1ffffef, 25 },
+    { 0xfffff4, 24 }, { 0xfffff5, 24 }, { 0x3ffffea, 26 }, { 0x7ffff4, 23 },
+    { 0x3ffffeb, 26 }, { 0x7ffffe6, 27 }, { 0x3ffffec, 26 }, { 0x3ffffed, 26 },
+    { 0x7ffffe7, 27 }, { 0x7ffffe8, 27 }, { 0x7ffffe9, 27 }, { 0x7ffffea, 27 },
+    { 0x7ffffeb, 27 }, { 0xffffffe, 28 }, { 0x7ffffec, 27 }, { 0x7ffffed, 27 },
+    { 0x7ffffee, 27 }, { 0x7ffffef, 27 }, { 0x7fffff0, 27 }, { 0x3ffffee, 26 },
+    { 0x3fffffff, 30 },
+} };
+static constexpr u16 huffman_eos_symbol = 256;
+
+// A binary tree over the codes, which decoding walks one bit at a time.
+struct HuffmanTree {
+    struct Node {
+        Array<u16, 2> children { 0, 0 };
+        i16 symbol { -1 };
+    };
+
+    // A full binary tree with one leaf per symbol.
+    Array<Node, 2 * s_huffman_codes.size() - 1> nodes;
+};
+
+static HuffmanTree const& huffman_tree()
+{
+    static HuffmanTree const tree = [] {
+        HuffmanTree tree;
+        size_t node_count = 1;
+        for (u16 symbol = 0; symbol < s_huffman_codes.size(); ++symbol) {
+            auto [code, length] = s_huffman_codes[symbol];
+            size_t node = 0;
+            for (int bit = length - 1; bit >= 0; --bit) {
+                auto direction = (code >> bit) & 1;
+                if (tree.nodes[node].children[direction] == 0)
+                    tree.nodes[node].children[direction] = node_count++;
+                node = tree.nodes[node].children[direction];
+            }
+            tree.nodes[node].symbol = symbol;
+        }
+        VERIFY(node_count == tree.nodes.size());
+        return tree;
+    }();
+    return tree;
+}
+
+ErrorOr<ByteBuffer> huffman_decode(ReadonlyBytes input)
+{
+    auto& tree = huffman_tree();
+
+    ByteBuffer output;
+    // The shortest code is 5 bits long.
+    TRY(output.try_ensure_capacity(input.size() * 8 / 5));
+
+    size_t node = 0;
+    size_t bits_since_last_symbol = 0;
+    bool bits_since_last_symbol_are_ones = true;
+    for (u8 byte : input) {
+        for (int bit = 7; bit >= 0; --bit) {
+            auto direction = (byte >> bit) & 1;
+            node = tree.nodes[node].children[direction];
+            ++bits_since_last_symbol;
+            bits_since_last_symbol_are_ones &= direction == 1;
+
+            auto symbol = tree.nodes[node].symbol;
+            if (symbol < 0)
+                continue;
+            if (symbol == huffman_eos_symbol)
+                return Error::from_string_literal("HPACK: EOS in a Huffman-encoded string");
+            TRY(output.try_append(static_cast<u8>(symbol)));
+            node = 0;
+            bits_since_last_symbol = 0;
+            bits_since_last_symbol_are_ones = true;
+        }
+    }
+
+    // Whatever is left has to be padding, which is the start of EOS and thus shorter than a byte and all ones.
+    if (bits_since_last_symbol > 7 || !bits_since_last_symbol_are_ones)
+        return Error::from_string_literal("HPACK: Invalid padding in a Huffman-encoded string");
+
+    return output;
+}
+
+ErrorOr<void> huffman_encode(ReadonlyBytes input, ByteBuffer& output)
+{
+    u64 bits = 0;
+    size_t bit_count = 0;
+    for (u8 byte : input) {
+        auto [code, length] = s_huffman_codes[byte];
+        bits = (bits << length) | code;
+        bit_count += length;
+        while (bit_count >= 8) {
+            bit_count -= 8;
+            TRY(output.try_append(static_cast<u8>(bits >> bit_count)));
+        }
+    }
+
+    // Pad with the start of EOS, which is all ones.
+    if (bit_count > 0)
+        TRY(output.try_append(static_cast<u8>((bits << (8 - bit_count)) | (0xff >> bit_count))));
+    return {};
+}
+
+size_t huffman_encoded_length(ReadonlyBytes input)
+{
+    size_t bit_count = 0;
+    for (u8 byte : input)
+        bit_count += s_huffman_codes[byte].length;
+    return (bit_count + 7) / 8;
+}
+
+// RFC 7541, section 5.1: An integer that starts in the low bits of a byte, and continues in 7-bit groups if it doesn't fit.
+static ErrorOr<void> encode_integer(ByteBuffer& output, u8 flags, u8 prefix_bits, size_t value)
+{
+    u8 max_prefix_value = (1 << prefix_bits) - 1;
+    if (value < max_prefix_value)
+        return output.try_append(static_cast<u8>(flags | value));
+
+    TRY(output.try_append(static_cast<u8>(flags | max_prefix_value)));
+    value -= max_prefix_value;
+    while (value >= 128) {
+        TRY(output.try_append(static_cast<u8>(0x80 | (value & 0x7f))));
+        value >>= 7;
+    }
+    return output.try_append(static_cast<u8>(value));
+}
+
+static ErrorOr<size_t> decode_integer(ReadonlyBytes input, size_t& offset, u8 prefix_bits)
+{
+    if (offset >= input.size())
+        return Error::from_string_literal("HPACK: Truncated integer");
+
+    u8 max_prefix_value = (1 << prefix_bits) - 1;
+    size_t value = input[offset++] & max_prefix_value;
+    if (value < max_prefix_value)
+        return value;
+
+    for (size_t shift = 0; offset < input.size(); shift += 7) {
+        // Nothing we deal with comes close to needing more than 32 bits.
+        if (shift > 28)
+            return Error::from_string_literal("HPACK: Integer is too big");
+        u8 byte = input[offset++];
+        value += static_cast<size_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            return value;
+    }
+    return Error::from_string_literal("HPACK: Truncated integer");
+}
+
+static ErrorOr<void> encode_string(ByteBuffer& output, StringView string)
+{
+    auto huffman_length = huffman_encoded_length(string.bytes());
+    if (huffman_length < string.length()) {
+        TRY(encode_integer(output, 0x80, 7, huffman_length));
+        return huffman_encode(string.bytes(), output);
+    }
+    TRY(encode_integer(output, 0, 7, string.length()));
+    return output.try_append(string.bytes());
+}
+
+static ErrorOr<DeprecatedString> decode_string(ReadonlyBytes input, size_t& offset)
+{
+    if (offset >= input.size())
+        return Error::from_string_literal("HPACK: Truncated string");
+
+    bool is_huffman_encoded = input[offset] & 0x80;
+    auto length = TRY(decode_integer(input, offset, 7));
+    if (length > input.size() - offset)
+        return Error::from_string_literal("HPACK: Truncated string");
+
+    auto bytes = input.slice(offset, length);
+    offset += length;
+    if (is_huffman_encoded) {
+        auto decoded = TRY(huffman_decode(bytes));
+        return DeprecatedString { StringView { decoded.bytes() } };
+    }
+    return DeprecatedString { StringView { bytes } };
+}
+
+void DynamicTable::add(Header header)
+{
+    auto size = entry_size(header);
+
+    // An entry that is too big for the table empties it, and isn't added either (RFC 7541, section 4.4).
+    if (size > m_max_size) {
+        m_entries.clear();
+        m_size = 0;
+        return;
+    }
+
+    evict_until_size_is_at_most(m_max_size - size);
+    m_entries.prepend(move(header));
+    m_size += size;
+}
+
+void DynamicTable::set_max_size(size_t max_size)
+{
+    m_max_size = max_size;
+    evict_until_size_is_at_most(max_size);
+}
+
+void DynamicTable::evict_until_size_is_at_most(size_t size)
+{
+    while (m_size > size)
+        m_size -= entry_size(m_entries.take_last());
+}
+
+ErrorOr<Header> Decoder::header_at_index(size_t index) const
+{
+    if (index == 0)
+        return Error::from_string_literal("HPACK: Index 0 is not valid");
+    if (index <= s_static_table.size()) {
+        auto& entry = s_static_table[index - 1];
+        return Header { entry.name, entry.value };
+    }
+    index -= s_static_table.size() + 1;
+    if (index >= m_table.entry_count())
+        return Error::from_string_literal("HPACK: Index is out of bounds");
+    return m_table.at(index);
+}
+
+ErrorOr<Vector<Header>> Decoder::decode(ReadonlyBytes header_block)
+{
+    Vector<Header> headers;
+    size_t header_list_size = 0;
+    bool may_update_table_size = true;
+
+    size_t offset = 0;
+    while (offset < header_block.size()) {
+        u8 first_byte = header_block[offset];
+
+        // Dynamic table size updates may only come before the first header (RFC 7541, section 4.2).
+        if ((first_byte & 0xe0) == 0x20) {
+            if (!may_update_table_size)
+                return Error::from_string_literal("HPACK: Dynamic table size update after a header");
+            auto size = TRY(decode_integer(header_block, offset, 5));
+            if (size > default_table_size)
+                return Error::from_string_literal("HPACK: Dynamic table size update beyond our limit");
+            m_table.set_max_size(size);
+            continue;
+        }
+        may_update_table_size = false;
+
+        Header header;
+        if (first_byte & 0x80) {
+            // Indexed header field.
+            header = TRY(header_at_index(TRY(decode_integer(header_block, offset, 7))));
+        } else {
+            // Literal header field, which is either added to the table (01xxxxxx), or not (0000xxxx and 0001xxxx).
+            bool should_add_to_table = first_byte & 0x40;
+            auto name_index = TRY(decode_integer(header_block, offset, should_add_to_table ? 6 : 4));
+            if (name_index == 0)
+                header.name = TRY(decode_string(header_block, offset));
+            else
+                header.name = TRY(header_at_index(name_index)).name;
+            header.value = TRY(decode_string(header_block, offset));
+            if (should_add_to_table)
+                m_table.add(header);
+        }
+
+        header_list_size += DynamicTable::entry_size(header);
+        if (header_list_size > max_header_list_size)
+            return Error::from_string_literal("HPACK: Header list is too big");
+        TRY(headers.try_append(move(header)));
+    }
+
+    return headers;
+}
+
+Encoder::Match Encoder::find(Header const& header) const
+{
+    Match match;
+    for (size_t i = 0; i < s_static_table.size(); ++i) {
+        if (s_static_table[i].name != header.name)
+            continue;
+        if (s_static_table[i].value == header.value)
+            return { i + 1, true };
+        if (match.index == 0)
+            match.index = i + 1;
+    }
+    for (size_t i = 0; i < m_table.entry_count(); ++i) {
+        auto& entry = m_table.at(i);
+        if (entry.name != header.name)
+            continue;
+        if (entry.value == header.value)
+            return { s_static_table.size() + i + 1, true };
+        if (match.index == 0)
+            match.index = s_static_table.size() + i + 1;
+    }
+    return match;
+}
+
+// Values that are easy to guess one character at a time if they end up in a table (RFC 7541, section 7.1.3).
+static bool is_sensitive(Header const& header)
+{
+    if (header.name == "authorization"sv || header.name == "proxy-authorization"sv)
+        return true;
+    return header.name == "cookie"sv && header.value.length() < 20;
+}
+
+ErrorOr<ByteBuffer> Encoder::encode(Span<Header const> headers)
+{
+    ByteBuffer output;
+
+    if (auto smallest_size = m_smallest_table_size_since_last_block; smallest_size.has_value()) {
+        m_smallest_table_size_since_last_block.clear();
+        TRY(encode_integer(output, 0x20, 5, smallest_size.value()));
+        if (smallest_size.value() != m_table.max_size())
+            TRY(encode_integer(output, 0x20, 5, m_table.max_size()));
+    }
+
+    for (auto& header : headers) {
+        auto match = find(header);
+        if (match.includes_value) {
+            TRY(encode_integer(output, 0x80, 7, match.index));
+            continue;
+        }
+
+        // Headers that would push most of the table out aren't worth remembering.
+        bool should_add_to_table = !is_sensitive(header) && DynamicTable::entry_size(header) <= m_table.max_size() / 2;
+        if (should_add_to_table)
+            TRY(encode_integer(output, 0x40, 6, match.index));
+        else if (is_sensitive(header))
+            TRY(encode_integer(output, 0x10, 4, match.index));
+        else
+            TRY(encode_integer(output, 0x00, 4, match.index));
+
+        if (match.index == 0)
+            TRY(encode_string(output, header.name));
+        TRY(encode_string(output, header.value));
+
+        if (should_add_to_table)
+            m_table.add(header);
+    }
+
+    return output;
+}
+
+void Encoder::set_max_table_size(size_t size)
+{
+    // We have no use for a bigger table than the default, even if the other end has room for one.
+    size = min(size, default_table_size);
+    if (size == m_table.max_size())
+        return;
+
+    m_table.set_max_size(size);
+    m_smallest_table_size_since_last_block = min(size, m_smallest_table_size_since_last_block.value_or(size));
+}
+
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/DeprecatedString.h>
+#include <AK/Error.h>
+#include <AK/Optional.h>
+#include <AK/Span.h>
+#include <AK/Vector.h>
+
+// HPACK, the header compression of HTTP/2 (RFC 7541).
+namespace HTTP::HPACK {
+
+struct Header {
+    DeprecatedString name;
+    DeprecatedString value;
+};
+
+// The table size both ends start out with, and the one we allow the other end to use.
+static constexpr size_t default_table_size = 4096;
+
+// The headers that were sent recently, newest first, which both ends keep the same copy of.
+class DynamicTable {
+public:
+    size_t size() const { return m_size; }
+    size_t max_size() const { return m_max_size; }
+    size_t entry_count() const { return m_entries.size(); }
+    Header const& at(size_t index) const { return m_entries[index]; }
+
+    void add(Header);
+    void set_max_size(size_t);
+
+    // Each entry also accounts for its bookkeeping (RFC 7541, section 4.1).
+    static size_t entry_size(Header const& header) { return header.name.length() + header.value.length() + 32; }
+
+private:
+    void evict_until_size_is_at_most(size_t);
+
+    Vector<Header> m_entries;
+    size_t m_size { 0 };
+    size_t m_max_size { default_table_size };
+};
+
+class Decoder {
+public:
+    // Anything bigger than this (counted like table entries) is most likely an attempt to make us run out of memory.
+    static constexpr size_t max_header_list_size = 256 * KiB;
+
+    ErrorOr<Vector<Header>> decode(ReadonlyBytes header_block);
+
+private:
+    ErrorOr<Header> header_at_index(size_t index) const;
+
+    DynamicTable m_table;
+};
+
+class Encoder {
+public:
+    ErrorOr<ByteBuffer> encode(Span<Header const>);
+
+    // The other end told us how big its table may become, see SETTINGS_HEADER_TABLE_SIZE.
+    void set_max_table_size(size_t);
+
+private:
+    // The index of an entry with the same name, and the same value too if possible. Zero if there is none.
+    struct Match {
+        size_t index { 0 };
+        bool includes_value { false };
+    };
+    Match find(Header const&) const;
+
+    DynamicTable m_table;
+    // The smallest size the table had since the last header block, which the other end has to hear about.
+    Optional<size_t> m_smallest_table_size_since_last_block;
+};
+
+ErrorOr<ByteBuffer> huffman_decode(ReadonlyBytes);
+ErrorOr<void> huffman_encode(ReadonlyBytes, ByteBuffer& output);
+size_t huffman_encoded_length(ReadonlyBytes);
+
+}
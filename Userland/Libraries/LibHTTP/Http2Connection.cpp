@@ -0,0 +1,750 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/Endian.h>
+#include <AK/StringBuilder.h>
+#include <AK/URL.h>
+#include <LibHTTP/Http2Connection.h>
+
+namespace HTTP {
+
+static constexpr auto connection_preface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"sv;
+static constexpr size_t frame_header_size = 9;
+
+// We never allow the server bigger frames than this, which is what everyone starts out with.
+static constexpr size_t default_max_frame_size = 16384;
+static constexpr size_t largest_max_frame_size = 16777215;
+static constexpr i64 default_initial_window_size = 65535;
+static constexpr i64 max_window_size = 0x7fffffff;
+static constexpr u32 max_stream_id = 0x7fffffff;
+
+// Received data is handed on right away, so these only have to be big enough to not slow down fast connections.
+static constexpr i64 stream_receive_window_size = 1 * MiB;
+static constexpr i64 connection_receive_window_size = 16 * MiB;
+
+// Servers usually allow about this many, and more streams than that on one connection don't make anything faster.
+static constexpr size_t max_concurrent_streams = 100;
+
+enum class Setting : u16 {
+    HeaderTableSize = 0x1,
+    EnablePush = 0x2,
+    MaxConcurrentStreams = 0x3,
+    InitialWindowSize = 0x4,
+    MaxFrameSize = 0x5,
+    MaxHeaderListSize = 0x6,
+};
+
+static constexpr u8 flag_end_stream = 0x1;
+static constexpr u8 flag_ack = 0x1;
+static constexpr u8 flag_end_headers = 0x4;
+static constexpr u8 flag_padded = 0x8;
+static constexpr u8 flag_priority = 0x20;
+
+static u32 read_u32(ReadonlyBytes bytes)
+{
+    return (static_cast<u32>(bytes[0]) << 24) | (static_cast<u32>(bytes[1]) << 16) | (static_cast<u32>(bytes[2]) << 8) | bytes[3];
+}
+
+static u16 read_u16(ReadonlyBytes bytes)
+{
+    return (static_cast<u16>(bytes[0]) << 8) | bytes[1];
+}
+
+template<typename T>
+static ErrorOr<void> append_big_endian(ByteBuffer& buffer, T value)
+{
+    BigEndian<T> big_endian_value = value;
+    return buffer.try_append(&big_endian_value, sizeof(big_endian_value));
+}
+
+// Everything after the padding length, without the padding.
+static Optional<ReadonlyBytes> remove_padding(u8 flags, ReadonlyBytes payload)
+{
+    if (!(flags & flag_padded))
+        return payload;
+    if (payload.is_empty() || payload[0] >= payload.size())
+        return {};
+    return payload.slice(1, payload.size() - 1 - payload[0]);
+}
+
+static ErrorOr<Vector<HPACK::Header>> request_headers(HttpRequest const& request)
+{
+    auto const& url = request.url();
+
+    StringBuilder authority;
+    TRY(authority.try_append(url.host()));
+    if (url.port().has_value())
+        TRY(authority.try_appendff(":{}", *url.port()));
+
+    StringBuilder path;
+    TRY(path.try_append(URL::percent_encode(url.path(), URL::PercentEncodeSet::EncodeURI)));
+    if (!url.query().is_empty()) {
+        TRY(path.try_append('?'));
+        TRY(path.try_append(url.query()));
+    }
+
+    Vector<HPACK::Header> headers;
+    TRY(headers.try_append({ ":method", request.method_name() }));
+    TRY(headers.try_append({ ":scheme", url.scheme() }));
+    TRY(headers.try_append({ ":authority", authority.to_deprecated_string() }));
+    TRY(headers.try_append({ ":path", path.to_deprecated_string() }));
+
+    for (auto& header : request.headers()) {
+        auto name = header.name.to_lowercase();
+        // These only make sense for HTTP/1 connections, and are not allowed here (RFC 9113, section 8.2.2).
+        if (name.is_one_of("connection", "keep-alive", "proxy-connection", "transfer-encoding", "upgrade", "host"))
+            continue;
+        if (name == "te" && !header.value.equals_ignoring_case("trailers"sv))
+            continue;
+        // Cookies are sent separately, so the ones that don't change can be compressed well (RFC 9113, section 8.2.3).
+        if (name == "cookie") {
+            for (auto cookie : header.value.view().split_view("; "sv))
+                TRY(headers.try_append({ name, DeprecatedString { cookie } }));
+            continue;
+        }
+        TRY(headers.try_append({ move(name), header.value }));
+    }
+
+    if (!request.body().is_empty() || request.method() == HttpRequest::Method::POST)
+        TRY(headers.try_append({ "content-length", DeprecatedString::number(request.body().size()) }));
+
+    return headers;
+}
+
+Http2Connection::Http2Connection(Core::Stream::Socket& socket)
+    : m_socket(socket)
+    , m_max_concurrent_streams(max_concurrent_streams)
+    , m_max_frame_size(default_max_frame_size)
+    , m_initial_send_window(default_initial_window_size)
+    , m_send_window(default_initial_window_size)
+    , m_receive_window(default_initial_window_size)
+{
+}
+
+Http2Connection::~Http2Connection()
+{
+    close();
+}
+
+ErrorOr<void> Http2Connection::start()
+{
+    TRY(m_write_buffer.try_append(connection_preface.bytes()));
+
+    ByteBuffer settings;
+    auto append_setting = [&](Setting setting, u32 value) -> ErrorOr<void> {
+        TRY(append_big_endian(settings, to_underlying(setting)));
+        TRY(append_big_endian(settings, value));
+        return {};
+    };
+    TRY(append_setting(Setting::EnablePush, 0));
+    TRY(append_setting(Setting::InitialWindowSize, stream_receive_window_size));
+    TRY(append_setting(Setting::MaxHeaderListSize, HPACK::Decoder::max_header_list_size));
+
+    auto result = queue_frame(FrameType::Settings, 0, 0, settings);
+    if (!result.is_error())
+        result = queue_window_update(0, connection_receive_window_size - m_receive_window);
+    if (result.is_error())
+        return Error::from_string_view(result.error().reason);
+    m_receive_window = connection_receive_window_size;
+
+    m_socket.on_ready_to_read = [this] { on_ready_to_read(); };
+
+    flush();
+    if (m_is_closed)
+        return Error::from_string_literal("Failed to send the HTTP/2 connection preface");
+    return {};
+}
+
+bool Http2Connection::can_open_stream() const
+{
+    return is_open() && m_streams.size() < m_max_concurrent_streams && m_next_stream_id <= max_stream_id;
+}
+
+ErrorOr<u32> Http2Connection::open_stream(HttpRequest const& request, StreamCallbacks callbacks)
+{
+    if (!can_open_stream())
+        return Error::from_string_literal("HTTP/2 connection can't take another stream");
+
+    auto stream = TRY(try_make_ref_counted<Stream>());
+    stream->id = m_next_stream_id;
+    stream->callbacks = move(callbacks);
+    stream->send_window = m_initial_send_window;
+    stream->receive_window = stream_receive_window_size;
+    stream->pending_body = TRY(ByteBuffer::copy(request.body()));
+    stream->has_sent_end_of_stream = request.body().is_empty();
+
+    auto headers = TRY(request_headers(request));
+    auto header_block = TRY(m_encoder.encode(headers));
+    m_next_stream_id += 2;
+
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Opening stream {} for {} {}", stream->id, request.method_name(), request.url());
+
+    auto result = queue_header_block(stream->id, header_block, stream->has_sent_end_of_stream);
+    if (!result.is_error())
+        result = queue_pending_body(*stream);
+    if (result.is_error()) {
+        // The encoder has already moved on, so the server would not be able to make sense of anything we send from now on.
+        fail_connection(result.release_error());
+        return Error::from_string_literal("Failed to queue HTTP/2 request");
+    }
+
+    flush();
+    if (m_is_closed)
+        return Error::from_string_literal("Failed to send HTTP/2 request");
+
+    m_streams.set(stream->id, stream);
+    return stream->id;
+}
+
+void Http2Connection::close_stream(u32 stream_id)
+{
+    auto stream = m_streams.take(stream_id);
+    if (!stream.has_value())
+        return;
+
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Cancelling stream {}", stream_id);
+    if (!m_is_closed) {
+        if (auto result = queue_rst_stream(stream_id, ErrorCode::Cancel); result.is_error())
+            return fail_connection(result.release_error());
+        flush();
+    }
+    if (on_stream_closed)
+        on_stream_closed();
+}
+
+void Http2Connection::close()
+{
+    if (m_is_closed)
+        return;
+    m_is_closed = true;
+    m_socket.on_ready_to_read = nullptr;
+    fail_all_streams(Core::NetworkJob::Error::ConnectionFailed);
+}
+
+void Http2Connection::socket_was_closed()
+{
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: The server closed the connection");
+    did_lose_connection(Core::NetworkJob::Error::ConnectionFailed);
+}
+
+void Http2Connection::on_ready_to_read()
+{
+    NonnullRefPtr<Http2Connection> protector(*this);
+
+    u8 buffer[16 * KiB];
+    while (!m_is_closed) {
+        auto can_read_without_blocking = m_socket.can_read_without_blocking();
+        if (can_read_without_blocking.is_error())
+            return did_lose_connection(Core::NetworkJob::Error::TransmissionFailed);
+        if (!can_read_without_blocking.value())
+            break;
+
+        auto bytes_read = m_socket.read({ buffer, sizeof(buffer) });
+        if (bytes_read.is_error()) {
+            if (bytes_read.error().is_errno() && bytes_read.error().code() == EINTR)
+                continue;
+            if (bytes_read.error().is_errno() && bytes_read.error().code() == EAGAIN)
+                break;
+            dbgln_if(HTTP2_DEBUG, "Http2Connection: Failed to read from the socket: {}", bytes_read.error());
+            return did_lose_connection(Core::NetworkJob::Error::TransmissionFailed);
+        }
+        if (bytes_read.value().is_empty())
+            break;
+
+        if (m_read_buffer.try_append(bytes_read.value()).is_error())
+            return fail_connection({ ErrorCode::InternalError, "Out of memory"sv });
+        if (auto result = process_received_frames(); result.is_error())
+            return fail_connection(result.release_error());
+    }
+
+    if (m_is_closed)
+        return;
+    if (m_socket.is_eof())
+        return socket_was_closed();
+    flush();
+}
+
+Http2Connection::ConnectionErrorOr<void> Http2Connection::process_received_frames()
+{
+    size_t offset = 0;
+    while (!m_is_closed && m_read_buffer.size() - offset >= frame_header_size) {
+        auto header = m_read_buffer.bytes().slice(offset, frame_header_size);
+        size_t length = (header[0] << 16) | (header[1] << 8) | header[2];
+        if (length > default_max_frame_size)
+            return ConnectionError { ErrorCode::FrameSizeError, "Frame is bigger than we allowed"sv };
+        if (m_read_buffer.size() - offset < frame_header_size + length)
+            break;
+
+        auto type = static_cast<FrameType>(header[3]);
+        auto flags = header[4];
+        auto stream_id = read_u32(header.slice(5)) & max_stream_id;
+        auto payload = m_read_buffer.bytes().slice(offset + frame_header_size, length);
+        offset += frame_header_size + length;
+
+        // Nothing may come between the frames of a header block (RFC 9113, section 6.10).
+        if (m_header_block_stream_id != 0 && type != FrameType::Continuation)
+            return ConnectionError { ErrorCode::ProtocolError, "Header block was interrupted by another frame"sv };
+
+        TRY(process_frame(type, flags, stream_id, payload));
+    }
+
+    if (offset > 0 && !m_is_closed) {
+        auto remaining = m_read_buffer.bytes().slice(offset);
+        // This is a tail of the same buffer, so it can't fail to fit.
+        memmove(m_read_buffer.data(), remaining.data(), remaining.size());
+        m_read_buffer.resize(remaining.size());
+    }
+    return {};
+}
+
+Http2Connection::ConnectionErrorOr<void> Http2Connection::process_frame(FrameType type, u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Received frame of type {} with flags {:#x} on stream {}, {} bytes", to_underlying(type), flags, stream_id, payload.size());
+
+    switch (type) {
+    case FrameType::Data:
+        return process_data_frame(flags, stream_id, payload);
+    case FrameType::Headers:
+        return process_headers_frame(flags, stream_id, payload);
+    case FrameType::Priority:
+        // We don't prioritize anything, and neither does the server care whether we do.
+        if (payload.size() != 5)
+            return reset_stream(stream_id, ErrorCode::FrameSizeError);
+        return {};
+    case FrameType::RstStream:
+        return process_rst_stream_frame(stream_id, payload);
+    case FrameType::Settings:
+        return process_settings_frame(flags, stream_id, payload);
+    case FrameType::PushPromise:
+        return ConnectionError { ErrorCode::ProtocolError, "Server pushed a stream after we disabled that"sv };
+    case FrameType::Ping:
+        return process_ping_frame(flags, stream_id, payload);
+    case FrameType::GoAway:
+        return process_goaway_frame(stream_id, payload);
+    case FrameType::WindowUpdate:
+        return process_window_update_frame(stream_id, payload);
+    case FrameType::Continuation:
+        return process_continuation_frame(flags, stream_id, payload);
+    }
+
+    // Frames of types we don't know about have to be ignored (RFC 9113, section 4.1).
+    return {};
+}
+
+Http2Connection::ConnectionErrorOr<RefPtr<Http2Connection::Stream>> Http2Connection::find_stream(u32 stream_id)
+{
+    if (stream_id == 0)
+        return ConnectionError { ErrorCode::ProtocolError, "Stream frame on the connection"sv };
+    if (auto stream = m_streams.get(stream_id); stream.has_value())
+        return RefPtr<Stream> { stream.value() };
+    // Only we open streams, and those have odd numbers.
+    if (stream_id % 2 == 0 || stream_id >= m_next_stream_id)
+        return ConnectionError { ErrorCode::ProtocolError, "Frame for a stream we never opened"sv };
+    return RefPtr<Stream> {};
+}
+
+Http2Connection::ConnectionErrorOr<void> Http2Connection::process_data_frame(u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    auto stream = TRY(find_stream(stream_id));
+
+    // Padding counts towards the windows too.
+    m_receive_window -= payload.size();
+    if (m_receive_window < 0)
+        return ConnectionError { ErrorCode::FlowControlError, "Server sent more than the connection window allowed"sv };
+    if (m_receive_window <= connection_receive_window_size / 2) {
+        TRY(queue_window_update(0, connection_receive_window_size - m_receive_window));
+        m_receive_window = connection_receive_window_size;
+    }
+
+    auto data = remove_padding(flags, payload);
+    if (!data.has_value())
+        return ConnectionError { ErrorCode::ProtocolError, "Invalid padding"sv };
+
+    if (!stream)
+        return {};
+
+    bool end_of_stream = flags & flag_end_stream;
+    stream->receive_window -= payload.size();
+    if (stream->receive_window < 0)
+        return reset_stream(stream_id, ErrorCode::FlowControlError);
+    if (!end_of_stream && stream->receive_window <= stream_receive_window_size / 2) {
+        TRY(queue_window_update(stream_id, stream_receive_window_size - stream->receive_window));
+        stream->receive_window = stream_receive_window_size;
+    }
+
+    if (stream->callbacks.on_data)
+        stream->callbacks.on_data(data.value(), end_of_stream);
+    if (end_of_stream)
+        end_stream(stream_id);
+    return {};
+}
+
+Http2Connection::ConnectionErrorOr<void> Http2Connection::process_headers_frame(u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (stream_id == 0)
+        return ConnectionError { ErrorCode::ProtocolError, "Headers for the connection"sv };
+
+    auto fragment = remove_padding(flags, payload);
+    if (!fragment.has_value())
+        return ConnectionError { ErrorCode::ProtocolError, "Invalid padding"sv };
+    if (flags & flag_priority) {
+        if (fragment->size() < 5)
+            return ConnectionError { ErrorCode::FrameSizeError, "Headers frame too short for its priority"sv };
+        fragment = fragment->slice(5);
+    }
+
+    VERIFY(m_header_block.is_empty());
+    if (m_header_block.try_append(fragment.value()).is_error())
+        return ConnectionError { ErrorCode::InternalError, "Out of memory"sv };
+    m_header_block_stream_id = stream_id;
+    m_header_block_ends_stream = flags & flag_end_stream;
+
+    if (flags & flag_end_headers)
+        return process_header_block();
+    return {};
+}
+
+Http2Connection::ConnectionErrorOr<void> Http2Connection::process_continuation_frame(u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (m_header_block_stream_id == 0 || stream_id != m_header_block_stream_id)
+        return ConnectionError { ErrorCode::ProtocolError, "Continuation of a header block that wasn't started"sv };
+    if (m_header_block.size() + payload.size() > HPACK::Decoder::max_header_list_size)
+        return ConnectionError { ErrorCode::EnhanceYourCalm, "Header block is too big"sv };
+    if (m_header_block.try_append(payload).is_error())
+        return ConnectionError { ErrorCode::InternalError, "Out of memory"sv };
+
+    if (flags & flag_end_headers)
+        return process_header_block();
+    return {};
+}
+
+Http2Connection::ConnectionErrorOr<void> Http2Connection::process_header_block()
+{
+    auto stream_id = exchange(m_header_block_stream_id, 0);
+    auto end_of_stream = m_header_block_ends_stream;
+    auto header_block = move(m_header_block);
+
+    // This has to happen even for streams we're done with, as it changes the decoder's table.
+    auto headers = m_decoder.decode(header_block);
+    if (headers.is_error()) {
+        dbgln_if(HTTP2_DEBUG, "Http2Connection: Failed to decode header block on stream {}: {}", stream_id, headers.error());
+        return ConnectionError { ErrorCode::CompressionError, "Failed to decode header block"sv };
+    }
+
+    auto stream = TRY(find_stream(stream_id));
+    if (!stream)
+        return {};
+
+    if (stream->callbacks.on_headers)
+        stream->callbacks.on_headers(headers.release_value(), end_of_stream);
+    if (end_of_stream)
+        end_stream(stream_id);
+    return {};
+}
+
+Http2Connection::ConnectionErrorOr<void> Http2Connection::process_rst_stream_frame(u32 stream_id, ReadonlyBytes payload)
+{
+    if (payload.size() != 4)
+        return ConnectionError { ErrorCode::FrameSizeError, "Invalid RST_STREAM frame"sv };
+    auto stream = TRY(find_stream(stream_id));
+    if (!stream)
+        return {};
+
+    auto error_code = static_cast<ErrorCode>(read_u32(payload));
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Server reset stream {} with error {}", stream_id, to_underlying(error_code));
+    fail_stream(stream_id, error_code == ErrorCode::RefusedStream ? Core::NetworkJob::Error::ConnectionFailed : Core::NetworkJob::Error::TransmissionFailed);
+    return {};
+}
+
+Http2Connection::ConnectionErrorOr<void> Http2Connection::process_settings_frame(u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (stream_id != 0)
+        return ConnectionError { ErrorCode::ProtocolError, "Settings for a stream"sv };
+    if (flags & flag_ack) {
+        if (!payload.is_empty())
+            return ConnectionError { ErrorCode::FrameSizeError, "Settings acknowledgement with a payload"sv };
+        return {};
+    }
+    if (payload.size() % 6 != 0)
+        return ConnectionError { ErrorCode::FrameSizeError, "Invalid SETTINGS frame"sv };
+
+    for (size_t offset = 0; offset < payload.size(); offset += 6) {
+        auto setting = static_cast<Setting>(read_u16(payload.slice(offset)));
+        auto value = read_u32(payload.slice(offset + 2));
+        dbgln_if(HTTP2_DEBUG, "Http2Connection: Setting {} = {}", to_underlying(setting), value);
+
+        switch (setting) {
+        case Setting::HeaderTableSize:
+            // There's no point in making our table bigger than the one the decoder on our side has.
+            m_encoder.set_max_table_size(min<size_t>(value, HPACK::default_table_size));
+            break;
+        case Setting::MaxConcurrentStreams:
+            m_max_concurrent_streams = min<size_t>(value, max_concurrent_streams);
+            break;
+        case Setting::InitialWindowSize: {
+            if (value > max_window_size)
+                return ConnectionError { ErrorCode::FlowControlError, "Initial window size is too big"sv };
+            // This changes the windows of the streams that are already open too (RFC 9113, section 6.9.2).
+            auto delta = static_cast<i64>(value) - m_initial_send_window;
+            for (auto& it : m_streams) {
+                it.value->send_window += delta;
+                if (it.value->send_window > max_window_size)
+                    return ConnectionError { ErrorCode::FlowControlError, "Stream window became too big"sv };
+            }
+            m_initial_send_window = value;
+            break;
+        }
+        case Setting::MaxFrameSize:
+            if (value < default_max_frame_size || value > largest_max_frame_size)
+                return ConnectionError { ErrorCode::ProtocolError, "Invalid maximum frame size"sv };
+            m_max_frame_size = value;
+            break;
+        case Setting::EnablePush:
+        case Setting::MaxHeaderListSize:
+        default:
+            // Either doesn't affect what we send, or is unknown and has to be ignored.
+            break;
+        }
+    }
+
+    TRY(queue_frame(FrameType::Settings, flag_ack, 0, {}));
+    return queue_pending_bodies();
+}
+
+Http2Connection::ConnectionErrorOr<void> Http2Connection::process_ping_frame(u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (stream_id != 0)
+        return ConnectionError { ErrorCode::ProtocolError, "Ping for a stream"sv };
+    if (payload.size() != 8)
+        return ConnectionError { ErrorCode::FrameSizeError, "Invalid PING frame"sv };
+    if (flags & flag_ack)
+        return {};
+    return queue_frame(FrameType::Ping, flag_ack, 0, payload);
+}
+
+Http2Connection::ConnectionErrorOr<void> Http2Connection::process_goaway_frame(u32 stream_id, ReadonlyBytes payload)
+{
+    if (stream_id != 0)
+        return ConnectionError { ErrorCode::ProtocolError, "GOAWAY for a stream"sv };
+    if (payload.size() < 8)
+        return ConnectionError { ErrorCode::FrameSizeError, "Invalid GOAWAY frame"sv };
+
+    auto last_stream_id = read_u32(payload) & max_stream_id;
+    auto error_code = static_cast<ErrorCode>(read_u32(payload.slice(4)));
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Server is going away after stream {} with error {}: '{}'",
+        last_stream_id, to_underlying(error_code), StringView { payload.slice(8) });
+
+    // The streams after the last one were never looked at, so they didn't get anywhere.
+    Vector<u32> unprocessed_stream_ids;
+    for (auto& it : m_streams) {
+        if (it.key > last_stream_id)
+            unprocessed_stream_ids.append(it.key);
+    }
+    for (auto id : unprocessed_stream_ids)
+        fail_stream(id, Core::NetworkJob::Error::ConnectionFailed);
+
+    did_stop_accepting_streams();
+    return {};
+}
+
+Http2Connection::ConnectionErrorOr<void> Http2Connection::process_window_update_frame(u32 stream_id, ReadonlyBytes payload)
+{
+    if (payload.size() != 4)
+        return ConnectionError { ErrorCode::FrameSizeError, "Invalid WINDOW_UPDATE frame"sv };
+    auto increment = read_u32(payload) & max_stream_id;
+
+    if (stream_id == 0) {
+        if (increment == 0)
+            return ConnectionError { ErrorCode::ProtocolError, "Connection window update without an increment"sv };
+        m_send_window += increment;
+        if (m_send_window > max_window_size)
+            return ConnectionError { ErrorCode::FlowControlError, "Connection window became too big"sv };
+        return queue_pending_bodies();
+    }
+
+    auto stream = TRY(find_stream(stream_id));
+    if (!stream)
+        return {};
+    if (increment == 0)
+        return reset_stream(stream_id, ErrorCode::ProtocolError);
+    stream->send_window += increment;
+    if (stream->send_window > max_window_size)
+        return reset_stream(stream_id, ErrorCode::FlowControlError);
+    return queue_pending_body(*stream);
+}
+
+Http2Connection::ConnectionErrorOr<void> Http2Connection::queue_frame(FrameType type, u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    VERIFY(payload.size() <= m_max_frame_size);
+    u8 header[frame_header_size] = {
+        static_cast<u8>(payload.size() >> 16),
+        static_cast<u8>(payload.size() >> 8),
+        static_cast<u8>(payload.size()),
+        to_underlying(type),
+        flags,
+        static_cast<u8>(stream_id >> 24),
+        static_cast<u8>(stream_id >> 16),
+        static_cast<u8>(stream_id >> 8),
+        static_cast<u8>(stream_id),
+    };
+    if (m_write_buffer.try_append(header, sizeof(header)).is_error() || m_write_buffer.try_append(payload).is_error())
+        return ConnectionError { ErrorCode::InternalError, "Out of memory"sv };
+    return {};
+}
+
+Http2Connection::ConnectionErrorOr<void> Http2Connection::queue_header_block(u32 stream_id, ReadonlyBytes header_block, bool end_of_stream)
+{
+    auto first_fragment_size = min(header_block.size(), m_max_frame_size);
+    u8 flags = end_of_stream ? flag_end_stream : 0;
+    if (first_fragment_size == header_block.size())
+        flags |= flag_end_headers;
+    TRY(queue_frame(FrameType::Headers, flags, stream_id, header_block.trim(first_fragment_size)));
+
+    for (size_t offset = first_fragment_size; offset < header_block.size(); offset += m_max_frame_size) {
+        auto fragment = header_block.slice(offset, min(header_block.size() - offset, m_max_frame_size));
+        TRY(queue_frame(FrameType::Continuation, offset + fragment.size() == header_block.size() ? flag_end_headers : 0, stream_id, fragment));
+    }
+    return {};
+}
+
+Http2Connection::ConnectionErrorOr<void> Http2Connection::queue_window_update(u32 stream_id, u32 increment)
+{
+    BigEndian<u32> payload = increment;
+    return queue_frame(FrameType::WindowUpdate, 0, stream_id, { &payload, sizeof(payload) });
+}
+
+Http2Connection::ConnectionErrorOr<void> Http2Connection::queue_rst_stream(u32 stream_id, ErrorCode error_code)
+{
+    BigEndian<u32> payload = to_underlying(error_code);
+    return queue_frame(FrameType::RstStream, 0, stream_id, { &payload, sizeof(payload) });
+}
+
+Http2Connection::ConnectionErrorOr<void> Http2Connection::queue_pending_body(Stream& stream)
+{
+    while (!stream.has_sent_end_of_stream && stream.send_window > 0 && m_send_window > 0) {
+        auto remaining = stream.pending_body.bytes().slice(stream.pending_body_offset);
+        auto size = min(min(remaining.size(), m_max_frame_size), static_cast<size_t>(min(stream.send_window, m_send_window)));
+        bool end_of_stream = size == remaining.size();
+        TRY(queue_frame(FrameType::Data, end_of_stream ? flag_end_stream : 0, stream.id, remaining.trim(size)));
+
+        stream.pending_body_offset += size;
+        stream.send_window -= size;
+        m_send_window -= size;
+        if (end_of_stream) {
+            stream.has_sent_end_of_stream = true;
+            stream.pending_body.clear();
+        }
+    }
+    return {};
+}
+
+Http2Connection::ConnectionErrorOr<void> Http2Connection::queue_pending_bodies()
+{
+    for (auto& it : m_streams)
+        TRY(queue_pending_body(*it.value));
+    return {};
+}
+
+void Http2Connection::flush()
+{
+    if (m_is_closed || m_write_buffer.is_empty())
+        return;
+
+    auto result = m_socket.write_entire_buffer(m_write_buffer);
+    m_write_buffer.clear();
+    if (result.is_error()) {
+        dbgln_if(HTTP2_DEBUG, "Http2Connection: Failed to write to the socket: {}", result.error());
+        did_lose_connection(Core::NetworkJob::Error::TransmissionFailed);
+    }
+}
+
+void Http2Connection::end_stream(u32 stream_id)
+{
+    auto stream = m_streams.take(stream_id);
+    if (!stream.has_value())
+        return;
+
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Stream {} has ended", stream_id);
+    // The response can be complete before all of the request body has been sent, which the server doesn't want anymore.
+    if (!stream.value()->has_sent_end_of_stream && !m_is_closed) {
+        if (auto result = queue_rst_stream(stream_id, ErrorCode::NoError); result.is_error())
+            return fail_connection(result.release_error());
+    }
+    if (on_stream_closed)
+        on_stream_closed();
+}
+
+Http2Connection::ConnectionErrorOr<void> Http2Connection::reset_stream(u32 stream_id, ErrorCode error_code)
+{
+    if (stream_id == 0)
+        return ConnectionError { error_code, "Stream error on the connection"sv };
+
+    dbgln_if(HTTP2_DEBUG, "Http2Connection: Resetting stream {} with error {}", stream_id, to_underlying(error_code));
+    TRY(queue_rst_stream(stream_id, error_code));
+    fail_stream(stream_id, Core::NetworkJob::Error::ProtocolFailed);
+    return {};
+}
+
+void Http2Connection::fail_stream(u32 stream_id, Core::NetworkJob::Error error)
+{
+    auto stream = m_streams.take(stream_id);
+    if (!stream.has_value())
+        return;
+
+    if (stream.value()->callbacks.on_error)
+        stream.value()->callbacks.on_error(error);
+    if (on_stream_closed)
+        on_stream_closed();
+}
+
+void Http2Connection::fail_all_streams(Core::NetworkJob::Error error)
+{
+    auto streams = move(m_streams);
+    for (auto& it : streams) {
+        if (it.value->callbacks.on_error)
+            it.value->callbacks.on_error(error);
+    }
+}
+
+void Http2Connection::fail_connection(ConnectionError error)
+{
+    if (m_is_closed)
+        return;
+
+    dbgln("Http2Connection: Giving up on the connection: {}", error.reason);
+    // We never accept any streams from the server, so the last one we processed is always zero.
+    ByteBuffer payload;
+    if (!append_big_endian<u32>(payload, 0).is_error() && !append_big_endian(payload, to_underlying(error.code)).is_error()) {
+        (void)queue_frame(FrameType::GoAway, 0, 0, payload);
+        flush();
+    }
+    did_lose_connection(Core::NetworkJob::Error::ProtocolFailed);
+}
+
+void Http2Connection::did_lose_connection(Core::NetworkJob::Error error)
+{
+    if (m_is_closed)
+        return;
+
+    NonnullRefPtr<Http2Connection> protector(*this);
+    m_is_closed = true;
+    m_socket.on_ready_to_read = nullptr;
+    m_socket.close();
+    fail_all_streams(error);
+    did_stop_accepting_streams();
+}
+
+void Http2Connection::did_stop_accepting_streams()
+{
+    if (m_is_going_away)
+        return;
+    m_is_going_away = true;
+    if (on_close)
+        on_close();
+}
+
+}
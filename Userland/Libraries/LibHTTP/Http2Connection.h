@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/RefCounted.h>
+#include <LibCore/NetworkJob.h>
+#include <LibCore/Object.h>
+#include <LibCore/Stream.h>
+#include <LibHTTP/HPACK.h>
+#include <LibHTTP/HttpRequest.h>
+
+namespace HTTP {
+
+// The client end of an HTTP/2 connection (RFC 9113), which carries any number of requests at once as separate streams.
+// The socket belongs to whoever created the connection, and has to outlive it or be given up with close().
+class Http2Connection final : public Core::Object {
+    C_OBJECT(Http2Connection);
+
+public:
+    enum class ErrorCode : u32 {
+        NoError = 0x0,
+        ProtocolError = 0x1,
+        InternalError = 0x2,
+        FlowControlError = 0x3,
+        SettingsTimeout = 0x4,
+        StreamClosed = 0x5,
+        FrameSizeError = 0x6,
+        RefusedStream = 0x7,
+        Cancel = 0x8,
+        CompressionError = 0x9,
+        ConnectError = 0xa,
+        EnhanceYourCalm = 0xb,
+        InadequateSecurity = 0xc,
+        HTTP11Required = 0xd,
+    };
+
+    struct StreamCallbacks {
+        // Called for the response headers, any informational responses before them, and the trailers after the body.
+        Function<void(Vector<HPACK::Header>, bool end_of_stream)> on_headers;
+        Function<void(ReadonlyBytes, bool end_of_stream)> on_data;
+        // The stream is gone after this, without having ended properly.
+        Function<void(Core::NetworkJob::Error)> on_error;
+    };
+
+    virtual ~Http2Connection() override;
+
+    // Sends the connection preface, after which streams can be opened right away.
+    ErrorOr<void> start();
+
+    ErrorOr<u32> open_stream(HttpRequest const&, StreamCallbacks);
+    // Forgets about a stream, and cancels it if it's still going.
+    void close_stream(u32 stream_id);
+
+    // Stops using the socket, failing any streams that are left.
+    void close();
+
+    // Not every socket becomes readable when the other end closes it (TLS sockets don't), so their owner has to tell us.
+    void socket_was_closed();
+
+    bool is_open() const { return !m_is_closed && !m_is_going_away; }
+    bool can_open_stream() const;
+    size_t active_stream_count() const { return m_streams.size(); }
+    Core::Stream::Socket const* socket() const { return &m_socket; }
+
+    // A stream has ended one way or another, so there may be room for another one now.
+    Function<void()> on_stream_closed;
+    // The server is done with us, or the connection broke. No new streams can be opened from now on.
+    Function<void()> on_close;
+
+private:
+    explicit Http2Connection(Core::Stream::Socket&);
+
+    enum class FrameType : u8 {
+        Data = 0x0,
+        Headers = 0x1,
+        Priority = 0x2,
+        RstStream = 0x3,
+        Settings = 0x4,
+        PushPromise = 0x5,
+        Ping = 0x6,
+        GoAway = 0x7,
+        WindowUpdate = 0x8,
+        Continuation = 0x9,
+    };
+
+    struct ConnectionError {
+        ErrorCode code { ErrorCode::ProtocolError };
+        StringView reason;
+    };
+    template<typename T>
+    using ConnectionErrorOr = ErrorOr<T, ConnectionError>;
+
+    struct Stream : public RefCounted<Stream> {
+        u32 id { 0 };
+        StreamCallbacks callbacks;
+        // Flow control windows, which the server may push into the negative by shrinking its initial window size.
+        i64 send_window { 0 };
+        i64 receive_window { 0 };
+        // What's left of the request body, waiting for the send window to open up.
+        ByteBuffer pending_body;
+        size_t pending_body_offset { 0 };
+        bool has_sent_end_of_stream { false };
+    };
+
+    void on_ready_to_read();
+    ConnectionErrorOr<void> process_received_frames();
+    ConnectionErrorOr<void> process_frame(FrameType, u8 flags, u32 stream_id, ReadonlyBytes payload);
+    ConnectionErrorOr<void> process_data_frame(u8 flags, u32 stream_id, ReadonlyBytes payload);
+    ConnectionErrorOr<void> process_headers_frame(u8 flags, u32 stream_id, ReadonlyBytes payload);
+    ConnectionErrorOr<void> process_continuation_frame(u8 flags, u32 stream_id, ReadonlyBytes payload);
+    ConnectionErrorOr<void> process_header_block();
+    ConnectionErrorOr<void> process_rst_stream_frame(u32 stream_id, ReadonlyBytes payload);
+    ConnectionErrorOr<void> process_settings_frame(u8 flags, u32 stream_id, ReadonlyBytes payload);
+    ConnectionErrorOr<void> process_ping_frame(u8 flags, u32 stream_id, ReadonlyBytes payload);
+    ConnectionErrorOr<void> process_goaway_frame(u32 stream_id, ReadonlyBytes payload);
+    ConnectionErrorOr<void> process_window_update_frame(u32 stream_id, ReadonlyBytes payload);
+
+    // The stream the server sent something for, or null if we're done with it. Streams we never opened are an error.
+    ConnectionErrorOr<RefPtr<Stream>> find_stream(u32 stream_id);
+
+    ConnectionErrorOr<void> queue_frame(FrameType, u8 flags, u32 stream_id, ReadonlyBytes payload);
+    ConnectionErrorOr<void> queue_header_block(u32 stream_id, ReadonlyBytes header_block, bool end_of_stream);
+    ConnectionErrorOr<void> queue_window_update(u32 stream_id, u32 increment);
+    ConnectionErrorOr<void> queue_rst_stream(u32 stream_id, ErrorCode);
+    ConnectionErrorOr<void> queue_pending_body(Stream&);
+    ConnectionErrorOr<void> queue_pending_bodies();
+    void flush();
+
+    void end_stream(u32 stream_id);
+    ConnectionErrorOr<void> reset_stream(u32 stream_id, ErrorCode);
+    void fail_stream(u32 stream_id, Core::NetworkJob::Error);
+    void fail_all_streams(Core::NetworkJob::Error);
+    void fail_connection(ConnectionError);
+    void did_lose_connection(Core::NetworkJob::Error);
+    void did_stop_accepting_streams();
+
+    Core::Stream::Socket& m_socket;
+    bool m_is_closed { false };
+    ByteBuffer m_read_buffer;
+    ByteBuffer m_write_buffer;
+
+    HPACK::Encoder m_encoder;
+    HPACK::Decoder m_decoder;
+
+    HashMap<u32, NonnullRefPtr<Stream>> m_streams;
+    u32 m_next_stream_id { 1 };
+
+    // A header block that is split over several frames, which nothing else may come between.
+    ByteBuffer m_header_block;
+    u32 m_header_block_stream_id { 0 };
+    bool m_header_block_ends_stream { false };
+
+    // What the server told us in its SETTINGS.
+    size_t m_max_concurrent_streams;
+    size_t m_max_frame_size;
+    i64 m_initial_send_window;
+
+    i64 m_send_window;
+    i64 m_receive_window;
+
+    bool m_is_going_away { false };
+};
+
+}
@@ -8,12 +8,9 @@
 #include <AK/CharacterTypes.h>
 #include <AK/Debug.h>
 #include <AK/JsonObject.h>
-#include <AK/MemoryStream.h>
 #include <AK/Try.h>
-#include <LibCompress/Brotli.h>
-#include <LibCompress/Gzip.h>
-#include <LibCompress/Zlib.h>
 #include <LibCore/Event.h>
+#include <LibHTTP/ContentDecoder.h>
 #include <LibHTTP/HttpResponse.h>
 #include <LibHTTP/Job.h>
 #include <stdio.h>
@@ -21,71 +18,6 @@
 
 namespace HTTP {
 
-static ErrorOr<ByteBuffer> handle_content_encoding(ByteBuffer const& buf, DeprecatedString const& content_encoding)
-{
-    dbgln_if(JOB_DEBUG, "Job::handle_content_encoding: buf has content_encoding={}", content_encoding);
-
-    // FIXME: Actually do the decompression of the data using streams, instead of all at once when everything has been
-    //        received. This will require that some of the decompression algorithms are implemented in a streaming way.
-    //        Gzip and Deflate are implemented using AK::Stream, while Brotli uses the newer Core::Stream. The Gzip and
-    //        Deflate implementations will likely need to be changed to LibCore::Stream for this to work easily.
-
-    if (content_encoding == "gzip") {
-        if (!Compress::GzipDecompressor::is_likely_compressed(buf)) {
-            dbgln("Job::handle_content_encoding: buf is not gzip compressed!");
-        }
-
-        dbgln_if(JOB_DEBUG, "Job::handle_content_encoding: buf is gzip compressed!");
-
-        auto uncompressed = TRY(Compress::GzipDecompressor::decompress_all(buf));
-
-        if constexpr (JOB_DEBUG) {
-            dbgln("Job::handle_content_encoding: Gzip::decompress() successful.");
-            dbgln("  Input size: {}", buf.size());
-            dbgln("  Output size: {}", uncompressed.size());
-        }
-
-        return uncompressed;
-    } else if (content_encoding == "deflate") {
-        dbgln_if(JOB_DEBUG, "Job::handle_content_encoding: buf is deflate compressed!");
-
-        // Even though the content encoding is "deflate", it's actually deflate with the zlib wrapper.
-        // https://tools.ietf.org/html/rfc7230#section-4.2.2
-        auto uncompressed = Compress::ZlibDecompressor::decompress_all(buf);
-        if (!uncompressed.has_value()) {
-            // From the RFC:
-            // "Note: Some non-conformant implementations send the "deflate"
-            //        compressed data without the zlib wrapper."
-            dbgln_if(JOB_DEBUG, "Job::handle_content_encoding: ZlibDecompressor::decompress_all() failed. Trying DeflateDecompressor::decompress_all()");
-            uncompressed = TRY(Compress::DeflateDecompressor::decompress_all(buf));
-        }
-
-        if constexpr (JOB_DEBUG) {
-            dbgln("Job::handle_content_encoding: Deflate decompression successful.");
-            dbgln("  Input size: {}", buf.size());
-            dbgln("  Output size: {}", uncompressed.value().size());
-        }
-
-        return uncompressed.release_value();
-    } else if (content_encoding == "br") {
-        dbgln_if(JOB_DEBUG, "Job::handle_content_encoding: buf is brotli compressed!");
-
-        FixedMemoryStream bufstream { buf };
-        auto brotli_stream = Compress::BrotliDecompressionStream { bufstream };
-
-        auto uncompressed = TRY(brotli_stream.read_until_eof());
-        if constexpr (JOB_DEBUG) {
-            dbgln("Job::handle_content_encoding: Brotli::decompress() successful.");
-            dbgln("  Input size: {}", buf.size());
-            dbgln("  Output size: {}", uncompressed.size());
-        }
-
-        return uncompressed;
-    }
-
-    return buf;
-}
-
 Job::Job(HttpRequest&& request, AK::Stream& output_stream)
     : Core::NetworkJob(output_stream)
     , m_request(move(request))
@@ -103,8 +35,46 @@ void Job::start(Core::Stream::Socket& socket)
     });
 }
 
+Job::~Job()
+{
+    if (m_http2_connection)
+        m_http2_connection->close_stream(m_http2_stream_id);
+}
+
+void Job::start(Http2Connection& connection)
+{
+    VERIFY(!m_socket && !m_http2_connection);
+    m_http2_connection = connection;
+    dbgln_if(HTTPJOB_DEBUG, "Sending request for {} over HTTP/2", url());
+
+    auto stream_id = connection.open_stream(m_request,
+        {
+            .on_headers = [this](auto headers, bool end_of_stream) { handle_http2_headers(move(headers), end_of_stream); },
+            .on_data = [this](auto data, bool end_of_stream) { handle_http2_data(data, end_of_stream); },
+            .on_error = [this](auto error) { deferred_invoke([this, error] { did_fail(error); }); },
+        });
+    if (stream_id.is_error()) {
+        dbgln_if(JOB_DEBUG, "Job: Failed to open an HTTP/2 stream for {}: {}", url(), stream_id.error());
+        return deferred_invoke([this] { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
+    }
+    m_http2_stream_id = stream_id.value();
+}
+
+Core::Stream::Socket const* Job::socket() const
+{
+    if (m_http2_connection)
+        return m_http2_connection->socket();
+    return m_socket;
+}
+
 void Job::shutdown(ShutdownMode mode)
 {
+    if (m_http2_connection) {
+        // The connection isn't ours to close, so just stop caring about our stream.
+        auto connection = move(m_http2_connection);
+        connection->close_stream(m_http2_stream_id);
+        return;
+    }
     if (!m_socket)
         return;
     if (mode == ShutdownMode::CloseSocket) {
@@ -118,7 +88,7 @@ void Job::shutdown(ShutdownMode mode)
 
 void Job::flush_received_buffers()
 {
-    if (!m_can_stream_response || m_buffered_size == 0)
+    if (m_buffered_size == 0)
         return;
     dbgln_if(JOB_DEBUG, "Job: Flushing received buffers: have {} bytes in {} buffers for {}", m_buffered_size, m_received_buffers.size(), m_request.url());
     for (size_t i = 0; i < m_received_buffers.size(); ++i) {
@@ -312,12 +282,8 @@ void Job::on_socket_connected()
                 if (m_state == State::Trailers) {
                     return finish_up();
                 }
-                if (on_headers_received) {
-                    if (!m_set_cookie_headers.is_empty())
-                        m_headers.set("Set-Cookie", JsonArray { m_set_cookie_headers }.to_deprecated_string());
-                    on_headers_received(m_headers, m_code > 0 ? m_code : Optional<u32> {});
-                }
-                m_state = State::InBody;
+                if (did_receive_all_headers().is_error())
+                    return did_fail(Core::NetworkJob::Error::TransmissionFailed);
 
                 // We've reached the end of the headers, there's a possibility that the server
                 // responds with nothing (content-length = 0 with normal encoding); if that's the case,
@@ -357,34 +323,7 @@ void Job::on_socket_connected()
                 return deferred_invoke([this] { did_fail(Core::NetworkJob::Error::ProtocolFailed); });
             }
             auto value = line.substring(name.length() + 2, line.length() - name.length() - 2);
-            if (name.equals_ignoring_case("Set-Cookie"sv)) {
-                dbgln_if(JOB_DEBUG, "Job: Received Set-Cookie header: '{}'", value);
-                m_set_cookie_headers.append(move(value));
-
-                auto can_read_without_blocking = m_socket->can_read_without_blocking();
-                if (can_read_without_blocking.is_error())
-                    return deferred_invoke([this] { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
-                if (!can_read_without_blocking.value())
-                    return;
-            } else if (auto existing_value = m_headers.get(name); existing_value.has_value()) {
-                StringBuilder builder;
-                builder.append(existing_value.value());
-                builder.append(',');
-                builder.append(value);
-                m_headers.set(name, builder.to_deprecated_string());
-            } else {
-                m_headers.set(name, value);
-            }
-            if (name.equals_ignoring_case("Content-Encoding"sv)) {
-                // Assume that any content-encoding means that we can't decode it as a stream :(
-                dbgln_if(JOB_DEBUG, "Content-Encoding {} detected, cannot stream output :(", value);
-                m_can_stream_response = false;
-            } else if (name.equals_ignoring_case("Content-Length"sv)) {
-                auto length = value.to_uint();
-                if (length.has_value())
-                    m_content_length = length.value();
-            }
-            dbgln_if(JOB_DEBUG, "Job: [{}] = '{}'", name, value);
+            add_response_header(name, move(value));
 
             auto can_read_without_blocking = m_socket->can_read_without_blocking();
             if (can_read_without_blocking.is_error())
@@ -510,12 +449,10 @@ void Job::on_socket_connected()
                 }
             }
 
-            m_received_buffers.append(make<ReceivedBuffer>(payload));
-            m_buffered_size += payload.size();
-            m_received_size += payload.size();
-            flush_received_buffers();
-
-            deferred_invoke([this] { did_progress(m_content_length, m_received_size); });
+            // Chunk sizes count what was sent, not what it decodes to.
+            auto payload_size = payload.size();
+            if (auto result = handle_body_payload(move(payload)); result.is_error())
+                return deferred_invoke([this] { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
 
             if (read_everything) {
                 VERIFY(m_received_size <= m_content_length.value());
@@ -532,7 +469,7 @@ void Job::on_socket_connected()
             }
 
             if (m_current_chunk_remaining_size.has_value()) {
-                auto size = m_current_chunk_remaining_size.value() - payload.size();
+                auto size = m_current_chunk_remaining_size.value() - payload_size;
 
                 dbgln_if(JOB_DEBUG, "Job: We have {} bytes left over in this chunk", size);
                 if (size == 0) {
@@ -571,6 +508,129 @@ void Job::on_socket_connected()
     });
 }
 
+void Job::add_response_header(StringView name, DeprecatedString value)
+{
+    if (name.equals_ignoring_case("Set-Cookie"sv)) {
+        dbgln_if(JOB_DEBUG, "Job: Received Set-Cookie header: '{}'", value);
+        m_set_cookie_headers.append(move(value));
+        return;
+    }
+
+    dbgln_if(JOB_DEBUG, "Job: [{}] = '{}'", name, value);
+    if (name.equals_ignoring_case("Content-Length"sv)) {
+        auto length = value.to_uint();
+        if (length.has_value())
+            m_content_length = length.value();
+    }
+    if (auto existing_value = m_headers.get(name); existing_value.has_value()) {
+        StringBuilder builder;
+        builder.append(existing_value.value());
+        builder.append(',');
+        builder.append(value);
+        m_headers.set(name, builder.to_deprecated_string());
+    } else {
+        m_headers.set(name, move(value));
+    }
+}
+
+ErrorOr<void> Job::did_receive_all_headers()
+{
+    if (on_headers_received) {
+        if (!m_set_cookie_headers.is_empty())
+            m_headers.set("Set-Cookie", JsonArray { m_set_cookie_headers }.to_deprecated_string());
+        on_headers_received(m_headers, m_code > 0 ? m_code : Optional<u32> {});
+    }
+    m_state = State::InBody;
+
+    if (auto content_encoding = m_headers.get("Content-Encoding"sv); content_encoding.has_value()) {
+        m_content_decoder = TRY(ContentDecoder::create(content_encoding.value()));
+        dbgln_if(JOB_DEBUG, "Job: Content-Encoding {}, {}", content_encoding.value(), m_content_decoder ? "decoding as we go" : "passing it on as is");
+    }
+    return {};
+}
+
+ErrorOr<void> Job::handle_body_payload(ByteBuffer payload)
+{
+    m_received_size += payload.size();
+    if (m_content_decoder) {
+        auto decoded_payload = m_content_decoder->decode(payload);
+        if (decoded_payload.is_error()) {
+            dbgln_if(JOB_DEBUG, "Job: Failed to decode response body: {}", decoded_payload.error());
+            return decoded_payload.release_error();
+        }
+        payload = decoded_payload.release_value();
+    }
+    if (!payload.is_empty()) {
+        m_buffered_size += payload.size();
+        m_received_buffers.append(make<ReceivedBuffer>(move(payload)));
+    }
+    flush_received_buffers();
+
+    deferred_invoke([this] { did_progress(m_content_length, m_received_size); });
+    return {};
+}
+
+void Job::handle_http2_headers(Vector<HPACK::Header> headers, bool end_of_stream)
+{
+    if (is_cancelled() || m_state == State::Finished)
+        return;
+
+    if (m_state == State::InBody) {
+        // Trailers, which are kept with the other headers just like the ones at the end of a chunked HTTP/1.1 response.
+        for (auto& header : headers)
+            add_response_header(header.name, move(header.value));
+        if (!end_of_stream)
+            return fail_http2_stream(Core::NetworkJob::Error::ProtocolFailed);
+        return finish_up();
+    }
+
+    auto status = headers.first_matching([](auto& header) { return header.name == ":status"; });
+    auto code = status.has_value() ? status->value.to_uint() : Optional<unsigned> {};
+    if (!code.has_value()) {
+        dbgln("Job: Expected HTTP/2 response to have a valid status");
+        return fail_http2_stream(Core::NetworkJob::Error::ProtocolFailed);
+    }
+    // Informational responses come before the actual one, which is all we care about.
+    if (*code >= 100 && *code < 200 && !end_of_stream)
+        return;
+
+    m_code = *code;
+    for (auto& header : headers) {
+        if (!header.name.starts_with(':'))
+            add_response_header(header.name, move(header.value));
+    }
+
+    if (did_receive_all_headers().is_error())
+        return fail_http2_stream(Core::NetworkJob::Error::TransmissionFailed);
+    if (end_of_stream)
+        finish_up();
+}
+
+void Job::handle_http2_data(ReadonlyBytes data, bool end_of_stream)
+{
+    if (is_cancelled() || m_state == State::Finished)
+        return;
+    if (m_state != State::InBody) {
+        dbgln("Job: Received HTTP/2 response data before its headers");
+        return fail_http2_stream(Core::NetworkJob::Error::ProtocolFailed);
+    }
+
+    auto payload = ByteBuffer::copy(data);
+    if (payload.is_error())
+        return fail_http2_stream(Core::NetworkJob::Error::TransmissionFailed);
+    if (auto result = handle_body_payload(payload.release_value()); result.is_error())
+        return fail_http2_stream(Core::NetworkJob::Error::TransmissionFailed);
+    if (end_of_stream)
+        finish_up();
+}
+
+void Job::fail_http2_stream(Core::NetworkJob::Error error)
+{
+    // Nothing the server sends for the stream after this makes sense to us anymore.
+    m_http2_connection->close_stream(m_http2_stream_id);
+    deferred_invoke([this, error] { did_fail(error); });
+}
+
 void Job::timer_event(Core::TimerEvent& event)
 {
     event.accept();
@@ -583,32 +643,16 @@ void Job::finish_up()
 {
     VERIFY(!m_has_scheduled_finish);
     m_state = State::Finished;
-    if (!m_can_stream_response) {
-        auto maybe_flattened_buffer = ByteBuffer::create_uninitialized(m_buffered_size);
-        if (maybe_flattened_buffer.is_error())
+    if (auto content_decoder = move(m_content_decoder)) {
+        auto decoded_rest = content_decoder->finish();
+        if (decoded_rest.is_error()) {
+            dbgln_if(JOB_DEBUG, "Job: Failed to decode response body: {}", decoded_rest.error());
             return did_fail(Core::NetworkJob::Error::TransmissionFailed);
-        auto flattened_buffer = maybe_flattened_buffer.release_value();
-
-        u8* flat_ptr = flattened_buffer.data();
-        for (auto& received_buffer : m_received_buffers) {
-            memcpy(flat_ptr, received_buffer.pending_flush.data(), received_buffer.pending_flush.size());
-            flat_ptr += received_buffer.pending_flush.size();
         }
-        m_received_buffers.clear();
-
-        // For the time being, we cannot stream stuff with content-encoding set to _anything_.
-        // FIXME: LibCompress exposes a streaming interface, so this can be resolved
-        auto content_encoding = m_headers.get("Content-Encoding");
-        if (content_encoding.has_value()) {
-            if (auto result = handle_content_encoding(flattened_buffer, content_encoding.value()); !result.is_error())
-                flattened_buffer = result.release_value();
-            else
-                return did_fail(Core::NetworkJob::Error::TransmissionFailed);
+        if (!decoded_rest.value().is_empty()) {
+            m_buffered_size += decoded_rest.value().size();
+            m_received_buffers.append(make<ReceivedBuffer>(decoded_rest.release_value()));
         }
-
-        m_buffered_size = flattened_buffer.size();
-        m_received_buffers.append(make<ReceivedBuffer>(move(flattened_buffer)));
-        m_can_stream_response = true;
     }
 
     flush_received_buffers();
@@ -10,6 +10,8 @@
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/Optional.h>
 #include <LibCore/NetworkJob.h>
+#include <LibHTTP/ContentDecoder.h>
+#include <LibHTTP/Http2Connection.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibHTTP/HttpResponse.h>
 
@@ -20,12 +22,14 @@ class Job : public Core::NetworkJob {
 
 public:
     explicit Job(HttpRequest&&, AK::Stream&);
-    virtual ~Job() override = default;
+    virtual ~Job() override;
 
     virtual void start(Core::Stream::Socket&) override;
+    // Sends the request as a stream of its own on a connection that other jobs may be using at the same time.
+    void start(Http2Connection&);
     virtual void shutdown(ShutdownMode) override;
 
-    Core::Stream::Socket const* socket() const { return m_socket; }
+    Core::Stream::Socket const* socket() const;
     URL url() const { return m_request.url(); }
 
     HttpResponse* response() { return static_cast<HttpResponse*>(Core::NetworkJob::response()); }
@@ -38,6 +42,12 @@ protected:
     void register_on_ready_to_read(Function<void()>);
     ErrorOr<DeprecatedString> read_line(size_t);
     ErrorOr<ByteBuffer> receive(size_t);
+    void add_response_header(StringView name, DeprecatedString value);
+    ErrorOr<void> did_receive_all_headers();
+    ErrorOr<void> handle_body_payload(ByteBuffer);
+    void handle_http2_headers(Vector<HPACK::Header>, bool end_of_stream);
+    void handle_http2_data(ReadonlyBytes, bool end_of_stream);
+    void fail_http2_stream(Core::NetworkJob::Error);
     void timer_event(Core::TimerEvent&) override;
 
     enum class State {
@@ -51,6 +61,8 @@ protected:
     HttpRequest m_request;
     State m_state { State::InStatus };
     Core::Stream::BufferedSocketBase* m_socket { nullptr };
+    RefPtr<Http2Connection> m_http2_connection;
+    u32 m_http2_stream_id { 0 };
     bool m_legacy_connection { false };
     int m_code { -1 };
     HashMap<DeprecatedString, DeprecatedString, CaseInsensitiveStringTraits> m_headers;
@@ -77,7 +89,7 @@ protected:
     Optional<u32> m_content_length;
     Optional<ssize_t> m_current_chunk_remaining_size;
     Optional<size_t> m_current_chunk_total_size;
-    bool m_can_stream_response { true };
+    OwnPtr<ContentDecoder> m_content_decoder;
     bool m_should_read_chunk_ending_line { false };
     bool m_has_scheduled_finish { false };
 };
@@ -8,6 +8,8 @@
 
 namespace JS::Bytecode {
 
+PropertyLookupCacheStatistics g_property_lookup_cache_statistics;
+
 void Executable::dump() const
 {
     dbgln("\033[33;1mJS::Bytecode::Executable\033[0m ({})", name);
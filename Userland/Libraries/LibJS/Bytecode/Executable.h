@@ -6,19 +6,81 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/DeprecatedFlyString.h>
 #include <AK/NonnullOwnPtrVector.h>
+#include <AK/WeakPtr.h>
 #include <LibJS/Bytecode/BasicBlock.h>
 #include <LibJS/Bytecode/IdentifierTable.h>
 #include <LibJS/Bytecode/StringTable.h>
+#include <LibJS/Runtime/Shape.h>
 
 namespace JS::Bytecode {
 
+// Remembers where a GetById or PutById found its property for the last few shapes it has seen,
+// so that it can go straight to the object's storage the next time it sees one of them.
+struct PropertyLookupCache {
+    static constexpr size_t max_number_of_shapes = 4;
+
+    struct Entry {
+        WeakPtr<Shape> shape;
+        u32 property_offset { 0 };
+        u32 unique_shape_serial_number { 0 };
+
+        bool matches(Shape const& other) const
+        {
+            return shape.ptr() == &other && (!other.is_unique() || unique_shape_serial_number == other.unique_shape_serial_number());
+        }
+    };
+
+    Optional<u32> lookup(Shape const& shape) const
+    {
+        for (auto const& entry : entries) {
+            if (entry.matches(shape))
+                return entry.property_offset;
+        }
+        return {};
+    }
+
+    void update(Shape& shape, u32 property_offset)
+    {
+        Entry* entry_to_replace = nullptr;
+        for (auto& entry : entries) {
+            if (!entry.shape || entry.shape.ptr() == &shape) {
+                entry_to_replace = &entry;
+                break;
+            }
+        }
+        // Once a site has seen more shapes than we have room for, evict them in round-robin order.
+        if (!entry_to_replace) {
+            entry_to_replace = &entries[next_entry_to_evict];
+            next_entry_to_evict = (next_entry_to_evict + 1) % max_number_of_shapes;
+        }
+        entry_to_replace->shape = shape;
+        entry_to_replace->property_offset = property_offset;
+        entry_to_replace->unique_shape_serial_number = shape.unique_shape_serial_number();
+    }
+
+    AK::Array<Entry, max_number_of_shapes> entries;
+    u8 next_entry_to_evict { 0 };
+};
+
+struct PropertyLookupCacheStatistics {
+    u64 get_hits { 0 };
+    u64 get_misses { 0 };
+    u64 put_hits { 0 };
+    u64 put_misses { 0 };
+};
+
+extern PropertyLookupCacheStatistics g_property_lookup_cache_statistics;
+
 struct Executable {
     DeprecatedFlyString name;
     NonnullOwnPtrVector<BasicBlock> basic_blocks;
     NonnullOwnPtr<StringTable> string_table;
     NonnullOwnPtr<IdentifierTable> identifier_table;
+    // Indexed by the cache index of GetById and PutById. These are filled in as the code runs.
+    mutable Vector<PropertyLookupCache> property_lookup_caches;
     size_t number_of_registers { 0 };
     bool is_strict_mode { false };
 
@@ -48,7 +48,7 @@ DeprecatedString Instruction::to_deprecated_string(Bytecode::Executable const& e
 
 namespace JS::Bytecode::Op {
 
-static ThrowCompletionOr<void> put_by_property_key(Object* object, Value value, PropertyKey name, Bytecode::Interpreter& interpreter, PropertyKind kind)
+static ThrowCompletionOr<void> put_by_property_key(Object* object, Value value, PropertyKey name, Bytecode::Interpreter& interpreter, PropertyKind kind, CacheablePropertyMetadata* cacheable_metadata = nullptr)
 {
     auto& vm = interpreter.vm();
 
@@ -72,7 +72,7 @@ static ThrowCompletionOr<void> put_by_property_key(Object* object, Value value,
         break;
     }
     case PropertyKind::KeyValue: {
-        bool succeeded = TRY(object->internal_set(name, interpreter.accumulator(), object));
+        bool succeeded = TRY(object->internal_set(name, interpreter.accumulator(), object, cacheable_metadata));
         if (!succeeded && vm.in_strict_mode())
             return vm.throw_completion<TypeError>(ErrorType::ReferenceNullishSetProperty, name, interpreter.accumulator().to_string_without_side_effects());
         break;
@@ -492,18 +492,67 @@ ThrowCompletionOr<void> SetVariable::execute_impl(Bytecode::Interpreter& interpr
 ThrowCompletionOr<void> GetById::execute_impl(Bytecode::Interpreter& interpreter) const
 {
     auto& vm = interpreter.vm();
-    auto* object = TRY(interpreter.accumulator().to_object(vm));
-    interpreter.accumulator() = TRY(object->get(interpreter.current_executable().get_identifier(m_property)));
+    auto base = interpreter.accumulator();
+
+    // Primitives get a fresh wrapper object every time, so there's nothing to cache for them. Neither is there for
+    // objects that can have properties their shape doesn't know about.
+    if (!base.is_object() || !base.as_object().is_eligible_for_property_lookup_caches()) {
+        auto* object = TRY(base.to_object(vm));
+        interpreter.accumulator() = TRY(object->get(interpreter.current_executable().get_identifier(m_property)));
+        return {};
+    }
+
+    auto& object = base.as_object();
+    auto& cache = interpreter.current_executable().property_lookup_caches[m_cache_index];
+    if (auto property_offset = cache.lookup(object.shape()); property_offset.has_value()) {
+        // NOTE: An empty value is an intrinsic accessor that hasn't been materialized yet, which needs the slow path.
+        auto value = object.get_direct(*property_offset);
+        if (!value.is_empty() && !value.is_accessor()) {
+            ++g_property_lookup_cache_statistics.get_hits;
+            interpreter.accumulator() = value;
+            return {};
+        }
+    }
+
+    ++g_property_lookup_cache_statistics.get_misses;
+    CacheablePropertyMetadata cacheable_metadata;
+    interpreter.accumulator() = TRY(object.internal_get(interpreter.current_executable().get_identifier(m_property), &object, &cacheable_metadata));
+    if (cacheable_metadata.property_offset.has_value())
+        cache.update(object.shape(), *cacheable_metadata.property_offset);
     return {};
 }
 
 ThrowCompletionOr<void> PutById::execute_impl(Bytecode::Interpreter& interpreter) const
 {
     auto& vm = interpreter.vm();
-    auto* object = TRY(interpreter.reg(m_base).to_object(vm));
-    PropertyKey name = interpreter.current_executable().get_identifier(m_property);
+    auto base = interpreter.reg(m_base);
     auto value = interpreter.accumulator();
-    return put_by_property_key(object, value, name, interpreter, m_kind);
+
+    if (m_kind != PropertyKind::KeyValue || !base.is_object() || !base.as_object().is_eligible_for_property_lookup_caches()) {
+        auto* object = TRY(base.to_object(vm));
+        PropertyKey name = interpreter.current_executable().get_identifier(m_property);
+        return put_by_property_key(object, value, name, interpreter, m_kind);
+    }
+
+    auto& object = base.as_object();
+    auto& cache = interpreter.current_executable().property_lookup_caches[m_cache_index];
+    if (auto property_offset = cache.lookup(object.shape()); property_offset.has_value()) {
+        // NOTE: The cache only ever holds writable data properties, and changing that changes the shape.
+        auto old_value = object.get_direct(*property_offset);
+        if (!old_value.is_empty() && !old_value.is_accessor()) {
+            ++g_property_lookup_cache_statistics.put_hits;
+            object.put_direct(*property_offset, value);
+            return {};
+        }
+    }
+
+    ++g_property_lookup_cache_statistics.put_misses;
+    CacheablePropertyMetadata cacheable_metadata;
+    PropertyKey name = interpreter.current_executable().get_identifier(m_property);
+    TRY(put_by_property_key(&object, value, name, interpreter, m_kind, &cacheable_metadata));
+    if (cacheable_metadata.property_offset.has_value())
+        cache.update(object.shape(), *cacheable_metadata.property_offset);
+    return {};
 }
 
 ThrowCompletionOr<void> DeleteById::execute_impl(Bytecode::Interpreter& interpreter) const
@@ -1168,12 +1217,12 @@ DeprecatedString PutById::to_deprecated_string_impl(Bytecode::Executable const&
         ? "setter"
         : "property";
 
-    return DeprecatedString::formatted("PutById kind:{} base:{}, property:{} ({})", kind, m_base, m_property, executable.identifier_table->get(m_property));
+    return DeprecatedString::formatted("PutById kind:{} base:{}, property:{} ({}), cache:{}", kind, m_base, m_property, executable.identifier_table->get(m_property), m_cache_index);
 }
 
 DeprecatedString GetById::to_deprecated_string_impl(Bytecode::Executable const& executable) const
 {
-    return DeprecatedString::formatted("GetById {} ({})", m_property, executable.identifier_table->get(m_property));
+    return DeprecatedString::formatted("GetById {} ({}), cache:{}", m_property, executable.identifier_table->get(m_property), m_cache_index);
 }
 
 DeprecatedString DeleteById::to_deprecated_string_impl(Bytecode::Executable const& executable) const
@@ -40,6 +40,8 @@ public:
             m_src = to;
     }
 
+    Register src() const { return m_src; }
+
 private:
     Register m_src;
 };
@@ -72,7 +74,11 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     DeprecatedString to_deprecated_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
-    void replace_references_impl(Register, Register) { }
+    void replace_references_impl(Register from, Register to)
+    {
+        if (m_dst == from)
+            m_dst = to;
+    }
 
     Register dst() const { return m_dst; }
 
@@ -124,6 +130,8 @@ private:
                 m_lhs_reg = to;                                                        \
         }                                                                              \
                                                                                        \
+        Register lhs() const { return m_lhs_reg; }                                     \
+                                                                                       \
     private:                                                                           \
         Register m_lhs_reg;                                                            \
     };
@@ -255,6 +263,9 @@ public:
 
     size_t length_impl() const { return sizeof(*this) + sizeof(Register) * m_excluded_names_count; }
 
+    Register from_object() const { return m_from_object; }
+    Span<Register const> excluded_names() const { return { m_excluded_names, m_excluded_names_count }; }
+
 private:
     Register m_from_object;
     size_t m_excluded_names_count { 0 };
@@ -298,9 +309,16 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     DeprecatedString to_deprecated_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
-    // Note: The underlying element range shall never be changed item, by item
-    //       shifting it may be done in the future
-    void replace_references_impl(Register from, Register) { VERIFY(!m_element_count || from.index() < start().index() || from.index() > end().index()); }
+    // Note: The underlying element range shall never be changed item by item, instead the whole range
+    //       is shifted when its first register is replaced. Replacing any other register in the range
+    //       does nothing, so the caller has to move the rest of the range along with the first one.
+    void replace_references_impl(Register from, Register to)
+    {
+        if (m_element_count && m_elements[0] == from) {
+            m_elements[1] = Register(to.index() + m_elements[1].index() - from.index());
+            m_elements[0] = to;
+        }
+    }
 
     size_t length_impl() const
     {
@@ -339,8 +357,13 @@ public:
     DeprecatedString to_deprecated_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
 
-    // Note: This should never do anything, the lhs should always be an array, that is currently being constructed
-    void replace_references_impl(Register from, Register) { VERIFY(from != m_lhs); }
+    void replace_references_impl(Register from, Register to)
+    {
+        if (m_lhs == from)
+            m_lhs = to;
+    }
+
+    Register lhs() const { return m_lhs; }
 
 private:
     Register m_lhs;
@@ -371,8 +394,14 @@ public:
     ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
     DeprecatedString to_deprecated_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
-    // Note: lhs should always be a string in construction, so this should never do anything
-    void replace_references_impl(Register from, Register) { VERIFY(from != m_lhs); }
+    void replace_references_impl(Register from, Register to)
+    {
+        if (m_lhs == from)
+            m_lhs = to;
+    }
+
+    // Note: This is both read and written, as the string is built up in place.
+    Register lhs() const { return m_lhs; }
 
 private:
     Register m_lhs;
@@ -506,9 +535,10 @@ private:
 
 class GetById final : public Instruction {
 public:
-    explicit GetById(IdentifierTableIndex property)
+    GetById(IdentifierTableIndex property, u32 cache_index)
         : Instruction(Type::GetById)
         , m_property(property)
+        , m_cache_index(cache_index)
     {
     }
 
@@ -519,6 +549,7 @@ public:
 
 private:
     IdentifierTableIndex m_property;
+    u32 m_cache_index { 0 };
 };
 
 enum class PropertyKind {
@@ -531,11 +562,12 @@ enum class PropertyKind {
 
 class PutById final : public Instruction {
 public:
-    explicit PutById(Register base, IdentifierTableIndex property, PropertyKind kind = PropertyKind::KeyValue)
+    PutById(Register base, IdentifierTableIndex property, u32 cache_index, PropertyKind kind = PropertyKind::KeyValue)
         : Instruction(Type::PutById)
         , m_base(base)
         , m_property(property)
         , m_kind(kind)
+        , m_cache_index(cache_index)
     {
     }
 
@@ -548,10 +580,13 @@ public:
             m_base = to;
     }
 
+    Register base() const { return m_base; }
+
 private:
     Register m_base;
     IdentifierTableIndex m_property;
     PropertyKind m_kind;
+    u32 m_cache_index { 0 };
 };
 
 class DeleteById final : public Instruction {
@@ -588,6 +623,8 @@ public:
             m_base = to;
     }
 
+    Register base() const { return m_base; }
+
 private:
     Register m_base;
 };
@@ -609,8 +646,13 @@ public:
     {
         if (m_base == from)
             m_base = to;
+        if (m_property == from)
+            m_property = to;
     }
 
+    Register base() const { return m_base; }
+    Register property() const { return m_property; }
+
 private:
     Register m_base;
     Register m_property;
@@ -634,6 +676,8 @@ public:
             m_base = to;
     }
 
+    Register base() const { return m_base; }
+
 private:
     Register m_base;
 };
@@ -732,6 +776,9 @@ public:
 
     Completion throw_type_error_for_callee(Bytecode::Interpreter&, StringView callee_type) const;
 
+    Register callee() const { return m_callee; }
+    Register this_value() const { return m_this_value; }
+
 private:
     Register m_callee;
     Register m_this_value;
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashTable.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/Pass/Liveness.h>
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+void EliminateDeadStores::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    auto liveness = compute_liveness(executable.executable);
+
+    // A store to a register that is never read again has no effect, as a Store doesn't touch anything else.
+    HashTable<Instruction const*> dead_stores;
+    for (auto const& block : executable.executable.basic_blocks) {
+        liveness.for_each_instruction_backwards(block, [&](Instruction const& instruction, RegisterSet const& live_after) {
+            if (instruction.type() != Instruction::Type::Store)
+                return;
+            auto dst = static_cast<Op::Store const&>(instruction).dst();
+            if (dst != Register::accumulator() && !live_after.contains(dst.index()))
+                dead_stores.set(&instruction);
+        });
+    }
+
+    if (dead_stores.is_empty()) {
+        finished();
+        return;
+    }
+
+    // The old blocks are kept alive until all references to them are gone, so that a new block
+    // can't end up at the address of an old one while we're still looking for that address.
+    HashMap<BasicBlock const*, BasicBlock const*> replaced_blocks;
+    NonnullOwnPtrVector<BasicBlock> old_blocks;
+    for (size_t i = 0; i < executable.executable.basic_blocks.size(); ++i) {
+        auto const& old_block = executable.executable.basic_blocks[i];
+        bool has_dead_stores = false;
+        for (InstructionStreamIterator it { old_block.instruction_stream() }; !it.at_end(); ++it)
+            has_dead_stores |= dead_stores.contains(&*it);
+        if (!has_dead_stores)
+            continue;
+
+        auto new_block = BasicBlock::create(old_block.name(), old_block.size());
+        for (InstructionStreamIterator it { old_block.instruction_stream() }; !it.at_end(); ++it) {
+            auto const& instruction = *it;
+            if (dead_stores.contains(&instruction))
+                continue;
+
+            if (instruction.type() == Instruction::Type::NewBigInt) {
+                // FIXME: This is the only non trivially copyable Instruction,
+                //        so we need to do some extra work here
+                new (new_block->next_slot()) Op::NewBigInt(static_cast<Op::NewBigInt const&>(instruction));
+            } else {
+                memcpy(new_block->next_slot(), &instruction, instruction.length());
+            }
+            new_block->grow(instruction.length());
+        }
+
+        replaced_blocks.set(&old_block, new_block.ptr());
+        old_blocks.append(exchange(executable.executable.basic_blocks.ptr_at(i), move(new_block)));
+    }
+
+    // Only terminators refer to other blocks, so it's enough to look at their targets.
+    for (auto& block : executable.executable.basic_blocks) {
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            auto& instruction = const_cast<Instruction&>(*it);
+            Vector<BasicBlock const*, 3> targets;
+            for_each_successor(instruction, [&](BasicBlock const& target) { targets.append(&target); });
+            for (auto const* target : targets) {
+                if (auto replacement = replaced_blocks.get(target); replacement.has_value())
+                    instruction.replace_references(*target, **replacement);
+            }
+        }
+    }
+
+    // The blocks have changed, so any previously generated CFG is stale now.
+    executable.cfg.clear();
+    executable.inverted_cfg.clear();
+    executable.exported_blocks.clear();
+
+    finished();
+}
+
+}
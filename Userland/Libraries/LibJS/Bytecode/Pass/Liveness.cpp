@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/Pass/Liveness.h>
+
+namespace JS::Bytecode::Passes {
+
+void for_each_register_operand(Instruction const& instruction, Function<void(Register, RegisterAccess)> const& callback)
+{
+    auto visit = [&](Register reg, RegisterAccess access) {
+        if (reg != Register::accumulator())
+            callback(reg, access);
+    };
+
+    using enum Instruction::Type;
+    switch (instruction.type()) {
+    case Load:
+        visit(static_cast<Op::Load const&>(instruction).src(), RegisterAccess::Read);
+        break;
+    case Store:
+        visit(static_cast<Op::Store const&>(instruction).dst(), RegisterAccess::Write);
+        break;
+#define __VISIT_BINARY_OP(OpTitleCase, op_snake_case)                                        \
+    case OpTitleCase:                                                                        \
+        visit(static_cast<Op::OpTitleCase const&>(instruction).lhs(), RegisterAccess::Read); \
+        break;
+        JS_ENUMERATE_COMMON_BINARY_OPS(__VISIT_BINARY_OP)
+#undef __VISIT_BINARY_OP
+    case CopyObjectExcludingProperties: {
+        auto const& copy = static_cast<Op::CopyObjectExcludingProperties const&>(instruction);
+        visit(copy.from_object(), RegisterAccess::Read);
+        for (auto excluded_name : copy.excluded_names())
+            visit(excluded_name, RegisterAccess::Read);
+        break;
+    }
+    case NewArray: {
+        auto const& new_array = static_cast<Op::NewArray const&>(instruction);
+        if (new_array.element_count() == 0)
+            break;
+        for (auto i = new_array.start().index(); i <= new_array.end().index(); ++i)
+            visit(Register(i), RegisterAccess::Read);
+        break;
+    }
+    case Append:
+        visit(static_cast<Op::Append const&>(instruction).lhs(), RegisterAccess::Read);
+        break;
+    case ConcatString:
+        visit(static_cast<Op::ConcatString const&>(instruction).lhs(), RegisterAccess::Read);
+        visit(static_cast<Op::ConcatString const&>(instruction).lhs(), RegisterAccess::Write);
+        break;
+    case PutById:
+        visit(static_cast<Op::PutById const&>(instruction).base(), RegisterAccess::Read);
+        break;
+    case GetByValue:
+        visit(static_cast<Op::GetByValue const&>(instruction).base(), RegisterAccess::Read);
+        break;
+    case PutByValue:
+        visit(static_cast<Op::PutByValue const&>(instruction).base(), RegisterAccess::Read);
+        visit(static_cast<Op::PutByValue const&>(instruction).property(), RegisterAccess::Read);
+        break;
+    case DeleteByValue:
+        visit(static_cast<Op::DeleteByValue const&>(instruction).base(), RegisterAccess::Read);
+        break;
+    case Call:
+        visit(static_cast<Op::Call const&>(instruction).callee(), RegisterAccess::Read);
+        visit(static_cast<Op::Call const&>(instruction).this_value(), RegisterAccess::Read);
+        break;
+    default:
+        // Everything else only ever touches the accumulator.
+        break;
+    }
+}
+
+void for_each_successor(Instruction const& instruction, Function<void(BasicBlock const&)> const& callback)
+{
+    using enum Instruction::Type;
+    switch (instruction.type()) {
+    case Jump:
+    case JumpConditional:
+    case JumpNullish:
+    case JumpUndefined: {
+        auto const& jump = static_cast<Op::Jump const&>(instruction);
+        if (jump.true_target().has_value())
+            callback(jump.true_target()->block());
+        if (jump.false_target().has_value())
+            callback(jump.false_target()->block());
+        break;
+    }
+    case Yield: {
+        auto const& continuation = static_cast<Op::Yield const&>(instruction).continuation();
+        if (continuation.has_value())
+            callback(continuation->block());
+        break;
+    }
+    case EnterUnwindContext: {
+        auto const& enter_unwind_context = static_cast<Op::EnterUnwindContext const&>(instruction);
+        callback(enter_unwind_context.entry_point().block());
+        if (enter_unwind_context.handler_target().has_value())
+            callback(enter_unwind_context.handler_target()->block());
+        if (enter_unwind_context.finalizer_target().has_value())
+            callback(enter_unwind_context.finalizer_target()->block());
+        break;
+    }
+    case ContinuePendingUnwind:
+        callback(static_cast<Op::ContinuePendingUnwind const&>(instruction).resume_target().block());
+        break;
+    default:
+        break;
+    }
+}
+
+void Liveness::for_each_instruction_backwards(BasicBlock const& block, Function<void(Instruction const&, RegisterSet const& live_after)> const& callback) const
+{
+    Vector<Instruction const*> instructions;
+    for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it)
+        instructions.append(&*it);
+
+    auto live = live_out.find(&block)->value;
+    for (size_t i = instructions.size(); i > 0; --i) {
+        auto const& instruction = *instructions[i - 1];
+        callback(instruction, live);
+
+        for_each_register_operand(instruction, [&](Register reg, RegisterAccess access) {
+            if (access == RegisterAccess::Write)
+                live.unset(reg.index());
+        });
+        for_each_register_operand(instruction, [&](Register reg, RegisterAccess access) {
+            if (access == RegisterAccess::Read)
+                live.set(reg.index());
+        });
+        live.merge(live_in_handlers);
+    }
+}
+
+Liveness compute_liveness(Executable const& executable)
+{
+    auto number_of_registers = executable.number_of_registers;
+
+    struct BlockInfo {
+        RegisterSet uses;
+        RegisterSet defs;
+        Vector<BasicBlock const*> successors;
+    };
+    HashMap<BasicBlock const*, BlockInfo> block_infos;
+    Vector<BasicBlock const*> handlers;
+
+    Liveness liveness { {}, {}, RegisterSet { number_of_registers } };
+
+    for (auto const& block : executable.basic_blocks) {
+        BlockInfo info { RegisterSet { number_of_registers }, RegisterSet { number_of_registers }, {} };
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            auto const& instruction = *it;
+            // A register read before any write in this block is an upward-exposed use.
+            for_each_register_operand(instruction, [&](Register reg, RegisterAccess access) {
+                if (access == RegisterAccess::Read && !info.defs.contains(reg.index()))
+                    info.uses.set(reg.index());
+            });
+            for_each_register_operand(instruction, [&](Register reg, RegisterAccess access) {
+                if (access == RegisterAccess::Write)
+                    info.defs.set(reg.index());
+            });
+            for_each_successor(instruction, [&](BasicBlock const& successor) {
+                info.successors.append(&successor);
+            });
+            if (instruction.type() == Instruction::Type::EnterUnwindContext) {
+                auto const& enter_unwind_context = static_cast<Op::EnterUnwindContext const&>(instruction);
+                if (enter_unwind_context.handler_target().has_value())
+                    handlers.append(&enter_unwind_context.handler_target()->block());
+                if (enter_unwind_context.finalizer_target().has_value())
+                    handlers.append(&enter_unwind_context.finalizer_target()->block());
+            }
+        }
+        block_infos.set(&block, move(info));
+        liveness.live_in.set(&block, RegisterSet { number_of_registers });
+        liveness.live_out.set(&block, RegisterSet { number_of_registers });
+    }
+
+    // Iterate to a fixed point, visiting blocks backwards as liveness flows against the control flow.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = executable.basic_blocks.size(); i > 0; --i) {
+            auto const* block = &executable.basic_blocks[i - 1];
+            auto const& info = block_infos.find(block)->value;
+            auto& live_out = liveness.live_out.find(block)->value;
+            auto& live_in = liveness.live_in.find(block)->value;
+
+            for (auto const* successor : info.successors)
+                changed |= live_out.merge(liveness.live_in.find(successor)->value);
+            changed |= live_out.merge(liveness.live_in_handlers);
+
+            // live_in = uses | (live_out & ~defs) | live_in_handlers
+            RegisterSet new_live_in { number_of_registers };
+            new_live_in.merge(info.uses);
+            live_out.for_each([&](u32 index) {
+                if (!info.defs.contains(index))
+                    new_live_in.set(index);
+            });
+            new_live_in.merge(liveness.live_in_handlers);
+            changed |= live_in.merge(new_live_in);
+        }
+
+        for (auto const* handler : handlers)
+            changed |= liveness.live_in_handlers.merge(liveness.live_in.find(handler)->value);
+    }
+
+    return liveness;
+}
+
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/BuiltinWrappers.h>
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/Vector.h>
+#include <LibJS/Bytecode/BasicBlock.h>
+#include <LibJS/Bytecode/Executable.h>
+#include <LibJS/Bytecode/Instruction.h>
+#include <LibJS/Bytecode/Register.h>
+
+namespace JS::Bytecode::Passes {
+
+// A set of registers, with one bit per register.
+class RegisterSet {
+public:
+    explicit RegisterSet(size_t number_of_registers = 0)
+    {
+        m_words.resize(ceil_div(number_of_registers, bits_per_word));
+    }
+
+    bool contains(u32 index) const { return m_words[index / bits_per_word] & (1ull << (index % bits_per_word)); }
+    void set(u32 index) { m_words[index / bits_per_word] |= 1ull << (index % bits_per_word); }
+    void unset(u32 index) { m_words[index / bits_per_word] &= ~(1ull << (index % bits_per_word)); }
+
+    // Adds all registers of the other set, and returns whether that changed anything.
+    bool merge(RegisterSet const& other)
+    {
+        bool changed = false;
+        for (size_t i = 0; i < m_words.size(); ++i) {
+            auto merged = m_words[i] | other.m_words[i];
+            changed |= merged != m_words[i];
+            m_words[i] = merged;
+        }
+        return changed;
+    }
+
+    template<typename Callback>
+    void for_each(Callback callback) const
+    {
+        for (size_t i = 0; i < m_words.size(); ++i) {
+            for (auto word = m_words[i]; word != 0; word &= word - 1)
+                callback(static_cast<u32>(i * bits_per_word + count_trailing_zeroes(word)));
+        }
+    }
+
+private:
+    static constexpr size_t bits_per_word = 64;
+
+    Vector<u64> m_words;
+};
+
+enum class RegisterAccess {
+    Read,
+    Write,
+};
+
+// Calls the callback for every register the instruction reads or writes, except for the accumulator.
+// An instruction that both reads and writes a register reports it twice, the read first.
+void for_each_register_operand(Instruction const&, Function<void(Register, RegisterAccess)> const&);
+
+// Calls the callback for every block that control can be transferred to from a terminator.
+void for_each_successor(Instruction const&, Function<void(BasicBlock const&)> const&);
+
+struct Liveness {
+    // The registers whose values may still be read after leaving each block.
+    HashMap<BasicBlock const*, RegisterSet> live_out;
+    HashMap<BasicBlock const*, RegisterSet> live_in;
+
+    // The registers that are live on entry to any exception handler or finalizer. An exception
+    // can transfer control there from almost any instruction, so these are live everywhere.
+    RegisterSet live_in_handlers;
+
+    // Walks the block backwards, calling the callback with every instruction and the registers
+    // that are live right after it.
+    void for_each_instruction_backwards(BasicBlock const&, Function<void(Instruction const&, RegisterSet const& live_after)> const&) const;
+};
+
+Liveness compute_liveness(Executable const&);
+
+}
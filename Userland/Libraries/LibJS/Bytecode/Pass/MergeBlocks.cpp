@@ -30,7 +30,13 @@ void MergeBlocks::perform(PassPipelineExecutable& executable)
         if (executable.exported_blocks->contains(*entry.value.begin()))
             continue;
 
-        if (entry.key->terminator()->type() != Instruction::Type::Jump)
+        // Blocks created by earlier passes don't know their terminator, so look it up in the instruction stream.
+        Instruction const* terminator = entry.key->terminator();
+        for (InstructionStreamIterator it { entry.key->instruction_stream() }; !terminator && !it.at_end(); ++it) {
+            if ((*it).is_terminator())
+                terminator = &*it;
+        }
+        if (!terminator || terminator->type() != Instruction::Type::Jump)
             continue;
 
         {
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/QuickSort.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/Pass/Liveness.h>
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+// The registers of a NewArray element range have to stay next to each other, so they are allocated
+// together as one unit. Every other register is a unit of its own.
+struct AllocationUnit {
+    u32 first_register { 0 };
+    u32 register_count { 1 };
+    // The first and last position at which any register of the unit is live or accessed.
+    size_t start { NumericLimits<size_t>::max() };
+    size_t end { 0 };
+
+    bool is_used() const { return start <= end; }
+};
+
+void AllocateRegisters::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    auto number_of_registers = executable.executable.number_of_registers;
+    if (number_of_registers <= 1) {
+        finished();
+        return;
+    }
+
+    auto liveness = compute_liveness(executable.executable);
+
+    // Merge overlapping NewArray ranges into units first, everything else gets a unit per register.
+    Vector<u32> unit_of_register;
+    unit_of_register.resize(number_of_registers);
+    Vector<u32> range_end;
+    range_end.resize(number_of_registers);
+    for (auto const& block : executable.executable.basic_blocks) {
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            if ((*it).type() != Instruction::Type::NewArray)
+                continue;
+            auto const& new_array = static_cast<Op::NewArray const&>(*it);
+            if (new_array.element_count() != 0)
+                range_end[new_array.start().index()] = max(range_end[new_array.start().index()], new_array.end().index());
+        }
+    }
+
+    Vector<AllocationUnit> units;
+    for (u32 index = 1; index < number_of_registers;) {
+        u32 end = max(index, range_end[index]);
+        for (u32 i = index; i <= end; ++i)
+            end = max(end, range_end[i]);
+        for (u32 i = index; i <= end; ++i)
+            unit_of_register[i] = units.size();
+        units.append({ index, end - index + 1 });
+        index = end + 1;
+    }
+
+    // Number the instructions linearly in block order. As two registers can only interfere where both of them
+    // are live, and liveness within a block is bounded by the block's live-in and live-out sets and the
+    // accesses inside it, a unit that spans from its first to its last such point covers every place it's live.
+    size_t position = 0;
+    auto extend = [&](u32 index) {
+        auto& unit = units[unit_of_register[index]];
+        unit.start = min(unit.start, position);
+        unit.end = max(unit.end, position);
+    };
+    for (auto const& block : executable.executable.basic_blocks) {
+        liveness.live_in.find(&block)->value.for_each(extend);
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            ++position;
+            for_each_register_operand(*it, [&](Register reg, RegisterAccess) { extend(reg.index()); });
+        }
+        ++position;
+        liveness.live_out.find(&block)->value.for_each(extend);
+    }
+
+    // Linear scan: hand out the lowest slots that are free for the whole lifetime of the unit.
+    quick_sort(units, [](auto const& a, auto const& b) { return a.start < b.start; });
+
+    // The position after which each slot is free again. Slot 0 is the accumulator, which is never reallocated.
+    Vector<size_t> slot_busy_until;
+    slot_busy_until.append(NumericLimits<size_t>::max());
+
+    Vector<u32> new_index_of_register;
+    new_index_of_register.resize(number_of_registers);
+    for (auto const& unit : units) {
+        if (!unit.is_used())
+            continue;
+
+        u32 base = 1;
+        while (true) {
+            bool fits = true;
+            for (u32 i = 0; i < unit.register_count && base + i < slot_busy_until.size(); ++i) {
+                if (slot_busy_until[base + i] >= unit.start) {
+                    base += i + 1;
+                    fits = false;
+                    break;
+                }
+            }
+            if (fits)
+                break;
+        }
+
+        if (slot_busy_until.size() < base + unit.register_count)
+            slot_busy_until.resize(base + unit.register_count);
+        for (u32 i = 0; i < unit.register_count; ++i) {
+            slot_busy_until[base + i] = unit.end;
+            new_index_of_register[unit.first_register + i] = base + i;
+        }
+    }
+
+    // Keep the original numbering if we couldn't improve on it.
+    if (slot_busy_until.size() >= number_of_registers) {
+        finished();
+        return;
+    }
+
+    // Rename all operands. Every register first moves to a temporary index past all existing ones,
+    // so that renaming one register can never clash with another one that hasn't been renamed yet.
+    for (auto& block : executable.executable.basic_blocks) {
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            auto& instruction = const_cast<Instruction&>(*it);
+            Vector<u32, 4> operands;
+            for_each_register_operand(instruction, [&](Register reg, RegisterAccess) {
+                if (!operands.contains_slow(reg.index()))
+                    operands.append(reg.index());
+            });
+            for (auto index : operands)
+                instruction.replace_references(Register(index), Register(number_of_registers + index));
+            for (auto index : operands)
+                instruction.replace_references(Register(number_of_registers + index), Register(new_index_of_register[index]));
+        }
+    }
+
+    executable.executable.number_of_registers = slot_busy_until.size();
+
+    finished();
+}
+
+}
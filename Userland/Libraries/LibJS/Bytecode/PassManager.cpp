@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode {
+
+bool g_dump_optimization_statistics = false;
+
+static size_t count_instructions(Executable const& executable)
+{
+    size_t count = 0;
+    for (auto const& block : executable.basic_blocks) {
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it)
+            ++count;
+    }
+    return count;
+}
+
+void PassManager::perform(Executable& executable)
+{
+    auto registers_before = executable.number_of_registers;
+    auto instructions_before = g_dump_optimization_statistics ? count_instructions(executable) : 0;
+
+    PassPipelineExecutable pipeline_executable { executable };
+    perform(pipeline_executable);
+
+    if (g_dump_optimization_statistics && !m_passes.is_empty()) {
+        warnln("Optimized '{}' in {}us: {} -> {} registers, {} -> {} instructions",
+            executable.name, elapsed(),
+            registers_before, executable.number_of_registers,
+            instructions_before, count_instructions(executable));
+    }
+}
+
+}
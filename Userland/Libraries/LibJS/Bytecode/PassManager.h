@@ -12,6 +12,9 @@
 
 namespace JS::Bytecode {
 
+// Reports the register and instruction counts of every executable before and after optimization.
+extern bool g_dump_optimization_statistics;
+
 struct PassPipelineExecutable {
     Executable& executable;
     Optional<HashMap<BasicBlock const*, HashTable<BasicBlock const*>>> cfg {};
@@ -51,11 +54,7 @@ public:
     template<typename PassT, typename... Args>
     void add(Args&&... args) { m_passes.append(make<PassT>(forward<Args>(args)...)); }
 
-    void perform(Executable& executable)
-    {
-        PassPipelineExecutable pipeline_executable { executable };
-        perform(pipeline_executable);
-    }
+    void perform(Executable&);
 
     virtual void perform(PassPipelineExecutable& executable) override
     {
@@ -131,6 +130,26 @@ private:
     virtual void perform(PassPipelineExecutable&) override;
 };
 
+class EliminateDeadStores : public Pass {
+public:
+    EliminateDeadStores() = default;
+    virtual ~EliminateDeadStores() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+// Renumbers the registers based on their live ranges, so that registers that are never live
+// at the same time share a slot in the register window.
+class AllocateRegisters : public Pass {
+public:
+    AllocateRegisters() = default;
+    virtual ~AllocateRegisters() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
 }
 
 }
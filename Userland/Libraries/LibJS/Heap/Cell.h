@@ -27,6 +27,13 @@ public:                                            \
     }                                              \
     friend class JS::Heap;
 
+// Cells that pass every GC pointer they store into themselves after construction to Heap::write_barrier()
+// can declare this, which saves incremental marking from visiting them again when it finishes.
+// It isn't inherited, since subclasses may store pointers of their own.
+#define JS_DECLARE_WRITE_BARRIERS(class_) \
+public:                                   \
+    using CellWithWriteBarriers = class_;
+
 class Cell {
     AK_MAKE_NONCOPYABLE(Cell);
     AK_MAKE_NONMOVABLE(Cell);
@@ -98,6 +105,9 @@ public:
 
     bool overrides_must_survive_garbage_collection(Badge<Heap>) const { return m_overrides_must_survive_garbage_collection; }
 
+    bool has_write_barriers(Badge<Heap>) const { return m_has_write_barriers; }
+    void set_has_write_barriers(Badge<Heap>) { m_has_write_barriers = true; }
+
     Heap& heap() const;
     VM& vm() const;
 
@@ -109,6 +119,7 @@ protected:
 private:
     bool m_mark : 1 { false };
     bool m_overrides_must_survive_garbage_collection : 1 { false };
+    bool m_has_write_barriers : 1 { false };
     State m_state : 1 { State::Live };
 };
 
@@ -77,10 +77,16 @@ Cell* Heap::allocate_cell(size_t size)
     if (should_collect_on_every_allocation()) {
         collect_garbage();
     } else if (m_allocations_since_last_gc > m_max_allocations_between_gc) {
+        // If incremental marking can't keep up with the allocations, we finish it right away.
         m_allocations_since_last_gc = 0;
-        collect_garbage();
+        if (m_incremental_marking_enabled && !m_is_marking_incrementally)
+            start_incremental_marking();
+        else
+            collect_garbage();
     } else {
         ++m_allocations_since_last_gc;
+        if (m_is_marking_incrementally && ++m_allocations_since_last_incremental_marking_step >= allocations_between_incremental_marking_steps)
+            perform_incremental_marking_step();
     }
 
     auto& allocator = allocator_for_size(size);
@@ -97,9 +103,7 @@ void Heap::collect_garbage(CollectionType collection_type, bool print_report)
     perf_event(PERF_EVENT_SIGNPOST, gc_perf_string_id, global_gc_counter++);
 #endif
 
-    Core::ElapsedTimer collection_measurement_timer;
-    if (print_report)
-        collection_measurement_timer.start();
+    auto collection_measurement_timer = Core::ElapsedTimer::start_new();
 
     if (collection_type == CollectionType::CollectGarbage) {
         if (m_gc_deferrals) {
@@ -108,7 +112,12 @@ void Heap::collect_garbage(CollectionType collection_type, bool print_report)
         }
         HashTable<Cell*> roots;
         gather_roots(roots);
-        mark_live_cells(roots);
+        if (m_is_marking_incrementally)
+            finish_incremental_marking(roots);
+        else
+            mark_live_cells(roots);
+    } else if (m_is_marking_incrementally) {
+        abandon_incremental_marking();
     }
     finalize_unmarked_cells();
     sweep_dead_cells(print_report, collection_measurement_timer);
@@ -209,7 +218,12 @@ __attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(Has
 
 class MarkingVisitor final : public Cell::Visitor {
 public:
-    explicit MarkingVisitor(HashTable<Cell*> const& roots)
+    explicit MarkingVisitor(Vector<Cell&>& work_queue)
+        : m_work_queue(work_queue)
+    {
+    }
+
+    void visit_roots(HashTable<Cell*> const& roots)
     {
         for (auto* root : roots) {
             visit(root);
@@ -234,14 +248,15 @@ public:
     }
 
 private:
-    Vector<Cell&> m_work_queue;
+    Vector<Cell&>& m_work_queue;
 };
 
 void Heap::mark_live_cells(HashTable<Cell*> const& roots)
 {
     dbgln_if(HEAP_DEBUG, "mark_live_cells:");
 
-    MarkingVisitor visitor(roots);
+    MarkingVisitor visitor(m_mark_stack);
+    visitor.visit_roots(roots);
     visitor.mark_all_live_cells();
 
     for (auto& inverse_root : m_uprooted_cells)
@@ -250,6 +265,136 @@ void Heap::mark_live_cells(HashTable<Cell*> const& roots)
     m_uprooted_cells.clear();
 }
 
+// Incremental marking spreads the marking work over many short steps in between allocations.
+// The mutator keeps changing the heap in the meantime, so it may store a pointer to a cell that hasn't been
+// marked yet into one that has already been visited. Cells with write barriers mark such cells as they're
+// stored, everything else that has been visited is visited once more when marking finishes, along with the
+// roots. Cells allocated during marking start out unmarked like everything else.
+void Heap::start_incremental_marking()
+{
+    VERIFY(!m_collecting_garbage);
+    TemporaryChange change(m_collecting_garbage, true);
+    auto timer = Core::ElapsedTimer::start_new();
+
+    dbgln_if(HEAP_DEBUG, "start_incremental_marking:");
+
+    HashTable<Cell*> roots;
+    gather_roots(roots);
+    MarkingVisitor visitor(m_mark_stack);
+    visitor.visit_roots(roots);
+
+    m_is_marking_incrementally = true;
+    m_allocations_since_last_incremental_marking_step = 0;
+    m_gc_statistics.record_pause(timer.elapsed_time());
+}
+
+void Heap::perform_incremental_marking_step()
+{
+    VERIFY(m_is_marking_incrementally);
+    m_allocations_since_last_incremental_marking_step = 0;
+
+    {
+        VERIFY(!m_collecting_garbage);
+        TemporaryChange change(m_collecting_garbage, true);
+        auto timer = Core::ElapsedTimer::start_new();
+
+        MarkingVisitor visitor(m_mark_stack);
+        size_t visited_cells = 0;
+        while (!m_mark_stack.is_empty()) {
+            auto& cell = m_mark_stack.take_last();
+            cell.visit_edges(visitor);
+            if (!cell.has_write_barriers({}))
+                m_cells_to_revisit.append(cell);
+            // Looking at the clock isn't free either, so only do it every now and then.
+            if (++visited_cells % 256 == 0 && timer.elapsed_time().to_microseconds() >= incremental_marking_step_budget_in_microseconds)
+                break;
+        }
+
+        ++m_gc_statistics.incremental_marking_step_count;
+        m_gc_statistics.record_pause(timer.elapsed_time());
+    }
+
+    if (m_mark_stack.is_empty())
+        collect_garbage();
+}
+
+void Heap::finish_incremental_marking(HashTable<Cell*> const& roots)
+{
+    dbgln_if(HEAP_DEBUG, "finish_incremental_marking: revisiting {} cells", m_cells_to_revisit.size());
+
+    MarkingVisitor visitor(m_mark_stack);
+    visitor.visit_roots(roots);
+    for (auto& cell : m_cells_to_revisit)
+        cell.visit_edges(visitor);
+    m_cells_to_revisit.clear();
+    m_is_marking_incrementally = false;
+    visitor.mark_all_live_cells();
+
+    if constexpr (INCREMENTAL_MARKING_DEBUG)
+        verify_incremental_marking(roots);
+
+    for (auto& inverse_root : m_uprooted_cells)
+        inverse_root->set_marked(false);
+
+    m_uprooted_cells.clear();
+}
+
+void Heap::abandon_incremental_marking()
+{
+    m_is_marking_incrementally = false;
+    m_mark_stack.clear();
+    m_cells_to_revisit.clear();
+    for_each_block([&](auto& block) {
+        block.template for_each_cell_in_state<Cell::State::Live>([](Cell* cell) {
+            cell->set_marked(false);
+        });
+        return IterationDecision::Continue;
+    });
+}
+
+void Heap::mark_cell_for_incremental_marking(Cell& cell)
+{
+    VERIFY(m_is_marking_incrementally);
+    cell.set_marked(true);
+    m_mark_stack.append(cell);
+}
+
+class ReachabilityVisitor final : public Cell::Visitor {
+public:
+    virtual void visit_impl(Cell& cell) override
+    {
+        if (m_reachable_cells.set(&cell) == AK::HashSetResult::InsertedNewEntry)
+            m_work_queue.append(cell);
+    }
+
+    HashTable<Cell*> const& find_reachable_cells(HashTable<Cell*> const& roots)
+    {
+        for (auto* root : roots)
+            visit(root);
+        while (!m_work_queue.is_empty())
+            m_work_queue.take_last().visit_edges(*this);
+        return m_reachable_cells;
+    }
+
+private:
+    HashTable<Cell*> m_reachable_cells;
+    Vector<Cell&> m_work_queue;
+};
+
+// Checks that incremental marking marked everything that a full collection would have marked.
+void Heap::verify_incremental_marking(HashTable<Cell*> const& roots)
+{
+    ReachabilityVisitor visitor;
+    size_t missed_cells = 0;
+    for (auto* cell : visitor.find_reachable_cells(roots)) {
+        if (!cell->is_marked()) {
+            dbgln("Incremental marking missed {} @ {}", cell->class_name(), cell);
+            ++missed_cells;
+        }
+    }
+    VERIFY(missed_cells == 0);
+}
+
 bool Heap::cell_must_survive_garbage_collection(Cell const& cell)
 {
     if (!cell.overrides_must_survive_garbage_collection({}))
@@ -322,8 +467,16 @@ void Heap::sweep_dead_cells(bool print_report, Core::ElapsedTimer const& measure
         });
     }
 
+    Time const time_spent = measurement_timer.elapsed_time();
+    ++m_gc_statistics.collection_count;
+    m_gc_statistics.record_pause(time_spent);
+
+    // Collecting is proportional to the size of the heap, so let the heap grow by as many
+    // cells as survived before collecting again. This keeps the amount of GC work per
+    // allocation bounded, instead of collecting big heaps over and over again.
+    m_max_allocations_between_gc = max(min_allocations_between_gc, live_cells);
+
     if (print_report) {
-        Time const time_spent = measurement_timer.elapsed_time();
         size_t live_block_count = 0;
         for_each_block([&](auto&) {
             ++live_block_count;
@@ -337,10 +490,37 @@ void Heap::sweep_dead_cells(bool print_report, Core::ElapsedTimer const& measure
         dbgln("Collected cells: {} ({} bytes)", collected_cells, collected_cell_bytes);
         dbgln("    Live blocks: {} ({} bytes)", live_block_count, live_block_count * HeapBlock::block_size);
         dbgln("   Freed blocks: {} ({} bytes)", empty_blocks.size(), empty_blocks.size() * HeapBlock::block_size);
+        dbgln(" Next collection after {} allocations", m_max_allocations_between_gc);
+        dbgln("=============================================");
+        dbgln("    Collections: {}", m_gc_statistics.collection_count);
+        dbgln(" Marking steps: {}", m_gc_statistics.incremental_marking_step_count);
+        dbgln("    Total pause: {} ms", m_gc_statistics.total_pause_time.to_milliseconds());
+        dbgln("  Longest pause: {} ms", m_gc_statistics.longest_pause_time.to_milliseconds());
+        dbgln("  Pause histogram:");
+        for (size_t i = 0; i < GCStatistics::pause_histogram_bucket_count; ++i) {
+            auto count = m_gc_statistics.pause_histogram[i];
+            if (i == GCStatistics::pause_histogram_bucket_count - 1)
+                dbgln("    >= {:4} ms: {}", 1u << (i - 1), count);
+            else
+                dbgln("     < {:4} ms: {}", 1u << i, count);
+        }
         dbgln("=============================================");
     }
 }
 
+void Heap::GCStatistics::record_pause(Time pause_time)
+{
+    total_pause_time += pause_time;
+    if (pause_time > longest_pause_time)
+        longest_pause_time = pause_time;
+
+    size_t bucket = 0;
+    auto milliseconds = pause_time.to_milliseconds();
+    while (bucket < pause_histogram_bucket_count - 1 && milliseconds >= (1ll << bucket))
+        ++bucket;
+    ++pause_histogram[bucket];
+}
+
 void Heap::did_create_handle(Badge<HandleImpl>, HandleImpl& impl)
 {
     VERIFY(!m_handles.contains(impl));
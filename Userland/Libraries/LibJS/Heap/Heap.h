@@ -6,11 +6,13 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/Badge.h>
 #include <AK/HashTable.h>
 #include <AK/IntrusiveList.h>
 #include <AK/Noncopyable.h>
 #include <AK/NonnullOwnPtr.h>
+#include <AK/Time.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
 #include <LibCore/Forward.h>
@@ -24,6 +26,9 @@
 
 namespace JS {
 
+template<typename T>
+concept CellWithWriteBarriers = IsSame<typename T::CellWithWriteBarriers, T>;
+
 class Heap {
     AK_MAKE_NONCOPYABLE(Heap);
     AK_MAKE_NONMOVABLE(Heap);
@@ -37,6 +42,8 @@ public:
     {
         auto* memory = allocate_cell(sizeof(T));
         new (memory) T(forward<Args>(args)...);
+        if constexpr (CellWithWriteBarriers<T>)
+            memory->set_has_write_barriers({});
         return *static_cast<T*>(memory);
     }
 
@@ -45,6 +52,8 @@ public:
     {
         auto* memory = allocate_cell(sizeof(T));
         new (memory) T(forward<Args>(args)...);
+        if constexpr (CellWithWriteBarriers<T>)
+            memory->set_has_write_barriers({});
         auto* cell = static_cast<T*>(memory);
         MUST_OR_THROW_OOM(memory->initialize(realm));
         return *cell;
@@ -57,6 +66,41 @@ public:
 
     void collect_garbage(CollectionType = CollectionType::CollectGarbage, bool print_report = false);
 
+    // While incremental marking is in progress, cells that declare JS_DECLARE_WRITE_BARRIERS have to pass
+    // every GC pointer they store to this, so that it can't hide behind a cell that has been visited already.
+    ALWAYS_INLINE void write_barrier(Cell* cell)
+    {
+        if (m_is_marking_incrementally && cell && !cell->is_marked()) [[unlikely]]
+            mark_cell_for_incremental_marking(*cell);
+    }
+
+    ALWAYS_INLINE void write_barrier(Value value)
+    {
+        if (m_is_marking_incrementally && value.is_cell()) [[unlikely]]
+            write_barrier(&value.as_cell());
+    }
+
+    bool is_marking_incrementally() const { return m_is_marking_incrementally; }
+
+    bool incremental_marking_enabled() const { return m_incremental_marking_enabled; }
+    void set_incremental_marking_enabled(bool enabled) { m_incremental_marking_enabled = enabled; }
+
+    struct GCStatistics {
+        // Bucket N counts the pauses that took less than 2^N milliseconds,
+        // with the last bucket counting every pause that took even longer.
+        static constexpr size_t pause_histogram_bucket_count = 10;
+
+        size_t collection_count { 0 };
+        size_t incremental_marking_step_count { 0 };
+        Time total_pause_time;
+        Time longest_pause_time;
+        AK::Array<size_t, pause_histogram_bucket_count> pause_histogram {};
+
+        void record_pause(Time);
+    };
+
+    GCStatistics const& gc_statistics() const { return m_gc_statistics; }
+
     VM& vm() { return m_vm; }
 
     bool should_collect_on_every_allocation() const { return m_should_collect_on_every_allocation; }
@@ -86,6 +130,12 @@ private:
     void gather_roots(HashTable<Cell*>&);
     void gather_conservative_roots(HashTable<Cell*>&);
     void mark_live_cells(HashTable<Cell*> const& live_cells);
+    void start_incremental_marking();
+    void perform_incremental_marking_step();
+    void finish_incremental_marking(HashTable<Cell*> const& roots);
+    void abandon_incremental_marking();
+    void mark_cell_for_incremental_marking(Cell&);
+    void verify_incremental_marking(HashTable<Cell*> const& roots);
     void finalize_unmarked_cells();
     void sweep_dead_cells(bool print_report, Core::ElapsedTimer const&);
 
@@ -100,9 +150,27 @@ private:
         }
     }
 
-    size_t m_max_allocations_between_gc { 100000 };
+    // The number of allocations between collections grows along with the number of cells
+    // that survived the last one, but never drops below this.
+    static constexpr size_t min_allocations_between_gc = 100000;
+
+    size_t m_max_allocations_between_gc { min_allocations_between_gc };
     size_t m_allocations_since_last_gc { 0 };
 
+    // Incremental marking takes a step every so many allocations, and each step stops after a while.
+    static constexpr size_t allocations_between_incremental_marking_steps = 1000;
+    static constexpr i64 incremental_marking_step_budget_in_microseconds = 1000;
+
+    bool m_incremental_marking_enabled { true };
+    bool m_is_marking_incrementally { false };
+    size_t m_allocations_since_last_incremental_marking_step { 0 };
+    // Cells that have been marked but not visited yet.
+    Vector<Cell&> m_mark_stack;
+    // Cells that have been visited during incremental marking, but may have changed without a write barrier since.
+    Vector<Cell&> m_cells_to_revisit;
+
+    GCStatistics m_gc_statistics;
+
     bool m_should_collect_on_every_allocation { false };
 
     VM& m_vm;
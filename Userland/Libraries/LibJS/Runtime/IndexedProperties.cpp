@@ -7,6 +7,7 @@
 #include <AK/QuickSort.h>
 #include <LibJS/Runtime/Accessor.h>
 #include <LibJS/Runtime/IndexedProperties.h>
+#include <LibJS/Runtime/VM.h>
 
 namespace JS {
 
@@ -228,6 +229,9 @@ Optional<ValueAndAttributes> IndexedProperties::get(u32 index) const
 
 void IndexedProperties::put(u32 index, Value value, PropertyAttributes attributes)
 {
+    if (value.is_cell())
+        value.as_cell().heap().write_barrier(value);
+
     ensure_storage();
     if (m_storage->is_simple_storage() && (attributes != default_attributes || index > (array_like_size() + SPARSE_ARRAY_HOLE_THRESHOLD))) {
         switch_to_generic_storage();
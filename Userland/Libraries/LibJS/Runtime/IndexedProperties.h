@@ -15,6 +15,8 @@ namespace JS {
 struct ValueAndAttributes {
     Value value;
     PropertyAttributes attributes { default_attributes };
+    // The offset in the object's shape, for properties that aren't indexed.
+    Optional<u32> property_offset {};
 };
 
 class IndexedProperties;
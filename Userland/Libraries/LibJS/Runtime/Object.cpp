@@ -73,6 +73,25 @@ Object::~Object()
     s_intrinsics.remove(this);
 }
 
+void Object::put_direct(size_t index, Value value)
+{
+    heap().write_barrier(value);
+    m_storage[index] = value;
+}
+
+void Object::set_indexed_property_elements(Vector<Value>&& values)
+{
+    for (auto value : values)
+        heap().write_barrier(value);
+    m_indexed_properties = IndexedProperties(move(values));
+}
+
+void Object::set_shape(Shape& shape)
+{
+    heap().write_barrier(&shape);
+    m_shape = &shape;
+}
+
 ThrowCompletionOr<void> Object::initialize(Realm&)
 {
     return {};
@@ -485,6 +504,7 @@ ThrowCompletionOr<void> Object::private_field_add(PrivateName const& name, Value
         m_private_elements = make<Vector<PrivateElement>>();
 
     // 4. Append PrivateElement { [[Key]]: P, [[Kind]]: field, [[Value]]: value } to O.[[PrivateElements]].
+    heap().write_barrier(value);
     m_private_elements->empend(name, PrivateElement::Kind::Field, value);
 
     // 5. Return unused.
@@ -513,6 +533,7 @@ ThrowCompletionOr<void> Object::private_method_or_accessor_add(PrivateElement el
         m_private_elements = make<Vector<PrivateElement>>();
 
     // 5. Append method to O.[[PrivateElements]].
+    heap().write_barrier(element.value);
     m_private_elements->append(move(element));
 
     // 6. Return unused.
@@ -552,6 +573,7 @@ ThrowCompletionOr<void> Object::private_set(PrivateName const& name, Value value
         return vm.throw_completion<TypeError>(ErrorType::PrivateFieldDoesNotExistOnObject, name.description);
 
     if (entry->kind == PrivateElement::Kind::Field) {
+        heap().write_barrier(value);
         entry->value = value;
         return {};
     } else if (entry->kind == PrivateElement::Kind::Method) {
@@ -711,7 +733,7 @@ ThrowCompletionOr<Optional<PropertyDescriptor>> Object::internal_get_own_propert
     PropertyDescriptor descriptor;
 
     // 3. Let X be O's own property whose key is P.
-    auto [value, attributes] = *maybe_storage_entry;
+    auto [value, attributes, property_offset] = *maybe_storage_entry;
 
     // 4. If X is a data property, then
     if (!value.is_accessor()) {
@@ -738,6 +760,9 @@ ThrowCompletionOr<Optional<PropertyDescriptor>> Object::internal_get_own_propert
     // 7. Set D.[[Configurable]] to the value of X's [[Configurable]] attribute.
     descriptor.configurable = attributes.is_configurable();
 
+    // Non-standard: Keep track of where the property lives, so that [[Get]] and [[Set]] can tell their callers.
+    descriptor.property_offset = property_offset;
+
     // 8. Return D.
     return descriptor;
 }
@@ -783,7 +808,7 @@ ThrowCompletionOr<bool> Object::internal_has_property(PropertyKey const& propert
 }
 
 // 10.1.8 [[Get]] ( P, Receiver ), https://tc39.es/ecma262/#sec-ordinary-object-internal-methods-and-internal-slots-get-p-receiver
-ThrowCompletionOr<Value> Object::internal_get(PropertyKey const& property_key, Value receiver) const
+ThrowCompletionOr<Value> Object::internal_get(PropertyKey const& property_key, Value receiver, CacheablePropertyMetadata* cacheable_metadata) const
 {
     VERIFY(!receiver.is_empty());
     VERIFY(property_key.is_valid());
@@ -807,8 +832,11 @@ ThrowCompletionOr<Value> Object::internal_get(PropertyKey const& property_key, V
     }
 
     // 3. If IsDataDescriptor(desc) is true, return desc.[[Value]].
-    if (descriptor->is_data_descriptor())
+    if (descriptor->is_data_descriptor()) {
+        if (cacheable_metadata && receiver.is_object() && &receiver.as_object() == this)
+            cacheable_metadata->property_offset = descriptor->property_offset;
         return *descriptor->value;
+    }
 
     // 4. Assert: IsAccessorDescriptor(desc) is true.
     VERIFY(descriptor->is_accessor_descriptor());
@@ -825,7 +853,7 @@ ThrowCompletionOr<Value> Object::internal_get(PropertyKey const& property_key, V
 }
 
 // 10.1.9 [[Set]] ( P, V, Receiver ), https://tc39.es/ecma262/#sec-ordinary-object-internal-methods-and-internal-slots-set-p-v-receiver
-ThrowCompletionOr<bool> Object::internal_set(PropertyKey const& property_key, Value value, Value receiver)
+ThrowCompletionOr<bool> Object::internal_set(PropertyKey const& property_key, Value value, Value receiver, CacheablePropertyMetadata* cacheable_metadata)
 {
     VERIFY(property_key.is_valid());
     VERIFY(!value.is_empty());
@@ -835,7 +863,14 @@ ThrowCompletionOr<bool> Object::internal_set(PropertyKey const& property_key, Va
     auto own_descriptor = TRY(internal_get_own_property(property_key));
 
     // 3. Return ? OrdinarySetWithOwnDescriptor(O, P, V, Receiver, ownDesc).
-    return ordinary_set_with_own_descriptor(property_key, value, receiver, own_descriptor);
+    auto success = TRY(ordinary_set_with_own_descriptor(property_key, value, receiver, own_descriptor));
+
+    // NOTE: Overwriting an own writable data property only replaces its value, so the next set can go straight to the storage.
+    if (success && cacheable_metadata && own_descriptor.has_value() && own_descriptor->is_data_descriptor() && *own_descriptor->writable
+        && receiver.is_object() && &receiver.as_object() == this)
+        cacheable_metadata->property_offset = own_descriptor->property_offset;
+
+    return success;
 }
 
 // 10.1.9.2 OrdinarySetWithOwnDescriptor ( O, P, V, Receiver, ownDesc ), https://tc39.es/ecma262/#sec-ordinarysetwithowndescriptor
@@ -1021,6 +1056,7 @@ Optional<ValueAndAttributes> Object::storage_get(PropertyKey const& property_key
 
     Value value;
     PropertyAttributes attributes;
+    Optional<u32> property_offset;
 
     if (property_key.is_number()) {
         auto value_and_attributes = m_indexed_properties.get(property_key.as_number());
@@ -1034,13 +1070,14 @@ Optional<ValueAndAttributes> Object::storage_get(PropertyKey const& property_key
             return {};
 
         if (auto accessor = find_intrinsic_accessor(this, property_key); accessor.has_value())
-            const_cast<Object&>(*this).m_storage[metadata->offset] = (*accessor)(shape().realm());
+            const_cast<Object&>(*this).put_direct(metadata->offset, (*accessor)(shape().realm()));
 
         value = m_storage[metadata->offset];
         attributes = metadata->attributes;
+        property_offset = metadata->offset;
     }
 
-    return ValueAndAttributes { .value = value, .attributes = attributes };
+    return ValueAndAttributes { .value = value, .attributes = attributes, .property_offset = property_offset };
 }
 
 bool Object::storage_has(PropertyKey const& property_key) const
@@ -1055,7 +1092,8 @@ void Object::storage_set(PropertyKey const& property_key, ValueAndAttributes con
 {
     VERIFY(property_key.is_valid());
 
-    auto [value, attributes] = value_and_attributes;
+    auto value = value_and_attributes.value;
+    auto attributes = value_and_attributes.attributes;
 
     if (property_key.is_number()) {
         auto index = property_key.as_number();
@@ -1083,6 +1121,7 @@ void Object::storage_set(PropertyKey const& property_key, ValueAndAttributes con
         else
             set_shape(*m_shape->create_put_transition(property_key_string_or_symbol, attributes));
 
+        heap().write_barrier(value);
         m_storage.append(value);
         return;
     }
@@ -1094,7 +1133,7 @@ void Object::storage_set(PropertyKey const& property_key, ValueAndAttributes con
             set_shape(*m_shape->create_configure_transition(property_key_string_or_symbol, attributes));
     }
 
-    m_storage[metadata->offset] = value;
+    put_direct(metadata->offset, value);
 }
 
 void Object::storage_delete(PropertyKey const& property_key)
@@ -1127,7 +1166,7 @@ void Object::set_prototype(Object* new_prototype)
     if (shape.is_unique())
         shape.set_prototype_without_transition(new_prototype);
     else
-        m_shape = shape.create_prototype_transition(new_prototype);
+        set_shape(*shape.create_prototype_transition(new_prototype));
 }
 
 void Object::define_native_accessor(Realm& realm, PropertyKey const& property_key, SafeFunction<ThrowCompletionOr<Value>(VM&)> getter, SafeFunction<ThrowCompletionOr<Value>(VM&)> setter, PropertyAttributes attribute)
@@ -1173,7 +1212,7 @@ void Object::ensure_shape_is_unique()
     if (shape().is_unique())
         return;
 
-    m_shape = m_shape->create_unique_clone();
+    set_shape(*m_shape->create_unique_clone());
 }
 
 // Simple side-effect free property lookup, following the prototype chain. Non-standard.
@@ -40,8 +40,15 @@ struct PrivateElement {
     Value value;
 };
 
+// Filled in by the ordinary [[Get]] and [[Set]] when the property they accessed is an own data property
+// stored at a fixed offset of the object's shape, so that the bytecode interpreter can cache the offset.
+struct CacheablePropertyMetadata {
+    Optional<u32> property_offset;
+};
+
 class Object : public Cell {
     JS_CELL(Object, Cell);
+    JS_DECLARE_WRITE_BARRIERS(Object);
 
 public:
     static NonnullGCPtr<Object> create(Realm&, Object* prototype);
@@ -119,8 +126,8 @@ public:
     virtual ThrowCompletionOr<Optional<PropertyDescriptor>> internal_get_own_property(PropertyKey const&) const;
     virtual ThrowCompletionOr<bool> internal_define_own_property(PropertyKey const&, PropertyDescriptor const&);
     virtual ThrowCompletionOr<bool> internal_has_property(PropertyKey const&) const;
-    virtual ThrowCompletionOr<Value> internal_get(PropertyKey const&, Value receiver) const;
-    virtual ThrowCompletionOr<bool> internal_set(PropertyKey const&, Value value, Value receiver);
+    virtual ThrowCompletionOr<Value> internal_get(PropertyKey const&, Value receiver, CacheablePropertyMetadata* = nullptr) const;
+    virtual ThrowCompletionOr<bool> internal_set(PropertyKey const&, Value value, Value receiver, CacheablePropertyMetadata* = nullptr);
     virtual ThrowCompletionOr<bool> internal_delete(PropertyKey const&);
     virtual ThrowCompletionOr<MarkedVector<Value>> internal_own_property_keys() const;
 
@@ -169,16 +176,21 @@ public:
     // B.3.7 The [[IsHTMLDDA]] Internal Slot, https://tc39.es/ecma262/#sec-IsHTMLDDA-internal-slot
     virtual bool is_htmldda() const { return false; }
 
+    // Whether the bytecode interpreter may remember where an own property lives by this object's shape alone.
+    // Objects whose [[GetOwnProperty]] can also find properties that aren't in their shape must opt out.
+    virtual bool is_eligible_for_property_lookup_caches() const { return true; }
+
     bool has_parameter_map() const { return m_has_parameter_map; }
     void set_has_parameter_map() { m_has_parameter_map = true; }
 
     virtual void visit_edges(Cell::Visitor&) override;
 
     Value get_direct(size_t index) const { return m_storage[index]; }
+    void put_direct(size_t index, Value value);
 
     IndexedProperties const& indexed_properties() const { return m_indexed_properties; }
     IndexedProperties& indexed_properties() { return m_indexed_properties; }
-    void set_indexed_property_elements(Vector<Value>&& values) { m_indexed_properties = IndexedProperties(move(values)); }
+    void set_indexed_property_elements(Vector<Value>&& values);
 
     Shape& shape() { return *m_shape; }
     Shape const& shape() const { return *m_shape; }
@@ -208,7 +220,7 @@ protected:
     bool m_has_parameter_map { false };
 
 private:
-    void set_shape(Shape& shape) { m_shape = &shape; }
+    void set_shape(Shape&);
 
     Object* prototype() { return shape().prototype(); }
     Object const* prototype() const { return shape().prototype(); }
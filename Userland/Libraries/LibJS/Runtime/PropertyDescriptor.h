@@ -39,6 +39,9 @@ public:
     Optional<bool> writable {};
     Optional<bool> enumerable {};
     Optional<bool> configurable {};
+
+    // Non-standard: the offset in the shape of the object this descriptor was read from, if it's backed by the shape's storage.
+    Optional<u32> property_offset {};
 };
 
 }
@@ -187,15 +187,25 @@ void Shape::ensure_property_table() const
     }
 }
 
+void Shape::set_prototype_without_transition(Object* new_prototype)
+{
+    heap().write_barrier(new_prototype);
+    m_prototype = new_prototype;
+}
+
 void Shape::add_property_to_unique_shape(StringOrSymbol const& property_key, PropertyAttributes attributes)
 {
     VERIFY(is_unique());
     VERIFY(m_property_table);
     VERIFY(!m_property_table->contains(property_key));
+    if (property_key.is_symbol())
+        heap().write_barrier(const_cast<Symbol*>(property_key.as_symbol()));
     m_property_table->set(property_key, { static_cast<u32>(m_property_table->size()), attributes });
 
     VERIFY(m_property_count < NumericLimits<u32>::max());
     ++m_property_count;
+
+    ++m_unique_shape_serial_number;
 }
 
 void Shape::reconfigure_property_in_unique_shape(StringOrSymbol const& property_key, PropertyAttributes attributes)
@@ -206,6 +216,8 @@ void Shape::reconfigure_property_in_unique_shape(StringOrSymbol const& property_
     VERIFY(it != m_property_table->end());
     it->value.attributes = attributes;
     m_property_table->set(property_key, it->value);
+
+    ++m_unique_shape_serial_number;
 }
 
 void Shape::remove_property_from_unique_shape(StringOrSymbol const& property_key, size_t offset)
@@ -219,12 +231,16 @@ void Shape::remove_property_from_unique_shape(StringOrSymbol const& property_key
         if (it.value.offset > offset)
             --it.value.offset;
     }
+
+    ++m_unique_shape_serial_number;
 }
 
 void Shape::add_property_without_transition(StringOrSymbol const& property_key, PropertyAttributes attributes)
 {
     VERIFY(property_key.is_valid());
     ensure_property_table();
+    if (property_key.is_symbol())
+        heap().write_barrier(const_cast<Symbol*>(property_key.as_symbol()));
     if (m_property_table->set(property_key, { m_property_count, attributes }) == AK::HashSetResult::InsertedNewEntry) {
         VERIFY(m_property_count < NumericLimits<u32>::max());
         ++m_property_count;
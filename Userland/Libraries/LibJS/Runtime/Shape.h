@@ -38,6 +38,7 @@ class Shape final
     : public Cell
     , public Weakable<Shape> {
     JS_CELL(Shape, Cell);
+    JS_DECLARE_WRITE_BARRIERS(Shape);
 
 public:
     virtual ~Shape() override = default;
@@ -59,6 +60,10 @@ public:
     bool is_unique() const { return m_unique; }
     Shape* create_unique_clone() const;
 
+    // Unique shapes are changed in place, so anything that remembers property offsets for a unique shape
+    // also has to remember this number, which changes whenever the shape's properties do.
+    u32 unique_shape_serial_number() const { return m_unique_shape_serial_number; }
+
     Realm& realm() const { return m_realm; }
 
     Object* prototype() { return m_prototype; }
@@ -75,7 +80,7 @@ public:
 
     Vector<Property> property_table_ordered() const;
 
-    void set_prototype_without_transition(Object* new_prototype) { m_prototype = new_prototype; }
+    void set_prototype_without_transition(Object* new_prototype);
 
     void remove_property_from_unique_shape(StringOrSymbol const&, size_t offset);
     void add_property_to_unique_shape(StringOrSymbol const&, PropertyAttributes attributes);
@@ -103,6 +108,7 @@ private:
     StringOrSymbol m_property_key;
     Object* m_prototype { nullptr };
     u32 m_property_count { 0 };
+    u32 m_unique_shape_serial_number { 0 };
 
     PropertyAttributes m_attributes { 0 };
     TransitionType m_transition_type : 6 { TransitionType::Invalid };
@@ -0,0 +1,42 @@
+test("values moved between objects while marking incrementally survive", () => {
+    const count = 1000;
+    const objects = [];
+    const arrays = [];
+    for (let i = 0; i < count; ++i) {
+        objects.push({ value: { i } });
+        arrays.push([null]);
+    }
+
+    // Enough allocations for a few collections, with the values changing places all the while.
+    for (let round = 0; round < 100; ++round) {
+        for (let i = 0; i < count; ++i) {
+            if (round % 2 === 0) {
+                arrays[i][0] = objects[i].value;
+                objects[i].value = null;
+            } else {
+                objects[i].value = arrays[i][0];
+                arrays[i][0] = null;
+            }
+            for (let j = 0; j < 3; ++j) ({ garbage: [j] });
+        }
+    }
+
+    for (let i = 0; i < count; ++i) expect(objects[i].value.i).toBe(i);
+});
+
+test("prototypes set while marking incrementally survive", () => {
+    const objects = [];
+    for (let i = 0; i < 500; ++i) objects.push({});
+
+    for (let round = 0; round < 100; ++round) {
+        for (let i = 0; i < objects.length; ++i) {
+            Object.setPrototypeOf(objects[i], { round, i });
+            for (let j = 0; j < 3; ++j) ({ garbage: [j] });
+        }
+    }
+
+    for (let i = 0; i < objects.length; ++i) {
+        expect(Object.getPrototypeOf(objects[i]).round).toBe(99);
+        expect(Object.getPrototypeOf(objects[i]).i).toBe(i);
+    }
+});
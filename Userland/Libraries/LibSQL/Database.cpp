@@ -78,7 +78,17 @@ Database::~Database() = default;
 ErrorOr<void> Database::commit()
 {
     VERIFY(is_open());
-    TRY(m_heap->flush());
+    if (m_group_commit_enabled)
+        TRY(m_heap->commit());
+    else
+        TRY(m_heap->flush());
+    return {};
+}
+
+ErrorOr<void> Database::sync()
+{
+    VERIFY(is_open());
+    TRY(m_heap->sync());
     return {};
 }
 
@@ -32,6 +32,13 @@ public:
     ResultOr<void> open();
     bool is_open() const { return m_open; }
     ErrorOr<void> commit();
+    ErrorOr<void> sync();
+
+    // With group commit enabled, commit() only appends to the heap's write-ahead log,
+    // and the caller is responsible for calling sync() before acknowledging the commit.
+    // This allows many statements to share a single sync of the log.
+    bool group_commit_enabled() const { return m_group_commit_enabled; }
+    void set_group_commit_enabled(bool enabled) { m_group_commit_enabled = enabled; }
 
     ResultOr<void> add_schema(SchemaDef const&);
     static Key get_schema_key(DeprecatedString const&);
@@ -51,6 +58,7 @@ private:
     explicit Database(DeprecatedString);
 
     bool m_open { false };
+    bool m_group_commit_enabled { false };
     NonnullRefPtr<Heap> m_heap;
     Serializer m_serializer;
     RefPtr<BTree> m_schemas;
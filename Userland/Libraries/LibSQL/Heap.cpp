@@ -9,6 +9,7 @@
 #include <AK/QuickSort.h>
 #include <LibCore/IODevice.h>
 #include <LibCore/System.h>
+#include <LibCrypto/Checksum/CRC32.h>
 #include <LibSQL/Heap.h>
 #include <LibSQL/Serializer.h>
 #include <sys/stat.h>
@@ -23,9 +24,20 @@ Heap::Heap(DeprecatedString file_name)
 
 Heap::~Heap()
 {
-    if (m_file && !m_write_ahead_log.is_empty()) {
-        if (auto maybe_error = flush(); maybe_error.is_error())
-            warnln("~Heap({}): {}", name(), maybe_error.error());
+    if (!m_file)
+        return;
+    if (auto maybe_error = flush(); maybe_error.is_error()) {
+        warnln("~Heap({}): {}", name(), maybe_error.error());
+        return;
+    }
+    if (auto maybe_error = checkpoint(); maybe_error.is_error()) {
+        warnln("~Heap({}): {}", name(), maybe_error.error());
+        return;
+    }
+    // Everything made it into the heap file, so the log is no longer needed.
+    if (m_log_file) {
+        m_log_file = nullptr;
+        (void)Core::System::unlink(log_file_name());
     }
 }
 
@@ -41,14 +53,29 @@ ErrorOr<void> Heap::open()
     } else if (!S_ISREG(stat_buffer.st_mode)) {
         warnln("Heap::open({}): can only use regular files"sv, name());
         return Error::from_string_literal("Heap::open(): can only use regular files");
-    } else {
-        file_size = stat_buffer.st_size;
     }
-    if (file_size > 0)
-        m_next_block = m_end_of_file = file_size / BLOCKSIZE;
 
     auto file = TRY(Core::Stream::File::open(name(), Core::Stream::OpenMode::ReadWrite));
+    m_file_fd = file->fd();
     m_file = TRY(Core::Stream::BufferedFile::create(move(file)));
+    clear_page_cache();
+    m_pending_writes.clear();
+    m_logged_blocks.clear();
+
+    // If we crashed before the last checkpoint, the log holds transactions that
+    // still have to be copied into the heap file.
+    m_log_file = nullptr;
+    if (!Core::System::access(log_file_name(), F_OK).is_error()) {
+        if (auto error_maybe = recover_from_log(); error_maybe.is_error()) {
+            m_file = nullptr;
+            return error_maybe.release_error();
+        }
+    }
+
+    file_size = TRY(Core::System::fstat(m_file_fd)).st_size;
+    m_next_block = m_end_of_file = 1;
+    if (file_size > 0)
+        m_next_block = m_end_of_file = file_size / BLOCKSIZE;
 
     if (file_size > 0) {
         if (auto error_maybe = read_zero_block(); error_maybe.is_error()) {
@@ -72,21 +99,29 @@ ErrorOr<void> Heap::open()
     return {};
 }
 
-ErrorOr<ByteBuffer> Heap::read_block(u32 block)
+ErrorOr<ReadonlyBytes> Heap::read_block(u32 block)
 {
     if (!m_file) {
         warnln("Heap({})::read_block({}): Heap file not opened"sv, name(), block);
         return Error::from_string_literal("Heap()::read_block(): Heap file not opened");
     }
 
-    if (auto buffer = m_write_ahead_log.get(block); buffer.has_value())
-        return TRY(ByteBuffer::copy(*buffer));
+    if (auto buffer = m_pending_writes.get(block); buffer.has_value())
+        return buffer->bytes();
+    if (auto buffer = m_logged_blocks.get(block); buffer.has_value())
+        return buffer->bytes();
 
     if (block >= m_next_block) {
         warnln("Heap({})::read_block({}): block # out of range (>= {})"sv, name(), block, m_next_block);
         return Error::from_string_literal("Heap()::read_block(): block # out of range");
     }
 
+    if (auto const* cached_buffer = find_in_page_cache(block)) {
+        ++m_page_cache_statistics.hits;
+        return cached_buffer->bytes();
+    }
+    ++m_page_cache_statistics.misses;
+
     dbgln_if(SQL_DEBUG, "Read heap block {}", block);
     TRY(seek_block(block));
 
@@ -96,7 +131,7 @@ ErrorOr<ByteBuffer> Heap::read_block(u32 block)
     dbgln_if(SQL_DEBUG, "{:hex-dump}", bytes.trim(8));
     TRY(buffer.try_resize(bytes.size()));
 
-    return buffer;
+    return put_in_page_cache(block, move(buffer));
 }
 
 ErrorOr<void> Heap::write_block(u32 block, ByteBuffer& buffer)
@@ -127,9 +162,60 @@ ErrorOr<void> Heap::write_block(u32 block, ByteBuffer& buffer)
 
     if (block == m_end_of_file)
         m_end_of_file++;
+
+    // Only update blocks that are already cached, so that writing out a large
+    // batch of blocks doesn't push the hot blocks out of the cache.
+    if (auto index = m_page_cache_index.get(block); index.has_value())
+        m_page_cache[*index].buffer = TRY(ByteBuffer::copy(buffer));
     return {};
 }
 
+ByteBuffer const* Heap::find_in_page_cache(u32 block)
+{
+    auto index = m_page_cache_index.get(block);
+    if (!index.has_value())
+        return nullptr;
+
+    auto& cached_block = m_page_cache[*index];
+    cached_block.referenced = true;
+    return &cached_block.buffer;
+}
+
+ErrorOr<ReadonlyBytes> Heap::put_in_page_cache(u32 block, ByteBuffer buffer)
+{
+    VERIFY(!m_page_cache_index.contains(block));
+
+    if (m_page_cache.size() < page_cache_block_count) {
+        TRY(m_page_cache.try_append({ block, move(buffer), false }));
+        TRY(m_page_cache_index.try_set(block, m_page_cache.size() - 1));
+        return m_page_cache.last().buffer.bytes();
+    }
+
+    // Sweep the clock hand across the cache, giving every recently referenced block
+    // a second chance, until we find one that wasn't used since the last sweep.
+    while (m_page_cache[m_page_cache_hand].referenced) {
+        m_page_cache[m_page_cache_hand].referenced = false;
+        m_page_cache_hand = (m_page_cache_hand + 1) % m_page_cache.size();
+    }
+
+    auto& victim = m_page_cache[m_page_cache_hand];
+    dbgln_if(SQL_DEBUG, "Evicting heap block {} from page cache", victim.block);
+    m_page_cache_index.remove(victim.block);
+    ++m_page_cache_statistics.evictions;
+
+    victim = { block, move(buffer), false };
+    TRY(m_page_cache_index.try_set(block, m_page_cache_hand));
+    m_page_cache_hand = (m_page_cache_hand + 1) % m_page_cache.size();
+    return victim.buffer.bytes();
+}
+
+void Heap::clear_page_cache()
+{
+    m_page_cache.clear();
+    m_page_cache_index.clear();
+    m_page_cache_hand = 0;
+}
+
 ErrorOr<void> Heap::seek_block(u32 block)
 {
     if (!m_file) {
@@ -167,21 +253,215 @@ u32 Heap::new_record_pointer()
 }
 
 ErrorOr<void> Heap::flush()
+{
+    TRY(commit());
+    TRY(sync());
+    return {};
+}
+
+ErrorOr<void> Heap::commit()
 {
     VERIFY(m_file);
+    if (m_pending_writes.is_empty())
+        return {};
+
     Vector<u32> blocks;
-    for (auto& wal_entry : m_write_ahead_log) {
-        blocks.append(wal_entry.key);
+    TRY(blocks.try_ensure_capacity(m_pending_writes.size()));
+    for (auto& pending_write : m_pending_writes)
+        blocks.unchecked_append(pending_write.key);
+    quick_sort(blocks);
+
+    TRY(write_transaction_to_log(blocks));
+
+    for (auto block : blocks) {
+        auto buffer = m_pending_writes.take(block).release_value();
+        TRY(m_logged_blocks.try_set(block, move(buffer)));
     }
+    m_log_needs_sync = true;
+    dbgln_if(SQL_DEBUG, "Committed {} blocks to the write-ahead log of {}", blocks.size(), name());
+    return {};
+}
+
+ErrorOr<void> Heap::sync()
+{
+    VERIFY(m_file);
+    if (m_log_needs_sync) {
+        VERIFY(m_log_file);
+        TRY(Core::System::fsync(m_log_file->fd()));
+        m_log_needs_sync = false;
+    }
+
+    if (m_logged_blocks.size() >= checkpoint_block_count)
+        TRY(checkpoint());
+    return {};
+}
+
+ErrorOr<void> Heap::checkpoint()
+{
+    VERIFY(m_file);
+    if (m_logged_blocks.is_empty())
+        return {};
+
+    // The log has to be durable before we start overwriting blocks in the heap file,
+    // otherwise a crash halfway through could leave us with a corrupted heap.
+    if (m_log_needs_sync) {
+        TRY(Core::System::fsync(m_log_file->fd()));
+        m_log_needs_sync = false;
+    }
+
+    Vector<u32> blocks;
+    TRY(blocks.try_ensure_capacity(m_logged_blocks.size()));
+    for (auto& logged_block : m_logged_blocks)
+        blocks.unchecked_append(logged_block.key);
     quick_sort(blocks);
-    for (auto& block : blocks) {
-        auto buffer_it = m_write_ahead_log.find(block);
-        VERIFY(buffer_it != m_write_ahead_log.end());
-        dbgln_if(SQL_DEBUG, "Flushing block {} to {}", block, name());
+
+    for (auto block : blocks) {
+        auto buffer_it = m_logged_blocks.find(block);
+        VERIFY(buffer_it != m_logged_blocks.end());
+        dbgln_if(SQL_DEBUG, "Checkpointing block {} to {}", block, name());
         TRY(write_block(block, buffer_it->value));
     }
-    m_write_ahead_log.clear();
-    dbgln_if(SQL_DEBUG, "WAL flushed. Heap size = {}", size());
+    TRY(Core::System::fsync(m_file_fd));
+
+    TRY(m_log_file->truncate(0));
+    m_logged_blocks.clear();
+    dbgln_if(SQL_DEBUG, "WAL checkpointed. Heap size = {}", size());
+    return {};
+}
+
+struct [[gnu::packed]] LogRecordHeader {
+    static constexpr u32 expected_magic = 0x57514c53; // "SQLW"
+
+    enum class Type : u32 {
+        Block = 1,
+        Commit = 2,
+    };
+
+    u32 magic { expected_magic };
+    Type type { Type::Block };
+    // The block number for block records, the transaction id for commit records.
+    u32 value { 0 };
+    u32 size { 0 };
+    u32 checksum { 0 };
+
+    u32 compute_checksum(ReadonlyBytes payload) const
+    {
+        auto header = *this;
+        header.checksum = 0;
+        Crypto::Checksum::CRC32 crc32 { { &header, sizeof(header) } };
+        crc32.update(payload);
+        return crc32.digest();
+    }
+};
+
+DeprecatedString Heap::log_file_name() const
+{
+    return DeprecatedString::formatted("{}-wal", name());
+}
+
+ErrorOr<void> Heap::open_log_file()
+{
+    if (m_log_file)
+        return {};
+    m_log_file = TRY(Core::Stream::File::open(log_file_name(), Core::Stream::OpenMode::ReadWrite | Core::Stream::OpenMode::Append));
+    return {};
+}
+
+ErrorOr<void> Heap::write_transaction_to_log(Vector<u32> const& blocks)
+{
+    TRY(open_log_file());
+
+    // Gather the whole transaction up front, so it ends up in the log with a single write.
+    auto record_size = sizeof(LogRecordHeader) + BLOCKSIZE;
+    auto transaction = TRY(ByteBuffer::create_zeroed(blocks.size() * record_size + sizeof(LogRecordHeader)));
+
+    size_t offset = 0;
+    for (auto block : blocks) {
+        auto& buffer = m_pending_writes.find(block)->value;
+        if (buffer.size() > BLOCKSIZE) {
+            warnln("Heap({})::commit(): Oversized block {} ({} > {})"sv, name(), block, buffer.size(), BLOCKSIZE);
+            return Error::from_string_literal("Heap()::commit(): Oversized block");
+        }
+        if (auto current_size = buffer.size(); current_size < BLOCKSIZE) {
+            TRY(buffer.try_resize(BLOCKSIZE));
+            memset(buffer.offset_pointer(current_size), 0, BLOCKSIZE - current_size);
+        }
+
+        LogRecordHeader header;
+        header.type = LogRecordHeader::Type::Block;
+        header.value = block;
+        header.size = BLOCKSIZE;
+        header.checksum = header.compute_checksum(buffer);
+        transaction.overwrite(offset, &header, sizeof(header));
+        transaction.overwrite(offset + sizeof(header), buffer.data(), BLOCKSIZE);
+        offset += record_size;
+    }
+
+    LogRecordHeader commit_header;
+    commit_header.type = LogRecordHeader::Type::Commit;
+    commit_header.value = m_next_transaction_id++;
+    commit_header.checksum = commit_header.compute_checksum({});
+    transaction.overwrite(offset, &commit_header, sizeof(commit_header));
+
+    TRY(m_log_file->write_entire_buffer(transaction));
+    return {};
+}
+
+ErrorOr<void> Heap::recover_from_log()
+{
+    TRY(open_log_file());
+    auto log = TRY(m_log_file->read_until_eof());
+
+    HashMap<u32, ByteBuffer> transaction_blocks;
+    HashMap<u32, ByteBuffer> committed_blocks;
+    size_t transaction_count = 0;
+
+    // Replay records up to the first one that is incomplete or corrupted, which is
+    // where we crashed while appending to the log. Only blocks belonging to a
+    // transaction that was followed by its commit record are recovered.
+    size_t offset = 0;
+    while (offset + sizeof(LogRecordHeader) <= log.size()) {
+        LogRecordHeader header;
+        memcpy(&header, log.offset_pointer(offset), sizeof(header));
+        if (header.magic != LogRecordHeader::expected_magic || header.size > BLOCKSIZE)
+            break;
+        if (offset + sizeof(header) + header.size > log.size())
+            break;
+        auto payload = log.bytes().slice(offset + sizeof(header), header.size);
+        if (header.checksum != header.compute_checksum(payload))
+            break;
+        offset += sizeof(header) + header.size;
+
+        if (header.type == LogRecordHeader::Type::Block) {
+            TRY(transaction_blocks.try_set(header.value, TRY(ByteBuffer::copy(payload))));
+        } else if (header.type == LogRecordHeader::Type::Commit) {
+            for (auto& block : transaction_blocks)
+                TRY(committed_blocks.try_set(block.key, move(block.value)));
+            transaction_blocks.clear();
+            m_next_transaction_id = header.value + 1;
+            ++transaction_count;
+        } else {
+            break;
+        }
+    }
+
+    if (!committed_blocks.is_empty()) {
+        dbgln_if(SQL_DEBUG, "Recovering {} blocks from {} transactions in {}", committed_blocks.size(), transaction_count, log_file_name());
+
+        Vector<u32> blocks;
+        TRY(blocks.try_ensure_capacity(committed_blocks.size()));
+        for (auto& block : committed_blocks)
+            blocks.unchecked_append(block.key);
+        quick_sort(blocks);
+
+        for (auto block : blocks) {
+            TRY(m_file->seek(static_cast<i64>(block) * BLOCKSIZE, SeekMode::SetPosition));
+            TRY(m_file->write_entire_buffer(committed_blocks.find(block)->value));
+        }
+        TRY(Core::System::fsync(m_file_fd));
+    }
+
+    TRY(m_log_file->truncate(0));
     return {};
 }
 
@@ -196,9 +476,7 @@ constexpr static auto USER_VALUES_OFFSET = FREE_LIST_OFFSET + sizeof(u32);
 ErrorOr<void> Heap::read_zero_block()
 {
     auto buffer = TRY(read_block(0));
-    auto file_id_buffer = TRY(buffer.slice(0, FILE_ID.length()));
-    auto file_id = StringView(file_id_buffer);
-    if (file_id != FILE_ID) {
+    if (buffer.size() < FILE_ID.length() || StringView(buffer.trim(FILE_ID.length())) != FILE_ID) {
         warnln("{}: Zero page corrupt. This is probably not a {} heap file"sv, name(), FILE_ID);
         return Error::from_string_literal("Heap()::read_zero_block(): Zero page corrupt. This is probably not a SerenitySQL heap file");
     }
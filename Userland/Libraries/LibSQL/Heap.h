@@ -39,7 +39,8 @@ public:
 
     ErrorOr<void> open();
     u32 size() const { return m_end_of_file; }
-    ErrorOr<ByteBuffer> read_block(u32);
+    // The returned bytes belong to the heap, and are only valid until the heap is used again.
+    ErrorOr<ReadonlyBytes> read_block(u32);
     [[nodiscard]] u32 new_record_pointer();
     [[nodiscard]] bool valid() const { return static_cast<bool>(m_file); }
 
@@ -85,21 +86,49 @@ public:
     {
         dbgln_if(SQL_DEBUG, "Adding to WAL: block #{}, size {}", block, buffer.size());
         dbgln_if(SQL_DEBUG, "{:hex-dump}", buffer.bytes().trim(8));
-        m_write_ahead_log.set(block, buffer);
+        m_pending_writes.set(block, buffer);
     }
 
+    // Appends all blocks added since the last commit to the write-ahead log as a single
+    // transaction. The transaction is only guaranteed to survive a crash after sync().
+    ErrorOr<void> commit();
+    // Makes all committed transactions durable. Transactions committed since the last
+    // sync are all written out with a single sync of the log file.
+    ErrorOr<void> sync();
+    // Copies all blocks in the write-ahead log into the heap file and empties the log.
+    ErrorOr<void> checkpoint();
+    // Commits and syncs all pending blocks.
     ErrorOr<void> flush();
 
+    struct PageCacheStatistics {
+        size_t hits { 0 };
+        size_t misses { 0 };
+        size_t evictions { 0 };
+    };
+
+    PageCacheStatistics const& page_cache_statistics() const { return m_page_cache_statistics; }
+
 private:
     explicit Heap(DeprecatedString);
 
     ErrorOr<void> write_block(u32, ByteBuffer&);
     ErrorOr<void> seek_block(u32);
     ErrorOr<void> read_zero_block();
+
+    DeprecatedString log_file_name() const;
+    ErrorOr<void> open_log_file();
+    ErrorOr<void> recover_from_log();
+    ErrorOr<void> write_transaction_to_log(Vector<u32> const& blocks);
+
     void initialize_zero_block();
     void update_zero_block();
 
+    ByteBuffer const* find_in_page_cache(u32 block);
+    ErrorOr<ReadonlyBytes> put_in_page_cache(u32 block, ByteBuffer);
+    void clear_page_cache();
+
     OwnPtr<Core::Stream::BufferedFile> m_file;
+    int m_file_fd { -1 };
     u32 m_free_list { 0 };
     u32 m_next_block { 1 };
     u32 m_end_of_file { 1 };
@@ -108,7 +137,34 @@ private:
     u32 m_table_columns_root { 0 };
     u32 m_version { current_version };
     Array<u32, 16> m_user_values { 0 };
-    HashMap<u32, ByteBuffer> m_write_ahead_log;
+    // Blocks that were written since the last commit.
+    HashMap<u32, ByteBuffer> m_pending_writes;
+
+    // The write-ahead log is an append-only file of checksummed block records, each
+    // transaction followed by a commit record. Blocks in the log stay in memory until
+    // they are checkpointed into the heap file.
+    static constexpr size_t checkpoint_block_count = 1024;
+
+    OwnPtr<Core::Stream::File> m_log_file;
+    HashMap<u32, ByteBuffer> m_logged_blocks;
+    u32 m_next_transaction_id { 1 };
+    bool m_log_needs_sync { false };
+
+    // The page cache keeps recently read blocks around, so that hot blocks like the
+    // interior nodes of B-trees don't have to be read from the file over and over again.
+    // Blocks are evicted using the clock (second chance) algorithm.
+    static constexpr size_t page_cache_block_count = 1024;
+
+    struct CachedBlock {
+        u32 block { 0 };
+        ByteBuffer buffer;
+        bool referenced { false };
+    };
+
+    Vector<CachedBlock> m_page_cache;
+    HashMap<u32, size_t> m_page_cache_index;
+    size_t m_page_cache_hand { 0 };
+    PageCacheStatistics m_page_cache_statistics;
 };
 
 }
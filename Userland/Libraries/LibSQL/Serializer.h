@@ -29,16 +29,18 @@ public:
     void get_block(u32 pointer)
     {
         VERIFY(m_heap.ptr() != nullptr);
-        auto buffer_or_error = m_heap->read_block(pointer);
-        if (buffer_or_error.is_error())
+        auto block_or_error = m_heap->read_block(pointer);
+        if (block_or_error.is_error())
             VERIFY_NOT_REACHED();
-        m_buffer = buffer_or_error.value();
+        m_buffer.clear();
+        m_block = block_or_error.value();
         m_current_offset = 0;
     }
 
     void reset()
     {
         m_buffer.clear();
+        m_block = {};
         m_current_offset = 0;
     }
 
@@ -141,13 +143,14 @@ private:
     {
         if constexpr (SQL_DEBUG)
             dump(ptr, sz, "(out) =>");
+        VERIFY(m_block.is_empty());
         m_buffer.append(ptr, sz);
         m_current_offset += sz;
     }
 
     u8 const* read(size_t sz)
     {
-        auto buffer_ptr = m_buffer.offset_pointer(m_current_offset);
+        auto buffer_ptr = (m_block.is_empty() ? m_buffer.bytes() : m_block).offset_pointer(m_current_offset);
         if constexpr (SQL_DEBUG)
             dump(buffer_ptr, sz, "<= (in)");
         m_current_offset += sz;
@@ -168,6 +171,9 @@ private:
         dbgln(builder.to_deprecated_string());
     }
 
+    // The block we're deserializing. It belongs to the heap, which keeps it in its page cache while we
+    // read it, so we don't copy it. Anything we serialize goes into m_buffer, after a reset().
+    ReadonlyBytes m_block {};
     ByteBuffer m_buffer {};
     size_t m_current_offset { 0 };
     RefPtr<Heap> m_heap { nullptr };
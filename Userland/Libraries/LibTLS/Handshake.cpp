@@ -48,8 +48,8 @@ ByteBuffer TLSv12::build_hello()
         alpn_negotiated_length = m_context.negotiated_alpn.length();
         alpn_length = alpn_negotiated_length + 1;
         extension_length += alpn_length + 6;
-    } else if (m_context.alpn.size()) {
-        for (auto& alpn : m_context.alpn) {
+    } else if (m_context.options.alpn_protocols.size()) {
+        for (auto& alpn : m_context.options.alpn_protocols) {
             size_t length = alpn.length();
             alpn_length += length + 1;
         }
@@ -131,8 +131,22 @@ ByteBuffer TLSv12::build_hello()
     }
 
     if (alpn_length) {
-        // TODO
-        VERIFY_NOT_REACHED();
+        // ALPN extension
+        builder.append((u16)HandshakeExtension::ApplicationLayerProtocolNegotiation);
+        // extension length
+        builder.append((u16)(alpn_length + 2));
+        // ProtocolNameList length
+        builder.append((u16)alpn_length);
+        auto append_protocol = [&](StringView protocol) {
+            builder.append((u8)protocol.length());
+            builder.append(protocol.bytes());
+        };
+        if (!m_context.negotiated_alpn.is_null()) {
+            append_protocol(m_context.negotiated_alpn);
+        } else {
+            for (auto& protocol : m_context.options.alpn_protocols)
+                append_protocol(protocol);
+        }
     }
 
     // set the "length" field of the packet
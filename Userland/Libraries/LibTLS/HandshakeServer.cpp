@@ -149,28 +149,20 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
                 res += sni_name_length;
                 dbgln("SNI host_name: {}", m_context.extensions.SNI);
             }
-        } else if (extension_type == HandshakeExtension::ApplicationLayerProtocolNegotiation && m_context.alpn.size()) {
-            if (buffer.size() - res > 2) {
-                auto alpn_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res)));
-                if (alpn_length && alpn_length <= extension_length - 2) {
-                    u8 const* alpn = buffer.offset_pointer(res + 2);
-                    size_t alpn_position = 0;
-                    while (alpn_position < alpn_length) {
-                        u8 alpn_size = alpn[alpn_position++];
-                        if (alpn_size + alpn_position >= extension_length)
-                            break;
-                        DeprecatedString alpn_str { (char const*)alpn + alpn_position, alpn_length };
-                        if (alpn_size && m_context.alpn.contains_slow(alpn_str)) {
-                            m_context.negotiated_alpn = alpn_str;
-                            dbgln("negotiated alpn: {}", alpn_str);
-                            break;
-                        }
-                        alpn_position += alpn_length;
-                        if (!m_context.is_server) // server hello must contain one ALPN
-                            break;
-                    }
-                }
-            }
+        } else if (extension_type == HandshakeExtension::ApplicationLayerProtocolNegotiation && !m_context.options.alpn_protocols.is_empty()) {
+            // RFC7301 section 3.1: The ServerHello contains a ProtocolNameList with exactly one of the protocols we offered.
+            if (extension_length < 3)
+                return (i8)Error::BrokenPacket;
+            auto protocol_name_list_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res)));
+            u8 protocol_name_length = buffer[res + 2];
+            if (protocol_name_list_length != extension_length - 2 || protocol_name_length == 0 || protocol_name_length != protocol_name_list_length - 1)
+                return (i8)Error::BrokenPacket;
+
+            StringView protocol { buffer.offset_pointer(res + 3), protocol_name_length };
+            if (!m_context.options.alpn_protocols.contains_slow(protocol))
+                return (i8)Error::NotUnderstood;
+            m_context.negotiated_alpn = protocol;
+            dbgln_if(TLS_DEBUG, "ALPN: Server picked {}", protocol);
             res += extension_length;
         } else if (extension_type == HandshakeExtension::SignatureAlgorithms) {
             dbgln("supported signatures: ");
@@ -260,6 +260,8 @@ struct Options {
     OPTION_WITH_DEFAULTS(Function<void(AlertDescription)>, alert_handler, [](auto) {})
     OPTION_WITH_DEFAULTS(Function<void()>, finish_callback, [] {})
     OPTION_WITH_DEFAULTS(Function<Vector<Certificate>()>, certificate_provider, [] { return Vector<Certificate> {}; })
+    // Application protocols to offer the server via ALPN (RFC 7301), most preferred first, e.g. "h2" and "http/1.1".
+    OPTION_WITH_DEFAULTS(Vector<DeprecatedString>, alpn_protocols, )
 
 #undef OPTION_WITH_DEFAULTS
 };
@@ -328,8 +330,7 @@ struct Context {
     ByteBuffer user_data;
     HashMap<DeprecatedString, Certificate> root_certificates;
 
-    Vector<DeprecatedString> alpn;
-    StringView negotiated_alpn;
+    DeprecatedString negotiated_alpn;
 
     size_t send_retries { 0 };
 
@@ -404,6 +405,7 @@ public:
 
     static Vector<Certificate> parse_pem_certificate(ReadonlyBytes certificate_pem_buffer, ReadonlyBytes key_pem_buffer);
 
+    // The application protocol the server picked from Options::alpn_protocols, if it did.
     StringView alpn() const { return m_context.negotiated_alpn; }
 
     bool supports_cipher(CipherSuite suite) const
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Format.h>
+#include <LibThreading/ThreadPool.h>
+#include <unistd.h>
+
+namespace Threading {
+
+// The pool and worker index of the current thread, if it is a pool worker.
+static thread_local ThreadPool* s_current_pool;
+static thread_local size_t s_current_worker_index;
+
+ThreadPool& ThreadPool::the()
+{
+    static ThreadPool* s_the;
+    static pthread_once_t s_once = PTHREAD_ONCE_INIT;
+    pthread_once(&s_once, [] {
+        auto processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+        // This pool lives for the rest of the process, as workers may still be running tasks at exit.
+        s_the = MUST(try_create(max<long>(1, processor_count))).leak_ptr();
+    });
+    return *s_the;
+}
+
+ErrorOr<NonnullOwnPtr<ThreadPool>> ThreadPool::try_create(size_t thread_count)
+{
+    VERIFY(thread_count > 0);
+    auto pool = TRY(adopt_nonnull_own_or_enomem(new (nothrow) ThreadPool));
+
+    TRY(pool->m_workers.try_ensure_capacity(thread_count));
+    for (size_t i = 0; i < thread_count; ++i)
+        pool->m_workers.unchecked_append(TRY(adopt_nonnull_own_or_enomem(new (nothrow) Worker)));
+
+    for (size_t i = 0; i < thread_count; ++i) {
+        auto& worker = pool->m_workers[i];
+        worker.thread = TRY(Thread::try_create([pool = pool.ptr(), i] { return pool->worker_main(i); }, "ThreadPool worker"sv));
+        worker.thread->start();
+    }
+    return pool;
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        MutexLocker locker(m_idle_mutex);
+        m_exiting = true;
+        m_idle_condition.broadcast();
+    }
+    for (auto& worker : m_workers)
+        (void)worker.thread->join();
+}
+
+ThreadPool::Statistics ThreadPool::statistics() const
+{
+    Statistics statistics;
+    for (auto& worker : m_workers) {
+        statistics.tasks_executed += worker.tasks_executed.load(AK::MemoryOrder::memory_order_relaxed);
+        statistics.tasks_stolen += worker.tasks_stolen.load(AK::MemoryOrder::memory_order_relaxed);
+    }
+    return statistics;
+}
+
+void ThreadPool::submit(Task task)
+{
+    // Workers keep their own tasks local, everyone else spreads them out over all workers.
+    size_t worker_index;
+    if (s_current_pool == this)
+        worker_index = s_current_worker_index;
+    else
+        worker_index = m_next_worker.fetch_add(1, AK::MemoryOrder::memory_order_relaxed) % m_workers.size();
+
+    {
+        auto& worker = m_workers[worker_index];
+        MutexLocker locker(worker.mutex);
+        worker.queue.append(move(task));
+    }
+
+    MutexLocker locker(m_idle_mutex);
+    ++m_queued_task_count;
+    m_idle_condition.signal();
+}
+
+Optional<ThreadPool::Task> ThreadPool::take_task(Optional<size_t> worker_index)
+{
+    // Newest task from our own queue first, as it is the most likely to still be in the cache.
+    if (worker_index.has_value()) {
+        auto& worker = m_workers[*worker_index];
+        MutexLocker locker(worker.mutex);
+        if (!worker.queue.is_empty()) {
+            --m_queued_task_count;
+            return worker.queue.take_last();
+        }
+    }
+
+    // Otherwise steal the oldest task of another worker, which tends to be the one that
+    // would be split up into the most further work.
+    auto start = worker_index.has_value() ? *worker_index + 1 : 0;
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        auto victim_index = (start + i) % m_workers.size();
+        if (worker_index.has_value() && victim_index == *worker_index)
+            continue;
+        auto& victim = m_workers[victim_index];
+        MutexLocker locker(victim.mutex);
+        if (victim.queue.is_empty())
+            continue;
+        --m_queued_task_count;
+        if (worker_index.has_value())
+            m_workers[*worker_index].tasks_stolen.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+        return victim.queue.take_first();
+    }
+    return {};
+}
+
+bool ThreadPool::run_pending_task()
+{
+    Optional<size_t> worker_index;
+    if (s_current_pool == this)
+        worker_index = s_current_worker_index;
+
+    auto task = take_task(worker_index);
+    if (!task.has_value())
+        return false;
+    (*task)();
+    if (worker_index.has_value())
+        m_workers[*worker_index].tasks_executed.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    return true;
+}
+
+intptr_t ThreadPool::worker_main(size_t worker_index)
+{
+    s_current_pool = this;
+    s_current_worker_index = worker_index;
+
+    while (true) {
+        if (run_pending_task())
+            continue;
+
+        MutexLocker locker(m_idle_mutex);
+        while (m_queued_task_count.load() <= 0 && !m_exiting)
+            m_idle_condition.wait();
+        if (m_exiting && m_queued_task_count.load() <= 0)
+            return 0;
+    }
+}
+
+void TaskGroup::spawn(ThreadPool::Task task)
+{
+    {
+        MutexLocker locker(m_mutex);
+        ++m_pending_tasks;
+    }
+    m_pool.submit([this, task = move(task)] {
+        task();
+        // The waiting thread only returns after taking the mutex, so the group stays alive until we are done here.
+        MutexLocker locker(m_mutex);
+        if (--m_pending_tasks == 0)
+            m_condition.broadcast();
+    });
+}
+
+void TaskGroup::wait()
+{
+    while (true) {
+        {
+            MutexLocker locker(m_mutex);
+            if (m_pending_tasks == 0)
+                return;
+        }
+        if (m_pool.run_pending_task())
+            continue;
+        MutexLocker locker(m_mutex);
+        if (m_pending_tasks == 0)
+            return;
+        m_condition.wait();
+    }
+}
+
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/AtomicRefCounted.h>
+#include <AK/Function.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibCore/EventLoop.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
+
+namespace Threading {
+
+template<typename T>
+class Future;
+
+// A fixed set of worker threads that run short tasks.
+// Every worker has its own queue of tasks. Tasks submitted from a worker go to the back of its
+// own queue and are picked up from there again (so nested work stays hot in that worker's cache),
+// while idle workers steal the oldest tasks from the front of the other workers' queues.
+class ThreadPool {
+    AK_MAKE_NONCOPYABLE(ThreadPool);
+    AK_MAKE_NONMOVABLE(ThreadPool);
+
+public:
+    using Task = Function<void()>;
+
+    struct Statistics {
+        u64 tasks_executed { 0 };
+        u64 tasks_stolen { 0 };
+    };
+
+    // The process-wide pool, which has one worker per online processor.
+    static ThreadPool& the();
+
+    static ErrorOr<NonnullOwnPtr<ThreadPool>> try_create(size_t thread_count);
+    ~ThreadPool();
+
+    size_t thread_count() const { return m_workers.size(); }
+    Statistics statistics() const;
+
+    void submit(Task);
+
+    // Submits a task whose result can be waited on or delivered to an event loop.
+    template<typename T>
+    NonnullRefPtr<Future<T>> async(Function<T()> task);
+
+    // Takes one queued task and runs it on the calling thread. Threads that wait on work
+    // they submitted to the pool use this to help out, so that nested waits cannot deadlock.
+    bool run_pending_task();
+
+private:
+    struct Worker {
+        Mutex mutex;
+        Vector<Task> queue;
+        RefPtr<Thread> thread;
+        Atomic<u64> tasks_executed { 0 };
+        Atomic<u64> tasks_stolen { 0 };
+    };
+
+    ThreadPool() = default;
+
+    Optional<Task> take_task(Optional<size_t> worker_index);
+    intptr_t worker_main(size_t worker_index);
+
+    NonnullOwnPtrVector<Worker> m_workers;
+    Atomic<size_t> m_next_worker { 0 };
+
+    Mutex m_idle_mutex;
+    ConditionVariable m_idle_condition { m_idle_mutex };
+    Atomic<i64> m_queued_task_count { 0 };
+    bool m_exiting { false };
+};
+
+// A set of tasks that can be waited on together.
+class TaskGroup {
+    AK_MAKE_NONCOPYABLE(TaskGroup);
+    AK_MAKE_NONMOVABLE(TaskGroup);
+
+public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::the())
+        : m_pool(pool)
+    {
+    }
+
+    ~TaskGroup() { wait(); }
+
+    void spawn(ThreadPool::Task);
+
+    // Returns once all spawned tasks have finished, running queued tasks on this thread in the meantime.
+    void wait();
+
+private:
+    ThreadPool& m_pool;
+    Mutex m_mutex;
+    ConditionVariable m_condition { m_mutex };
+    size_t m_pending_tasks { 0 };
+};
+
+template<typename T>
+class Future final : public AtomicRefCounted<Future<T>> {
+    friend class ThreadPool;
+
+public:
+    bool is_resolved() const
+    {
+        MutexLocker locker(m_mutex);
+        return m_value.has_value();
+    }
+
+    // Blocks until the task has finished, running queued tasks on this thread in the meantime.
+    T& await()
+    {
+        while (true) {
+            {
+                MutexLocker locker(m_mutex);
+                if (m_value.has_value())
+                    return m_value.value();
+            }
+            if (m_pool.run_pending_task())
+                continue;
+            MutexLocker locker(m_mutex);
+            if (!m_value.has_value())
+                m_condition.wait();
+        }
+    }
+
+    // Invokes the callback on the calling thread's event loop once the task has finished.
+    void on_resolution(Function<void(T&)> callback)
+    {
+        MutexLocker locker(m_mutex);
+        VERIFY(!m_on_resolution);
+        m_on_resolution = move(callback);
+        m_event_loop = &Core::EventLoop::current();
+        if (m_value.has_value())
+            notify_event_loop();
+    }
+
+private:
+    explicit Future(ThreadPool& pool)
+        : m_pool(pool)
+    {
+    }
+
+    void resolve(T value)
+    {
+        MutexLocker locker(m_mutex);
+        m_value = move(value);
+        m_condition.broadcast();
+        if (m_on_resolution)
+            notify_event_loop();
+    }
+
+    // Must be called with m_mutex held.
+    void notify_event_loop()
+    {
+        m_event_loop->deferred_invoke([self = NonnullRefPtr(*this)] {
+            self->m_on_resolution(self->m_value.value());
+        });
+        m_event_loop->wake();
+    }
+
+    ThreadPool& m_pool;
+    mutable Mutex m_mutex;
+    ConditionVariable m_condition { m_mutex };
+    Optional<T> m_value;
+    Function<void(T&)> m_on_resolution;
+    Core::EventLoop* m_event_loop { nullptr };
+};
+
+template<typename T>
+NonnullRefPtr<Future<T>> ThreadPool::async(Function<T()> task)
+{
+    auto future = adopt_ref(*new Future<T>(*this));
+    submit([future, task = move(task)] {
+        future->resolve(task());
+    });
+    return future;
+}
+
+// Splits [begin, end) into chunks of at least grain_size indices and calls callback(chunk_begin, chunk_end)
+// for each of them on the pool. The calling thread processes the last chunk itself and returns once all
+// chunks are done. A grain size of 0 picks one that gives every worker a few chunks to balance the load.
+template<typename Callback>
+void parallel_for(size_t begin, size_t end, Callback&& callback, size_t grain_size = 0, ThreadPool& pool = ThreadPool::the())
+{
+    if (begin >= end)
+        return;
+
+    auto count = end - begin;
+    if (grain_size == 0)
+        grain_size = max<size_t>(1, count / (pool.thread_count() * 4));
+
+    if (count <= grain_size) {
+        callback(begin, end);
+        return;
+    }
+
+    TaskGroup group { pool };
+    auto chunk_begin = begin;
+    for (; end - chunk_begin > grain_size; chunk_begin += grain_size) {
+        group.spawn([&callback, chunk_begin, grain_size] {
+            callback(chunk_begin, chunk_begin + grain_size);
+        });
+    }
+    callback(chunk_begin, end);
+    group.wait();
+}
+
+}
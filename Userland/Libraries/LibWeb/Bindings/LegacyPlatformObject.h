@@ -18,7 +18,7 @@ public:
     virtual ~LegacyPlatformObject() override;
 
     virtual JS::ThrowCompletionOr<Optional<JS::PropertyDescriptor>> internal_get_own_property(JS::PropertyKey const&) const override;
-    virtual JS::ThrowCompletionOr<bool> internal_set(JS::PropertyKey const&, JS::Value, JS::Value) override;
+    virtual JS::ThrowCompletionOr<bool> internal_set(JS::PropertyKey const&, JS::Value, JS::Value, JS::CacheablePropertyMetadata* = nullptr) override;
     virtual JS::ThrowCompletionOr<bool> internal_define_own_property(JS::PropertyKey const&, JS::PropertyDescriptor const&) override;
     virtual JS::ThrowCompletionOr<bool> internal_delete(JS::PropertyKey const&) override;
     virtual JS::ThrowCompletionOr<bool> internal_prevent_extensions() override;
@@ -33,6 +33,9 @@ public:
     virtual Vector<DeprecatedString> supported_property_names() const;
     virtual bool is_supported_property_index(u32) const;
 
+    // Named properties come and go without changing our shape.
+    virtual bool is_eligible_for_property_lookup_caches() const override { return false; }
+
 protected:
     explicit LegacyPlatformObject(JS::Realm& realm);
 };
@@ -0,0 +1,44 @@
+describe("HTMLCollection", () => {
+    loadLocalPage("/res/html/misc/blank.html");
+
+    afterInitialPageLoad(page => {
+        test("Named properties added after the property was read many times", () => {
+            const collection = page.document.getElementsByTagName("div");
+            const getFoo = object => object.foo;
+            const getBar = object => object.bar;
+            const setBar = (object, value) => {
+                object.bar = value;
+            };
+
+            collection.bar = 1;
+            for (let i = 0; i < 10; ++i) {
+                expect(getFoo(collection)).toBeUndefined();
+                expect(getBar(collection)).toBe(1);
+                setBar(collection, 1);
+            }
+
+            const foo = page.document.createElement("div");
+            foo.id = "foo";
+            page.document.body.appendChild(foo);
+            expect(getFoo(collection)).toBe(foo);
+
+            // An own property that's already there still takes precedence over a named property.
+            const bar = page.document.createElement("div");
+            bar.id = "bar";
+            page.document.body.appendChild(bar);
+            expect(getBar(collection)).toBe(1);
+            setBar(collection, 2);
+            expect(getBar(collection)).toBe(2);
+
+            delete collection.bar;
+            expect(getBar(collection)).toBe(bar);
+
+            foo.remove();
+            bar.remove();
+            expect(getFoo(collection)).toBeUndefined();
+            expect(getBar(collection)).toBeUndefined();
+        });
+    });
+
+    waitForPageToLoad();
+});
@@ -64,4 +64,15 @@ Messages::LookupServer::LookupAddressResponse ConnectionFromClient::lookup_addre
         return { 1, DeprecatedString() };
     return { 0, answers[0].record_data() };
 }
+
+Messages::LookupServer::GetCacheStatisticsResponse ConnectionFromClient::get_cache_statistics()
+{
+    auto statistics = LookupServer::the().cache_statistics();
+    return { statistics.hits, statistics.negative_hits, statistics.misses, statistics.prefetches, statistics.evictions, statistics.expirations, static_cast<u32>(statistics.entry_count) };
+}
+
+void ConnectionFromClient::clear_cache()
+{
+    LookupServer::the().clear_cache();
+}
 }
@@ -27,6 +27,8 @@ private:
 
     virtual Messages::LookupServer::LookupNameResponse lookup_name(DeprecatedString const&) override;
     virtual Messages::LookupServer::LookupAddressResponse lookup_address(DeprecatedString const&) override;
+    virtual Messages::LookupServer::GetCacheStatisticsResponse get_cache_statistics() override;
+    virtual void clear_cache() override;
 };
 
 }
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "DNSCache.h"
+#include <AK/Debug.h>
+#include <AK/Time.h>
+
+namespace LookupServer {
+
+static constexpr size_t max_entry_count = 1024;
+static constexpr u32 max_ttl = 86400;
+// RFC 2308 suggests one to three hours, but names that didn't exist a moment ago tend to be created soon.
+static constexpr u32 max_negative_ttl = 3600;
+
+// Entries are prefetched during the last tenth of their lifetime, if they have been used a few times since
+// they were stored and don't expire so quickly that we'd be prefetching them all the time.
+static constexpr u32 min_prefetch_hit_count = 2;
+static constexpr i64 min_prefetch_lifetime = 10;
+static constexpr i64 prefetch_lifetime_divisor = 10;
+
+i64 DNSCache::now()
+{
+    return Time::now_monotonic_coarse().to_seconds();
+}
+
+Vector<Answer> DNSCache::Entry::answers(i64 now) const
+{
+    u32 remaining_ttl = static_cast<u32>(max<i64>(0, m_expiry_time - now));
+    Vector<Answer> answers;
+    answers.ensure_capacity(m_answers.size());
+    for (auto& answer : m_answers)
+        answers.unchecked_append({ answer.name(), answer.type(), answer.class_code(), remaining_ttl, answer.record_data(), answer.mdns_cache_flush() });
+    return answers;
+}
+
+DNSCache::Key DNSCache::key_for(Entry const& entry)
+{
+    if (entry.m_negative_answer == NegativeAnswer::NameDoesNotExist)
+        return { entry.m_name, 0 };
+    return { entry.m_name, static_cast<u16>(entry.m_record_type) };
+}
+
+RefPtr<DNSCache::Entry> DNSCache::find_unexpired(Key const& key, i64 now)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+        return nullptr;
+    NonnullRefPtr<Entry> entry = it->value;
+    if (entry->m_expiry_time <= now) {
+        dbgln_if(LOOKUPSERVER_DEBUG, "DNSCache: {} ({}) has expired", entry->m_name, entry->m_record_type);
+        m_statistics.expirations++;
+        remove(*entry);
+        return nullptr;
+    }
+    return entry;
+}
+
+RefPtr<DNSCache::Entry> DNSCache::lookup(Name const& name, RecordType record_type)
+{
+    auto current_time = now();
+    auto entry = find_unexpired({ name, static_cast<u16>(record_type) }, current_time);
+    if (!entry)
+        entry = find_unexpired({ name, 0 }, current_time);
+    if (!entry) {
+        m_statistics.misses++;
+        return nullptr;
+    }
+
+    m_statistics.hits++;
+    if (entry->m_negative_answer != NegativeAnswer::None)
+        m_statistics.negative_hits++;
+    entry->m_hit_count++;
+    m_lru_list.append(*entry);
+    return entry;
+}
+
+void DNSCache::store(Name const& name, RecordType record_type, Vector<Answer> answers)
+{
+    if (answers.is_empty())
+        return;
+
+    u32 ttl = max_ttl;
+    for (auto& answer : answers)
+        ttl = min(ttl, answer.ttl());
+    if (ttl == 0)
+        return;
+
+    auto entry = adopt_ref(*new Entry);
+    entry->m_name = name;
+    entry->m_record_type = record_type;
+    entry->m_answers = move(answers);
+    entry->m_stored_time = now();
+    entry->m_expiry_time = entry->m_stored_time + ttl;
+    dbgln_if(LOOKUPSERVER_DEBUG, "DNSCache: Storing {} answers for {} ({}) for {}s", entry->m_answers.size(), name, record_type, ttl);
+
+    // The name evidently exists now.
+    if (auto it = m_entries.find({ name, 0 }); it != m_entries.end())
+        remove(*it->value);
+    add(move(entry));
+}
+
+void DNSCache::store_negative_answer(Name const& name, RecordType record_type, NegativeAnswer negative_answer, u32 ttl)
+{
+    VERIFY(negative_answer != NegativeAnswer::None);
+    ttl = min(ttl, max_negative_ttl);
+    if (ttl == 0)
+        return;
+
+    auto entry = adopt_ref(*new Entry);
+    entry->m_name = name;
+    entry->m_record_type = record_type;
+    entry->m_negative_answer = negative_answer;
+    entry->m_stored_time = now();
+    entry->m_expiry_time = entry->m_stored_time + ttl;
+    dbgln_if(LOOKUPSERVER_DEBUG, "DNSCache: Storing {} for {} ({}) for {}s",
+        negative_answer == NegativeAnswer::NameDoesNotExist ? "NXDOMAIN"sv : "NODATA"sv, name, record_type, ttl);
+    add(move(entry));
+}
+
+void DNSCache::add(NonnullRefPtr<Entry> entry)
+{
+    auto key = key_for(*entry);
+    if (auto it = m_entries.find(key); it != m_entries.end())
+        remove(*it->value);
+
+    m_entries.set(key, entry);
+    m_lru_list.append(*entry);
+
+    while (m_entries.size() > max_entry_count) {
+        auto least_recently_used = m_lru_list.first();
+        VERIFY(least_recently_used);
+        dbgln_if(LOOKUPSERVER_DEBUG, "DNSCache: Evicting {} ({})", least_recently_used->m_name, least_recently_used->m_record_type);
+        m_statistics.evictions++;
+        remove(*least_recently_used);
+    }
+}
+
+void DNSCache::remove(Entry& entry)
+{
+    NonnullRefPtr<Entry> protector = entry;
+    m_lru_list.remove(entry);
+    m_entries.remove(key_for(entry));
+}
+
+bool DNSCache::should_prefetch(Entry const& entry) const
+{
+    if (entry.m_negative_answer != NegativeAnswer::None || entry.m_is_being_prefetched)
+        return false;
+    if (entry.m_hit_count < min_prefetch_hit_count)
+        return false;
+    auto lifetime = entry.m_expiry_time - entry.m_stored_time;
+    if (lifetime < min_prefetch_lifetime)
+        return false;
+    return entry.m_expiry_time - now() <= lifetime / prefetch_lifetime_divisor;
+}
+
+void DNSCache::did_start_prefetch(Entry& entry)
+{
+    entry.m_is_being_prefetched = true;
+    m_statistics.prefetches++;
+}
+
+void DNSCache::did_finish_prefetch(Name const& name, RecordType record_type)
+{
+    // If the prefetch worked, this is the new entry already. Otherwise, later lookups may try again.
+    if (auto it = m_entries.find({ name, static_cast<u16>(record_type) }); it != m_entries.end())
+        it->value->m_is_being_prefetched = false;
+}
+
+void DNSCache::remove_expired_entries()
+{
+    auto current_time = now();
+    Vector<NonnullRefPtr<Entry>> expired_entries;
+    for (auto& it : m_entries) {
+        if (it.value->m_expiry_time <= current_time)
+            expired_entries.append(it.value);
+    }
+    for (auto& entry : expired_entries)
+        remove(entry);
+    m_statistics.expirations += expired_entries.size();
+}
+
+void DNSCache::clear()
+{
+    m_lru_list.clear();
+    m_entries.clear();
+}
+
+DNSCache::Statistics DNSCache::statistics() const
+{
+    auto statistics = m_statistics;
+    statistics.entry_count = m_entries.size();
+    return statistics;
+}
+
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/RefCounted.h>
+#include <AK/Vector.h>
+#include <LibDNS/Answer.h>
+#include <LibDNS/Name.h>
+
+namespace LookupServer {
+
+using namespace DNS;
+
+// Remembers the answers to the questions we asked upstream, for as long as their TTL allows.
+// "There is no such name" and "there are no records of that type" are remembered too (RFC 2308),
+// so names that don't resolve don't send us to the nameservers on every lookup either.
+class DNSCache {
+public:
+    struct Statistics {
+        u64 hits { 0 };
+        // Hits that told the client that there is no answer.
+        u64 negative_hits { 0 };
+        u64 misses { 0 };
+        u64 prefetches { 0 };
+        u64 evictions { 0 };
+        u64 expirations { 0 };
+        size_t entry_count { 0 };
+    };
+
+    enum class NegativeAnswer {
+        None,
+        // NXDOMAIN, which covers all record types.
+        NameDoesNotExist,
+        // NOERROR without any records of the type we asked for.
+        NoRecords,
+    };
+
+    class Entry : public RefCounted<Entry> {
+    public:
+        Name const& name() const { return m_name; }
+        RecordType record_type() const { return m_record_type; }
+        NegativeAnswer negative_answer() const { return m_negative_answer; }
+
+        // The answers with their TTL counting down from the time they were stored.
+        Vector<Answer> answers(i64 now) const;
+
+    private:
+        friend class DNSCache;
+
+        Name m_name;
+        RecordType m_record_type { 0 };
+        NegativeAnswer m_negative_answer { NegativeAnswer::None };
+        Vector<Answer> m_answers;
+        i64 m_stored_time { 0 };
+        i64 m_expiry_time { 0 };
+        u32 m_hit_count { 0 };
+        bool m_is_being_prefetched { false };
+
+        IntrusiveListNode<Entry, RefPtr<Entry>> m_lru_list_node;
+
+    public:
+        using LRUList = IntrusiveList<&Entry::m_lru_list_node>;
+    };
+
+    // A monotonic clock in seconds, which is what all the times here are in.
+    static i64 now();
+
+    RefPtr<Entry> lookup(Name const&, RecordType);
+    void store(Name const&, RecordType, Vector<Answer>);
+    void store_negative_answer(Name const&, RecordType, NegativeAnswer, u32 ttl);
+
+    // Popular entries are looked up again shortly before they expire, so their users never have to wait for it.
+    bool should_prefetch(Entry const&) const;
+    void did_start_prefetch(Entry&);
+    void did_finish_prefetch(Name const&, RecordType);
+
+    void remove_expired_entries();
+    void clear();
+
+    Statistics statistics() const;
+
+private:
+    struct Key {
+        Name name;
+        // Zero for names that don't exist at all, see NegativeAnswer::NameDoesNotExist.
+        u16 record_type { 0 };
+
+        bool operator==(Key const&) const = default;
+    };
+
+    struct KeyTraits : public AK::Traits<Key> {
+        static unsigned hash(Key const& key) { return pair_int_hash(Name::Traits::hash(key.name), key.record_type); }
+        static bool equals(Key const& a, Key const& b) { return a.record_type == b.record_type && Name::Traits::equals(a.name, b.name); }
+    };
+
+    static Key key_for(Entry const&);
+    RefPtr<Entry> find_unexpired(Key const&, i64 now);
+    void add(NonnullRefPtr<Entry>);
+    void remove(Entry&);
+
+    HashMap<Key, NonnullRefPtr<Entry>, KeyTraits> m_entries;
+    Entry::LRUList m_lru_list;
+    Statistics m_statistics;
+};
+
+}
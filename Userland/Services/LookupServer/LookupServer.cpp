@@ -26,6 +26,9 @@ namespace LookupServer {
 static LookupServer* s_the;
 // NOTE: This is the TTL we return for the hostname or answers from /etc/hosts.
 static constexpr u32 s_static_ttl = 86400;
+static constexpr int s_cache_purge_interval_ms = 60 * 1000;
+static constexpr int s_upstream_timeout_ms = 1000;
+static constexpr int s_upstream_attempt_count = 3;
 
 LookupServer& LookupServer::the()
 {
@@ -74,6 +77,18 @@ LookupServer::LookupServer()
     m_mdns = MulticastDNS::construct(this);
 
     m_server = MUST(IPC::MultiServer<ConnectionFromClient>::try_create());
+
+    m_prefetch_timeout_timer = MUST(Core::Timer::create_single_shot(s_upstream_timeout_ms, [this] {
+        dbgln_if(LOOKUPSERVER_DEBUG, "Prefetch request timed out");
+        did_finish_prefetch_attempt({});
+    }));
+
+    start_timer(s_cache_purge_interval_ms);
+}
+
+void LookupServer::timer_event(Core::TimerEvent&)
+{
+    m_cache.remove_expired_entries();
 }
 
 void LookupServer::load_etc_hosts()
@@ -170,62 +185,184 @@ ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, RecordType record
     }
 
     // Third, try our cache.
-    if (auto cached_answers = m_lookup_cache.find(name); cached_answers != m_lookup_cache.end()) {
-        for (auto& answer : cached_answers->value) {
-            // TODO: Actually remove expired answers from the cache.
-            if (answer.type() == record_type && !answer.has_expired()) {
-                dbgln_if(LOOKUPSERVER_DEBUG, "Cache hit: {} -> {}", name.as_string(), answer.record_data());
-                add_answer(answer);
-            }
+    if (auto entry = m_cache.lookup(name, record_type)) {
+        if (entry->negative_answer() != DNSCache::NegativeAnswer::None) {
+            dbgln_if(LOOKUPSERVER_DEBUG, "Cache hit: {} has no answers", name.as_string());
+            return Vector<Answer> {};
         }
-        if (!answers.is_empty())
-            return answers;
+        for (auto& answer : entry->answers(DNSCache::now())) {
+            dbgln_if(LOOKUPSERVER_DEBUG, "Cache hit: {} -> {}", name.as_string(), answer.record_data());
+            add_answer(answer);
+        }
+        if (m_cache.should_prefetch(*entry))
+            schedule_prefetch(*entry);
+        return answers;
     }
 
     // Fourth, look up .local names using mDNS instead of DNS nameservers.
     if (name.as_string().ends_with(".local"sv)) {
         answers = TRY(m_mdns->lookup(name, record_type));
-        for (auto& answer : answers)
-            put_in_cache(answer);
+        m_cache.store(name, record_type, answers);
         return answers;
     }
 
     // Fifth, ask the upstream nameservers.
+    for (auto& answer : lookup_upstream(name, record_type))
+        add_answer(answer);
+    return answers;
+}
+
+Vector<Answer> LookupServer::lookup_upstream(Name const& name, RecordType record_type)
+{
     for (auto& nameserver : m_nameservers) {
         dbgln_if(LOOKUPSERVER_DEBUG, "Doing lookup using nameserver '{}'", nameserver);
-        bool did_get_response = false;
-        int retries = 3;
+        UpstreamResponse upstream_response;
+        int retries = s_upstream_attempt_count;
         Vector<Answer> upstream_answers;
         do {
-            auto upstream_answers_or_error = lookup(name, nameserver, did_get_response, record_type);
+            auto upstream_answers_or_error = lookup(name, nameserver, upstream_response, record_type);
             if (upstream_answers_or_error.is_error())
                 continue;
             upstream_answers = upstream_answers_or_error.release_value();
-            if (did_get_response)
+            if (upstream_response.did_get_response)
                 break;
         } while (--retries);
-        if (!upstream_answers.is_empty()) {
-            for (auto& answer : upstream_answers)
-                add_answer(answer);
-            break;
-        } else {
-            if (!did_get_response)
-                dbgln("Never got a response from '{}', trying next nameserver", nameserver);
-            else
-                dbgln("Received response from '{}' but no result(s), trying next nameserver", nameserver);
-        }
+
+        if (store_upstream_answers(name, record_type, upstream_answers, upstream_response, nameserver))
+            return upstream_answers;
     }
 
-    // Sixth, fail.
-    if (answers.is_empty()) {
+    dbgln("Tried all nameservers but never got a response :(");
+    return {};
+}
+
+// Returns whether we're done with the lookup, or whether the next nameserver should be asked.
+bool LookupServer::store_upstream_answers(Name const& name, RecordType record_type, Vector<Answer> const& upstream_answers, UpstreamResponse const& upstream_response, DeprecatedString const& nameserver)
+{
+    if (!upstream_answers.is_empty()) {
+        m_cache.store(name, record_type, upstream_answers);
+        return true;
+    }
+    if (upstream_response.negative_answer != DNSCache::NegativeAnswer::None) {
+        // The nameserver knows for sure, so asking the next one wouldn't tell us anything else.
+        m_cache.store_negative_answer(name, record_type, upstream_response.negative_answer, upstream_response.negative_ttl);
+        return true;
+    }
+    if (!upstream_response.did_get_response)
+        dbgln("Never got a response from '{}', trying next nameserver", nameserver);
+    else
+        dbgln("Received response from '{}' but no result(s), trying next nameserver", nameserver);
+    return false;
+}
+
+void LookupServer::schedule_prefetch(DNSCache::Entry& entry)
+{
+    m_cache.did_start_prefetch(entry);
+    m_prefetch_queue.append(entry);
+
+    // Refresh the entry after we've answered the current request, so this client doesn't have to wait for it.
+    if (m_prefetch_queue.size() == 1)
+        deferred_invoke([this] { prefetch_next(); });
+}
+
+void LookupServer::prefetch_next()
+{
+    // One at a time, the next one is started once this one is finished.
+    if (m_prefetch || m_prefetch_queue.is_empty())
+        return;
+
+    m_prefetch = make<Prefetch>(m_prefetch_queue.take_first());
+    m_prefetch->attempts_left = s_upstream_attempt_count;
+    dbgln_if(LOOKUPSERVER_DEBUG, "Prefetching '{}'", m_prefetch->entry->name().as_string());
+    send_prefetch_request();
+}
+
+void LookupServer::send_prefetch_request(ShouldRandomizeCase should_randomize_case)
+{
+    auto& prefetch = *m_prefetch;
+    if (prefetch.nameserver_index >= m_nameservers.size()) {
         dbgln("Tried all nameservers but never got a response :(");
-        return Vector<Answer> {};
+        finish_prefetch();
+        return;
     }
 
-    return answers;
+    auto& nameserver = m_nameservers[prefetch.nameserver_index];
+    dbgln_if(LOOKUPSERVER_DEBUG, "Doing prefetch using nameserver '{}'", nameserver);
+    prefetch.should_randomize_case = should_randomize_case;
+    prefetch.request = make_upstream_request(prefetch.entry->name(), prefetch.entry->record_type(), should_randomize_case);
+
+    auto result = [&]() -> ErrorOr<void> {
+        auto buffer = TRY(prefetch.request.to_byte_buffer());
+        prefetch.socket = TRY(Core::Stream::UDPSocket::connect(nameserver, 53));
+        TRY(prefetch.socket->set_blocking(false));
+        TRY(prefetch.socket->write(buffer));
+        return {};
+    }();
+    if (result.is_error()) {
+        dbgln("Failed to send prefetch request to '{}': {}", nameserver, result.error());
+        did_finish_prefetch_attempt({});
+        return;
+    }
+
+    prefetch.socket->on_ready_to_read = [this] { receive_prefetch_response(); };
+    m_prefetch_timeout_timer->restart();
+}
+
+void LookupServer::receive_prefetch_response()
+{
+    auto& prefetch = *m_prefetch;
+    u8 response_buffer[4096];
+    auto response_or_error = prefetch.socket->read({ response_buffer, sizeof(response_buffer) });
+    if (response_or_error.is_error() && response_or_error.error().is_errno() && response_or_error.error().code() == EAGAIN)
+        return;
+
+    m_prefetch_timeout_timer->stop();
+    prefetch.socket->set_notifications_enabled(false);
+
+    Optional<Vector<Answer>> answers = Vector<Answer> {};
+    if (!response_or_error.is_error() && !response_or_error.value().is_empty()) {
+        prefetch.upstream_response.did_get_response = true;
+        answers = parse_upstream_response(prefetch.request, response_or_error.value(), prefetch.entry->record_type(), prefetch.upstream_response, prefetch.should_randomize_case);
+    }
+
+    // NOTE: The next attempt replaces the socket, which can't happen while the socket is notifying us.
+    deferred_invoke([this, answers = move(answers)]() mutable {
+        if (!answers.has_value()) {
+            // Retry with 0x20 case randomization turned off.
+            send_prefetch_request(ShouldRandomizeCase::No);
+            return;
+        }
+        did_finish_prefetch_attempt(answers.release_value());
+    });
 }
 
-ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, DeprecatedString const& nameserver, bool& did_get_response, RecordType record_type, ShouldRandomizeCase should_randomize_case)
+void LookupServer::did_finish_prefetch_attempt(Vector<Answer> answers)
+{
+    auto& prefetch = *m_prefetch;
+    if (prefetch.upstream_response.did_get_response || --prefetch.attempts_left == 0) {
+        if (store_upstream_answers(prefetch.entry->name(), prefetch.entry->record_type(), answers, prefetch.upstream_response, m_nameservers[prefetch.nameserver_index])) {
+            finish_prefetch();
+            return;
+        }
+        ++prefetch.nameserver_index;
+        prefetch.attempts_left = s_upstream_attempt_count;
+        prefetch.upstream_response = {};
+    }
+    send_prefetch_request();
+}
+
+void LookupServer::finish_prefetch()
+{
+    m_prefetch_timeout_timer->stop();
+    auto prefetch = m_prefetch.release_nonnull();
+    m_cache.did_finish_prefetch(prefetch->entry->name(), prefetch->entry->record_type());
+
+    // Requests from clients get their turn before the next prefetch starts.
+    if (!m_prefetch_queue.is_empty())
+        deferred_invoke([this] { prefetch_next(); });
+}
+
+Packet LookupServer::make_upstream_request(Name const& name, RecordType record_type, ShouldRandomizeCase should_randomize_case)
 {
     Packet request;
     request.set_is_query();
@@ -234,22 +371,38 @@ ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, DeprecatedString
     if (should_randomize_case == ShouldRandomizeCase::Yes)
         name_in_question.randomize_case();
     request.add_question({ name_in_question, record_type, RecordClass::IN, false });
+    return request;
+}
 
+ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, DeprecatedString const& nameserver, UpstreamResponse& upstream_response, RecordType record_type, ShouldRandomizeCase should_randomize_case)
+{
+    auto request = make_upstream_request(name, record_type, should_randomize_case);
     auto buffer = TRY(request.to_byte_buffer());
 
-    auto udp_socket = TRY(Core::Stream::UDPSocket::connect(nameserver, 53, Time::from_seconds(1)));
+    auto udp_socket = TRY(Core::Stream::UDPSocket::connect(nameserver, 53, Time::from_milliseconds(s_upstream_timeout_ms)));
     TRY(udp_socket->set_blocking(true));
 
     TRY(udp_socket->write(buffer));
 
     u8 response_buffer[4096];
-    int nrecv = TRY(udp_socket->read({ response_buffer, sizeof(response_buffer) })).size();
+    auto response = TRY(udp_socket->read({ response_buffer, sizeof(response_buffer) }));
     if (udp_socket->is_eof())
         return Vector<Answer> {};
 
-    did_get_response = true;
+    upstream_response.did_get_response = true;
+
+    auto answers = parse_upstream_response(request, response, record_type, upstream_response, should_randomize_case);
+    if (!answers.has_value()) {
+        // Retry with 0x20 case randomization turned off.
+        return lookup(name, nameserver, upstream_response, record_type, ShouldRandomizeCase::No);
+    }
+    return answers.release_value();
+}
 
-    auto o_response = Packet::from_raw_packet(response_buffer, nrecv);
+// Returns nothing if the nameserver refused a request with a randomized case, so it should be asked again without it.
+Optional<Vector<Answer>> LookupServer::parse_upstream_response(Packet const& request, ReadonlyBytes raw_response, RecordType record_type, UpstreamResponse& upstream_response, ShouldRandomizeCase should_randomize_case)
+{
+    auto o_response = Packet::from_raw_packet(raw_response.data(), raw_response.size());
     if (!o_response.has_value())
         return Vector<Answer> {};
 
@@ -261,10 +414,8 @@ ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, DeprecatedString
     }
 
     if (response.code() == Packet::Code::REFUSED) {
-        if (should_randomize_case == ShouldRandomizeCase::Yes) {
-            // Retry with 0x20 case randomization turned off.
-            return lookup(name, nameserver, did_get_response, record_type, ShouldRandomizeCase::No);
-        }
+        if (should_randomize_case == ShouldRandomizeCase::Yes)
+            return {};
         return Vector<Answer> {};
     }
 
@@ -288,52 +439,24 @@ ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, DeprecatedString
         }
     }
 
-    if (response.answer_count() < 1) {
-        dbgln("LookupServer: No answers :(");
-        return Vector<Answer> {};
-    }
-
-    Vector<Answer, 8> answers;
+    Vector<Answer> answers;
     for (auto& answer : response.answers()) {
-        put_in_cache(answer);
-        if (answer.type() != record_type)
-            continue;
-        answers.append(answer);
+        if (answer.type() == record_type)
+            answers.append(answer);
     }
 
-    return answers;
-}
-
-void LookupServer::put_in_cache(Answer const& answer)
-{
-    if (answer.has_expired())
-        return;
-
-    // Prevent the cache from growing too big.
-    // TODO: Evict least used entries.
-    if (m_lookup_cache.size() >= 256)
-        m_lookup_cache.remove(m_lookup_cache.begin());
-
-    auto it = m_lookup_cache.find(answer.name());
-    if (it == m_lookup_cache.end())
-        m_lookup_cache.set(answer.name(), { answer });
-    else {
-        if (answer.mdns_cache_flush()) {
-            auto now = time(nullptr);
-
-            it->value.remove_all_matching([&](Answer const& other_answer) {
-                if (other_answer.type() != answer.type() || other_answer.class_code() != answer.class_code())
-                    return false;
-
-                if (other_answer.received_time() >= now - 1)
-                    return false;
-
-                dbgln_if(LOOKUPSERVER_DEBUG, "Removing cache entry: {}", other_answer.name());
-                return true;
-            });
+    if (answers.is_empty()) {
+        dbgln("LookupServer: No answers :(");
+        // Without an SOA record, we don't know how long the absence of an answer may be remembered (RFC 2308, section 5).
+        if (auto negative_ttl = response.negative_caching_ttl(); negative_ttl.has_value()) {
+            upstream_response.negative_answer = response.code() == Packet::Code::NXDOMAIN
+                ? DNSCache::NegativeAnswer::NameDoesNotExist
+                : DNSCache::NegativeAnswer::NoRecords;
+            upstream_response.negative_ttl = negative_ttl.value();
         }
-        it->value.append(answer);
     }
+
+    return answers;
 }
 
 }
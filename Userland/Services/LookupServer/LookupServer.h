@@ -7,10 +7,13 @@
 #pragma once
 
 #include "ConnectionFromClient.h"
+#include "DNSCache.h"
 #include "DNSServer.h"
 #include "MulticastDNS.h"
 #include <LibCore/FileWatcher.h>
 #include <LibCore/Object.h>
+#include <LibCore/Stream.h>
+#include <LibCore/Timer.h>
 #include <LibDNS/Name.h>
 #include <LibDNS/Packet.h>
 #include <LibIPC/MultiServer.h>
@@ -26,13 +29,51 @@ public:
     static LookupServer& the();
     ErrorOr<Vector<Answer>> lookup(Name const& name, RecordType record_type);
 
+    DNSCache::Statistics cache_statistics() const { return m_cache.statistics(); }
+    void clear_cache() { m_cache.clear(); }
+
 private:
     LookupServer();
 
+    virtual void timer_event(Core::TimerEvent&) override;
+
+    struct UpstreamResponse {
+        bool did_get_response { false };
+        // Set if the nameserver told us that there is no answer, and how long we may remember that.
+        DNSCache::NegativeAnswer negative_answer { DNSCache::NegativeAnswer::None };
+        u32 negative_ttl { 0 };
+    };
+
+    // Prefetches ask the nameservers in the same way as lookup_upstream(), but without blocking the event loop.
+    struct Prefetch {
+        explicit Prefetch(NonnullRefPtr<DNSCache::Entry> entry)
+            : entry(move(entry))
+        {
+        }
+
+        NonnullRefPtr<DNSCache::Entry> entry;
+        size_t nameserver_index { 0 };
+        int attempts_left { 0 };
+        ShouldRandomizeCase should_randomize_case { ShouldRandomizeCase::Yes };
+        Packet request;
+        UpstreamResponse upstream_response;
+        OwnPtr<Core::Stream::UDPSocket> socket;
+    };
+
     void load_etc_hosts();
-    void put_in_cache(Answer const&);
+    void schedule_prefetch(DNSCache::Entry&);
+    void prefetch_next();
+    void send_prefetch_request(ShouldRandomizeCase = ShouldRandomizeCase::Yes);
+    void receive_prefetch_response();
+    void did_finish_prefetch_attempt(Vector<Answer>);
+    void finish_prefetch();
+
+    Vector<Answer> lookup_upstream(Name const&, RecordType);
+    ErrorOr<Vector<Answer>> lookup(Name const& hostname, DeprecatedString const& nameserver, UpstreamResponse&, RecordType record_type, ShouldRandomizeCase = ShouldRandomizeCase::Yes);
+    bool store_upstream_answers(Name const&, RecordType, Vector<Answer> const&, UpstreamResponse const&, DeprecatedString const& nameserver);
 
-    ErrorOr<Vector<Answer>> lookup(Name const& hostname, DeprecatedString const& nameserver, bool& did_get_response, RecordType record_type, ShouldRandomizeCase = ShouldRandomizeCase::Yes);
+    static Packet make_upstream_request(Name const&, RecordType, ShouldRandomizeCase);
+    static Optional<Vector<Answer>> parse_upstream_response(Packet const& request, ReadonlyBytes, RecordType, UpstreamResponse&, ShouldRandomizeCase);
 
     OwnPtr<IPC::MultiServer<ConnectionFromClient>> m_server;
     RefPtr<DNSServer> m_dns_server;
@@ -40,7 +81,10 @@ private:
     Vector<DeprecatedString> m_nameservers;
     RefPtr<Core::FileWatcher> m_file_watcher;
     HashMap<Name, Vector<Answer>, Name::Traits> m_etc_hosts;
-    HashMap<Name, Vector<Answer>, Name::Traits> m_lookup_cache;
+    DNSCache m_cache;
+    Vector<NonnullRefPtr<DNSCache::Entry>> m_prefetch_queue;
+    OwnPtr<Prefetch> m_prefetch;
+    RefPtr<Core::Timer> m_prefetch_timeout_timer;
 };
 
 }
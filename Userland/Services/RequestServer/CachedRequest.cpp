@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <RequestServer/CachedRequest.h>
+
+namespace RequestServer {
+
+CachedRequest::CachedRequest(ConnectionFromClient& client, URL url, NonnullOwnPtr<Core::Stream::File>&& output_stream)
+    : Request(client, move(output_stream))
+    , m_url(move(url))
+{
+}
+
+NonnullOwnPtr<CachedRequest> CachedRequest::create(ConnectionFromClient& client, URL url, NonnullOwnPtr<Core::Stream::File>&& output_stream)
+{
+    return adopt_own(*new CachedRequest(client, move(url), move(output_stream)));
+}
+
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtr.h>
+#include <LibCore/Forward.h>
+#include <RequestServer/Request.h>
+
+namespace RequestServer {
+
+// A request that is answered from the HTTP cache without going to the network at all.
+class CachedRequest final : public Request {
+public:
+    virtual ~CachedRequest() override = default;
+    static NonnullOwnPtr<CachedRequest> create(ConnectionFromClient&, URL, NonnullOwnPtr<Core::Stream::File>&&);
+
+    virtual URL url() const override { return m_url; }
+
+private:
+    explicit CachedRequest(ConnectionFromClient&, URL, NonnullOwnPtr<Core::Stream::File>&&);
+
+    URL m_url;
+};
+
+}
@@ -37,15 +37,23 @@ void request_did_finish(URL const& url, Core::Stream::Socket const* socket)
         }
 
         auto& connection = *connection_it;
-        if (connection->request_queue.is_empty()) {
+        auto schedule_removal = [&] {
             Core::deferred_invoke([&connection, &cache_entry = *it->value, key = it->key, &cache] {
-                connection->socket->set_notifications_enabled(false);
+                if (auto& http2_connection = connection->http2_connection) {
+                    // Another job may have come along for it in the meantime.
+                    if (http2_connection->active_stream_count() > 0 || !connection->request_queue.is_empty())
+                        return;
+                } else {
+                    connection->socket->set_notifications_enabled(false);
+                }
                 connection->has_started = false;
                 connection->current_url = {};
                 connection->job_data = {};
                 connection->removal_timer->on_timeout = [ptr = connection.ptr(), &cache_entry, key = move(key), &cache]() mutable {
                     Core::deferred_invoke([&, key = move(key), ptr] {
                         dbgln_if(REQUESTSERVER_DEBUG, "Removing no-longer-used connection {} (socket {})", ptr, ptr->socket);
+                        if (ptr->http2_connection)
+                            ptr->http2_connection->close();
                         auto did_remove = cache_entry.remove_first_matching([&](auto& entry) { return entry == ptr; });
                         VERIFY(did_remove);
                         if (cache_entry.is_empty())
@@ -54,6 +62,29 @@ void request_did_finish(URL const& url, Core::Stream::Socket const* socket)
                 };
                 connection->removal_timer->start();
             });
+        };
+
+        if (connection->http2_connection && !connection->http2_connection->is_open()) {
+            // The server is done with the connection, but may still be finishing some of the streams on it.
+            if (connection->http2_connection->active_stream_count() > 0)
+                return;
+            dbgln_if(REQUESTSERVER_DEBUG, "HTTP/2 connection {} for {} is gone, falling back to a new connection", &connection, url);
+            connection->http2_connection->close();
+            connection->http2_connection = nullptr;
+            connection->socket->close();
+        }
+
+        if (connection->http2_connection) {
+            auto& http2_connection = *connection->http2_connection;
+            while (!connection->request_queue.is_empty() && http2_connection.can_open_stream())
+                start_http2_job(*connection, url, connection->request_queue.take_first());
+            if (connection->request_queue.is_empty() && http2_connection.active_stream_count() == 0)
+                schedule_removal();
+            return;
+        }
+
+        if (connection->request_queue.is_empty()) {
+            schedule_removal();
         } else {
             if (auto result = recreate_socket_if_needed(*connection, url); result.is_error()) {
                 dbgln("ConnectionCache request finish handler, reconnection failed with {}", result.error());
@@ -61,6 +92,12 @@ void request_did_finish(URL const& url, Core::Stream::Socket const* socket)
                 return;
             }
             Core::deferred_invoke([&, url] {
+                // The new socket may well speak HTTP/2, which all of the waiting jobs can share.
+                if (connection->http2_connection) {
+                    while (!connection->request_queue.is_empty() && connection->http2_connection->can_open_stream())
+                        start_http2_job(*connection, url, connection->request_queue.take_first());
+                    return;
+                }
                 dbgln_if(REQUESTSERVER_DEBUG, "Running next job in queue for connection {} @{}", &connection, connection->socket);
                 connection->timer.start();
                 connection->current_url = url;
@@ -86,6 +123,8 @@ void dump_jobs()
         dbgln(" - {}:{}", connection.key.hostname, connection.key.port);
         for (auto& entry : *connection.value) {
             dbgln("  - Connection {} (started={}) (socket={})", &entry, entry.has_started, entry.socket);
+            if (entry.http2_connection)
+                dbgln("    HTTP/2 ({}) with {} streams", entry.http2_connection->is_open() ? "open"sv : "going away"sv, entry.http2_connection->active_stream_count());
             dbgln("    Currently loading {} ({} elapsed)", entry.current_url, entry.timer.is_valid() ? entry.timer.elapsed() : 0);
             dbgln("    Request Queue:");
             for (auto& job : entry.request_queue)
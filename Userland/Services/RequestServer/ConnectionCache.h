@@ -17,6 +17,7 @@
 #include <LibCore/NetworkJob.h>
 #include <LibCore/SOCKSProxyClient.h>
 #include <LibCore/Timer.h>
+#include <LibHTTP/Http2Connection.h>
 #include <LibTLS/TLSv12.h>
 
 namespace RequestServer {
@@ -58,6 +59,8 @@ template<typename Socket, typename SocketStorageType = Socket>
 struct Connection {
     struct JobData {
         Function<void(Core::Stream::Socket&)> start {};
+        // Only set for jobs that know how to send their request as an HTTP/2 stream.
+        Function<void(HTTP::Http2Connection&)> start_http2 {};
         Function<void(Core::NetworkJob::Error)> fail {};
         Function<Vector<TLS::Certificate>()> provide_client_certificates {};
 
@@ -66,7 +69,7 @@ struct Connection {
         {
             // Clang-format _really_ messes up formatting this, so just format it manually.
             // clang-format off
-            return JobData {
+            auto job_data = JobData {
                 .start = [&job](auto& socket) {
                     job.start(socket);
                 },
@@ -85,6 +88,12 @@ struct Connection {
                 },
             };
             // clang-format on
+            if constexpr (requires(HTTP::Http2Connection& connection) { job.start(connection); }) {
+                job_data.start_http2 = [&job](auto& connection) {
+                    job.start(connection);
+                };
+            }
+            return job_data;
         }
     };
     using QueueType = Vector<JobData>;
@@ -99,6 +108,8 @@ struct Connection {
     Core::ElapsedTimer timer {};
     JobData job_data {};
     Proxy proxy {};
+    // Set if the server agreed to speak HTTP/2, in which case all requests share the socket at the same time.
+    RefPtr<HTTP::Http2Connection> http2_connection {};
 };
 
 struct ConnectionKey {
@@ -130,6 +141,71 @@ void dump_jobs();
 constexpr static size_t MaxConcurrentConnectionsPerURL = 4;
 constexpr static size_t ConnectionKeepAliveTimeMilliseconds = 10'000;
 
+// HTTPS servers are asked whether they speak HTTP/2, which lets all of our requests to them share a single connection.
+inline TLS::Options tls_options_for(URL const& url)
+{
+    TLS::Options options;
+    if (url.scheme() == "https"sv)
+        options.set_alpn_protocols({ "h2", "http/1.1" });
+    return options;
+}
+
+template<typename T>
+ErrorOr<void> start_http2_if_negotiated(T& connection, URL const& url, TLS::TLSv12& tls_socket)
+{
+    if (tls_socket.alpn() != "h2"sv)
+        return {};
+
+    auto http2_connection = TRY(HTTP::Http2Connection::try_create(*connection.socket));
+    auto notify_cache = [&url, socket = connection.socket.ptr()] {
+        return [url, socket] {
+            Core::deferred_invoke([url, socket] {
+                request_did_finish(url, socket);
+            });
+        };
+    };
+    http2_connection->on_stream_closed = notify_cache();
+    http2_connection->on_close = notify_cache();
+
+    // The TLS socket doesn't become readable when the server closes it, so this is the only way to find out.
+    auto weak_connection = http2_connection->template make_weak_ptr<HTTP::Http2Connection>();
+    tls_socket.on_tls_finished = [weak_connection] {
+        if (weak_connection)
+            weak_connection->socket_was_closed();
+    };
+    tls_socket.on_tls_error = [weak_connection](auto) {
+        if (weak_connection)
+            weak_connection->socket_was_closed();
+    };
+
+    TRY(http2_connection->start());
+    dbgln_if(REQUESTSERVER_DEBUG, "Speaking HTTP/2 to {} over {}", url.host(), connection.socket);
+    connection.http2_connection = move(http2_connection);
+    return {};
+}
+
+// Starts the job as soon as the server lets us open another stream for it.
+template<typename T>
+void start_http2_job(T& connection, URL const& url, typename T::JobData job_data)
+{
+    auto& http2_connection = *connection.http2_connection;
+    connection.removal_timer->stop();
+    if (!http2_connection.can_open_stream()) {
+        dbgln_if(REQUESTSERVER_DEBUG, "Enqueue request for URL {} on HTTP/2 connection {}", url, &connection);
+        connection.request_queue.append(move(job_data));
+        return;
+    }
+
+    dbgln_if(REQUESTSERVER_DEBUG, "Start request for URL {} on HTTP/2 connection {} with {} other streams", url, &connection, http2_connection.active_stream_count());
+    connection.has_started = true;
+    connection.timer.start();
+    connection.current_url = url;
+    if (job_data.start_http2)
+        job_data.start_http2(http2_connection);
+    else
+        job_data.start(*connection.socket);
+}
+
 template<typename T>
 ErrorOr<void> recreate_socket_if_needed(T& connection, URL const& url)
 {
@@ -144,7 +220,7 @@ ErrorOr<void> recreate_socket_if_needed(T& connection, URL const& url)
         };
 
         if constexpr (IsSame<TLS::TLSv12, SocketType>) {
-            TLS::Options options;
+            auto options = tls_options_for(url);
             options.set_alert_handler([&connection](TLS::AlertDescription alert) {
                 Core::NetworkJob::Error reason;
                 if (alert == TLS::AlertDescription::HandshakeFailure)
@@ -162,7 +238,10 @@ ErrorOr<void> recreate_socket_if_needed(T& connection, URL const& url)
                     return connection.job_data.provide_client_certificates();
                 return {};
             });
-            TRY(set_socket(TRY((connection.proxy.template tunnel<SocketType, SocketStorageType>(url, move(options))))));
+            auto socket = TRY((connection.proxy.template tunnel<SocketType, SocketStorageType>(url, move(options))));
+            auto& tls_socket = *socket;
+            TRY(set_socket(move(socket)));
+            TRY(start_http2_if_negotiated(connection, url, tls_socket));
         } else {
             TRY(set_socket(TRY((connection.proxy.template tunnel<SocketType, SocketStorageType>(url)))));
         }
@@ -179,12 +258,29 @@ decltype(auto) get_or_create_connection(auto& cache, URL const& url, auto& job,
     Proxy proxy { proxy_data };
 
     using ReturnType = decltype(&sockets_for_url[0]);
-    auto it = sockets_for_url.find_if([](auto& connection) { return connection->request_queue.is_empty(); });
+    using ConnectionType = RemoveCVReference<decltype(cache.begin()->value->at(0))>;
+    constexpr bool is_tls = IsSame<TLS::TLSv12, typename ConnectionType::SocketType>;
+
+    if constexpr (is_tls && requires(HTTP::Http2Connection& connection) { job.start(connection); }) {
+        auto it = sockets_for_url.find_if([](auto& connection) { return connection->http2_connection && connection->http2_connection->is_open(); });
+        if (!it.is_end()) {
+            auto& connection = sockets_for_url[it.index()];
+            start_http2_job(connection, url, ConnectionType::JobData::create(job));
+            return &connection;
+        }
+    }
+
+    // Connections that speak HTTP/2 (or did until the server went away) aren't good for anything else.
+    auto it = sockets_for_url.find_if([](auto& connection) { return !connection->http2_connection && connection->request_queue.is_empty(); });
     auto did_add_new_connection = false;
     auto failed_to_find_a_socket = it.is_end();
     if (failed_to_find_a_socket && sockets_for_url.size() < ConnectionCache::MaxConcurrentConnectionsPerURL) {
-        using ConnectionType = RemoveCVReference<decltype(cache.begin()->value->at(0))>;
-        auto connection_result = proxy.tunnel<typename ConnectionType::SocketType, typename ConnectionType::StorageType>(url);
+        auto connection_result = [&] {
+            if constexpr (is_tls)
+                return proxy.tunnel<typename ConnectionType::SocketType, typename ConnectionType::StorageType>(url, tls_options_for(url));
+            else
+                return proxy.tunnel<typename ConnectionType::SocketType, typename ConnectionType::StorageType>(url);
+        }();
         if (connection_result.is_error()) {
             dbgln("ConnectionCache: Connection to {} failed: {}", url, connection_result.error());
             Core::deferred_invoke([&job] {
@@ -192,6 +288,7 @@ decltype(auto) get_or_create_connection(auto& cache, URL const& url, auto& job,
             });
             return ReturnType { nullptr };
         }
+        auto& raw_socket = *connection_result.value();
         auto socket_result = Core::Stream::BufferedSocket<typename ConnectionType::StorageType>::create(connection_result.release_value());
         if (socket_result.is_error()) {
             dbgln("ConnectionCache: Failed to make a buffered socket for {}: {}", url, socket_result.error());
@@ -206,6 +303,19 @@ decltype(auto) get_or_create_connection(auto& cache, URL const& url, auto& job,
             Core::Timer::create_single_shot(ConnectionKeepAliveTimeMilliseconds, nullptr).release_value_but_fixme_should_propagate_errors()));
         sockets_for_url.last().proxy = move(proxy);
         did_add_new_connection = true;
+
+        if constexpr (is_tls) {
+            if (auto result = start_http2_if_negotiated(sockets_for_url.last(), url, raw_socket); result.is_error()) {
+                dbgln("ConnectionCache: Failed to start HTTP/2 connection to {}: {}", url, result.error());
+                (void)sockets_for_url.take_last();
+                Core::deferred_invoke([&job] {
+                    job.fail(Core::NetworkJob::Error::ConnectionFailed);
+                });
+                return ReturnType { nullptr };
+            }
+        } else {
+            (void)raw_socket;
+        }
     }
     size_t index;
     if (failed_to_find_a_socket) {
@@ -241,6 +351,10 @@ decltype(auto) get_or_create_connection(auto& cache, URL const& url, auto& job,
             });
             return ReturnType { nullptr };
         }
+        if (connection.http2_connection) {
+            start_http2_job(connection, url, decltype(connection.job_data)::create(job));
+            return &connection;
+        }
         dbgln_if(REQUESTSERVER_DEBUG, "Immediately start request for url {} in {} - {}", url, &connection, connection.socket);
         connection.has_started = true;
         connection.removal_timer->stop();
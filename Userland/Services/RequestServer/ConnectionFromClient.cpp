@@ -8,6 +8,7 @@
 #include <AK/NonnullOwnPtr.h>
 #include <LibCore/Proxy.h>
 #include <RequestServer/ConnectionFromClient.h>
+#include <RequestServer/HttpCache.h>
 #include <RequestServer/Protocol.h>
 #include <RequestServer/Request.h>
 #include <RequestServer/RequestClientEndpoint.h>
@@ -172,4 +173,15 @@ void ConnectionFromClient::ensure_connection(URL const& url, ::RequestServer::Ca
         dbgln("EnsureConnection: Invalid URL scheme: '{}'", url.scheme());
 }
 
+Messages::RequestServer::GetHttpCacheStatisticsResponse ConnectionFromClient::get_http_cache_statistics()
+{
+    auto const& statistics = HttpCache::the().statistics();
+    return { statistics.hits, statistics.validations, statistics.validated_hits, statistics.misses, statistics.memory_size, statistics.disk_size, static_cast<u32>(statistics.entry_count) };
+}
+
+void ConnectionFromClient::clear_http_cache()
+{
+    HttpCache::the().clear();
+}
+
 }
@@ -36,6 +36,8 @@ private:
     virtual Messages::RequestServer::StopRequestResponse stop_request(i32) override;
     virtual Messages::RequestServer::SetCertificateResponse set_certificate(i32, DeprecatedString const&, DeprecatedString const&) override;
     virtual void ensure_connection(URL const& url, ::RequestServer::CacheLevel const& cache_level) override;
+    virtual Messages::RequestServer::GetHttpCacheStatisticsResponse get_http_cache_statistics() override;
+    virtual void clear_http_cache() override;
 
     HashMap<i32, OwnPtr<Request>> m_requests;
 };
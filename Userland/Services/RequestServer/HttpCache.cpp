@@ -0,0 +1,550 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/AllOf.h>
+#include <AK/Debug.h>
+#include <AK/NumberFormat.h>
+#include <AK/StringBuilder.h>
+#include <LibCore/DateTime.h>
+#include <LibCore/DirIterator.h>
+#include <LibCore/Stream.h>
+#include <LibCore/System.h>
+#include <RequestServer/HttpCache.h>
+#include <unistd.h>
+
+namespace RequestServer {
+
+static constexpr u64 memory_cache_size_limit = 16 * MiB;
+static constexpr u64 disk_cache_size_limit = 64 * MiB;
+
+// Anything bigger is most likely a download, which isn't going to be requested again anyway.
+static constexpr size_t max_cacheable_body_size = 4 * MiB;
+
+// How long a response without any explicit freshness information may be considered fresh for, at most.
+static constexpr i64 max_heuristic_freshness_lifetime = 24 * 60 * 60;
+
+static Optional<DeprecatedString> find_request_header(HashMap<DeprecatedString, DeprecatedString> const& request_headers, StringView name)
+{
+    for (auto& it : request_headers) {
+        if (it.key.equals_ignoring_case(name))
+            return it.value;
+    }
+    return {};
+}
+
+// Returns the argument of the given Cache-Control directive, which is empty if it doesn't take one.
+static Optional<StringView> find_cache_directive(StringView cache_control, StringView name)
+{
+    for (auto directive : cache_control.split_view(',')) {
+        directive = directive.trim_whitespace();
+        auto equals_sign = directive.find('=');
+        if (!directive.substring_view(0, equals_sign.value_or(directive.length())).trim_whitespace().equals_ignoring_case(name))
+            continue;
+        if (!equals_sign.has_value())
+            return ""sv;
+        return directive.substring_view(equals_sign.value() + 1).trim_whitespace().trim("\""sv);
+    }
+    return {};
+}
+
+static Optional<i64> parse_delta_seconds(StringView value)
+{
+    auto seconds = value.to_uint<u64>();
+    if (!seconds.has_value())
+        return {};
+    return static_cast<i64>(min(seconds.value(), static_cast<u64>(NumericLimits<i32>::max())));
+}
+
+// Only understands the preferred format, e.g. "Sun, 06 Nov 1994 08:49:37 GMT", as that is what servers are required to send.
+static Optional<time_t> parse_http_date(StringView value)
+{
+    if (!value.ends_with(" GMT"sv))
+        return {};
+    auto date = Core::DateTime::parse("%a, %d %b %Y %H:%M:%S %z"sv, DeprecatedString::formatted("{} +0000", value.substring_view(0, value.length() - 4)));
+    if (!date.has_value())
+        return {};
+    return date->timestamp();
+}
+
+static bool is_cacheable_status_code(u32 status_code)
+{
+    switch (status_code) {
+    case 200:
+    case 203:
+    case 204:
+    case 300:
+    case 301:
+    case 308:
+    case 404:
+    case 410:
+        return true;
+    default:
+        return false;
+    }
+}
+
+ErrorOr<size_t> HttpCache::ResponseRecorder::write(ReadonlyBytes bytes)
+{
+    auto written = TRY(m_output_stream.write(bytes));
+    if (m_exceeded_size_limit)
+        return written;
+
+    if (m_body.size() + written > max_cacheable_body_size || m_body.try_append(bytes.trim(written)).is_error()) {
+        m_exceeded_size_limit = true;
+        m_body.clear();
+    }
+    return written;
+}
+
+Optional<ByteBuffer> HttpCache::ResponseRecorder::take_body()
+{
+    if (m_exceeded_size_limit)
+        return {};
+    return move(m_body);
+}
+
+HttpCache& HttpCache::the()
+{
+    static HttpCache cache;
+    return cache;
+}
+
+DeprecatedString HttpCache::key_for(URL const& url)
+{
+    return url.serialize(URL::ExcludeFragment::Yes);
+}
+
+bool HttpCache::is_cacheable_request(StringView method, HashMap<DeprecatedString, DeprecatedString> const& request_headers)
+{
+    if (!method.equals_ignoring_case("GET"sv))
+        return false;
+
+    // The client is either keeping its own copy of the response around, or only wants a part of it.
+    for (auto name : { "If-None-Match"sv, "If-Modified-Since"sv, "If-Match"sv, "If-Unmodified-Since"sv, "If-Range"sv, "Range"sv }) {
+        if (find_request_header(request_headers, name).has_value())
+            return false;
+    }
+
+    auto cache_control = find_request_header(request_headers, "Cache-Control"sv).value_or({});
+    return !find_cache_directive(cache_control, "no-store"sv).has_value();
+}
+
+bool HttpCache::has_validators(Entry const& entry)
+{
+    return entry.m_response_headers.contains("ETag") || entry.m_response_headers.contains("Last-Modified");
+}
+
+bool HttpCache::matches_request(Entry const& entry, HashMap<DeprecatedString, DeprecatedString> const& request_headers)
+{
+    return all_of(entry.m_vary_headers, [&](auto const& vary_header) {
+        return find_request_header(request_headers, vary_header.name).value_or({}) == vary_header.value;
+    });
+}
+
+void HttpCache::compute_freshness(Entry& entry, time_t request_time, time_t response_time)
+{
+    auto const& headers = entry.m_response_headers;
+
+    auto date_value = response_time;
+    if (auto date = headers.get("Date"); date.has_value())
+        date_value = parse_http_date(date.value()).value_or(response_time);
+
+    // RFC 9111, 4.2.3. Calculating Age
+    i64 age_value = 0;
+    if (auto age = headers.get("Age"); age.has_value())
+        age_value = parse_delta_seconds(age.value()).value_or(0);
+    i64 apparent_age = max<i64>(0, response_time - date_value);
+    i64 response_delay = max<i64>(0, response_time - request_time);
+    entry.m_corrected_initial_age = max(apparent_age, age_value + response_delay);
+    entry.m_response_time = response_time;
+
+    // RFC 9111, 4.2.1. Calculating Freshness Lifetime
+    auto cache_control = headers.get("Cache-Control").value_or({});
+    entry.m_always_validate = find_cache_directive(cache_control, "no-cache"sv).has_value();
+    entry.m_freshness_lifetime = 0;
+    if (auto max_age = find_cache_directive(cache_control, "max-age"sv); max_age.has_value()) {
+        entry.m_freshness_lifetime = parse_delta_seconds(max_age.value()).value_or(0);
+    } else if (auto expires = headers.get("Expires"); expires.has_value()) {
+        // An Expires value we don't understand, like "0", means that the response has already expired.
+        if (auto expiry_time = parse_http_date(expires.value()); expiry_time.has_value())
+            entry.m_freshness_lifetime = max<i64>(0, expiry_time.value() - date_value);
+    } else if (auto last_modified = headers.get("Last-Modified"); last_modified.has_value()) {
+        // RFC 9111, 4.2.2. Calculating Heuristic Freshness: "a typical setting of this fraction might be 10%".
+        if (auto last_modified_time = parse_http_date(last_modified.value()); last_modified_time.has_value())
+            entry.m_freshness_lifetime = min(max<i64>(0, date_value - last_modified_time.value()) / 10, max_heuristic_freshness_lifetime);
+    }
+}
+
+bool HttpCache::is_fresh(Entry const& entry) const
+{
+    if (entry.m_always_validate)
+        return false;
+    auto current_age = entry.m_corrected_initial_age + max<i64>(0, time(nullptr) - entry.m_response_time);
+    return entry.m_freshness_lifetime > current_age;
+}
+
+Optional<HttpCache::Lookup> HttpCache::lookup(URL const& url, HashMap<DeprecatedString, DeprecatedString> const& request_headers)
+{
+    auto it = m_entries.find(key_for(url));
+    if (it == m_entries.end()) {
+        m_statistics.misses++;
+        return {};
+    }
+
+    RefPtr<Entry> entry;
+    for (auto& candidate : it->value) {
+        if (matches_request(candidate, request_headers)) {
+            entry = candidate;
+            break;
+        }
+    }
+    if (!entry) {
+        m_statistics.misses++;
+        return {};
+    }
+
+    auto body_or_error = body_for(*entry);
+    if (body_or_error.is_error()) {
+        dbgln("HttpCache: Failed to load {} from the disk cache: {}", entry->m_key, body_or_error.error());
+        remove(*entry);
+        m_statistics.misses++;
+        return {};
+    }
+
+    bool needs_validation = !is_fresh(*entry);
+    auto cache_control = find_request_header(request_headers, "Cache-Control"sv).value_or({});
+    if (find_cache_directive(cache_control, "no-cache"sv).has_value() || find_cache_directive(cache_control, "max-age"sv) == "0"sv)
+        needs_validation = true;
+    if (find_request_header(request_headers, "Pragma"sv).value_or({}).equals_ignoring_case("no-cache"sv))
+        needs_validation = true;
+
+    if (needs_validation && !has_validators(*entry)) {
+        remove(*entry);
+        m_statistics.misses++;
+        return {};
+    }
+
+    touch(*entry);
+    if (needs_validation)
+        m_statistics.validations++;
+    else
+        m_statistics.hits++;
+    dbgln_if(HTTP_CACHE_DEBUG, "HttpCache: {} {}", needs_validation ? "Validating" : "Hit for", entry->m_key);
+    return Lookup { entry.release_nonnull(), body_or_error.release_value(), needs_validation };
+}
+
+void HttpCache::add_validation_headers(Entry const& entry, HashMap<DeprecatedString, DeprecatedString>& request_headers)
+{
+    if (auto etag = entry.m_response_headers.get("ETag"); etag.has_value())
+        request_headers.set("If-None-Match", etag.release_value());
+    if (auto last_modified = entry.m_response_headers.get("Last-Modified"); last_modified.has_value())
+        request_headers.set("If-Modified-Since", last_modified.release_value());
+}
+
+void HttpCache::did_validate(Entry& entry, time_t request_time, ResponseHeaders const& not_modified_response_headers)
+{
+    m_statistics.validated_hits++;
+
+    // RFC 9111, 4.3.4. Freshening Stored Responses upon Validation
+    for (auto& it : not_modified_response_headers) {
+        if (it.key.equals_ignoring_case("Content-Length"sv))
+            continue;
+        entry.m_response_headers.set(it.key, it.value);
+    }
+    compute_freshness(entry, request_time, time(nullptr));
+
+    if (!entry.m_body && entry.m_lru_list_node.is_in_list()) {
+        if (auto result = write_headers_to_disk(entry); result.is_error())
+            dbgln("HttpCache: Failed to update {} in the disk cache: {}", entry.m_key, result.error());
+    }
+}
+
+void HttpCache::store(URL const& url, HashMap<DeprecatedString, DeprecatedString> const& request_headers, time_t request_time, u32 status_code, ResponseHeaders const& response_headers, ByteBuffer body)
+{
+    if (!is_cacheable_status_code(status_code))
+        return;
+    auto cache_control = response_headers.get("Cache-Control").value_or({});
+    if (find_cache_directive(cache_control, "no-store"sv).has_value())
+        return;
+
+    auto entry = adopt_ref(*new Entry);
+    entry->m_key = key_for(url);
+    if (auto vary = response_headers.get("Vary"); vary.has_value()) {
+        for (auto name : vary->split_view(',')) {
+            name = name.trim_whitespace();
+            // The response depends on more than just the request headers.
+            if (name == "*"sv)
+                return;
+            entry->m_vary_headers.append({ name.to_lowercase_string(), find_request_header(request_headers, name).value_or({}) });
+        }
+    }
+    entry->m_status_code = status_code;
+    entry->m_response_headers = response_headers;
+    entry->m_body_size = body.size();
+    entry->m_body = adopt_ref(*new Body(move(body)));
+    compute_freshness(*entry, request_time, time(nullptr));
+
+    // We would never be able to use it.
+    if (!is_fresh(*entry) && !has_validators(*entry))
+        return;
+
+    // The new response replaces whatever we had for this request so far.
+    if (auto it = m_entries.find(entry->m_key); it != m_entries.end()) {
+        auto entries = it->value;
+        for (auto& old_entry : entries) {
+            if (matches_request(old_entry, request_headers))
+                remove(old_entry);
+        }
+    }
+
+    dbgln_if(HTTP_CACHE_DEBUG, "HttpCache: Storing {} ({}, {} bytes, fresh for {}s)", entry->m_key, status_code, entry->m_body_size, entry->m_freshness_lifetime);
+    m_entries.ensure(entry->m_key).append(entry);
+    m_memory_lru_list.prepend(*entry);
+    m_statistics.memory_size += entry->m_body_size;
+    m_statistics.entry_count++;
+    m_statistics.stored_responses++;
+    enforce_memory_limit();
+}
+
+void HttpCache::invalidate(URL const& url)
+{
+    auto it = m_entries.find(key_for(url));
+    if (it == m_entries.end())
+        return;
+    auto entries = it->value;
+    for (auto& entry : entries)
+        remove(entry);
+}
+
+void HttpCache::clear()
+{
+    while (!m_entries.is_empty()) {
+        auto entries = m_entries.begin()->value;
+        for (auto& entry : entries)
+            remove(entry);
+    }
+}
+
+void HttpCache::touch(Entry& entry)
+{
+    if (entry.m_body)
+        m_memory_lru_list.prepend(entry);
+    else
+        m_disk_lru_list.prepend(entry);
+}
+
+void HttpCache::remove(Entry& entry)
+{
+    NonnullRefPtr<Entry> protector = entry;
+    entry.m_lru_list_node.remove();
+    if (entry.m_body)
+        m_statistics.memory_size -= entry.m_body_size;
+    else
+        remove_from_disk(entry);
+
+    auto it = m_entries.find(entry.m_key);
+    VERIFY(it != m_entries.end());
+    it->value.remove_first_matching([&](auto& other) { return other.ptr() == &entry; });
+    if (it->value.is_empty())
+        m_entries.remove(it);
+    m_statistics.entry_count--;
+}
+
+void HttpCache::enforce_memory_limit()
+{
+    while (m_statistics.memory_size > memory_cache_size_limit) {
+        auto entry = m_memory_lru_list.last();
+        VERIFY(entry);
+
+        if (!m_disk_cache_directory.is_empty()) {
+            if (auto result = write_to_disk(*entry, *entry->m_body); !result.is_error()) {
+                m_statistics.memory_size -= entry->m_body_size;
+                m_statistics.disk_size += entry->m_body_size;
+                entry->m_body = nullptr;
+                m_disk_lru_list.prepend(*entry);
+                continue;
+            } else {
+                dbgln("HttpCache: Failed to move {} to the disk cache: {}", entry->m_key, result.error());
+            }
+        }
+        remove(*entry);
+        m_statistics.evicted_responses++;
+    }
+    enforce_disk_limit();
+}
+
+void HttpCache::enforce_disk_limit()
+{
+    while (m_statistics.disk_size > disk_cache_size_limit) {
+        auto entry = m_disk_lru_list.last();
+        VERIFY(entry);
+        remove(*entry);
+        m_statistics.evicted_responses++;
+    }
+}
+
+DeprecatedString HttpCache::disk_path(Entry const& entry, StringView extension) const
+{
+    return DeprecatedString::formatted("{}/{}.{}", m_disk_cache_directory, entry.m_disk_name, extension);
+}
+
+ErrorOr<void> HttpCache::write_to_disk(Entry& entry, Body const& body)
+{
+    // Other RequestServer instances share the directory with us, so make sure we never pick the same name as any of them.
+    if (entry.m_disk_name.is_empty())
+        entry.m_disk_name = DeprecatedString::formatted("{}-{}-{}", time(nullptr), getpid(), m_next_disk_name_index++);
+
+    auto body_file = TRY(Core::Stream::File::open(disk_path(entry, "body"sv), Core::Stream::OpenMode::Write | Core::Stream::OpenMode::Truncate, 0600));
+    TRY(body_file->write_entire_buffer(body.bytes()));
+    return write_headers_to_disk(entry);
+}
+
+// The headers file describes the entry line by line: its key, then its status code, response time, initial age,
+// freshness lifetime, whether it always needs validation and its body size, then the Vary and response headers.
+ErrorOr<void> HttpCache::write_headers_to_disk(Entry const& entry)
+{
+    StringBuilder builder;
+    builder.appendff("{}\n", entry.m_key);
+    builder.appendff("{} {} {} {} {} {}\n", entry.m_status_code, static_cast<i64>(entry.m_response_time), entry.m_corrected_initial_age,
+        entry.m_freshness_lifetime, entry.m_always_validate ? 1 : 0, entry.m_body_size);
+    builder.appendff("{}\n", entry.m_vary_headers.size());
+    for (auto const& vary_header : entry.m_vary_headers)
+        builder.appendff("{}: {}\n", vary_header.name, vary_header.value);
+    builder.appendff("{}\n", entry.m_response_headers.size());
+    for (auto const& it : entry.m_response_headers)
+        builder.appendff("{}: {}\n", it.key, it.value);
+
+    // Write to a temporary file first, so that nobody ever picks up an entry that is only half written.
+    auto temporary_path = disk_path(entry, "headers.tmp"sv);
+    auto headers_file = TRY(Core::Stream::File::open(temporary_path, Core::Stream::OpenMode::Write | Core::Stream::OpenMode::Truncate, 0600));
+    TRY(headers_file->write_entire_buffer(builder.string_view().bytes()));
+    headers_file->close();
+    TRY(Core::System::rename(temporary_path, disk_path(entry, "headers"sv)));
+    return {};
+}
+
+ErrorOr<NonnullRefPtr<HttpCache::Entry>> HttpCache::read_from_disk(DeprecatedString const& name)
+{
+    auto entry = TRY(adopt_nonnull_ref_or_enomem(new (nothrow) Entry));
+    entry->m_disk_name = name;
+
+    auto headers_file = TRY(Core::Stream::File::open(disk_path(*entry, "headers"sv), Core::Stream::OpenMode::Read));
+    auto contents = TRY(headers_file->read_until_eof());
+    auto lines = StringView(contents.bytes()).split_view('\n');
+    size_t line_index = 0;
+    auto next_line = [&]() -> ErrorOr<StringView> {
+        if (line_index >= lines.size())
+            return Error::from_string_literal("Truncated cache entry");
+        return lines[line_index++];
+    };
+    auto next_number = [](Vector<StringView> const& fields, size_t index) -> ErrorOr<i64> {
+        auto number = fields[index].to_int<i64>();
+        if (!number.has_value())
+            return Error::from_string_literal("Invalid number in cache entry");
+        return number.value();
+    };
+    auto next_header = [&]() -> ErrorOr<Entry::VaryHeader> {
+        auto line = TRY(next_line());
+        auto separator = line.find(": "sv);
+        if (!separator.has_value())
+            return Error::from_string_literal("Invalid header in cache entry");
+        return Entry::VaryHeader { line.substring_view(0, separator.value()), line.substring_view(separator.value() + 2) };
+    };
+
+    entry->m_key = TRY(next_line());
+    auto fields = TRY(next_line()).split_view(' ');
+    if (fields.size() != 6)
+        return Error::from_string_literal("Invalid cache entry");
+    entry->m_status_code = TRY(next_number(fields, 0));
+    entry->m_response_time = TRY(next_number(fields, 1));
+    entry->m_corrected_initial_age = TRY(next_number(fields, 2));
+    entry->m_freshness_lifetime = TRY(next_number(fields, 3));
+    entry->m_always_validate = TRY(next_number(fields, 4)) != 0;
+    entry->m_body_size = TRY(next_number(fields, 5));
+
+    auto vary_header_count = TRY(next_line()).to_uint<size_t>();
+    if (!vary_header_count.has_value())
+        return Error::from_string_literal("Invalid cache entry");
+    for (size_t i = 0; i < vary_header_count.value(); ++i)
+        TRY(entry->m_vary_headers.try_append(TRY(next_header())));
+
+    auto response_header_count = TRY(next_line()).to_uint<size_t>();
+    if (!response_header_count.has_value())
+        return Error::from_string_literal("Invalid cache entry");
+    for (size_t i = 0; i < response_header_count.value(); ++i) {
+        auto header = TRY(next_header());
+        entry->m_response_headers.set(move(header.name), move(header.value));
+    }
+
+    // Make sure the body wasn't removed or cut short in the meantime.
+    auto body_stat = TRY(Core::System::stat(disk_path(*entry, "body"sv)));
+    if (static_cast<u64>(body_stat.st_size) != entry->m_body_size)
+        return Error::from_string_literal("Cache entry body has the wrong size");
+    return entry;
+}
+
+ErrorOr<NonnullRefPtr<HttpCache::Body>> HttpCache::body_for(Entry& entry)
+{
+    if (entry.m_body)
+        return NonnullRefPtr<Body> { *entry.m_body };
+
+    auto body_file = TRY(Core::Stream::File::open(disk_path(entry, "body"sv), Core::Stream::OpenMode::Read));
+    auto data = TRY(body_file->read_until_eof());
+    if (data.size() != entry.m_body_size)
+        return Error::from_string_literal("Cache entry body has the wrong size");
+    return adopt_nonnull_ref_or_enomem(new (nothrow) Body(move(data)));
+}
+
+void HttpCache::remove_from_disk(Entry& entry)
+{
+    m_statistics.disk_size -= entry.m_body_size;
+    (void)Core::System::unlink(disk_path(entry, "headers"sv));
+    (void)Core::System::unlink(disk_path(entry, "body"sv));
+}
+
+void HttpCache::set_disk_cache_directory(DeprecatedString directory)
+{
+    m_disk_cache_directory = move(directory);
+
+    Core::DirIterator iterator(m_disk_cache_directory, Core::DirIterator::SkipDots);
+    while (iterator.has_next()) {
+        auto file_name = iterator.next_path();
+        if (!file_name.ends_with(".headers"sv))
+            continue;
+        auto name = file_name.substring(0, file_name.length() - ".headers"sv.length());
+
+        auto entry_or_error = read_from_disk(name);
+        if (entry_or_error.is_error()) {
+            dbgln("HttpCache: Removing broken disk cache entry {}: {}", name, entry_or_error.error());
+            (void)Core::System::unlink(DeprecatedString::formatted("{}/{}.headers", m_disk_cache_directory, name));
+            (void)Core::System::unlink(DeprecatedString::formatted("{}/{}.body", m_disk_cache_directory, name));
+            continue;
+        }
+
+        auto entry = entry_or_error.release_value();
+        m_entries.ensure(entry->m_key).append(entry);
+        m_disk_lru_list.append(*entry);
+        m_statistics.disk_size += entry->m_body_size;
+        m_statistics.entry_count++;
+    }
+
+    dbgln_if(HTTP_CACHE_DEBUG, "HttpCache: Found {} entries ({}) in {}", m_statistics.entry_count, human_readable_size(m_statistics.disk_size), m_disk_cache_directory);
+    enforce_disk_limit();
+}
+
+void HttpCache::dump() const
+{
+    dbgln("=========== HTTP Cache ==========");
+    dbgln(" {} entries, {} in memory, {} on disk", m_statistics.entry_count, human_readable_size(m_statistics.memory_size), human_readable_size(m_statistics.disk_size));
+    dbgln(" {} hits, {} of {} validations successful, {} misses, {} stored, {} evicted", m_statistics.hits, m_statistics.validated_hits,
+        m_statistics.validations, m_statistics.misses, m_statistics.stored_responses, m_statistics.evicted_responses);
+    for (auto& it : m_entries) {
+        for (auto& entry : it.value)
+            dbgln(" - {} ({}, {} bytes, {}, {})", it.key, entry->m_status_code, entry->m_body_size, is_fresh(entry) ? "fresh" : "stale", entry->m_body ? "in memory" : "on disk");
+    }
+}
+
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/DeprecatedString.h>
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/RefCounted.h>
+#include <AK/Stream.h>
+#include <AK/URL.h>
+#include <AK/Vector.h>
+#include <time.h>
+
+namespace RequestServer {
+
+using ResponseHeaders = HashMap<DeprecatedString, DeprecatedString, CaseInsensitiveStringTraits>;
+
+// A private HTTP cache as described by RFC 9111, shared by all requests of this RequestServer.
+// Responses are kept in memory until the memory budget is used up, at which point the least recently
+// used ones are moved out to the disk cache directory, where they survive until the disk budget is used up.
+class HttpCache {
+public:
+    struct Statistics {
+        // Lookups that found a fresh response.
+        u64 hits { 0 };
+        // Lookups that found a stale response, which the origin server was asked about.
+        u64 validations { 0 };
+        // Validations that ended with the origin server confirming the stored response.
+        u64 validated_hits { 0 };
+        u64 misses { 0 };
+        u64 stored_responses { 0 };
+        u64 evicted_responses { 0 };
+        u64 memory_size { 0 };
+        u64 disk_size { 0 };
+        size_t entry_count { 0 };
+    };
+
+    class Body : public RefCounted<Body> {
+    public:
+        explicit Body(ByteBuffer data)
+            : m_data(move(data))
+        {
+        }
+
+        ReadonlyBytes bytes() const { return m_data.bytes(); }
+        size_t size() const { return m_data.size(); }
+
+    private:
+        ByteBuffer m_data;
+    };
+
+    class Entry : public RefCounted<Entry> {
+    public:
+        u32 status_code() const { return m_status_code; }
+        ResponseHeaders const& response_headers() const { return m_response_headers; }
+        size_t body_size() const { return m_body_size; }
+
+    private:
+        friend class HttpCache;
+
+        DeprecatedString m_key;
+        // The request headers named by the response's Vary header, with the values they had in the original request.
+        struct VaryHeader {
+            DeprecatedString name;
+            DeprecatedString value;
+        };
+        Vector<VaryHeader> m_vary_headers;
+        u32 m_status_code { 0 };
+        ResponseHeaders m_response_headers;
+        size_t m_body_size { 0 };
+
+        // Null once the body only lives in the disk cache.
+        RefPtr<Body> m_body;
+        DeprecatedString m_disk_name;
+
+        time_t m_response_time { 0 };
+        i64 m_corrected_initial_age { 0 };
+        i64 m_freshness_lifetime { 0 };
+        bool m_always_validate { false };
+
+        IntrusiveListNode<Entry, RefPtr<Entry>> m_lru_list_node;
+
+    public:
+        using LRUList = IntrusiveList<&Entry::m_lru_list_node>;
+    };
+
+    struct Lookup {
+        NonnullRefPtr<Entry> entry;
+        NonnullRefPtr<Body> body;
+        bool needs_validation { false };
+    };
+
+    // Records what a job writes to the client's pipe, so the response can be stored once it's complete.
+    class ResponseRecorder final : public AK::Stream {
+    public:
+        explicit ResponseRecorder(AK::Stream& output_stream)
+            : m_output_stream(output_stream)
+        {
+        }
+
+        virtual ErrorOr<Bytes> read(Bytes) override { return Error::from_errno(EBADF); }
+        virtual ErrorOr<size_t> write(ReadonlyBytes) override;
+        virtual bool is_eof() const override { return m_output_stream.is_eof(); }
+        virtual bool is_open() const override { return m_output_stream.is_open(); }
+        virtual void close() override { m_output_stream.close(); }
+
+        // Empty if the response turned out too big to be stored.
+        Optional<ByteBuffer> take_body();
+
+    private:
+        AK::Stream& m_output_stream;
+        ByteBuffer m_body;
+        bool m_exceeded_size_limit { false };
+    };
+
+    static HttpCache& the();
+
+    // Enables the disk cache and picks up the responses stored there by earlier instances.
+    void set_disk_cache_directory(DeprecatedString);
+
+    static bool is_cacheable_request(StringView method, HashMap<DeprecatedString, DeprecatedString> const& request_headers);
+
+    // Returns a stored response to the given request, if there is one. If it's stale, the origin server has to
+    // confirm it's still good first, see add_validation_headers() and did_validate().
+    Optional<Lookup> lookup(URL const&, HashMap<DeprecatedString, DeprecatedString> const& request_headers);
+    static void add_validation_headers(Entry const&, HashMap<DeprecatedString, DeprecatedString>& request_headers);
+    void did_validate(Entry&, time_t request_time, ResponseHeaders const& not_modified_response_headers);
+
+    void store(URL const&, HashMap<DeprecatedString, DeprecatedString> const& request_headers, time_t request_time, u32 status_code, ResponseHeaders const& response_headers, ByteBuffer body);
+
+    // Requests with unsafe methods (POST, PUT, ...) may change the resource, so we forget what we know about it.
+    void invalidate(URL const&);
+    void clear();
+
+    Statistics const& statistics() const { return m_statistics; }
+    void dump() const;
+
+private:
+    HttpCache() = default;
+
+    static DeprecatedString key_for(URL const&);
+    void compute_freshness(Entry&, time_t request_time, time_t response_time);
+    bool is_fresh(Entry const&) const;
+    static bool has_validators(Entry const&);
+    static bool matches_request(Entry const&, HashMap<DeprecatedString, DeprecatedString> const& request_headers);
+    void touch(Entry&);
+    void remove(Entry&);
+    void enforce_memory_limit();
+    void enforce_disk_limit();
+    DeprecatedString disk_path(Entry const&, StringView extension) const;
+    ErrorOr<void> write_to_disk(Entry&, Body const&);
+    ErrorOr<void> write_headers_to_disk(Entry const&);
+    ErrorOr<NonnullRefPtr<Entry>> read_from_disk(DeprecatedString const& name);
+    ErrorOr<NonnullRefPtr<Body>> body_for(Entry&);
+    void remove_from_disk(Entry&);
+
+    HashMap<DeprecatedString, Vector<NonnullRefPtr<Entry>>> m_entries;
+    Entry::LRUList m_memory_lru_list;
+    Entry::LRUList m_disk_lru_list;
+    DeprecatedString m_disk_cache_directory;
+    u64 m_next_disk_name_index { 0 };
+    Statistics m_statistics;
+};
+
+}
@@ -14,8 +14,10 @@
 #include <AK/OwnPtr.h>
 #include <AK/Types.h>
 #include <LibHTTP/HttpRequest.h>
+#include <RequestServer/CachedRequest.h>
 #include <RequestServer/ConnectionCache.h>
 #include <RequestServer/ConnectionFromClient.h>
+#include <RequestServer/HttpCache.h>
 #include <RequestServer/Request.h>
 
 namespace RequestServer::Detail {
@@ -24,6 +26,11 @@ template<typename TSelf, typename TJob>
 void init(TSelf* self, TJob job)
 {
     job->on_headers_received = [self](auto& headers, auto response_code) {
+        // The stored response is still good, it's sent to the client once we're done with this one.
+        if (self->is_validating_cached_response() && response_code.has_value() && response_code.value() == 304) {
+            self->set_received_not_modified();
+            return;
+        }
         if (response_code.has_value())
             self->set_status_code(response_code.value());
         self->set_response_headers(headers);
@@ -34,6 +41,10 @@ void init(TSelf* self, TJob job)
             ConnectionCache::request_did_finish(url, socket);
         });
         if (auto* response = self->job().response()) {
+            if (success && self->is_validating_cached_response() && response->code() == 304) {
+                self->did_validate_cached_response(response->headers());
+                return;
+            }
             self->set_status_code(response->code());
             self->set_response_headers(response->headers());
             self->set_downloaded_size(response->downloaded_size());
@@ -47,6 +58,9 @@ void init(TSelf* self, TJob job)
         self->did_finish(success);
     };
     job->on_progress = [self](Optional<u32> total, u32 current) {
+        // The stored response's size is reported once it's been sent, not that of the empty 304 response.
+        if (self->has_received_not_modified())
+            return;
         self->did_progress(total, current);
     };
     if constexpr (requires { job->on_certificate_requested; }) {
@@ -90,17 +104,44 @@ OwnPtr<Request> start_request(TBadgedProtocol&& protocol, ConnectionFromClient&
     else
         request.set_method(HTTP::HttpRequest::Method::GET);
     request.set_url(url);
-    request.set_headers(headers);
+
+    auto request_time = time(nullptr);
+    auto request_headers = headers;
+    bool is_cacheable = HttpCache::is_cacheable_request(method, headers);
+    Optional<HttpCache::Lookup> cached_response;
+    if (is_cacheable) {
+        cached_response = HttpCache::the().lookup(url, headers);
+        if (cached_response.has_value() && cached_response->needs_validation)
+            HttpCache::add_validation_headers(cached_response->entry, request_headers);
+    } else if (!method.equals_ignoring_case("get"sv) && !method.equals_ignoring_case("head"sv)) {
+        HttpCache::the().invalidate(url);
+    }
+    request.set_headers(request_headers);
+
+    auto output_stream = MUST(Core::Stream::File::adopt_fd(pipe_result.value().write_fd, Core::Stream::OpenMode::Write));
+    if (cached_response.has_value() && !cached_response->needs_validation) {
+        auto fresh_response = cached_response.release_value();
+        auto cached_request = CachedRequest::create(client, url, move(output_stream));
+        cached_request->set_request_fd(pipe_result.value().read_fd);
+        cached_request->serve_cached_response(move(fresh_response.entry), move(fresh_response.body));
+        return cached_request;
+    }
 
     auto allocated_body_result = ByteBuffer::copy(body);
     if (allocated_body_result.is_error())
         return {};
     request.set_body(allocated_body_result.release_value());
 
-    auto output_stream = MUST(Core::Stream::File::adopt_fd(pipe_result.value().write_fd, Core::Stream::OpenMode::Write));
-    auto job = TJob::construct(move(request), *output_stream);
+    OwnPtr<HttpCache::ResponseRecorder> response_recorder;
+    if (is_cacheable)
+        response_recorder = make<HttpCache::ResponseRecorder>(*output_stream);
+    auto job = TJob::construct(move(request), response_recorder ? static_cast<AK::Stream&>(*response_recorder) : *output_stream);
     auto protocol_request = TRequest::create_with_job(forward<TBadgedProtocol>(protocol), client, (TJob&)*job, move(output_stream));
     protocol_request->set_request_fd(pipe_result.value().read_fd);
+    if (response_recorder)
+        protocol_request->set_response_recorder(response_recorder.release_nonnull(), headers, request_time);
+    if (cached_response.has_value())
+        protocol_request->set_cached_response_to_validate(cached_response.release_value());
 
     if constexpr (IsSame<typename TBadgedProtocol::Type, HttpsProtocol>)
         ConnectionCache::get_or_create_connection(ConnectionCache::g_tls_connection_cache, url, *job, proxy_data);
@@ -36,6 +36,10 @@ void Request::set_certificate(DeprecatedString, DeprecatedString)
 
 void Request::did_finish(bool success)
 {
+    if (success && m_response_recorder && !m_cached_response && m_status_code.has_value()) {
+        if (auto body = m_response_recorder->take_body(); body.has_value())
+            HttpCache::the().store(url(), m_request_headers, m_request_time, m_status_code.value(), m_response_headers, body.release_value());
+    }
     m_client.did_finish_request({}, *this, success);
 }
 
@@ -51,4 +55,67 @@ void Request::did_request_certificates()
     m_client.did_request_certificates({}, *this);
 }
 
+void Request::set_response_recorder(NonnullOwnPtr<HttpCache::ResponseRecorder> response_recorder, HashMap<DeprecatedString, DeprecatedString> request_headers, time_t request_time)
+{
+    m_response_recorder = move(response_recorder);
+    m_request_headers = move(request_headers);
+    m_request_time = request_time;
+}
+
+void Request::set_cached_response_to_validate(HttpCache::Lookup cached_response)
+{
+    m_cached_response_to_validate = move(cached_response);
+}
+
+void Request::did_validate_cached_response(ResponseHeaders const& not_modified_response_headers)
+{
+    auto cached_response = m_cached_response_to_validate.release_value();
+    HttpCache::the().did_validate(cached_response.entry, m_request_time, not_modified_response_headers);
+    serve_cached_response(move(cached_response.entry), move(cached_response.body));
+}
+
+void Request::serve_cached_response(NonnullRefPtr<HttpCache::Entry> entry, NonnullRefPtr<HttpCache::Body> body)
+{
+    m_cached_response = move(entry);
+    m_cached_response_body = move(body);
+    m_cached_response_offset = 0;
+    m_did_send_cached_response_headers = false;
+
+    // The client may not know about this request yet, so we send everything from the event loop.
+    // The pipe is non-blocking, and we carry on whenever the client has made room in it.
+    m_cached_response_notifier = Core::Notifier::construct(m_output_stream->fd(), Core::Notifier::Event::Write);
+    m_cached_response_notifier->on_ready_to_write = [this] {
+        write_cached_response();
+    };
+}
+
+void Request::write_cached_response()
+{
+    if (!m_did_send_cached_response_headers) {
+        m_did_send_cached_response_headers = true;
+        set_status_code(m_cached_response->status_code());
+        set_response_headers(m_cached_response->response_headers());
+    }
+
+    auto bytes = m_cached_response_body->bytes();
+    while (m_cached_response_offset < bytes.size()) {
+        auto result = m_output_stream->write(bytes.slice(m_cached_response_offset));
+        if (result.is_error()) {
+            if (result.error().is_errno() && result.error().code() == EINTR)
+                continue;
+            if (result.error().is_errno() && result.error().code() == EAGAIN)
+                return;
+            dbgln("Request: Failed to write cached response for {}: {}", url(), result.error());
+            m_cached_response_notifier->set_enabled(false);
+            did_finish(false);
+            return;
+        }
+        m_cached_response_offset += result.value();
+    }
+
+    m_cached_response_notifier->set_enabled(false);
+    did_progress(bytes.size(), bytes.size());
+    did_finish(true);
+}
+
 }
@@ -11,7 +11,9 @@
 #include <AK/Optional.h>
 #include <AK/RefCounted.h>
 #include <AK/URL.h>
+#include <LibCore/Notifier.h>
 #include <RequestServer/Forward.h>
+#include <RequestServer/HttpCache.h>
 
 namespace RequestServer {
 
@@ -42,6 +44,18 @@ public:
     void set_downloaded_size(size_t size) { m_downloaded_size = size; }
     Core::Stream::File const& output_stream() const { return *m_output_stream; }
 
+    // Once the response is complete, it's stored in the HTTP cache.
+    void set_response_recorder(NonnullOwnPtr<HttpCache::ResponseRecorder>, HashMap<DeprecatedString, DeprecatedString> request_headers, time_t request_time);
+
+    // The request asks the server whether the given stale response is still good, and sends that instead if it is.
+    void set_cached_response_to_validate(HttpCache::Lookup);
+    bool is_validating_cached_response() const { return m_cached_response_to_validate.has_value(); }
+    bool has_received_not_modified() const { return m_has_received_not_modified; }
+    void set_received_not_modified() { m_has_received_not_modified = true; }
+    void did_validate_cached_response(ResponseHeaders const& not_modified_response_headers);
+
+    void serve_cached_response(NonnullRefPtr<HttpCache::Entry>, NonnullRefPtr<HttpCache::Body>);
+
 protected:
     explicit Request(ConnectionFromClient&, NonnullOwnPtr<Core::Stream::File>&&);
 
@@ -54,6 +68,20 @@ private:
     size_t m_downloaded_size { 0 };
     NonnullOwnPtr<Core::Stream::File> m_output_stream;
     HashMap<DeprecatedString, DeprecatedString, CaseInsensitiveStringTraits> m_response_headers;
+
+    void write_cached_response();
+
+    OwnPtr<HttpCache::ResponseRecorder> m_response_recorder;
+    HashMap<DeprecatedString, DeprecatedString> m_request_headers;
+    time_t m_request_time { 0 };
+    Optional<HttpCache::Lookup> m_cached_response_to_validate;
+    bool m_has_received_not_modified { false };
+
+    RefPtr<HttpCache::Entry> m_cached_response;
+    RefPtr<HttpCache::Body> m_cached_response_body;
+    size_t m_cached_response_offset { 0 };
+    bool m_did_send_cached_response_headers { false };
+    RefPtr<Core::Notifier> m_cached_response_notifier;
 };
 
 }
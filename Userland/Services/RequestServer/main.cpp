@@ -6,32 +6,32 @@
 
 #include <AK/OwnPtr.h>
 #include <LibCore/EventLoop.h>
+#include <LibCore/Directory.h>
 #include <LibCore/LocalServer.h>
+#include <LibCore/StandardPaths.h>
 #include <LibCore/System.h>
 #include <LibIPC/SingleServer.h>
 #include <LibMain/Main.h>
 #include <LibTLS/Certificate.h>
 #include <RequestServer/ConnectionFromClient.h>
 #include <RequestServer/GeminiProtocol.h>
+#include <RequestServer/HttpCache.h>
 #include <RequestServer/HttpProtocol.h>
 #include <RequestServer/HttpsProtocol.h>
 #include <signal.h>
 
 ErrorOr<int> serenity_main(Main::Arguments)
 {
-    if constexpr (TLS_SSL_KEYLOG_DEBUG)
-        TRY(Core::System::pledge("stdio inet accept unix cpath wpath rpath sendfd recvfd sigaction"));
-    else
-        TRY(Core::System::pledge("stdio inet accept unix rpath sendfd recvfd sigaction"));
+    TRY(Core::System::pledge("stdio inet accept unix cpath wpath rpath sendfd recvfd sigaction"));
 
 #ifdef SIGINFO
-    signal(SIGINFO, [](int) { RequestServer::ConnectionCache::dump_jobs(); });
+    signal(SIGINFO, [](int) {
+        RequestServer::ConnectionCache::dump_jobs();
+        RequestServer::HttpCache::the().dump();
+    });
 #endif
 
-    if constexpr (TLS_SSL_KEYLOG_DEBUG)
-        TRY(Core::System::pledge("stdio inet accept unix cpath wpath rpath sendfd recvfd"));
-    else
-        TRY(Core::System::pledge("stdio inet accept unix rpath sendfd recvfd"));
+    TRY(Core::System::pledge("stdio inet accept unix cpath wpath rpath sendfd recvfd"));
 
     // Ensure the certificates are read out here.
     [[maybe_unused]] auto& certs = DefaultRootCACertificates::the();
@@ -42,8 +42,19 @@ ErrorOr<int> serenity_main(Main::Arguments)
     TRY(Core::System::unveil("/etc/timezone", "r"));
     if constexpr (TLS_SSL_KEYLOG_DEBUG)
         TRY(Core::System::unveil("/home/anon", "rwc"));
+
+    // Responses that don't fit in memory are kept on disk, where other instances can pick them up as well.
+    auto disk_cache_directory = DeprecatedString::formatted("{}/.cache/RequestServer", Core::StandardPaths::home_directory());
+    auto disk_cache_directory_or_error = Core::Directory::create(disk_cache_directory, Core::Directory::CreateDirectories::Yes, 0700);
+    if (disk_cache_directory_or_error.is_error())
+        dbgln("Failed to create the HTTP disk cache directory {}: {}", disk_cache_directory, disk_cache_directory_or_error.error());
+    else
+        TRY(Core::System::unveil(disk_cache_directory, "rwc"sv));
     TRY(Core::System::unveil(nullptr, nullptr));
 
+    if (!disk_cache_directory_or_error.is_error())
+        RequestServer::HttpCache::the().set_disk_cache_directory(move(disk_cache_directory));
+
     [[maybe_unused]] auto gemini = make<RequestServer::GeminiProtocol>();
     [[maybe_unused]] auto http = make<RequestServer::HttpProtocol>();
     [[maybe_unused]] auto https = make<RequestServer::HttpsProtocol>();
@@ -43,6 +43,7 @@ ErrorOr<NonnullRefPtr<DatabaseConnection>> DatabaseConnection::create(StringView
         warnln("Could not open database: {}", result.error().error_string());
         return Error::from_string_view("Could not open database"sv);
     }
+    database->set_group_commit_enabled(true);
 
     return adopt_nonnull_ref_or_enomem(new (nothrow) DatabaseConnection(move(database), move(database_name), client_id));
 }
@@ -72,4 +73,24 @@ SQL::ResultOr<SQL::StatementID> DatabaseConnection::prepare_statement(StringView
     return statement->statement_id();
 }
 
+void DatabaseConnection::when_committed(Function<void(SQL::ResultOr<void>)> callback)
+{
+    m_commit_callbacks.append(move(callback));
+    if (m_commit_callbacks.size() > 1)
+        return;
+
+    deferred_invoke([this] {
+        auto callbacks = move(m_commit_callbacks);
+        auto sync_result = m_database->sync();
+        dbgln_if(SQLSERVER_DEBUG, "DatabaseConnection::when_committed(connection_id {}): synced {} statements", connection_id(), callbacks.size());
+
+        for (auto& callback : callbacks) {
+            if (sync_result.is_error())
+                callback(SQL::Result { SQL::SQLCommand::Unknown, SQL::SQLErrorCode::InternalError, DeprecatedString::formatted("{}", sync_result.error()) });
+            else
+                callback({});
+        }
+    });
+}
+
 }
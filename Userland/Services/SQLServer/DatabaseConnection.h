@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include <AK/Function.h>
 #include <AK/NonnullRefPtr.h>
+#include <AK/Vector.h>
 #include <LibCore/Object.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Result.h>
@@ -30,6 +32,10 @@ public:
     void disconnect();
     SQL::ResultOr<SQL::StatementID> prepare_statement(StringView sql);
 
+    // Invokes the callback once everything committed so far is durable. All callbacks
+    // queued during one event loop iteration share a single sync of the database.
+    void when_committed(Function<void(SQL::ResultOr<void>)> callback);
+
 private:
     DatabaseConnection(NonnullRefPtr<SQL::Database> database, DeprecatedString database_name, int client_id);
 
@@ -37,6 +43,7 @@ private:
     DeprecatedString m_database_name;
     SQL::ConnectionID m_connection_id { 0 };
     int m_client_id { 0 };
+    Vector<Function<void(SQL::ResultOr<void>)>> m_commit_callbacks;
 };
 
 }
@@ -80,29 +80,35 @@ Optional<SQL::ExecutionID> SQLStatement::execute(Vector<SQL::Value> placeholder_
             return;
         }
 
-        auto client_connection = ConnectionFromClient::client_connection_for(connection()->client_id());
-        if (!client_connection) {
-            warnln("Cannot return statement execution results. Client disconnected");
-            return;
-        }
-
-        auto result = execution_result.release_value();
-
-        if (should_send_result_rows(result)) {
-            client_connection->async_execution_success(statement_id(), execution_id, result.column_names(), true, 0, 0, 0);
-
-            auto result_size = result.size();
-            next(execution_id, move(result), result_size);
-        } else {
-            if (result.command() == SQL::SQLCommand::Insert)
-                client_connection->async_execution_success(statement_id(), execution_id, result.column_names(), false, result.size(), 0, 0);
-            else if (result.command() == SQL::SQLCommand::Update)
-                client_connection->async_execution_success(statement_id(), execution_id, result.column_names(), false, 0, result.size(), 0);
-            else if (result.command() == SQL::SQLCommand::Delete)
-                client_connection->async_execution_success(statement_id(), execution_id, result.column_names(), false, 0, 0, result.size());
-            else
-                client_connection->async_execution_success(statement_id(), execution_id, result.column_names(), false, 0, 0, 0);
-        }
+        // The statement is only acknowledged once its changes are durable.
+        connection()->when_committed([this, strong_this = NonnullRefPtr(*this), execution_id, result = execution_result.release_value()](SQL::ResultOr<void> commit_result) mutable {
+            if (commit_result.is_error()) {
+                report_error(commit_result.release_error(), execution_id);
+                return;
+            }
+
+            auto client_connection = ConnectionFromClient::client_connection_for(connection()->client_id());
+            if (!client_connection) {
+                warnln("Cannot return statement execution results. Client disconnected");
+                return;
+            }
+
+            if (should_send_result_rows(result)) {
+                client_connection->async_execution_success(statement_id(), execution_id, result.column_names(), true, 0, 0, 0);
+
+                auto result_size = result.size();
+                next(execution_id, move(result), result_size);
+            } else {
+                if (result.command() == SQL::SQLCommand::Insert)
+                    client_connection->async_execution_success(statement_id(), execution_id, result.column_names(), false, result.size(), 0, 0);
+                else if (result.command() == SQL::SQLCommand::Update)
+                    client_connection->async_execution_success(statement_id(), execution_id, result.column_names(), false, 0, result.size(), 0);
+                else if (result.command() == SQL::SQLCommand::Delete)
+                    client_connection->async_execution_success(statement_id(), execution_id, result.column_names(), false, 0, 0, result.size());
+                else
+                    client_connection->async_execution_success(statement_id(), execution_id, result.column_names(), false, 0, 0, 0);
+            }
+        });
     });
 
     return execution_id;
@@ -9,7 +9,6 @@
 #include <AK/Base64.h>
 #include <AK/Debug.h>
 #include <AK/LexicalPath.h>
-#include <AK/MemoryStream.h>
 #include <AK/QuickSort.h>
 #include <AK/StringBuilder.h>
 #include <AK/URL.h>
@@ -17,18 +16,25 @@
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
 #include <LibCore/MappedFile.h>
-#include <LibCore/MimeData.h>
+#include <LibCore/System.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibHTTP/HttpResponse.h>
 #include <WebServer/Client.h>
 #include <WebServer/Configuration.h>
 #include <stdio.h>
 #include <sys/stat.h>
+#include <time.h>
 #include <unistd.h>
 
 namespace WebServer {
 
-Client::Client(NonnullOwnPtr<Core::Stream::BufferedTCPSocket> socket, Core::Object* parent)
+// Requests with bigger headers than this are refused.
+static constexpr size_t max_request_size = 64 * KiB;
+// Connections that are idle for longer than this are closed.
+static constexpr int keep_alive_timeout_ms = 15000;
+static constexpr size_t sendfile_chunk_size = 1 * MiB;
+
+Client::Client(NonnullOwnPtr<Core::Stream::TCPSocket> socket, Core::Object* parent)
     : Core::Object(parent)
     , m_socket(move(socket))
 {
@@ -36,67 +42,142 @@ Client::Client(NonnullOwnPtr<Core::Stream::BufferedTCPSocket> socket, Core::Obje
 
 void Client::die()
 {
+    if (!m_socket->is_open())
+        return;
+    if (m_write_notifier)
+        m_write_notifier->close();
+    if (m_idle_timer)
+        m_idle_timer->stop();
     m_socket->close();
     deferred_invoke([this] { remove_from_parent(); });
 }
 
-void Client::start()
+ErrorOr<void> Client::start()
 {
-    m_socket->on_ready_to_read = [this] {
-        StringBuilder builder;
-
-        auto maybe_buffer = ByteBuffer::create_uninitialized(m_socket->buffer_size());
-        if (maybe_buffer.is_error()) {
-            warnln("Could not create buffer for client: {}", maybe_buffer.error());
+    m_write_notifier = Core::Notifier::construct(m_socket->fd(), Core::Notifier::Event::Write, this);
+    m_write_notifier->set_enabled(false);
+    m_write_notifier->on_ready_to_write = [this] {
+        m_write_notifier->set_enabled(false);
+        if (auto result = flush_pending_response(); result.is_error()) {
+            warnln("Failed to send the response: {}", result.error());
             die();
             return;
         }
+        if (!m_pending_response.has_value())
+            handle_buffered_requests();
+    };
 
-        auto buffer = maybe_buffer.release_value();
-        for (;;) {
-            auto maybe_can_read = m_socket->can_read_without_blocking();
-            if (maybe_can_read.is_error()) {
-                warnln("Failed to get the blocking status for the socket: {}", maybe_can_read.error());
-                die();
-                return;
-            }
+    m_idle_timer = TRY(Core::Timer::create_single_shot(
+        keep_alive_timeout_ms, [this] {
+            dbgln_if(WEBSERVER_DEBUG, "Closing idle connection");
+            die();
+        },
+        this));
+    m_idle_timer->start();
 
-            if (!maybe_can_read.value())
-                break;
+    m_socket->on_ready_to_read = [this] { on_ready_to_read(); };
+    return {};
+}
 
-            auto maybe_bytes_read = m_socket->read_until_any_of(buffer, Array { "\r"sv, "\n"sv, "\r\n"sv });
-            if (maybe_bytes_read.is_error()) {
-                warnln("Failed to read a line from the request: {}", maybe_bytes_read.error());
-                die();
-                return;
-            }
+void Client::on_ready_to_read()
+{
+    m_idle_timer->restart();
 
-            if (m_socket->is_eof()) {
-                die();
+    u8 buffer[PAGE_SIZE];
+    for (;;) {
+        auto maybe_bytes_read = m_socket->read({ buffer, sizeof(buffer) });
+        if (maybe_bytes_read.is_error()) {
+            if (maybe_bytes_read.error().code() == EAGAIN)
                 break;
-            }
+            warnln("Failed to read the request: {}", maybe_bytes_read.error());
+            die();
+            return;
+        }
 
-            builder.append(StringView { maybe_bytes_read.value() });
-            builder.append("\r\n"sv);
+        // The client is done sending, but may still be waiting for the responses to what it sent so far.
+        auto bytes_read = maybe_bytes_read.release_value();
+        if (bytes_read.is_empty())
+            break;
+
+        if (m_request_buffer.size() + bytes_read.size() > max_request_size || m_request_buffer.try_append(bytes_read).is_error()) {
+            warnln("Request from client is too large");
+            die();
+            return;
         }
+    }
+
+    handle_buffered_requests();
+}
+
+void Client::handle_buffered_requests()
+{
+    // Requests may be pipelined, but we only work on one at a time and leave the others in the buffer for later.
+    while (m_socket->is_open() && !m_pending_response.has_value()) {
+        auto end_of_headers = StringView { m_request_buffer.bytes() }.find("\r\n\r\n"sv);
+        if (!end_of_headers.has_value())
+            break;
 
-        auto request = builder.to_byte_buffer();
-        dbgln_if(WEBSERVER_DEBUG, "Got raw request: '{}'", DeprecatedString::copy(request));
+        auto request_size = end_of_headers.value() + 4;
+        auto maybe_raw_request = m_request_buffer.slice(0, request_size);
+        auto maybe_rest = ByteBuffer::copy(m_request_buffer.bytes().slice(request_size));
+        if (maybe_raw_request.is_error() || maybe_rest.is_error()) {
+            warnln("Could not create buffer for client request");
+            die();
+            return;
+        }
+        auto raw_request = maybe_raw_request.release_value();
+        m_request_buffer = maybe_rest.release_value();
+        dbgln_if(WEBSERVER_DEBUG, "Got raw request: '{}'", StringView { raw_request.bytes() });
 
-        auto maybe_did_handle = handle_request(request);
-        if (maybe_did_handle.is_error()) {
-            warnln("Failed to handle the request: {}", maybe_did_handle.error());
+        if (auto result = handle_request(raw_request); result.is_error()) {
+            warnln("Failed to handle the request: {}", result.error());
+            die();
+            return;
         }
+    }
+
+    if (!m_socket->is_open())
+        return;
+
+    // Don't take on more work from this client until it has received what it asked for so far.
+    if (m_pending_response.has_value()) {
+        m_socket->set_notifications_enabled(false);
+        m_idle_timer->stop();
+        return;
+    }
 
+    if (m_socket->is_eof())
         die();
-    };
 }
 
-ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
+static Optional<DeprecatedString> header_value(HTTP::HttpRequest const& request, StringView name)
 {
-    auto request_or_error = HTTP::HttpRequest::from_raw_request(raw_request);
-    if (!request_or_error.has_value())
+    auto it = request.headers().find_if([&](auto& header) { return header.name.equals_ignoring_case(name); });
+    if (it.is_end())
+        return {};
+    return it->value.trim_whitespace();
+}
+
+static bool has_connection_option(HTTP::HttpRequest const& request, StringView option)
+{
+    auto connection = header_value(request, "Connection"sv);
+    if (!connection.has_value())
         return false;
+    for (auto token : connection->split_view(',')) {
+        if (token.trim_whitespace().equals_ignoring_case(option))
+            return true;
+    }
+    return false;
+}
+
+ErrorOr<void> Client::handle_request(ReadonlyBytes raw_request)
+{
+    auto request_or_error = HTTP::HttpRequest::from_raw_request(raw_request);
+    if (!request_or_error.has_value()) {
+        dbgln_if(WEBSERVER_DEBUG, "Could not parse the request");
+        die();
+        return {};
+    }
     auto& request = request_or_error.value();
     auto resource_decoded = URL::percent_decode(request.resource());
 
@@ -107,9 +188,21 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
         }
     }
 
-    if (request.method() != HTTP::HttpRequest::Method::GET) {
-        TRY(send_error_response(501, request));
-        return false;
+    // HTTP/1.1 connections stay open unless the client says otherwise, HTTP/1.0 ones only if the client asks for it.
+    auto request_line = StringView { raw_request }.substring_view(0, StringView { raw_request }.find("\r\n"sv).value());
+    if (request_line.ends_with(" HTTP/1.0"sv))
+        m_keep_alive = has_connection_option(request, "keep-alive"sv);
+    else
+        m_keep_alive = !has_connection_option(request, "close"sv);
+
+    // We don't read request bodies, so there's no telling where the next request would start.
+    if (header_value(request, "Content-Length"sv).value_or("0") != "0" || header_value(request, "Transfer-Encoding"sv).has_value())
+        m_keep_alive = false;
+
+    m_is_head_request = request.method() == HTTP::HttpRequest::Method::HEAD;
+    if (request.method() != HTTP::HttpRequest::Method::GET && request.method() != HTTP::HttpRequest::Method::HEAD) {
+        m_keep_alive = false;
+        return send_error_response(501, request);
     }
 
     // Check for credentials if they are required
@@ -119,8 +212,7 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
             auto const basic_auth_header = TRY(String::from_utf8("WWW-Authenticate: Basic realm=\"WebServer\", charset=\"UTF-8\""sv));
             Vector<String> headers {};
             TRY(headers.try_append(basic_auth_header));
-            TRY(send_error_response(401, request, move(headers)));
-            return false;
+            return send_error_response(401, request, move(headers));
         }
     }
 
@@ -139,104 +231,306 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
             red.append(requested_path);
             red.append("/"sv);
 
-            TRY(send_redirect(red.to_deprecated_string(), request));
-            return true;
+            return send_redirect(red.to_deprecated_string(), request);
         }
 
         StringBuilder index_html_path_builder;
         index_html_path_builder.append(real_path);
         index_html_path_builder.append("/index.html"sv);
         auto index_html_path = TRY(index_html_path_builder.to_string());
-        if (!Core::File::exists(index_html_path)) {
-            TRY(handle_directory_listing(requested_path, real_path, request));
-            return true;
-        }
+        if (!Core::File::exists(index_html_path))
+            return handle_directory_listing(requested_path, real_path, request);
         real_path = index_html_path;
     }
 
-    auto file = Core::File::construct(real_path.bytes_as_string_view());
-    if (!file->open(Core::OpenMode::ReadOnly)) {
-        TRY(send_error_response(404, request));
-        return false;
+    return handle_file_request(request, real_path.to_deprecated_string());
+}
+
+// If-None-Match uses the weak comparison, where W/"x" and "x" match, and If-Match the strong one, where they don't.
+enum class EntityTagComparison {
+    Strong,
+    Weak,
+};
+
+static bool entity_tag_list_matches(StringView list, StringView etag, EntityTagComparison comparison)
+{
+    if (list == "*"sv)
+        return true;
+    for (auto candidate : list.split_view(',')) {
+        candidate = candidate.trim_whitespace();
+        if (candidate.starts_with("W/"sv)) {
+            if (comparison == EntityTagComparison::Strong)
+                continue;
+            candidate = candidate.substring_view(2);
+        }
+        if (candidate == etag)
+            return true;
     }
+    return false;
+}
 
-    if (file->is_device()) {
-        TRY(send_error_response(403, request));
-        return false;
+struct ByteRange {
+    u64 first { 0 };
+    u64 length { 0 };
+    bool is_satisfiable { true };
+};
+
+// Only a single range is supported. For anything else we send the whole file instead, which clients have to accept.
+static Optional<ByteRange> parse_range(StringView value, u64 file_size)
+{
+    if (!value.starts_with("bytes="sv))
+        return {};
+    auto spec = value.substring_view(6).trim_whitespace();
+    if (spec.contains(','))
+        return {};
+    auto dash = spec.find('-');
+    if (!dash.has_value())
+        return {};
+    auto first_string = spec.substring_view(0, dash.value()).trim_whitespace();
+    auto last_string = spec.substring_view(dash.value() + 1).trim_whitespace();
+
+    // "bytes=-500" asks for the last 500 bytes.
+    if (first_string.is_empty()) {
+        auto suffix_length = last_string.to_uint<u64>();
+        if (!suffix_length.has_value())
+            return {};
+        if (suffix_length.value() == 0 || file_size == 0)
+            return ByteRange { .is_satisfiable = false };
+        auto length = min(suffix_length.value(), file_size);
+        return ByteRange { .first = file_size - length, .length = length };
     }
 
-    auto stream = TRY(Core::Stream::File::open(real_path.bytes_as_string_view(), Core::Stream::OpenMode::Read));
+    auto first = first_string.to_uint<u64>();
+    if (!first.has_value())
+        return {};
+    if (first.value() >= file_size)
+        return ByteRange { .is_satisfiable = false };
+
+    auto last = file_size - 1;
+    if (!last_string.is_empty()) {
+        auto requested_last = last_string.to_uint<u64>();
+        if (!requested_last.has_value() || requested_last.value() < first.value())
+            return {};
+        last = min(requested_last.value(), last);
+    }
+    return ByteRange { .first = first.value(), .length = last - first.value() + 1 };
+}
 
-    auto const info = ContentInfo {
-        .type = TRY(String::from_deprecated_string(Core::guess_mime_type_based_on_filename(real_path.bytes_as_string_view()))),
-        .length = TRY(Core::File::size(real_path.bytes_as_string_view()))
-    };
-    TRY(send_response(*stream, request, move(info)));
-    return true;
+ErrorOr<void> Client::handle_file_request(HTTP::HttpRequest const& request, DeprecatedString const& real_path)
+{
+    auto entry_or_error = FileCache::the().open(real_path);
+    if (entry_or_error.is_error()) {
+        auto error_code = entry_or_error.error().code();
+        if (error_code == EACCES || error_code == EPERM)
+            return send_error_response(403, request);
+        if (error_code == ENOENT || error_code == ENOTDIR || error_code == EISDIR)
+            return send_error_response(404, request);
+        return entry_or_error.release_error();
+    }
+    auto entry = entry_or_error.release_value();
+
+    Vector<String> headers;
+    TRY(headers.try_append(TRY(String::formatted("ETag: {}", entry->etag()))));
+    TRY(headers.try_append(TRY(String::formatted("Last-Modified: {}", entry->last_modified_string()))));
+    TRY(headers.try_append(TRY(String::from_utf8("Accept-Ranges: bytes"sv))));
+
+    // https://www.rfc-editor.org/rfc/rfc9110#section-13.2.2
+    if (auto if_match = header_value(request, "If-Match"sv); if_match.has_value()) {
+        if (!entity_tag_list_matches(if_match.value(), entry->etag(), EntityTagComparison::Strong))
+            return send_error_response(412, request);
+    } else if (auto if_unmodified_since = header_value(request, "If-Unmodified-Since"sv); if_unmodified_since.has_value()) {
+        auto date = parse_http_date(if_unmodified_since.value());
+        if (date.has_value() && entry->last_modified() > date.value())
+            return send_error_response(412, request);
+    }
+
+    if (auto if_none_match = header_value(request, "If-None-Match"sv); if_none_match.has_value()) {
+        if (entity_tag_list_matches(if_none_match.value(), entry->etag(), EntityTagComparison::Weak))
+            return send_response({ .code = 304, .headers = move(headers) }, request);
+    } else if (auto if_modified_since = header_value(request, "If-Modified-Since"sv); if_modified_since.has_value()) {
+        auto date = parse_http_date(if_modified_since.value());
+        if (date.has_value() && entry->last_modified() <= date.value())
+            return send_response({ .code = 304, .headers = move(headers) }, request);
+    }
+
+    if (entry->mime_type() == "text/plain")
+        TRY(headers.try_append(TRY(String::formatted("Content-Type: {}; charset=utf-8", entry->mime_type()))));
+    else
+        TRY(headers.try_append(TRY(String::formatted("Content-Type: {}", entry->mime_type()))));
+
+    Response response { .code = 200, .headers = move(headers), .file = entry, .file_offset = 0, .file_length = entry->size() };
+
+    auto range = header_value(request, "Range"sv);
+    if (range.has_value() && request.method() == HTTP::HttpRequest::Method::GET) {
+        // If-Range makes the client get the whole file instead if it has changed since it got the first part.
+        bool range_applies = true;
+        if (auto if_range = header_value(request, "If-Range"sv); if_range.has_value()) {
+            if (if_range->starts_with('"'))
+                range_applies = if_range.value() == entry->etag();
+            else
+                range_applies = parse_http_date(if_range.value()) == entry->last_modified();
+        }
+
+        auto byte_range = range_applies ? parse_range(range.value(), entry->size()) : Optional<ByteRange> {};
+        if (byte_range.has_value() && !byte_range->is_satisfiable) {
+            Vector<String> error_headers;
+            TRY(error_headers.try_append(TRY(String::formatted("Content-Range: bytes */{}", entry->size()))));
+            return send_error_response(416, request, move(error_headers));
+        }
+        if (byte_range.has_value()) {
+            response.code = 206;
+            response.file_offset = byte_range->first;
+            response.file_length = byte_range->length;
+            TRY(response.headers.try_append(TRY(String::formatted("Content-Range: bytes {}-{}/{}", byte_range->first, byte_range->first + byte_range->length - 1, entry->size()))));
+        }
+    }
+
+    return send_response(move(response), request);
 }
 
-ErrorOr<void> Client::send_response(AK::Stream& response, HTTP::HttpRequest const& request, ContentInfo content_info)
+ErrorOr<void> Client::send_response(Response response, HTTP::HttpRequest const& request)
 {
     StringBuilder builder;
-    builder.append("HTTP/1.0 200 OK\r\n"sv);
+    builder.appendff("HTTP/1.1 {} {}\r\n", response.code, HTTP::HttpResponse::reason_phrase_for_code(response.code));
     builder.append("Server: WebServer (SerenityOS)\r\n"sv);
+    builder.appendff("Date: {}\r\n", format_http_date(time(nullptr)));
+    builder.append(m_keep_alive ? "Connection: keep-alive\r\n"sv : "Connection: close\r\n"sv);
     builder.append("X-Frame-Options: SAMEORIGIN\r\n"sv);
     builder.append("X-Content-Type-Options: nosniff\r\n"sv);
-    builder.append("Pragma: no-cache\r\n"sv);
-    if (content_info.type == "text/plain")
-        builder.appendff("Content-Type: {}; charset=utf-8\r\n", content_info.type);
-    else
-        builder.appendff("Content-Type: {}\r\n", content_info.type);
-    builder.appendff("Content-Length: {}\r\n", content_info.length);
-    builder.append("\r\n"sv);
-
-    auto builder_contents = builder.to_byte_buffer();
-    TRY(m_socket->write(builder_contents));
-    log_response(200, request);
-
-    char buffer[PAGE_SIZE];
-    do {
-        auto size = TRY(response.read({ buffer, sizeof(buffer) })).size();
-        if (response.is_eof() && size == 0)
-            break;
-
-        ReadonlyBytes write_buffer { buffer, size };
-        while (!write_buffer.is_empty()) {
-            auto nwritten = TRY(m_socket->write(write_buffer));
+    // Clients may keep what we send them, but have to ask whether it's still current before using it again.
+    builder.append("Cache-Control: no-cache\r\n"sv);
+    for (auto& header : response.headers) {
+        builder.append(header);
+        builder.append("\r\n"sv);
+    }
 
-            if (nwritten == 0) {
-                dbgln("EEEEEE got 0 bytes written!");
+    PendingResponse pending;
+    if (response.code != 304) {
+        auto content_length = response.file ? response.file_length : response.body.size();
+        builder.appendff("Content-Length: {}\r\n", content_length);
+        builder.append("\r\n"sv);
+
+        if (!m_is_head_request) {
+            if (response.file && !response.file->has_contents()) {
+                pending.file = move(response.file);
+                pending.file_offset = response.file_offset;
+                pending.file_remaining = response.file_length;
+            } else {
+                // Bodies we have in memory are small, so they go out in the same write as the headers.
+                auto body = response.file ? response.file->contents().slice(response.file_offset, response.file_length) : response.body.bytes();
+                builder.append(StringView { body });
             }
+        }
+    } else {
+        builder.append("\r\n"sv);
+    }
+    pending.head = builder.to_byte_buffer();
+
+    log_response(response.code, request);
+    m_pending_response = move(pending);
+    return flush_pending_response();
+}
 
-            write_buffer = write_buffer.slice(nwritten);
+ErrorOr<void> Client::flush_pending_response()
+{
+    VERIFY(m_pending_response.has_value());
+    auto& pending = m_pending_response.value();
+
+    while (pending.head_offset < pending.head.size()) {
+        auto nwritten_or_error = m_socket->write(pending.head.bytes().slice(pending.head_offset));
+        if (nwritten_or_error.is_error()) {
+            auto error_code = nwritten_or_error.error().code();
+            if (error_code == EAGAIN) {
+                m_write_notifier->set_enabled(true);
+                return {};
+            }
+            if (error_code == EINTR)
+                continue;
+            return nwritten_or_error.release_error();
         }
-    } while (true);
+        pending.head_offset += nwritten_or_error.value();
+    }
 
-    auto keep_alive = false;
-    if (auto it = request.headers().find_if([](auto& header) { return header.name.equals_ignoring_case("Connection"sv); }); !it.is_end()) {
-        if (it->value.trim_whitespace().equals_ignoring_case("keep-alive"sv))
-            keep_alive = true;
+    while (pending.file_remaining > 0) {
+        if (!TRY(send_file_chunk(pending))) {
+            m_write_notifier->set_enabled(true);
+            return {};
+        }
     }
-    if (!keep_alive)
-        m_socket->close();
 
+    did_finish_response();
     return {};
 }
 
-ErrorOr<void> Client::send_redirect(StringView redirect_path, HTTP::HttpRequest const& request)
+// Returns false if the socket can't take any more right now.
+ErrorOr<bool> Client::send_file_chunk(PendingResponse& pending)
 {
-    StringBuilder builder;
-    builder.append("HTTP/1.0 301 Moved Permanently\r\n"sv);
-    builder.append("Location: "sv);
-    builder.append(redirect_path);
-    builder.append("\r\n"sv);
-    builder.append("\r\n"sv);
+    auto& file = *pending.file;
+
+    auto did_send = [&](size_t nsent) -> ErrorOr<bool> {
+        // The file must have shrunk since we looked at it, and we already promised the client more.
+        if (nsent == 0)
+            return Error::from_errno(EIO);
+        pending.file_offset += nsent;
+        pending.file_remaining -= nsent;
+        return true;
+    };
 
-    auto builder_contents = builder.to_byte_buffer();
-    TRY(m_socket->write(builder_contents));
+    auto write_to_socket = [&](ReadonlyBytes bytes) -> ErrorOr<bool> {
+        auto nwritten_or_error = m_socket->write(bytes);
+        if (nwritten_or_error.is_error()) {
+            auto error_code = nwritten_or_error.error().code();
+            if (error_code == EAGAIN)
+                return false;
+            if (error_code == EINTR)
+                return true;
+            return nwritten_or_error.release_error();
+        }
+        return did_send(nwritten_or_error.value());
+    };
 
-    log_response(301, request);
-    return {};
+#ifdef AK_OS_SERENITY
+    // Let the kernel feed the file straight into the socket, so the contents never pass through our buffers.
+    // The file descriptor is shared with other clients, so we always say where to read from.
+    off_t offset = pending.file_offset;
+    auto nsent_or_error = Core::System::sendfile(m_socket->fd(), file.fd(), &offset, min(pending.file_remaining, sendfile_chunk_size));
+    if (!nsent_or_error.is_error())
+        return did_send(nsent_or_error.value());
+    auto error_code = nsent_or_error.error().code();
+    if (error_code == EAGAIN)
+        return false;
+    if (error_code == EINTR)
+        return true;
+    if (error_code != ENOSYS && error_code != ENOTSUP)
+        return nsent_or_error.release_error();
+#endif
+
+    // Whatever sendfile() can't handle is copied over by hand.
+    u8 buffer[PAGE_SIZE];
+    auto nread = pread(file.fd(), buffer, min(sizeof(buffer), pending.file_remaining), pending.file_offset);
+    if (nread < 0)
+        return Error::from_syscall("pread"sv, -errno);
+    if (nread == 0)
+        return did_send(0);
+    return write_to_socket({ buffer, static_cast<size_t>(nread) });
+}
+
+void Client::did_finish_response()
+{
+    m_pending_response.clear();
+    if (!m_keep_alive) {
+        die();
+        return;
+    }
+    m_socket->set_notifications_enabled(true);
+    m_idle_timer->restart();
+}
+
+ErrorOr<void> Client::send_redirect(StringView redirect_path, HTTP::HttpRequest const& request)
+{
+    Vector<String> headers;
+    TRY(headers.try_append(TRY(String::formatted("Location: {}", redirect_path))));
+    return send_response({ .code = 301, .headers = move(headers) }, request);
 }
 
 static DeprecatedString folder_image_data()
@@ -335,12 +629,12 @@ ErrorOr<void> Client::handle_directory_listing(String const& requested_path, Str
     builder.append("</body>\n"sv);
     builder.append("</html>\n"sv);
 
-    auto response = builder.to_deprecated_string();
-    FixedMemoryStream stream { response.bytes() };
-    return send_response(stream, request, { .type = TRY(String::from_utf8("text/html"sv)), .length = response.length() });
+    Vector<String> headers;
+    TRY(headers.try_append(TRY(String::from_utf8("Content-Type: text/html"sv))));
+    return send_response({ .code = 200, .headers = move(headers), .body = builder.to_byte_buffer() }, request);
 }
 
-ErrorOr<void> Client::send_error_response(unsigned code, HTTP::HttpRequest const& request, Vector<String> const& headers)
+ErrorOr<void> Client::send_error_response(unsigned code, HTTP::HttpRequest const& request, Vector<String> headers)
 {
     auto reason_phrase = HTTP::HttpResponse::reason_phrase_for_code(code);
 
@@ -350,23 +644,8 @@ ErrorOr<void> Client::send_error_response(unsigned code, HTTP::HttpRequest const
     content_builder.append(reason_phrase);
     content_builder.append("</h1></body></html>"sv);
 
-    StringBuilder header_builder;
-    header_builder.appendff("HTTP/1.0 {} ", code);
-    header_builder.append(reason_phrase);
-    header_builder.append("\r\n"sv);
-
-    for (auto& header : headers) {
-        header_builder.append(header);
-        header_builder.append("\r\n"sv);
-    }
-    header_builder.append("Content-Type: text/html; charset=UTF-8\r\n"sv);
-    header_builder.appendff("Content-Length: {}\r\n", content_builder.length());
-    header_builder.append("\r\n"sv);
-    TRY(m_socket->write(header_builder.to_byte_buffer()));
-    TRY(m_socket->write(content_builder.to_byte_buffer()));
-
-    log_response(code, request);
-    return {};
+    TRY(headers.try_append(TRY(String::from_utf8("Content-Type: text/html; charset=UTF-8"sv))));
+    return send_response({ .code = code, .headers = move(headers), .body = content_builder.to_byte_buffer() }, request);
 }
 
 void Client::log_response(unsigned code, HTTP::HttpRequest const& request)
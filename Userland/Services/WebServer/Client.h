@@ -7,11 +7,15 @@
 
 #pragma once
 
+#include <AK/ByteBuffer.h>
 #include <AK/String.h>
+#include <LibCore/Notifier.h>
 #include <LibCore/Object.h>
 #include <LibCore/Stream.h>
+#include <LibCore/Timer.h>
 #include <LibHTTP/Forward.h>
 #include <LibHTTP/HttpRequest.h>
+#include <WebServer/FileCache.h>
 
 namespace WebServer {
 
@@ -19,26 +23,52 @@ class Client final : public Core::Object {
     C_OBJECT(Client);
 
 public:
-    void start();
+    ErrorOr<void> start();
 
 private:
-    Client(NonnullOwnPtr<Core::Stream::BufferedTCPSocket>, Core::Object* parent);
+    Client(NonnullOwnPtr<Core::Stream::TCPSocket>, Core::Object* parent);
 
-    struct ContentInfo {
-        String type;
-        size_t length {};
+    struct Response {
+        unsigned code { 200 };
+        Vector<String> headers;
+        ByteBuffer body;
+        // If set, the body is this part of the file instead.
+        RefPtr<FileCache::Entry> file;
+        u64 file_offset { 0 };
+        size_t file_length { 0 };
     };
 
-    ErrorOr<bool> handle_request(ReadonlyBytes);
-    ErrorOr<void> send_response(AK::Stream&, HTTP::HttpRequest const&, ContentInfo);
+    // What's left to write of the response we're currently sending.
+    struct PendingResponse {
+        ByteBuffer head;
+        size_t head_offset { 0 };
+        RefPtr<FileCache::Entry> file;
+        u64 file_offset { 0 };
+        size_t file_remaining { 0 };
+    };
+
+    void on_ready_to_read();
+    void handle_buffered_requests();
+    ErrorOr<void> handle_request(ReadonlyBytes);
+    ErrorOr<void> handle_file_request(HTTP::HttpRequest const&, DeprecatedString const& real_path);
+    ErrorOr<void> send_response(Response, HTTP::HttpRequest const&);
     ErrorOr<void> send_redirect(StringView redirect, HTTP::HttpRequest const&);
-    ErrorOr<void> send_error_response(unsigned code, HTTP::HttpRequest const&, Vector<String> const& headers = {});
+    ErrorOr<void> send_error_response(unsigned code, HTTP::HttpRequest const&, Vector<String> headers = {});
+    ErrorOr<void> flush_pending_response();
+    ErrorOr<bool> send_file_chunk(PendingResponse&);
+    void did_finish_response();
     void die();
     void log_response(unsigned code, HTTP::HttpRequest const&);
     ErrorOr<void> handle_directory_listing(String const& requested_path, String const& real_path, HTTP::HttpRequest const&);
     bool verify_credentials(Vector<HTTP::HttpRequest::Header> const&);
 
-    NonnullOwnPtr<Core::Stream::BufferedTCPSocket> m_socket;
+    NonnullOwnPtr<Core::Stream::TCPSocket> m_socket;
+    ByteBuffer m_request_buffer;
+    Optional<PendingResponse> m_pending_response;
+    bool m_keep_alive { false };
+    bool m_is_head_request { false };
+    RefPtr<Core::Notifier> m_write_notifier;
+    RefPtr<Core::Timer> m_idle_timer;
 };
 
 }
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/Debug.h>
+#include <LibCore/DateTime.h>
+#include <LibCore/MimeData.h>
+#include <LibCore/System.h>
+#include <WebServer/FileCache.h>
+#include <fcntl.h>
+#include <time.h>
+
+namespace WebServer {
+
+// How long we trust an entry before checking whether the file has changed in the meantime.
+static constexpr Time revalidation_interval = Time::from_seconds(1);
+static constexpr size_t max_entry_count = 256;
+static constexpr size_t max_in_memory_file_size = 64 * KiB;
+static constexpr size_t max_memory_size = 8 * MiB;
+
+FileCache::Entry::~Entry()
+{
+    if (m_fd >= 0)
+        (void)Core::System::close(m_fd);
+}
+
+FileCache& FileCache::the()
+{
+    static FileCache s_the;
+    return s_the;
+}
+
+bool FileCache::is_unchanged(Entry const& entry, struct stat const& st)
+{
+    return entry.m_device == st.st_dev
+        && entry.m_inode == st.st_ino
+        && entry.m_size == static_cast<size_t>(st.st_size)
+        && entry.m_last_modified == st.st_mtime;
+}
+
+ErrorOr<NonnullRefPtr<FileCache::Entry>> FileCache::open(DeprecatedString const& path)
+{
+    auto now = Time::now_monotonic_coarse();
+
+    if (auto it = m_entries.find(path); it != m_entries.end()) {
+        NonnullRefPtr<Entry> entry = it->value;
+        if (now - entry->m_last_validated < revalidation_interval) {
+            m_lru_list.append(*entry);
+            return entry;
+        }
+
+        auto st = TRY(Core::System::stat(path));
+        if (is_unchanged(*entry, st)) {
+            entry->m_last_validated = now;
+            m_lru_list.append(*entry);
+            return entry;
+        }
+
+        dbgln_if(WEBSERVER_DEBUG, "FileCache: {} has changed", path);
+        remove(*entry);
+        return create_entry(path, st);
+    }
+
+    auto st = TRY(Core::System::stat(path));
+    return create_entry(path, st);
+}
+
+ErrorOr<NonnullRefPtr<FileCache::Entry>> FileCache::create_entry(DeprecatedString const& path, struct stat const& st)
+{
+    if (S_ISDIR(st.st_mode))
+        return Error::from_errno(EISDIR);
+    if (!S_ISREG(st.st_mode))
+        return Error::from_errno(EACCES);
+
+    auto entry = TRY(adopt_nonnull_ref_or_enomem(new (nothrow) Entry));
+    entry->m_path = path;
+    entry->m_device = st.st_dev;
+    entry->m_inode = st.st_ino;
+    entry->m_size = st.st_size;
+    entry->m_last_modified = st.st_mtime;
+    entry->m_last_modified_string = format_http_date(st.st_mtime);
+    entry->m_etag = DeprecatedString::formatted("\"{:x}-{:x}-{:x}\"", st.st_ino, st.st_size, st.st_mtime);
+    entry->m_mime_type = Core::guess_mime_type_based_on_filename(path);
+    entry->m_last_validated = Time::now_monotonic_coarse();
+    entry->m_fd = TRY(Core::System::open(path, O_RDONLY | O_CLOEXEC));
+
+    if (entry->m_size <= max_in_memory_file_size) {
+        entry->m_contents = TRY(ByteBuffer::create_uninitialized(entry->m_size));
+        size_t nread = 0;
+        while (nread < entry->m_size) {
+            auto result = TRY(Core::System::read(entry->m_fd, entry->m_contents.bytes().slice(nread)));
+            if (result == 0)
+                break;
+            nread += result;
+        }
+        // The file shrank while we were reading it, so go with what we got.
+        if (nread < entry->m_size) {
+            entry->m_contents.resize(nread);
+            entry->m_size = nread;
+        }
+        (void)Core::System::close(entry->m_fd);
+        entry->m_fd = -1;
+        entry->m_has_contents = true;
+        m_memory_size += entry->m_size;
+    }
+
+    dbgln_if(WEBSERVER_DEBUG, "FileCache: Added {} ({} bytes, {})", path, entry->m_size, entry->m_has_contents ? "in memory" : "kept open");
+    TRY(m_entries.try_set(path, entry));
+    m_lru_list.append(*entry);
+    evict_if_needed();
+    return entry;
+}
+
+void FileCache::remove(Entry& entry)
+{
+    if (entry.m_has_contents)
+        m_memory_size -= entry.m_size;
+    m_lru_list.remove(entry);
+    m_entries.remove(entry.m_path);
+}
+
+void FileCache::evict_if_needed()
+{
+    // Entries that are still being sent stay alive until the client is done with them.
+    while (m_entries.size() > max_entry_count || m_memory_size > max_memory_size) {
+        auto entry = m_lru_list.first();
+        VERIFY(entry);
+        dbgln_if(WEBSERVER_DEBUG, "FileCache: Evicting {}", entry->m_path);
+        remove(*entry);
+    }
+}
+
+DeprecatedString format_http_date(time_t time)
+{
+    static constexpr Array day_names { "Sun"sv, "Mon"sv, "Tue"sv, "Wed"sv, "Thu"sv, "Fri"sv, "Sat"sv };
+    static constexpr Array month_names { "Jan"sv, "Feb"sv, "Mar"sv, "Apr"sv, "May"sv, "Jun"sv, "Jul"sv, "Aug"sv, "Sep"sv, "Oct"sv, "Nov"sv, "Dec"sv };
+
+    struct tm tm;
+    gmtime_r(&time, &tm);
+    return DeprecatedString::formatted("{}, {:02} {} {} {:02}:{:02}:{:02} GMT", day_names[tm.tm_wday], tm.tm_mday, month_names[tm.tm_mon],
+        tm.tm_year + 1900, tm.tm_hour, tm.tm_min, tm.tm_sec);
+}
+
+// Only understands the preferred format, e.g. "Sun, 06 Nov 1994 08:49:37 GMT", which is what clients send us back.
+Optional<time_t> parse_http_date(StringView value)
+{
+    if (!value.ends_with(" GMT"sv))
+        return {};
+    auto date = Core::DateTime::parse("%a, %d %b %Y %H:%M:%S %z"sv, DeprecatedString::formatted("{} +0000", value.substring_view(0, value.length() - 4)));
+    if (!date.has_value())
+        return {};
+    return date->timestamp();
+}
+
+}
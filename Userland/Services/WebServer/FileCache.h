@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/DeprecatedString.h>
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/RefCounted.h>
+#include <AK/Time.h>
+#include <sys/stat.h>
+
+namespace WebServer {
+
+// Remembers the files we served recently, so repeated requests for them can skip the stat(), open() and
+// MIME type guessing. Small files are kept in memory entirely, bigger ones are kept open and sent from
+// their file descriptor. Every worker process has a cache of its own.
+class FileCache {
+public:
+    class Entry : public RefCounted<Entry> {
+    public:
+        ~Entry();
+
+        DeprecatedString const& path() const { return m_path; }
+        size_t size() const { return m_size; }
+        time_t last_modified() const { return m_last_modified; }
+        DeprecatedString const& last_modified_string() const { return m_last_modified_string; }
+        DeprecatedString const& etag() const { return m_etag; }
+        DeprecatedString const& mime_type() const { return m_mime_type; }
+
+        // Only small files are kept in memory, everything else has to be read from fd().
+        bool has_contents() const { return m_has_contents; }
+        ReadonlyBytes contents() const { return m_contents.bytes(); }
+        int fd() const { return m_fd; }
+
+    private:
+        friend class FileCache;
+
+        DeprecatedString m_path;
+        dev_t m_device { 0 };
+        ino_t m_inode { 0 };
+        size_t m_size { 0 };
+        time_t m_last_modified { 0 };
+        DeprecatedString m_last_modified_string;
+        DeprecatedString m_etag;
+        DeprecatedString m_mime_type;
+
+        bool m_has_contents { false };
+        ByteBuffer m_contents;
+        int m_fd { -1 };
+
+        Time m_last_validated;
+
+        IntrusiveListNode<Entry, RefPtr<Entry>> m_lru_list_node;
+
+    public:
+        using LRUList = IntrusiveList<&Entry::m_lru_list_node>;
+    };
+
+    static FileCache& the();
+
+    // Fails with ENOENT, EISDIR or EACCES (for devices and the like) if the path isn't a regular file we can serve.
+    ErrorOr<NonnullRefPtr<Entry>> open(DeprecatedString const& path);
+
+private:
+    FileCache() = default;
+
+    ErrorOr<NonnullRefPtr<Entry>> create_entry(DeprecatedString const& path, struct stat const&);
+    static bool is_unchanged(Entry const&, struct stat const&);
+    void remove(Entry&);
+    void evict_if_needed();
+
+    HashMap<DeprecatedString, NonnullRefPtr<Entry>> m_entries;
+    Entry::LRUList m_lru_list;
+    size_t m_memory_size { 0 };
+};
+
+DeprecatedString format_http_date(time_t);
+Optional<time_t> parse_http_date(StringView);
+
+}
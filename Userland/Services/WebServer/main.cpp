@@ -6,20 +6,151 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
 #include <AK/String.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/File.h>
-#include <LibCore/MappedFile.h>
+#include <LibCore/Notifier.h>
+#include <LibCore/SocketAddress.h>
+#include <LibCore/Stream.h>
 #include <LibCore/System.h>
-#include <LibCore/TCPServer.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibMain/Main.h>
 #include <WebServer/Client.h>
 #include <WebServer/Configuration.h>
+#include <signal.h>
 #include <stdio.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
+static constexpr int listen_backlog = 64;
+static constexpr size_t max_worker_count = 64;
+
+static Array<pid_t, max_worker_count> s_worker_pids {};
+
+static ErrorOr<int> create_listening_socket(IPv4Address const& address, u16 port)
+{
+    int fd = TRY(Core::System::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0));
+    auto socket_address = Core::SocketAddress(address, port).to_sockaddr_in();
+    TRY(Core::System::bind(fd, reinterpret_cast<sockaddr const*>(&socket_address), sizeof(socket_address)));
+    TRY(Core::System::listen(fd, listen_backlog));
+    return fd;
+}
+
+static ErrorOr<int> run_worker(int listen_fd)
+{
+    // sendfile() raises SIGPIPE if the client has gone away, which we find out about from the error anyway.
+    TRY(Core::System::signal(SIGPIPE, SIG_IGN));
+
+    TRY(Core::System::pledge("stdio accept rpath"));
+
+    Core::EventLoop loop;
+
+    auto listen_notifier = Core::Notifier::construct(listen_fd, Core::Notifier::Event::Read);
+    listen_notifier->on_ready_to_read = [&] {
+        // All workers wait on the same socket, so another one may have taken the connection already.
+        for (;;) {
+            auto maybe_client_fd = Core::System::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (maybe_client_fd.is_error()) {
+                if (maybe_client_fd.error().code() != EAGAIN)
+                    warnln("Failed to accept the client: {}", maybe_client_fd.error());
+                return;
+            }
+
+            auto maybe_client_socket = Core::Stream::TCPSocket::adopt_fd(maybe_client_fd.value());
+            if (maybe_client_socket.is_error()) {
+                warnln("Could not obtain a socket for the client: {}", maybe_client_socket.error());
+                (void)Core::System::close(maybe_client_fd.value());
+                continue;
+            }
+
+            auto client = WebServer::Client::construct(maybe_client_socket.release_value(), listen_notifier.ptr());
+            if (auto result = client->start(); result.is_error()) {
+                warnln("Failed to start handling the client: {}", result.error());
+                client->remove_from_parent();
+            }
+        }
+    };
+
+    return loop.exec();
+}
+
+static ErrorOr<pid_t> spawn_worker(int listen_fd)
+{
+    // Otherwise, whatever we haven't written out yet would be written by every worker.
+    fflush(stdout);
+    pid_t pid = TRY(Core::System::fork());
+    if (pid != 0)
+        return pid;
+
+    // Forget about the supervisor's signal handlers, which are inherited by the workers it starts over.
+    MUST(Core::System::signal(SIGTERM, SIG_DFL));
+    MUST(Core::System::signal(SIGINT, SIG_DFL));
+    auto result = run_worker(listen_fd);
+    if (result.is_error()) {
+        warnln("Worker failed: {}", result.error());
+        _exit(1);
+    }
+    _exit(result.value());
+}
+
+static void stop_workers()
+{
+    for (auto pid : s_worker_pids) {
+        if (pid > 0)
+            (void)kill(pid, SIGTERM);
+    }
+}
+
+// The workers do all the serving, we just start them and start them again if they crash.
+static ErrorOr<int> supervise_workers(int listen_fd, size_t worker_count)
+{
+    for (size_t i = 0; i < worker_count; ++i)
+        s_worker_pids[i] = TRY(spawn_worker(listen_fd));
+
+    auto handle_termination = [](int signal) {
+        stop_workers();
+        _exit(128 + signal);
+    };
+    TRY(Core::System::signal(SIGTERM, handle_termination));
+    TRY(Core::System::signal(SIGINT, handle_termination));
+
+    // Workers that we start over have to reset the signal handlers they inherit from us, so we keep sigaction for them.
+    TRY(Core::System::pledge("stdio accept rpath proc sigaction"));
+
+    for (;;) {
+        auto maybe_result = Core::System::waitpid(-1);
+        if (maybe_result.is_error()) {
+            if (maybe_result.error().code() == EINTR)
+                continue;
+            stop_workers();
+            return maybe_result.release_error();
+        }
+        auto result = maybe_result.release_value();
+
+        Optional<size_t> index;
+        for (size_t i = 0; i < worker_count; ++i) {
+            if (s_worker_pids[i] == result.pid)
+                index = i;
+        }
+        if (!index.has_value())
+            continue;
+
+        if (WIFSIGNALED(result.status)) {
+            warnln("Worker {} was terminated by signal {}, starting a new one", result.pid, WTERMSIG(result.status));
+            s_worker_pids[index.value()] = TRY(spawn_worker(listen_fd));
+            continue;
+        }
+
+        // Workers only exit by themselves if something went wrong that another one won't do better at.
+        s_worker_pids[index.value()] = 0;
+        stop_workers();
+        return WIFEXITED(result.status) ? WEXITSTATUS(result.status) : 1;
+    }
+}
+
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
     static auto const default_listen_address = TRY(String::from_utf8("0.0.0.0"sv));
@@ -31,12 +162,14 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     DeprecatedString username;
     DeprecatedString password;
     DeprecatedString document_root_path = default_document_root_path.to_deprecated_string();
+    size_t worker_count = clamp(sysconf(_SC_NPROCESSORS_ONLN), 1, static_cast<long>(max_worker_count));
 
     Core::ArgsParser args_parser;
     args_parser.add_option(listen_address, "IP address to listen on", "listen-address", 'l', "listen_address");
     args_parser.add_option(port, "Port to listen on", "port", 'p', "port");
     args_parser.add_option(username, "HTTP basic authentication username", "user", 'U', "username");
     args_parser.add_option(password, "HTTP basic authentication password", "pass", 'P', "password");
+    args_parser.add_option(worker_count, "Number of worker processes (defaults to one per CPU)", "workers", 'w', "workers");
     args_parser.add_positional_argument(document_root_path, "Path to serve the contents of", "path", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
 
@@ -51,6 +184,11 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         return 1;
     }
 
+    if (worker_count == 0 || worker_count > max_worker_count) {
+        warnln("The number of workers has to be between 1 and {}", max_worker_count);
+        return 1;
+    }
+
     if (username.is_empty() != password.is_empty()) {
         warnln("Both username and password are required for HTTP basic authentication.");
         return 1;
@@ -62,7 +200,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         return 1;
     }
 
-    TRY(Core::System::pledge("stdio accept rpath inet unix"));
+    TRY(Core::System::pledge("stdio accept rpath inet unix proc sigaction"));
 
     Optional<HTTP::HttpRequest::BasicAuthenticationCredentials> credentials;
     if (!username.is_empty() && !password.is_empty())
@@ -70,30 +208,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
     WebServer::Configuration configuration(real_document_root_path, credentials);
 
-    Core::EventLoop loop;
-
-    auto server = TRY(Core::TCPServer::try_create());
-
-    server->on_ready_to_accept = [&] {
-        auto maybe_client_socket = server->accept();
-        if (maybe_client_socket.is_error()) {
-            warnln("Failed to accept the client: {}", maybe_client_socket.error());
-            return;
-        }
-
-        auto maybe_buffered_socket = Core::Stream::BufferedTCPSocket::create(maybe_client_socket.release_value());
-        if (maybe_buffered_socket.is_error()) {
-            warnln("Could not obtain a buffered socket for the client: {}", maybe_buffered_socket.error());
-            return;
-        }
-
-        // FIXME: Propagate errors
-        MUST(maybe_buffered_socket.value()->set_blocking(true));
-        auto client = WebServer::Client::construct(maybe_buffered_socket.release_value(), server);
-        client->start();
-    };
-
-    TRY(server->listen(ipv4_address.value(), port));
+    int listen_fd = TRY(create_listening_socket(ipv4_address.value(), port));
 
     out("Listening on ");
     out("\033]8;;http://{}:{}\033\\", ipv4_address.value(), port);
@@ -105,6 +220,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     TRY(Core::System::unveil(real_document_root_path, "r"sv));
     TRY(Core::System::unveil(nullptr, nullptr));
 
-    TRY(Core::System::pledge("stdio accept rpath"));
-    return loop.exec();
+    if (worker_count == 1)
+        return run_worker(listen_fd);
+    return supervise_workers(listen_fd, worker_count);
 }
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/DeprecatedString.h>
+#include <AK/NumberFormat.h>
+#include <AK/ScopeGuard.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/System.h>
+#include <LibMain/Main.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+// Returns the number of runs of physically consecutive blocks in the file, or an error if FIBMAP isn't allowed.
+static ErrorOr<size_t> count_extents(int fd)
+{
+    auto st = TRY(Core::System::fstat(fd));
+    if (st.st_blksize <= 0)
+        return Error::from_errno(ENOTSUP);
+    size_t block_count = ceil_div(static_cast<u64>(st.st_size), static_cast<u64>(st.st_blksize));
+
+    size_t extent_count = 0;
+    int previous_block = 0;
+    for (size_t i = 0; i < block_count; ++i) {
+        int block = static_cast<int>(i);
+        TRY(Core::System::ioctl(fd, FIBMAP, &block));
+        if (block != 0 && (previous_block == 0 || block != previous_block + 1))
+            extent_count++;
+        previous_block = block;
+    }
+    return extent_count;
+}
+
+ErrorOr<int> serenity_main(Main::Arguments arguments)
+{
+    StringView directory = "/tmp"sv;
+    size_t file_count = 4;
+    size_t append_size = 512;
+    size_t total_size = 4 * MiB;
+    bool keep_files = false;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure how fast several files can be grown by small appends, and how fragmented they end up.");
+    args_parser.add_option(file_count, "Number of files to append to in turn", "files", 'f', "files");
+    args_parser.add_option(append_size, "Size of each append", "append-size", 'a', "append-size");
+    args_parser.add_option(total_size, "Size each file grows to", "size", 's', "size");
+    args_parser.add_option(keep_files, "Don't delete the files afterwards", "keep", 'k');
+    args_parser.add_positional_argument(directory, "Directory to create the files in", "directory", Core::ArgsParser::Required::No);
+    args_parser.parse(arguments);
+
+    if (file_count == 0 || append_size == 0 || total_size == 0) {
+        warnln("The number of files, append size and size have to be positive");
+        return 1;
+    }
+
+    Vector<DeprecatedString> paths;
+    Vector<int> fds;
+    ScopeGuard cleanup = [&] {
+        for (auto fd : fds)
+            (void)Core::System::close(fd);
+        if (!keep_files) {
+            for (auto const& path : paths)
+                (void)Core::System::unlink(path);
+        }
+    };
+
+    for (size_t i = 0; i < file_count; ++i) {
+        auto path = DeprecatedString::formatted("{}/append_benchmark.{}.{}", directory, getpid(), i);
+        int fd = TRY(Core::System::open(path, O_CREAT | O_EXCL | O_WRONLY | O_APPEND, 0644));
+        TRY(paths.try_append(path));
+        TRY(fds.try_append(fd));
+    }
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(append_size));
+    buffer.bytes().fill('x');
+
+    auto timer = Core::ElapsedTimer::start_new();
+
+    // Take turns appending to every file, like a few log files or a database and its journal would.
+    for (size_t written = 0; written < total_size; written += append_size) {
+        auto chunk = buffer.bytes().trim(total_size - written);
+        for (auto fd : fds)
+            TRY(Core::System::write(fd, chunk));
+    }
+    for (auto fd : fds)
+        TRY(Core::System::fsync(fd));
+
+    auto elapsed_milliseconds = max<i64>(timer.elapsed(), 1);
+    u64 total_bytes = static_cast<u64>(file_count) * total_size;
+    u64 total_appends = static_cast<u64>(file_count) * ceil_div(total_size, append_size);
+    outln("{} appends of {} to {} files in {}ms: {} appends/s, {}/s", total_appends, human_readable_size(append_size), file_count, elapsed_milliseconds,
+        total_appends * 1000 / elapsed_milliseconds, human_readable_size(total_bytes * 1000 / elapsed_milliseconds));
+
+    size_t total_extents = 0;
+    for (auto fd : fds) {
+        auto extent_count_or_error = count_extents(fd);
+        if (extent_count_or_error.is_error()) {
+            if (extent_count_or_error.error().code() == EPERM)
+                outln("Run as root to see how fragmented the files are");
+            return 0;
+        }
+        total_extents += extent_count_or_error.value();
+    }
+    outln("{} extents in total, {}.{:02} extents per file", total_extents, total_extents / file_count, (total_extents * 100 / file_count) % 100);
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/DeprecatedString.h>
+#include <AK/NumberFormat.h>
+#include <AK/Random.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/Stream.h>
+#include <LibCore/System.h>
+#include <LibMain/Main.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/sysmacros.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct RequestQueueStatistics {
+    u64 submitted_requests { 0 };
+    u64 merged_requests { 0 };
+    u64 dispatched_requests { 0 };
+};
+
+static ErrorOr<u64> read_statistic(StringView directory, StringView name)
+{
+    auto file = TRY(Core::Stream::File::open(DeprecatedString::formatted("{}/{}", directory, name), Core::Stream::OpenMode::Read));
+    auto contents = TRY(file->read_until_eof());
+    auto value = StringView(contents.bytes()).trim_whitespace().to_uint<u64>();
+    if (!value.has_value())
+        return Error::from_string_literal("Invalid request queue statistic");
+    return value.value();
+}
+
+static ErrorOr<RequestQueueStatistics> read_request_queue_statistics(StringView directory)
+{
+    RequestQueueStatistics statistics;
+    statistics.submitted_requests = TRY(read_statistic(directory, "submitted_requests"sv));
+    statistics.merged_requests = TRY(read_statistic(directory, "merged_requests"sv));
+    statistics.dispatched_requests = TRY(read_statistic(directory, "dispatched_requests"sv));
+    return statistics;
+}
+
+static ErrorOr<void> run_job(int fd, size_t job_index, size_t job_count, size_t block_size, size_t request_count, u64 device_block_count, bool random)
+{
+    auto buffer = TRY(ByteBuffer::create_uninitialized(block_size));
+    for (size_t i = 0; i < request_count; ++i) {
+        // Without --random, the jobs take turns reading neighbouring blocks, so their requests can be merged.
+        u64 block_index = random ? get_random_uniform(static_cast<u32>(min<u64>(device_block_count, NumericLimits<u32>::max()))) : (i * job_count + job_index) % device_block_count;
+        auto nread = pread(fd, buffer.data(), block_size, static_cast<off_t>(block_index * block_size));
+        if (nread < 0)
+            return Error::from_syscall("pread"sv, -errno);
+    }
+    return {};
+}
+
+ErrorOr<int> serenity_main(Main::Arguments arguments)
+{
+    StringView device_path;
+    size_t job_count = 4;
+    size_t block_size = 4 * KiB;
+    size_t request_count = 1024;
+    bool random = false;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure how many read requests per second a storage device handles when several processes read from it at once.");
+    args_parser.add_option(job_count, "Number of processes reading at once", "jobs", 'j', "jobs");
+    args_parser.add_option(block_size, "Size of each read", "block-size", 'b', "block-size");
+    args_parser.add_option(request_count, "Number of reads per process", "count", 'c', "count");
+    args_parser.add_option(random, "Read from random offsets instead of neighbouring ones", "random", 'r');
+    args_parser.add_positional_argument(device_path, "Storage device to read from", "device");
+    args_parser.parse(arguments);
+
+    if (job_count == 0 || block_size == 0 || request_count == 0) {
+        warnln("The number of jobs, block size and count have to be positive");
+        return 1;
+    }
+
+    int fd = TRY(Core::System::open(device_path, O_RDONLY));
+
+    u64 device_size = 0;
+    TRY(Core::System::ioctl(fd, STORAGE_DEVICE_GET_SIZE, &device_size));
+    u64 device_block_count = device_size / block_size;
+    if (device_block_count == 0) {
+        warnln("The device is smaller than a single block");
+        return 1;
+    }
+
+    auto device_stat = TRY(Core::System::fstat(fd));
+    auto statistics_directory = DeprecatedString::formatted("/sys/dev/block/{}:{}", major(device_stat.st_rdev), minor(device_stat.st_rdev));
+    auto statistics_before = read_request_queue_statistics(statistics_directory);
+
+    auto timer = Core::ElapsedTimer::start_new();
+
+    Vector<pid_t> child_pids;
+    for (size_t job_index = 0; job_index < job_count; ++job_index) {
+        pid_t child_pid = TRY(Core::System::fork());
+        if (child_pid == 0) {
+            if (auto result = run_job(fd, job_index, job_count, block_size, request_count, device_block_count, random); result.is_error()) {
+                warnln("Reading failed: {}", result.error());
+                _exit(1);
+            }
+            _exit(0);
+        }
+        TRY(child_pids.try_append(child_pid));
+    }
+
+    bool failed = false;
+    for (auto child_pid : child_pids) {
+        auto wait_result = TRY(Core::System::waitpid(child_pid));
+        if (!WIFEXITED(wait_result.status) || WEXITSTATUS(wait_result.status) != 0)
+            failed = true;
+    }
+    auto elapsed_milliseconds = max<i64>(timer.elapsed(), 1);
+    if (failed)
+        return 1;
+
+    u64 total_requests = static_cast<u64>(job_count) * request_count;
+    u64 total_bytes = total_requests * block_size;
+    outln("{} reads of {} in {}ms: {} IOPS, {}/s", total_requests, human_readable_size(block_size), elapsed_milliseconds,
+        total_requests * 1000 / elapsed_milliseconds, human_readable_size(total_bytes * 1000 / elapsed_milliseconds));
+
+    auto statistics_after = read_request_queue_statistics(statistics_directory);
+    if (statistics_before.is_error() || statistics_after.is_error())
+        return 0;
+
+    auto submitted_requests = statistics_after.value().submitted_requests - statistics_before.value().submitted_requests;
+    auto merged_requests = statistics_after.value().merged_requests - statistics_before.value().merged_requests;
+    auto dispatched_requests = max<u64>(statistics_after.value().dispatched_requests - statistics_before.value().dispatched_requests, 1);
+    outln("{} requests submitted, {} merged, {} sent to the device ({}.{:02} requests per command)", submitted_requests, merged_requests, dispatched_requests,
+        submitted_requests / dispatched_requests, (submitted_requests * 100 / dispatched_requests) % 100);
+
+    return 0;
+}
@@ -5,17 +5,20 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/ByteBuffer.h>
 #include <AK/DeprecatedString.h>
 #include <AK/ScopeGuard.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
+#include <Kernel/API/IORing.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/ElapsedTimer.h>
 #include <LibCore/System.h>
 #include <LibMain/Main.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -39,7 +42,105 @@ static Result average_result(Vector<Result> const& results)
     return average;
 }
 
-static ErrorOr<Result> benchmark(DeprecatedString const& filename, int file_size, ByteBuffer& buffer, bool allow_cache);
+class IORing {
+public:
+    static ErrorOr<IORing> create(u32 entry_count)
+    {
+        int fd = TRY(Core::System::io_ring_create(entry_count, O_CLOEXEC));
+        auto size = io_ring_size(entry_count);
+        auto* base = TRY(Core::System::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0, 0, "IORing"sv));
+        return IORing { fd, static_cast<u8*>(base), size, entry_count };
+    }
+
+    IORing(IORing&& other)
+        : m_fd(exchange(other.m_fd, -1))
+        , m_base(exchange(other.m_base, nullptr))
+        , m_size(other.m_size)
+        , m_entry_count(other.m_entry_count)
+    {
+    }
+
+    ~IORing()
+    {
+        if (m_base)
+            (void)Core::System::munmap(m_base, m_size);
+        if (m_fd >= 0)
+            (void)Core::System::close(m_fd);
+    }
+
+    u32 entry_count() const { return m_entry_count; }
+
+    // Runs all the transfers, keeping up to queue_depth of them in flight.
+    // The buffer is split into one block per transfer in flight.
+    ErrorOr<void> transfer(IORingOpcode, int fd, size_t total_size, Bytes buffer, size_t queue_depth);
+
+private:
+    IORing(int fd, u8* base, size_t size, u32 entry_count)
+        : m_fd(fd)
+        , m_base(base)
+        , m_size(size)
+        , m_entry_count(entry_count)
+    {
+    }
+
+    IORingHeader& header() { return *reinterpret_cast<IORingHeader*>(m_base); }
+    IORingSubmission* submissions() { return reinterpret_cast<IORingSubmission*>(m_base + io_ring_submissions_offset()); }
+    IORingCompletion* completions() { return reinterpret_cast<IORingCompletion*>(m_base + io_ring_completions_offset(m_entry_count)); }
+
+    int m_fd { -1 };
+    u8* m_base { nullptr };
+    size_t m_size { 0 };
+    u32 m_entry_count { 0 };
+};
+
+ErrorOr<void> IORing::transfer(IORingOpcode opcode, int fd, size_t total_size, Bytes buffer, size_t queue_depth)
+{
+    auto block_size = buffer.size() / queue_depth;
+    auto completion_mask = io_ring_completion_entry_count(m_entry_count) - 1;
+    size_t next_offset = 0;
+    size_t total_transferred = 0;
+    size_t in_flight = 0;
+
+    while (total_transferred < total_size) {
+        auto submission_tail = header().submission_tail;
+        while (in_flight < queue_depth && next_offset < total_size) {
+            auto length = min(block_size, total_size - next_offset);
+            auto block_index = (next_offset / block_size) % queue_depth;
+            submissions()[submission_tail & (m_entry_count - 1)] = {
+                .opcode = opcode,
+                .fd = fd,
+                .offset = static_cast<i64>(next_offset),
+                .buffer = reinterpret_cast<FlatPtr>(buffer.offset_pointer(block_index * block_size)),
+                .length = length,
+                .user_data = length,
+            };
+            submission_tail++;
+            next_offset += length;
+            in_flight++;
+        }
+        AK::atomic_store(&header().submission_tail, submission_tail, AK::memory_order_release);
+
+        auto to_submit = submission_tail - AK::atomic_load(&header().submission_head, AK::memory_order_acquire);
+        if (to_submit > 0)
+            TRY(Core::System::io_ring_enter(m_fd, to_submit));
+
+        auto completion_head = header().completion_head;
+        auto completion_tail = AK::atomic_load(&header().completion_tail, AK::memory_order_acquire);
+        for (; completion_head != completion_tail; ++completion_head) {
+            auto const& completion = completions()[completion_head & completion_mask];
+            if (completion.result < 0)
+                return Error::from_errno(static_cast<int>(-completion.result));
+            if (static_cast<u64>(completion.result) != completion.user_data)
+                return Error::from_string_literal("Short transfer");
+            total_transferred += completion.result;
+            in_flight--;
+        }
+        AK::atomic_store(&header().completion_head, completion_head, AK::memory_order_release);
+    }
+    return {};
+}
+
+static ErrorOr<Result> benchmark(DeprecatedString const& filename, int file_size, ByteBuffer& buffer, bool allow_cache, size_t queue_depth);
 
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
@@ -50,6 +151,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     Vector<size_t> file_sizes;
     Vector<size_t> block_sizes;
     bool allow_cache = false;
+    size_t queue_depth = 0;
 
     Core::ArgsParser args_parser;
     args_parser.add_option(allow_cache, "Allow using disk cache", "cache", 'c');
@@ -57,8 +159,14 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.add_option(time_per_benchmark_sec, "Time elapsed per benchmark (seconds)", "time-per-benchmark", 't', "time-per-benchmark");
     args_parser.add_option(file_sizes, "A comma-separated list of file sizes", "file-size", 'f', "file-size");
     args_parser.add_option(block_sizes, "A comma-separated list of block sizes", "block-size", 'b', "block-size");
+    args_parser.add_option(queue_depth, "Queue up this many blocks at a time through an I/O ring", "queue-depth", 'q', "queue-depth");
     args_parser.parse(arguments);
 
+    if (queue_depth > IO_RING_MAX_ENTRIES) {
+        warnln("The queue depth can be at most {}", IO_RING_MAX_ENTRIES);
+        return 1;
+    }
+
     Time const time_per_benchmark = Time::from_seconds(time_per_benchmark_sec);
 
     if (file_sizes.size() == 0) {
@@ -77,19 +185,19 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             if (block_size > file_size)
                 continue;
 
-            auto buffer_result = ByteBuffer::create_uninitialized(block_size);
+            auto buffer_result = ByteBuffer::create_uninitialized(block_size * max(queue_depth, 1));
             if (buffer_result.is_error()) {
                 warnln("Not enough memory to allocate space for block size = {}", block_size);
                 continue;
             }
             Vector<Result> results;
 
-            outln("Running: file_size={} block_size={}", file_size, block_size);
+            outln("Running: file_size={} block_size={} queue_depth={}", file_size, block_size, queue_depth);
             auto timer = Core::ElapsedTimer::start_new();
             while (timer.elapsed_time() < time_per_benchmark) {
                 out(".");
                 fflush(stdout);
-                auto result = TRY(benchmark(filename, file_size, buffer_result.value(), allow_cache));
+                auto result = TRY(benchmark(filename, file_size, buffer_result.value(), allow_cache, queue_depth));
                 results.append(result);
                 usleep(100);
             }
@@ -103,7 +211,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     return 0;
 }
 
-ErrorOr<Result> benchmark(DeprecatedString const& filename, int file_size, ByteBuffer& buffer, bool allow_cache)
+ErrorOr<Result> benchmark(DeprecatedString const& filename, int file_size, ByteBuffer& buffer, bool allow_cache, size_t queue_depth)
 {
     int flags = O_CREAT | O_TRUNC | O_RDWR;
     if (!allow_cache)
@@ -123,6 +231,22 @@ ErrorOr<Result> benchmark(DeprecatedString const& filename, int file_size, ByteB
 
     Result result;
 
+    if (queue_depth > 0) {
+        u32 entry_count = 1;
+        while (entry_count < queue_depth)
+            entry_count *= 2;
+        auto ring = TRY(IORing::create(entry_count));
+
+        auto timer = Core::ElapsedTimer::start_new();
+        TRY(ring.transfer(IORingOpcode::Write, fd, file_size, buffer, queue_depth));
+        result.write_bps = (u64)(timer.elapsed() ? (file_size / timer.elapsed()) : file_size) * 1000;
+
+        timer.start();
+        TRY(ring.transfer(IORingOpcode::Read, fd, file_size, buffer, queue_depth));
+        result.read_bps = (u64)(timer.elapsed() ? (file_size / timer.elapsed()) : file_size) * 1000;
+        return result;
+    }
+
     auto timer = Core::ElapsedTimer::start_new();
 
     ssize_t total_written = 0;
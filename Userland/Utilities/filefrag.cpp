@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/System.h>
+#include <LibMain/Main.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+struct Extent {
+    size_t logical_block { 0 };
+    u32 physical_block { 0 };
+    size_t length { 0 };
+};
+
+static ErrorOr<Vector<Extent>> file_extents(int fd, size_t block_count)
+{
+    Vector<Extent> extents;
+    for (size_t i = 0; i < block_count; ++i) {
+        int block = static_cast<int>(i);
+        TRY(Core::System::ioctl(fd, FIBMAP, &block));
+        // Holes don't have a physical block and don't count as an extent.
+        if (block == 0)
+            continue;
+        auto physical_block = static_cast<u32>(block);
+        if (!extents.is_empty()) {
+            auto& last = extents.last();
+            if (last.logical_block + last.length == i && last.physical_block + last.length == physical_block) {
+                last.length++;
+                continue;
+            }
+        }
+        TRY(extents.try_append({ i, physical_block, 1 }));
+    }
+    return extents;
+}
+
+ErrorOr<int> serenity_main(Main::Arguments arguments)
+{
+    Vector<StringView> paths;
+    bool verbose = false;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Report how many pieces the blocks of a file are split into on disk.");
+    args_parser.add_option(verbose, "List every extent", "verbose", 'v');
+    args_parser.add_positional_argument(paths, "Files to inspect", "files");
+    args_parser.parse(arguments);
+
+    TRY(Core::System::pledge("stdio rpath"));
+
+    size_t total_files = 0;
+    size_t total_extents = 0;
+    bool failed = false;
+    for (auto path : paths) {
+        auto fd_or_error = Core::System::open(path, O_RDONLY);
+        if (fd_or_error.is_error()) {
+            warnln("filefrag: {}: {}", path, fd_or_error.error());
+            failed = true;
+            continue;
+        }
+        int fd = fd_or_error.value();
+
+        auto result = [&]() -> ErrorOr<void> {
+            auto st = TRY(Core::System::fstat(fd));
+            if (!S_ISREG(st.st_mode))
+                return Error::from_errno(EINVAL);
+            if (st.st_blksize <= 0)
+                return Error::from_errno(ENOTSUP);
+            size_t block_count = ceil_div(static_cast<u64>(st.st_size), static_cast<u64>(st.st_blksize));
+            auto extents = TRY(file_extents(fd, block_count));
+
+            outln("{}: {} extent{} found", path, extents.size(), extents.size() == 1 ? "" : "s");
+            if (verbose) {
+                for (auto const& extent : extents)
+                    outln("  logical {}..{} at physical {}..{} ({} blocks)", extent.logical_block, extent.logical_block + extent.length - 1,
+                        extent.physical_block, extent.physical_block + extent.length - 1, extent.length);
+            }
+            total_files++;
+            total_extents += extents.size();
+            return {};
+        }();
+        (void)Core::System::close(fd);
+
+        if (result.is_error()) {
+            warnln("filefrag: {}: {}", path, result.error());
+            failed = true;
+        }
+    }
+
+    if (total_files > 1)
+        outln("{} files, {} extents, {}.{:02} extents per file", total_files, total_extents,
+            total_extents / total_files, (total_extents * 100 / total_files) % 100);
+
+    return failed ? 1 : 0;
+}
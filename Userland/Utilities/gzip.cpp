@@ -17,11 +17,13 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     bool keep_input_files { false };
     bool write_to_stdout { false };
     bool decompress { false };
+    bool parallel { false };
 
     Core::ArgsParser args_parser;
     args_parser.add_option(keep_input_files, "Keep (don't delete) input files", "keep", 'k');
     args_parser.add_option(write_to_stdout, "Write to stdout, keep original files unchanged", "stdout", 'c');
     args_parser.add_option(decompress, "Decompress", "decompress", 'd');
+    args_parser.add_option(parallel, "Compress independent chunks on all processors", "parallel", 'p');
     args_parser.add_positional_argument(filenames, "Files", "FILES");
     args_parser.parse(arguments);
 
@@ -53,7 +55,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         if (decompress)
             output_bytes = TRY(Compress::GzipDecompressor::decompress_all(input_bytes));
         else
-            output_bytes = TRY(Compress::GzipCompressor::compress_all(input_bytes));
+            output_bytes = TRY(Compress::GzipCompressor::compress_all(input_bytes, parallel ? Compress::DeflateCompressor::Parallelism::Parallel : Compress::DeflateCompressor::Parallelism::Serial));
 
         auto output_stream = write_to_stdout ? TRY(Core::Stream::File::standard_output()) : TRY(Core::Stream::File::open(output_filename, Core::Stream::OpenMode::Write));
         TRY(output_stream->write_entire_buffer(output_bytes));
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/HashMap.h>
+#include <AK/NumberFormat.h>
+#include <AK/QuickSort.h>
+#include <AK/URL.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/Stream.h>
+#include <LibCore/System.h>
+#include <LibMain/Main.h>
+#include <poll.h>
+
+struct Connection {
+    OwnPtr<Core::Stream::TCPSocket> socket;
+    bool is_waiting_for_response { false };
+    Core::ElapsedTimer request_timer { true };
+    ByteBuffer response;
+    // Known once we have seen all of the response headers.
+    Optional<size_t> response_size;
+    unsigned status_code { 0 };
+    bool server_closes_connection { false };
+};
+
+struct Results {
+    size_t completed { 0 };
+    size_t failed { 0 };
+    DeprecatedString first_failure;
+    u64 received_bytes { 0 };
+    Vector<u64> latencies_in_microseconds;
+    HashMap<unsigned, size_t> status_codes;
+};
+
+// Fills in the response size, status and whether the server is going to close the connection, once the headers are complete.
+static ErrorOr<void> parse_response_headers(Connection& connection)
+{
+    auto response = StringView { connection.response.bytes() };
+    auto end_of_headers = response.find("\r\n\r\n"sv);
+    if (!end_of_headers.has_value())
+        return {};
+
+    auto lines = response.substring_view(0, end_of_headers.value()).split_view("\r\n"sv);
+    auto status_line = lines.first().split_view(' ');
+    if (status_line.size() < 2 || !status_line[0].starts_with("HTTP/"sv))
+        return Error::from_string_literal("Invalid status line");
+    auto status_code = status_line[1].to_uint();
+    if (!status_code.has_value())
+        return Error::from_string_literal("Invalid status code");
+    connection.status_code = status_code.value();
+
+    Optional<size_t> content_length;
+    for (size_t i = 1; i < lines.size(); ++i) {
+        auto colon = lines[i].find(':');
+        if (!colon.has_value())
+            continue;
+        auto name = lines[i].substring_view(0, colon.value()).trim_whitespace();
+        auto value = lines[i].substring_view(colon.value() + 1).trim_whitespace();
+        if (name.equals_ignoring_case("Content-Length"sv))
+            content_length = value.to_uint<size_t>();
+        else if (name.equals_ignoring_case("Connection"sv) && value.equals_ignoring_case("close"sv))
+            connection.server_closes_connection = true;
+    }
+
+    // Not Modified responses don't have a body, but may still say how big it would have been.
+    if (connection.status_code == 304)
+        content_length = 0;
+    if (!content_length.has_value())
+        return Error::from_string_literal("Response without a Content-Length");
+
+    connection.response_size = end_of_headers.value() + 4 + content_length.value();
+    return {};
+}
+
+ErrorOr<int> serenity_main(Main::Arguments arguments)
+{
+    StringView url_string;
+    size_t connection_count = 8;
+    size_t request_count = 1000;
+    bool close_connections = false;
+    Vector<StringView> extra_headers;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Send lots of HTTP requests to a server over several connections at once, and report how fast it answered them.");
+    args_parser.add_option(connection_count, "Number of connections to keep busy", "connections", 'c', "connections");
+    args_parser.add_option(request_count, "Total number of requests to send", "requests", 'n', "requests");
+    args_parser.add_option(close_connections, "Use a new connection for every request", "close", 'C');
+    args_parser.add_option(Core::ArgsParser::Option {
+        .argument_mode = Core::ArgsParser::OptionArgumentMode::Required,
+        .help_string = "Add a header to every request",
+        .long_name = "header",
+        .short_name = 'H',
+        .value_name = "header",
+        .accept_value = [&](char const* header) {
+            extra_headers.append({ header, strlen(header) });
+            return true;
+        },
+    });
+    args_parser.add_positional_argument(url_string, "URL to request", "url");
+    args_parser.parse(arguments);
+
+    if (connection_count == 0 || request_count == 0) {
+        warnln("The number of connections and requests have to be positive");
+        return 1;
+    }
+    connection_count = min(connection_count, request_count);
+
+    URL url(url_string);
+    if (!url.is_valid() || url.scheme() != "http") {
+        warnln("Only http:// URLs are supported");
+        return 1;
+    }
+
+    StringBuilder request_builder;
+    request_builder.appendff("GET {}", url.path());
+    if (!url.query().is_empty())
+        request_builder.appendff("?{}", url.query());
+    request_builder.append(" HTTP/1.1\r\n"sv);
+    request_builder.appendff("Host: {}\r\n", url.host());
+    request_builder.append(close_connections ? "Connection: close\r\n"sv : "Connection: keep-alive\r\n"sv);
+    for (auto header : extra_headers)
+        request_builder.appendff("{}\r\n", header);
+    request_builder.append("\r\n"sv);
+    auto request = request_builder.to_byte_buffer();
+
+    TRY(Core::System::pledge("stdio inet unix dns"));
+
+    // The sockets want an event loop to exist, even though we wait for them with poll() ourselves.
+    Core::EventLoop loop;
+
+    Vector<Connection> connections;
+    TRY(connections.try_resize(connection_count));
+    Results results;
+    TRY(results.latencies_in_microseconds.try_ensure_capacity(request_count));
+    size_t requests_sent = 0;
+
+    auto fail_request = [&](Connection& connection, auto const& reason) {
+        if (results.failed++ == 0)
+            results.first_failure = DeprecatedString::formatted("{}", reason);
+        connection.socket = nullptr;
+        connection.is_waiting_for_response = false;
+        connection.response.clear();
+        connection.response_size.clear();
+        connection.server_closes_connection = false;
+    };
+
+    auto finish_request = [&](Connection& connection) {
+        results.completed++;
+        results.received_bytes += connection.response.size();
+        results.latencies_in_microseconds.unchecked_append(connection.request_timer.elapsed_time().to_microseconds());
+        results.status_codes.ensure(connection.status_code)++;
+        if (close_connections || connection.server_closes_connection)
+            connection.socket = nullptr;
+        connection.is_waiting_for_response = false;
+        connection.response.clear();
+        connection.response_size.clear();
+        connection.server_closes_connection = false;
+    };
+
+    auto send_request = [&](Connection& connection) -> ErrorOr<void> {
+        if (!connection.socket)
+            connection.socket = TRY(Core::Stream::TCPSocket::connect(url.host(), url.port_or_default()));
+        connection.request_timer.start();
+        TRY(connection.socket->write_entire_buffer(request));
+        connection.is_waiting_for_response = true;
+        return {};
+    };
+
+    auto timer = Core::ElapsedTimer::start_new();
+
+    Vector<pollfd> pollfds;
+    auto buffer = TRY(ByteBuffer::create_uninitialized(64 * KiB));
+    while (results.completed + results.failed < request_count) {
+        for (auto& connection : connections) {
+            if (connection.is_waiting_for_response || requests_sent >= request_count)
+                continue;
+            requests_sent++;
+            if (auto result = send_request(connection); result.is_error())
+                fail_request(connection, result.error());
+        }
+
+        pollfds.clear_with_capacity();
+        for (auto& connection : connections) {
+            if (connection.is_waiting_for_response)
+                TRY(pollfds.try_append({ .fd = connection.socket->fd(), .events = POLLIN, .revents = 0 }));
+        }
+        if (pollfds.is_empty())
+            continue;
+        TRY(Core::System::poll(pollfds, -1));
+
+        for (auto& connection : connections) {
+            if (!connection.is_waiting_for_response)
+                continue;
+            auto pollfd = pollfds.first_matching([&](auto& pollfd) { return pollfd.fd == connection.socket->fd(); });
+            if (!pollfd.has_value() || pollfd->revents == 0)
+                continue;
+
+            auto bytes_read_or_error = connection.socket->read(buffer);
+            if (bytes_read_or_error.is_error()) {
+                fail_request(connection, bytes_read_or_error.error());
+                continue;
+            }
+            if (bytes_read_or_error.value().is_empty()) {
+                fail_request(connection, "Connection closed before the response was complete"sv);
+                continue;
+            }
+            TRY(connection.response.try_append(bytes_read_or_error.value()));
+
+            if (!connection.response_size.has_value()) {
+                if (auto result = parse_response_headers(connection); result.is_error()) {
+                    fail_request(connection, result.error());
+                    continue;
+                }
+            }
+            if (connection.response_size.has_value() && connection.response.size() >= connection.response_size.value())
+                finish_request(connection);
+        }
+    }
+
+    auto elapsed_milliseconds = max<i64>(timer.elapsed(), 1);
+
+    outln("{} requests over {} connections in {}ms: {} requests/s, {}/s", results.completed, connection_count, elapsed_milliseconds,
+        static_cast<u64>(results.completed) * 1000 / elapsed_milliseconds, human_readable_size(results.received_bytes * 1000 / elapsed_milliseconds));
+    if (results.failed > 0)
+        outln("{} requests failed, the first one with: {}", results.failed, results.first_failure);
+
+    for (auto& status_code : results.status_codes)
+        outln("  {} responses with status {}", status_code.value, status_code.key);
+
+    auto& latencies = results.latencies_in_microseconds;
+    if (!latencies.is_empty()) {
+        quick_sort(latencies);
+        u64 total = 0;
+        for (auto latency : latencies)
+            total += latency;
+        auto percentile = [&](size_t percent) { return latencies[min(latencies.size() - 1, latencies.size() * percent / 100)]; };
+        outln("Latency: average {}us, median {}us, 90th percentile {}us, 99th percentile {}us, maximum {}us",
+            total / latencies.size(), percentile(50), percentile(90), percentile(99), latencies.last());
+    }
+
+    return results.failed > 0 ? 1 : 0;
+}
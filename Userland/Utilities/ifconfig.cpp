@@ -47,6 +47,9 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             auto bytes_in = if_object.get_u32("bytes_in"sv).value_or(0);
             auto packets_out = if_object.get_u32("packets_out"sv).value_or(0);
             auto bytes_out = if_object.get_u32("bytes_out"sv).value_or(0);
+            auto packets_dropped = if_object.get_u32("packets_dropped"sv).value_or(0);
+            auto packets_in_per_second = if_object.get_u32("packets_in_per_second"sv).value_or(0);
+            auto packets_out_per_second = if_object.get_u32("packets_out_per_second"sv).value_or(0);
             auto mtu = if_object.get_u32("mtu"sv).value_or(0);
 
             outln("{}:", name);
@@ -54,8 +57,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             outln("\tipv4: {}", ipv4_address);
             outln("\tnetmask: {}", netmask);
             outln("\tclass: {}", class_name);
-            outln("\tRX: {} packets {} bytes ({})", packets_in, bytes_in, human_readable_size(bytes_in));
-            outln("\tTX: {} packets {} bytes ({})", packets_out, bytes_out, human_readable_size(bytes_out));
+            outln("\tRX: {} packets {} bytes ({}), {} dropped, {} packets/s", packets_in, bytes_in, human_readable_size(bytes_in), packets_dropped, packets_in_per_second);
+            outln("\tTX: {} packets {} bytes ({}), {} packets/s", packets_out, bytes_out, human_readable_size(bytes_out), packets_out_per_second);
             outln("\tMTU: {}", mtu);
             outln();
         });
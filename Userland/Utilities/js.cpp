@@ -71,6 +71,7 @@ private:
 
 static bool s_dump_ast = false;
 static bool s_run_bytecode = false;
+static bool s_dump_property_lookup_cache_statistics = false;
 static bool s_opt_bytecode = false;
 static bool s_as_module = false;
 static bool s_print_last_result = false;
@@ -236,6 +237,13 @@ static ErrorOr<bool> parse_and_run(JS::Interpreter& interpreter, StringView sour
                     result = result_or_error.value.release_error();
                 else
                     result = result_or_error.frame->registers[0];
+
+                if (s_dump_property_lookup_cache_statistics) {
+                    auto const& statistics = JS::Bytecode::g_property_lookup_cache_statistics;
+                    auto hit_rate = [](u64 hits, u64 misses) { return hits + misses ? 100.0 * hits / (hits + misses) : 0.0; };
+                    warnln("GetById: {} hits, {} misses ({:.1}% hit rate)", statistics.get_hits, statistics.get_misses, hit_rate(statistics.get_hits, statistics.get_misses));
+                    warnln("PutById: {} hits, {} misses ({:.1}% hit rate)", statistics.put_hits, statistics.put_misses, hit_rate(statistics.put_hits, statistics.put_misses));
+                }
             } else {
                 return ReturnEarly::Yes;
             }
@@ -602,6 +610,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.add_option(JS::Bytecode::g_dump_bytecode, "Dump the bytecode", "dump-bytecode", 'd');
     args_parser.add_option(s_run_bytecode, "Run the bytecode", "run-bytecode", 'b');
     args_parser.add_option(s_opt_bytecode, "Optimize the bytecode", "optimize-bytecode", 'p');
+    args_parser.add_option(s_dump_property_lookup_cache_statistics, "Report the hit rate of the property lookup caches after running the bytecode", "dump-property-lookup-cache-statistics", 0);
+    args_parser.add_option(JS::Bytecode::g_dump_optimization_statistics, "Report register and instruction counts before and after optimizing the bytecode", "dump-optimization-statistics", 0);
     args_parser.add_option(s_as_module, "Treat as module", "as-module", 'm');
     args_parser.add_option(s_print_last_result, "Print last result", "print-last-result", 'l');
     args_parser.add_option(s_strip_ansi, "Disable ANSI colors", "disable-ansi-colors", 'i');
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/NumberFormat.h>
+#include <AK/ScopeGuard.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/System.h>
+#include <LibMain/Main.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static ErrorOr<int> listen_on_loopback(u16& port)
+{
+    int fd = TRY(Core::System::socket(AF_INET, SOCK_STREAM, 0));
+
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    TRY(Core::System::bind(fd, reinterpret_cast<sockaddr const*>(&address), sizeof(address)));
+    TRY(Core::System::listen(fd, 1));
+
+    socklen_t address_size = sizeof(address);
+    TRY(Core::System::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &address_size));
+    port = ntohs(address.sin_port);
+    return fd;
+}
+
+static ErrorOr<void> send_data(u16 port, size_t total_size, size_t block_size)
+{
+    int fd = TRY(Core::System::socket(AF_INET, SOCK_STREAM, 0));
+    ScopeGuard close_fd = [fd] { (void)Core::System::close(fd); };
+
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    TRY(Core::System::connect(fd, reinterpret_cast<sockaddr const*>(&address), sizeof(address)));
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(block_size));
+    buffer.bytes().fill('x');
+
+    size_t total_written = 0;
+    while (total_written < total_size) {
+        auto chunk = buffer.bytes().trim(total_size - total_written);
+        total_written += TRY(Core::System::write(fd, chunk));
+    }
+    return {};
+}
+
+static ErrorOr<size_t> receive_data(int listen_fd, size_t block_size)
+{
+    int fd = TRY(Core::System::accept(listen_fd, nullptr, nullptr));
+    ScopeGuard close_fd = [fd] { (void)Core::System::close(fd); };
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(block_size));
+    size_t total_read = 0;
+    for (;;) {
+        auto nread = TRY(Core::System::read(fd, buffer));
+        if (nread == 0)
+            break;
+        total_read += nread;
+    }
+    return total_read;
+}
+
+ErrorOr<int> serenity_main(Main::Arguments arguments)
+{
+    size_t total_size_in_mib = 64;
+    size_t block_size = 64 * KiB;
+    int runs = 3;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure TCP throughput over the loopback interface.");
+    args_parser.add_option(total_size_in_mib, "Amount of data to send per run (MiB)", "size", 's', "size");
+    args_parser.add_option(block_size, "Size of each write", "block-size", 'b', "block-size");
+    args_parser.add_option(runs, "Number of runs", "runs", 'r', "runs");
+    args_parser.parse(arguments);
+
+    if (block_size == 0 || total_size_in_mib == 0 || runs <= 0) {
+        warnln("Sizes and the number of runs have to be positive");
+        return 1;
+    }
+
+    size_t total_size = total_size_in_mib * MiB;
+
+    for (int run = 0; run < runs; ++run) {
+        u16 port = 0;
+        int listen_fd = TRY(listen_on_loopback(port));
+        ScopeGuard close_listen_fd = [listen_fd] { (void)Core::System::close(listen_fd); };
+
+        auto timer = Core::ElapsedTimer::start_new();
+
+        pid_t child_pid = TRY(Core::System::fork());
+        if (child_pid == 0) {
+            if (auto result = send_data(port, total_size, block_size); result.is_error()) {
+                warnln("Sending failed: {}", result.error());
+                _exit(1);
+            }
+            _exit(0);
+        }
+
+        auto total_read = TRY(receive_data(listen_fd, block_size));
+        auto elapsed_milliseconds = max<i64>(timer.elapsed(), 1);
+        auto wait_result = TRY(Core::System::waitpid(child_pid));
+        if (!WIFEXITED(wait_result.status) || WEXITSTATUS(wait_result.status) != 0)
+            return 1;
+
+        if (total_read != total_size)
+            warnln("Only received {} of {} bytes", total_read, total_size);
+
+        u64 bytes_per_second = static_cast<u64>(total_read) * 1000 / elapsed_milliseconds;
+        outln("Run {}: {} in {}ms, {}/s", run + 1, human_readable_size(total_read), elapsed_milliseconds, human_readable_size(bytes_per_second));
+    }
+
+    return 0;
+}